@@ -5,25 +5,85 @@
 
 //#include <SoftwareSerial.h>
 
-#include "mgrs.h"
-#include <TinyGPS.h>
+#include "mgrs_tracker.h"
+#include "nmea.h"
+#include "serial_ring.h"
 #include <Wire.h>
 #include <Adafruit_GFX.h>
 #include <Adafruit_SSD1306.h>
 
 #define OLED_RESET 4
+#define OLED_ADDRESS 0x3C
+
+// Work done per pass of loop(); the serial port is drained between stages,
+// so no stage may hold it up for longer than the UART buffer lasts
+#ifndef PARSE_BUDGET
+#define PARSE_BUDGET 32   // Bytes parsed
+#endif
+#ifndef FLUSH_CHUNK
+#define FLUSH_CHUNK 16    // Display bytes sent over I2C
+#endif
+
+// The screen is a grid of text cells; only the cells whose character
+// changed are redrawn, and only the pages and columns they cover are sent
+#define TEXT_SIZE    2
+#define TEXT_ROWS    4
+#define TEXT_COLUMNS 10
+#define CELL_WIDTH   (6 * TEXT_SIZE)
+#define CELL_HEIGHT  (8 * TEXT_SIZE)
+#define MAX_PAGES    8
+
+// Hooks for timing the pipeline on the host (extras/ingest_sim)
+#ifndef INGEST_TRACE
+#define INGEST_TRACE(event)
+#endif
+#define TRACE_FIX    0    // A sentence with a fix has been parsed
+#define TRACE_RENDER 1    // The latest fix has been drawn into the buffer
+#define TRACE_FRAME  2    // That frame is now all on the display
+
+// Build with MGRS_PROBES defined to time each stage (mgrs_probe.h) and
+// dump the histograms over SerialUSB every PROBE_DUMP_MS
+#define PROBE_DUMP_MS 60000
+
 Adafruit_SSD1306 display(OLED_RESET);
 
 //SoftwareSerial mySerial(3, 4);
-TinyGPS gps;
+Serial_Ring ring;
+char sentence[NMEA_MAX_SENTENCE + 1];
+int sentence_length = 0;
+NMEA_Fix fix;
+bool fix_pending = false;     // Parsed but not drawn yet
+bool frame_pending = false;   // Drawn but not all sent yet
+bool full_redraw = true;      // Next frame must clear and send the screen
+char lines[TEXT_ROWS][TEXT_COLUMNS + 1];  // Text of the latest frame
+char shown[TEXT_ROWS][TEXT_COLUMNS + 1];  // Text already in the buffer
+uint8_t dirty_first[MAX_PAGES];   // Columns of each page still to send,
+uint8_t dirty_last[MAX_PAGES];    // none when first > last
+int flush_page = 0;
+int flush_column = -1;        // -1 until the page's window is set
+char string[16];
+MGRS_Tracker tracker;
+#ifdef MGRS_PROBES
+MGRS_Probe_Ticks fix_ticks;     // When the latest fix was parsed
+MGRS_Probe_Ticks frame_ticks;   // When the fix being sent was parsed
+unsigned long last_dump = 0;
+void printProbeLine(const char *line);
+#endif
 
-void gpsdump(TinyGPS &gps);
-void printFloat(double f, int digits = 2);
-char string[15];
+void drainSerial();
+void parseStage();
+void convertStage();
+void flushStage();
+void drawFix(NMEA_Fix &fix);
+void drawLines();
 
-void setup()  
+void setup()
 {
-  display.begin(SSD1306_SWITCHCAPVCC, 0x3C);
+  Init_MGRS_Tracker(&tracker, &MGRS_Float_Default_Parameters);
+  Init_Serial_Ring(&ring);
+  memset(dirty_first, 0xFF, sizeof(dirty_first));
+  memset(dirty_last, 0, sizeof(dirty_last));
+  display.begin(SSD1306_SWITCHCAPVCC, OLED_ADDRESS);
   //display.dim(1);
 
   display.clearDisplay();
@@ -33,103 +93,219 @@ void setup()
   display.println("Loading.");
   //Serial.println(string);
   display.display();
-  Serial1begin(9600);
+  Wire.setClock(400000);
+  Serial1.begin(9600);
   //SerialUSB.begin(9600);
+#ifdef MGRS_PROBES
+  SerialUSB.begin(9600);
+  Reset_MGRS_Probes();
+#endif
 }
 
 void loop() // run over and over
 {
-  bool newdata = false;
-  unsigned long start = millis();
-  // Every 5 seconds we print an update
-  while (millis() - start < 5000) 
+  // Each stage does a bounded step and returns; none waits for the GPS
+  drainSerial();
+  parseStage();
+  drainSerial();
+  convertStage();
+  drainSerial();
+  flushStage();
+#ifdef MGRS_PROBES
+  if (millis() - last_dump >= PROBE_DUMP_MS)
   {
-    if (Serial1.available()) 
-    
-    {
-      char c = Serial1.read();
-      //SerialUSB.print(c);  // uncomment to see raw GPS data
-      if (gps.encode(c)) 
-      {
-        newdata = true;
-        break;  // uncomment to print new data immediately!
-      }
-    }
+    last_dump = millis();
+    Dump_MGRS_Probes(printProbeLine);
   }
-  
-  if (newdata) 
+#endif
+}
+
+#ifdef MGRS_PROBES
+void printProbeLine(const char *line)
+{
+  SerialUSB.println(line);
+}
+#endif
+
+// Move whatever the UART has received into the ring
+void drainSerial()
+{
+  while (Serial1.available())
   {
-    gpsdump(gps);
+    char c = Serial1.read();
+    //SerialUSB.print(c);  // uncomment to see raw GPS data
+    Put_Serial_Ring(&ring, c);
   }
-  
 }
 
-void gpsdump(TinyGPS &gps)
+// Assemble sentences from the ring and parse each as it completes
+void parseStage()
 {
-  long lat, lon;
-  float flat, flon;
-  unsigned long age, date, time, chars;
-  int year;
-  int result;
-  gps.get_datetime(&date, &time, &age);
-  gps.f_get_position(&flat, &flon, &age);
-  result = Convert_Geodetic_To_MGRS( double(flat) * PI180,  double(flon) * PI180, 5, string);
-  int hours = time / 1000000;
-  hours = (hours+3) % 24;
-  int minutes = (time % 1000000) / 10000;
-  int seconds = (time % 10000) / 100;
-  int sats = gps.satellites();
-  display.clearDisplay();
-  display.setCursor(0,0);
-  display.print(" ");
-  if(hours < 10)
+  unsigned char c;
+  NMEA_Fix parsed;
+
+  for (int i = 0; i < PARSE_BUDGET && Get_Serial_Ring(&ring, &c); i++)
   {
-    display.print(0);
+    if (c == '$')
+      sentence_length = 0;
+    if (sentence_length < (int)sizeof(sentence))
+      sentence[sentence_length++] = c;
+    if (c == '\n' && sentence_length > 0 && sentence[0] == '$')
+    {
+      MGRS_PROBE_BEGIN(MGRS_PROBE_NMEA_PARSE);
+      long error = Parse_NMEA_Sentence(sentence, sentence + sentence_length, &parsed);
+      MGRS_PROBE_END(MGRS_PROBE_NMEA_PARSE);
+      if (!error)
+      {
+        fix = parsed;     // A newer fix replaces one not drawn yet
+        fix_pending = true;
+#ifdef MGRS_PROBES
+        fix_ticks = Get_MGRS_Probe_Ticks();
+#endif
+        INGEST_TRACE(TRACE_FIX);
+      }
+      sentence_length = 0;
+    }
   }
-  display.print(hours); display.print(":");
-  if(minutes < 10)
+}
+
+// Convert the latest fix and draw it, once the last frame is out
+void convertStage()
+{
+  if (!fix_pending || frame_pending)
+    return;
+  MGRS_PROBE_BEGIN(MGRS_PROBE_TRACKER);
+  long error = Update_MGRS_Tracker(&tracker, fix.Latitude, fix.Longitude, 5, string);
+  MGRS_PROBE_END(MGRS_PROBE_TRACKER);
+  if (error)
+    memset(string, 0, sizeof(string));  // Off the grid: blank the MGRS lines, keep the clock
+  MGRS_PROBE_BEGIN(MGRS_PROBE_DRAW);
+  drawFix(fix);
+  MGRS_PROBE_END(MGRS_PROBE_DRAW);
+#ifdef MGRS_PROBES
+  frame_ticks = fix_ticks;
+#endif
+  fix_pending = false;
+  frame_pending = true;
+  flush_page = 0;
+  flush_column = -1;
+  INGEST_TRACE(TRACE_RENDER);
+}
+
+// Send the next FLUSH_CHUNK bytes of the changed part of the frame
+void flushStage()
+{
+  int pages = display.height() / 8;
+  uint8_t *buffer = display.getBuffer();
+
+  if (!frame_pending)
+    return;
+  while (flush_page < pages && dirty_first[flush_page] > dirty_last[flush_page])
+    flush_page++;
+  if (flush_page == pages)
   {
-    display.print(0);
+    frame_pending = false;
+#ifdef MGRS_PROBES
+    Record_MGRS_Probe(MGRS_PROBE_FIX_TO_FRAME, Get_MGRS_Probe_Ticks() - frame_ticks);
+#endif
+    INGEST_TRACE(TRACE_FRAME);
+    return;
   }
-  display.print(minutes);display.print(":");
-  if(seconds < 10)
+  MGRS_PROBE_BEGIN(MGRS_PROBE_FLUSH);
+  if (flush_column < 0)
   {
-    display.print(0);
+    flush_column = dirty_first[flush_page];
+    Wire.beginTransmission(OLED_ADDRESS);
+    Wire.write((uint8_t)0x00);  // Commands follow
+    Wire.write((uint8_t)SSD1306_PAGEADDR);
+    Wire.write((uint8_t)flush_page);
+    Wire.write((uint8_t)flush_page);
+    Wire.write((uint8_t)SSD1306_COLUMNADDR);
+    Wire.write((uint8_t)flush_column);
+    Wire.write((uint8_t)dirty_last[flush_page]);
+    Wire.endTransmission();
   }
-  display.println(seconds);
-  //display.print(flat,6); display.print(", "); display.println(flon,6);
-  display.print("   ");
-  for(int i = 0;i < 5;i++)
+  Wire.beginTransmission(OLED_ADDRESS);
+  Wire.write((uint8_t)0x40);    // Display data follows
+  for (int i = 0; i < FLUSH_CHUNK && flush_column <= dirty_last[flush_page]; i++)
+    Wire.write(buffer[flush_page * display.width() + flush_column++]);
+  Wire.endTransmission();
+  if (flush_column > dirty_last[flush_page])
   {
-    display.print(string[i]);
+    dirty_first[flush_page] = 0xFF;
+    dirty_last[flush_page] = 0;
+    flush_page++;
+    flush_column = -1;
   }
-  display.println();
-  display.print("   ");
-  for(int i = 5;i < 10;i++)
+  MGRS_PROBE_END(MGRS_PROBE_FLUSH);
+}
+
+void drawFix(NMEA_Fix &fix)
+{
+  int hours = fix.Time / 3600000;
+  hours = (hours+3) % 24;
+  int minutes = (fix.Time / 60000) % 60;
+  int seconds = (fix.Time / 1000) % 60;
+  int clock[3] = {hours, minutes, seconds};
+  lines[0][0] = ' ';
+  for (int i = 0; i < 3; i++)
   {
-    display.print(string[i]);
+    lines[0][1 + 3 * i] = '0' + clock[i] / 10;
+    lines[0][2 + 3 * i] = '0' + clock[i] % 10;
+    lines[0][3 + 3 * i] = (i < 2) ? ':' : 0;
   }
-  display.println();
-  display.print("   ");
-  for(int i = 10;i < 15;i++)
+  for (int row = 1; row < TEXT_ROWS; row++)
   {
-    display.print(string[i]);
+    memcpy(lines[row], "   ", 3);
+    memcpy(lines[row] + 3, string + 5 * (row - 1), 5);
+    lines[row][8] = 0;
   }
-  display.println();
-  //SerialUSB.print(flat,6);
-  //SerialUSB.print(", ");
-  //SerialUSB.print(flon,6);
-  //SerialUSB.print(" ");
+  drawLines();
   //SerialUSB.println(string);
-  //display.setTextSize(1);
-
-  /*display.print("Satellites: ");*/ 
-  //display.setCursor(60,24);
-  //display.println(sats);
-
-  //display.setCursor(17,9);
-  //display.setTextSize(2);
+}
 
-  display.display();
+// Redraw the cells of lines that differ from what is in the buffer, and
+// mark the columns of the pages they cover for sending
+void drawLines()
+{
+  int pages = display.height() / 8;
 
+  if (full_redraw)
+  {
+    display.clearDisplay();
+    memset(shown, 0, sizeof(shown));
+    for (int page = 0; page < pages; page++)
+    {
+      dirty_first[page] = 0;
+      dirty_last[page] = display.width() - 1;
+    }
+    full_redraw = false;
+  }
+  for (int row = 0; row < TEXT_ROWS; row++)
+  {
+    bool ended = false;  // Cells past the end of the line are blank
+    for (int column = 0; column < TEXT_COLUMNS; column++)
+    {
+      char c = ' ';
+      if (!ended && lines[row][column])
+        c = lines[row][column];
+      else
+        ended = true;
+      if (c == shown[row][column])
+        continue;
+      int x = column * CELL_WIDTH;
+      int y = row * CELL_HEIGHT;
+      display.fillRect(x, y, CELL_WIDTH, CELL_HEIGHT, BLACK);
+      if (c != ' ')
+        display.drawChar(x, y, c, WHITE, BLACK, TEXT_SIZE);
+      shown[row][column] = c;
+      for (int page = y / 8; page <= (y + CELL_HEIGHT - 1) / 8 && page < pages; page++)
+      {
+        if (x < dirty_first[page])
+          dirty_first[page] = x;
+        if (x + CELL_WIDTH - 1 > dirty_last[page])
+          dirty_last[page] = x + CELL_WIDTH - 1;
+      }
+    }
+  }
 }
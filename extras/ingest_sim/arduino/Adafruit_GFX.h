@@ -0,0 +1,83 @@
+/*
+ * Host stand-in for Adafruit_GFX text drawing, for extras/ingest_sim.
+ * Characters are 6 x 8 pixel cells times the text size, as with the
+ * built-in font, but each glyph is a pattern made from its character code
+ * rather than the real font (a blank for space): what matters on the host
+ * is which pixels a frame changes.
+ */
+
+#ifndef ADAFRUIT_GFX_H
+#define ADAFRUIT_GFX_H
+
+#include "Arduino.h"
+
+class Adafruit_GFX : public Print
+{
+public:
+  int16_t _width;
+  int16_t _height;
+  int16_t cursor_x;
+  int16_t cursor_y;
+  uint8_t textsize;
+
+  Adafruit_GFX (int16_t w, int16_t h) : _width (w), _height (h), cursor_x (0), cursor_y (0),
+                                        textsize (1) {}
+
+  virtual void drawPixel (int16_t x, int16_t y, uint16_t color) = 0;
+
+  int16_t width () const { return (_width); }
+  int16_t height () const { return (_height); }
+  void setCursor (int16_t x, int16_t y) { cursor_x = x; cursor_y = y; }
+  void setTextSize (uint8_t s) { textsize = s ? s : 1; }
+  void setTextColor (uint16_t) {}
+
+  void fillRect (int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+  {
+    int16_t i;
+    int16_t j;
+
+    for (i = 0; i < w; i++)
+      for (j = 0; j < h; j++)
+        drawPixel (x + i, y + j, color);
+  }
+
+  /* As the real one: the 6 x 8 cell is filled with bg unless bg == color */
+  void drawChar (int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size)
+  {
+    int16_t col;
+    int16_t row;
+    uint8_t bits;
+
+    for (col = 0; col < 6; col++)
+    {
+      bits = ((col < 5) && (c != ' ')) ? ((uint8_t)((c * 37 + col * 101) ^ (c >> 1)) & 0x7F) : 0;
+      for (row = 0; row < 8; row++)
+        if (bits & (1 << row))
+          fillRect (x + col * size, y + row * size, size, size, color);
+        else if (bg != color)
+          fillRect (x + col * size, y + row * size, size, size, bg);
+    }
+  }
+
+  size_t write (uint8_t c)
+  {
+    if (c == '\n')
+    {
+      cursor_x = 0;
+      cursor_y += textsize * 8;
+    }
+    else if (c != '\r')
+    {
+      if (cursor_x + textsize * 6 > _width)
+      {
+        cursor_x = 0;
+        cursor_y += textsize * 8;
+      }
+      drawChar (cursor_x, cursor_y, c, 1, 1, textsize);
+      cursor_x += textsize * 6;
+    }
+    return (1);
+  }
+};
+
+#endif /* ADAFRUIT_GFX_H */
@@ -0,0 +1,131 @@
+/*
+ * Host stand-in for the Adafruit SSD1306 OLED driver, for
+ * extras/ingest_sim: a 128 x 64 frame buffer in the driver's layout (one
+ * byte per 8 pixel column of a page).  display() sends all of it through
+ * the Wire stand-in, blocking as the real driver does.  The panel itself
+ * is modelled too: SSD1306_Panel takes the column and page address
+ * commands and the data written over I2C in horizontal addressing mode,
+ * so that what reaches it can be checked against the frame buffer.
+ */
+
+#ifndef ADAFRUIT_SSD1306_H
+#define ADAFRUIT_SSD1306_H
+
+#include "Adafruit_GFX.h"
+#include "Wire.h"
+
+#define SSD1306_SWITCHCAPVCC    0x02
+#define SSD1306_COLUMNADDR      0x21
+#define SSD1306_PAGEADDR        0x22
+#define SSD1306_LCDWIDTH        128
+#define SSD1306_LCDHEIGHT       64
+#define BLACK                   0
+#define WHITE                   1
+
+struct SSD1306_Panel
+{
+  uint8_t ram[SSD1306_LCDWIDTH * SSD1306_LCDHEIGHT / 8];
+  int column_start, column_end, column;
+  int page_start, page_end, page;
+};
+
+static SSD1306_Panel panel;
+
+static void SSD1306_Receive (const uint8_t *data, size_t size)
+{
+  size_t i;
+
+  if (size == 0)
+    return;
+  if (data[0] == 0x00)
+  {
+    for (i = 1; i < size; i++)
+      if ((data[i] == SSD1306_COLUMNADDR) && (i + 2 < size))
+      {
+        panel.column = panel.column_start = data[i + 1] % SSD1306_LCDWIDTH;
+        panel.column_end = data[i + 2] % SSD1306_LCDWIDTH;
+        i += 2;
+      }
+      else if ((data[i] == SSD1306_PAGEADDR) && (i + 2 < size))
+      {
+        panel.page = panel.page_start = data[i + 1] % (SSD1306_LCDHEIGHT / 8);
+        panel.page_end = data[i + 2] % (SSD1306_LCDHEIGHT / 8);
+        i += 2;
+      }
+  }
+  else if (data[0] == 0x40)
+    for (i = 1; i < size; i++)
+    {
+      panel.ram[panel.page * SSD1306_LCDWIDTH + panel.column] = data[i];
+      if (panel.column++ == panel.column_end)
+      {
+        panel.column = panel.column_start;
+        if (panel.page++ == panel.page_end)
+          panel.page = panel.page_start;
+      }
+    }
+}
+
+class Adafruit_SSD1306 : public Adafruit_GFX
+{
+public:
+  uint8_t buffer[SSD1306_LCDWIDTH * SSD1306_LCDHEIGHT / 8];
+
+  Adafruit_SSD1306 (int8_t) : Adafruit_GFX (SSD1306_LCDWIDTH, SSD1306_LCDHEIGHT)
+  {
+    memset (buffer, 0, sizeof (buffer));
+  }
+
+  bool begin (uint8_t, uint8_t)
+  {
+    memset (&panel, 0, sizeof (panel));
+    panel.column_end = SSD1306_LCDWIDTH - 1;
+    panel.page_end = SSD1306_LCDHEIGHT / 8 - 1;
+    Wire.device = SSD1306_Receive;
+    return (true);
+  }
+
+  uint8_t *getBuffer () { return (buffer); }
+  void dim (bool) {}
+
+  void clearDisplay () { memset (buffer, 0, sizeof (buffer)); }
+
+  void drawPixel (int16_t x, int16_t y, uint16_t color)
+  {
+    if ((x < 0) || (y < 0) || (x >= _width) || (y >= _height))
+      return;
+    if (color)
+      buffer[x + (y / 8) * _width] |= (uint8_t)(1 << (y & 7));
+    else
+      buffer[x + (y / 8) * _width] &= (uint8_t)~(1 << (y & 7));
+  }
+
+  void display ()
+  {
+    unsigned long clock = Wire.clock;
+    size_t i;
+    size_t j;
+
+    Wire.setClock (400000);
+    Wire.beginTransmission (0x3C);
+    Wire.write (0x00);
+    Wire.write (SSD1306_PAGEADDR);
+    Wire.write (0);
+    Wire.write (SSD1306_LCDHEIGHT / 8 - 1);
+    Wire.write (SSD1306_COLUMNADDR);
+    Wire.write (0);
+    Wire.write (SSD1306_LCDWIDTH - 1);
+    Wire.endTransmission ();
+    for (i = 0; i < sizeof (buffer); i += 16)
+    {
+      Wire.beginTransmission (0x3C);
+      Wire.write (0x40);
+      for (j = 0; j < 16; j++)
+        Wire.write (buffer[i + j]);
+      Wire.endTransmission ();
+    }
+    Wire.setClock (clock);
+  }
+};
+
+#endif /* ADAFRUIT_SSD1306_H */
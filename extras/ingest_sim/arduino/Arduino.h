@@ -0,0 +1,125 @@
+/*
+ * Host stand-in for the parts of the Arduino core MGRS_SAMD.ino uses, for
+ * extras/ingest_sim.  Time is simulated: it only moves when Sim_Advance
+ * is called, by the simulator for the sketch's own work, by Serial1.read
+ * (read_cost_us a byte) and by the other stand-ins for I/O.  Serial1 replays a schedule of bytes, each arriving
+ * at its own time, into a receive buffer of SERIAL_BUFFER_SIZE bytes as
+ * the SAMD core's interrupt handler would; a byte arriving with that
+ * buffer full is dropped and counted.
+ */
+
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <deque>
+#include <vector>
+
+#ifndef SERIAL_BUFFER_SIZE
+#define SERIAL_BUFFER_SIZE      64      /* Receive buffer of the SAMD core */
+#endif
+
+struct Sim_Byte
+{
+  unsigned long long arrival;   /* Microseconds */
+  unsigned char value;
+};
+
+static unsigned long long sim_now;  /* Microseconds */
+
+class Uart
+{
+public:
+  std::vector<Sim_Byte> schedule;     /* Bytes on the wire, by arrival */
+  size_t next;                        /* Next byte of schedule to arrive */
+  std::deque<Sim_Byte> buffer;        /* Received, not yet read */
+  size_t buffer_size;
+  size_t peak;
+  unsigned long long dropped;
+  double read_cost_us;                /* Simulated time per read() */
+  double read_debt;                   /* Read time not yet advanced */
+  std::vector<unsigned long long> read_arrival;  /* Arrival of each byte read */
+
+  Uart () : next (0), buffer_size (SERIAL_BUFFER_SIZE), peak (0), dropped (0),
+          read_cost_us (0.0), read_debt (0.0) {}
+
+  void begin (unsigned long) {}
+
+  /* Receives every byte that has arrived by now */
+  void receive ()
+  {
+    for (; (next < schedule.size ()) && (schedule[next].arrival <= sim_now); next++)
+      if (buffer.size () < buffer_size)
+      {
+        buffer.push_back (schedule[next]);
+        if (buffer.size () > peak)
+          peak = buffer.size ();
+      }
+      else
+        dropped++;
+  }
+
+  int available ()
+  {
+    receive ();
+    return ((int)buffer.size ());
+  }
+
+  int read ()
+  {
+    int c;
+
+    receive ();
+    if (buffer.empty ())
+      return (-1);
+    c = buffer.front ().value;
+    read_arrival.push_back (buffer.front ().arrival);
+    buffer.pop_front ();
+    read_debt += read_cost_us;
+    sim_now += (unsigned long long)read_debt;
+    read_debt -= (unsigned long long)read_debt;
+    return (c);
+  }
+};
+
+static Uart Serial1;
+
+/* SerialUSB lines go to stderr */
+class Serial_
+{
+public:
+  void begin (unsigned long) {}
+  void println (const char *s) { fprintf (stderr, "%s\n", s); }
+};
+
+Serial_ SerialUSB;
+
+static void Sim_Advance (unsigned long long us)
+{
+  sim_now += us;
+  Serial1.receive ();
+}
+
+inline unsigned long millis () { return ((unsigned long)(sim_now / 1000)); }
+inline unsigned long micros () { return ((unsigned long)sim_now); }
+inline void delay (unsigned long ms) { Sim_Advance (ms * 1000ULL); }
+
+class Print
+{
+public:
+  virtual ~Print () {}
+  virtual size_t write (uint8_t c) = 0;
+
+  size_t print (const char *s) { size_t n = 0; while (*s) n += write ((uint8_t)*s++); return (n); }
+  size_t print (char c) { return (write ((uint8_t)c)); }
+  size_t print (long v) { char s[24]; snprintf (s, sizeof (s), "%ld", v); return (print (s)); }
+  size_t print (int v) { return (print ((long)v)); }
+  size_t print (unsigned long v) { char s[24]; snprintf (s, sizeof (s), "%lu", v); return (print (s)); }
+  size_t println () { return (write ('\n')); }
+  template <typename T> size_t println (T v) { size_t n = print (v); return (n + println ()); }
+};
+
+#endif /* ARDUINO_H */
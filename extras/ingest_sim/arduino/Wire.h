@@ -0,0 +1,44 @@
+/*
+ * Host stand-in for the Arduino Wire (I2C) library, for extras/ingest_sim.
+ * A transmission takes the simulated time of its address and data bytes,
+ * 9 clocks each, plus WIRE_OVERHEAD_US for start, stop and the library.
+ * Each finished transmission is handed to the device stand-in, if any.
+ */
+
+#ifndef WIRE_H
+#define WIRE_H
+
+#include "Arduino.h"
+
+#define WIRE_OVERHEAD_US        20
+
+class TwoWire
+{
+public:
+  unsigned long clock;
+  size_t bytes;                 /* In the current transmission */
+  unsigned long long total;     /* Bytes sent, address bytes included */
+  std::vector<uint8_t> data;    /* Of the current transmission */
+  void (*device) (const uint8_t *data, size_t size);
+
+  TwoWire () : clock (100000), bytes (0), total (0), device (0) {}
+
+  void begin () {}
+  void setClock (unsigned long c) { clock = c; }
+  void beginTransmission (uint8_t) { bytes = 1; data.clear (); }
+  size_t write (uint8_t b) { bytes++; data.push_back (b); return (1); }
+
+  uint8_t endTransmission ()
+  {
+    total += bytes;
+    if (device)
+      device (data.data (), data.size ());
+    Sim_Advance (WIRE_OVERHEAD_US + bytes * 9ULL * 1000000ULL / clock);
+    bytes = 0;
+    return (0);
+  }
+};
+
+static TwoWire Wire;
+
+#endif /* WIRE_H */
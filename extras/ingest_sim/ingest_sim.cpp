@@ -0,0 +1,258 @@
+/*
+ * Runs MGRS_SAMD.ino on the host against a replayed NMEA log, with
+ * stand-ins for Serial1, millis, Wire and Adafruit_SSD1306 (in arduino/),
+ * and measures dropped bytes and fix-to-display latency.  Not part of the
+ * sketch; build and run it on the host:
+ *
+ *   g++ -O2 -std=gnu++11 -Iarduino -I../.. ingest_sim.cpp -o ingest_sim
+ *   ./ingest_sim [-b baud] [-u uart_bytes] [-m cost_scale] [-v] log.nmea
+ *
+ * A log can be made with extras/nmea_mgrs (./nmea_mgrs -g bytes); that
+ * one reports at 10 Hz, so replay it at -b 38400 or faster.
+ *
+ * The log is split into epochs where the time of a fix changes, and each
+ * epoch goes out on the simulated wire at its time from the first fix, its
+ * bytes back to back at the baud rate (default 9600, 10 bits a byte) or
+ * as soon as the bytes before them are out.  The sketch's setup() and
+ * then loop() run over and over until the log has been sent and 2 more
+ * seconds have gone by.  Time moves for the I2C transfers as the Wire
+ * stand-in prices them, and for the sketch's own work by a fixed cost per
+ * pass, per byte read from the UART, per byte parsed, per fix and per
+ * frame converted and drawn (the *_US below, guesses for a 48 MHz
+ * Cortex-M0 with software floating point; -m scales them all), so that a
+ * run is the same every time.  The UART receive buffer holds -u bytes
+ * (default 64, as in the SAMD core).
+ *
+ * The latency of a frame is from the arrival of the last byte of the
+ * sentence it shows to the last byte of the frame going out on I2C.  The
+ * I2C bytes of each frame are counted against those of sending the whole
+ * screen.  Once a frame is out, the panel stand-in must hold exactly the
+ * frame buffer, and the frame buffer must be what clearing it and drawing
+ * the frame's text afresh would give; frames where either is not so are
+ * counted.  The results go to stdout as JSON; -v also lists each frame
+ * on stderr.
+ * Building with, say, -DFLUSH_CHUNK=1024 -DPARSE_BUDGET=1000 makes the
+ * sketch send a whole frame and parse everything in one pass, as a
+ * blocking loop would.
+ */
+
+#include <stdlib.h>
+
+#include <algorithm>
+
+static void sim_trace (int event);
+
+#define INGEST_TRACE(event)     sim_trace (event)
+
+#include "../../MGRS_SAMD.ino"
+
+#define TAIL_SECONDS    2
+/* I2C bytes of sending the whole screen 16 bytes at a time, as display() does */
+#define FULL_SCREEN_BYTES (9 + (SSD1306_LCDWIDTH * SSD1306_LCDHEIGHT / 8 / 16) * 18)
+#define PASS_US         5.0     /* Simulated cost of a pass of loop()          */
+#define READ_US         2.0     /* Of reading a byte and putting it in the ring */
+#define PARSE_US        2.0     /* Of taking a byte and parsing it             */
+#define FIX_US          100.0   /* Of the fields of a sentence with a fix      */
+#define RENDER_US       4000.0  /* Of converting a fix and drawing the frame   */
+
+struct Sim
+{
+  int verbose;
+  double cost_scale;
+  unsigned long long fixes;
+  unsigned long long renders;
+  unsigned long long last_fix_arrival;    /* Of the latest fix parsed */
+  unsigned long long render_arrival;      /* Of the fix being sent */
+  unsigned long long render_i2c;          /* Wire.total when it was drawn */
+  std::vector<double> latency;            /* Milliseconds, per frame */
+  std::vector<double> frame_bytes;        /* I2C bytes, per frame */
+  unsigned long long panel_mismatches;
+  unsigned long long redraw_mismatches;
+};
+
+static Sim sim;
+static Adafruit_SSD1306 redraw (OLED_RESET);
+
+static void sim_trace (int event)
+{
+  size_t consumed = ring.Tail + ring.Dropped;
+  int i;
+
+  if (event == TRACE_FIX)
+  {
+    Sim_Advance ((unsigned long long)(FIX_US * sim.cost_scale));
+    sim.fixes++;
+    if ((consumed > 0) && (consumed <= Serial1.read_arrival.size ()))
+      sim.last_fix_arrival = Serial1.read_arrival[consumed - 1];
+  }
+  else if (event == TRACE_RENDER)
+  {
+    Sim_Advance ((unsigned long long)(RENDER_US * sim.cost_scale));
+    sim.renders++;
+    sim.render_arrival = sim.last_fix_arrival;
+    sim.render_i2c = Wire.total;
+  }
+  else if (event == TRACE_FRAME)
+  {
+    sim.latency.push_back ((sim_now - sim.render_arrival) / 1000.0);
+    sim.frame_bytes.push_back (Wire.total - sim.render_i2c);
+    if (memcmp (panel.ram, display.getBuffer (), sizeof (panel.ram)))
+      sim.panel_mismatches++;
+    redraw.clearDisplay ();
+    redraw.setTextSize (TEXT_SIZE);
+    redraw.setCursor (0, 0);
+    for (i = 0; i < TEXT_ROWS; i++)
+      redraw.println (lines[i]);
+    if (memcmp (redraw.getBuffer (), display.getBuffer (), sizeof (redraw.buffer)))
+      sim.redraw_mismatches++;
+    if (sim.verbose)
+    {
+      fprintf (stderr, "%10.3f %4.0f", sim_now / 1e6, sim.frame_bytes.back ());
+      for (i = 0; i < TEXT_ROWS; i++)
+        fprintf (stderr, " |%s", lines[i]);
+      fprintf (stderr, "\n");
+    }
+  }
+}
+
+/* Puts the log's bytes on the wire, an epoch at a time */
+static long schedule (const char *data, long size, long baud)
+{
+  double byte_us = 10.0 * 1e6 / baud;
+  double wire = 0.0;          /* When the wire is next free */
+  double start;
+  long epoch_time = -1;       /* Time of day of the current epoch, ms */
+  long first_time = -1;
+  const char *line = data;
+  const char *end;
+  NMEA_Fix f;
+  Sim_Byte b;
+
+  for (; line < data + size; line = end)
+  {
+    end = (const char *)memchr (line, '\n', data + size - line);
+    end = end ? end + 1 : data + size;
+    if (!Parse_NMEA_Sentence (line, end, &f) && (f.Time != epoch_time))
+    {
+      if (first_time < 0)
+        first_time = f.Time;
+      epoch_time = f.Time;
+      start = ((epoch_time - first_time + 86400000L) % 86400000L) * 1000.0;
+      if (start > wire)
+        wire = start;
+    }
+    for (; line < end; line++)
+    {
+      wire += byte_us;
+      b.arrival = (unsigned long long)wire;
+      b.value = (unsigned char)*line;
+      Serial1.schedule.push_back (b);
+    }
+  }
+  return ((first_time < 0) ? -1 : 0);
+}
+
+static double mean_of (const std::vector<double> &v)
+{
+  double mean = 0.0;
+  size_t i;
+
+  for (i = 0; i < v.size (); i++)
+    mean += v[i] / v.size ();
+  return (mean);
+}
+
+static double percentile (std::vector<double> &v, double p)
+{
+  if (v.empty ())
+    return (0.0);
+  return (v[(size_t)(p * (v.size () - 1) + 0.5)]);
+}
+
+int main (int argc, char **argv)
+{
+  long baud = 9600;
+  const char *file = 0;
+  std::vector<char> data;
+  unsigned long long end_time;
+  unsigned long long pass_start;
+  unsigned long long longest_pass = 0;
+  unsigned long long passes = 0;
+  unsigned long long parsed;
+  FILE *f;
+  size_t n;
+  char block[65536];
+  int usage = 0;
+  int i;
+
+  sim.cost_scale = 1.0;
+  Serial1.read_cost_us = READ_US;
+  for (i = 1; i < argc; i++)
+  {
+    if (!strcmp (argv[i], "-b") && (i + 1 < argc))
+      baud = atol (argv[++i]);
+    else if (!strcmp (argv[i], "-u") && (i + 1 < argc))
+      Serial1.buffer_size = atol (argv[++i]);
+    else if (!strcmp (argv[i], "-m") && (i + 1 < argc))
+      sim.cost_scale = atof (argv[++i]);
+    else if (!strcmp (argv[i], "-v"))
+      sim.verbose = 1;
+    else if (!file)
+      file = argv[i];
+    else
+      usage = 1;
+  }
+  if (usage || !file || (baud <= 0) || (sim.cost_scale < 0.0) || (Serial1.buffer_size < 1))
+  {
+    fprintf (stderr, "usage: ingest_sim [-b baud] [-u uart_bytes] [-m cost_scale] [-v] log.nmea\n");
+    return (2);
+  }
+  f = fopen (file, "rb");
+  if (!f)
+  {
+    perror (file);
+    return (1);
+  }
+  while ((n = fread (block, 1, sizeof (block), f)) > 0)
+    data.insert (data.end (), block, block + n);
+  fclose (f);
+  if (schedule (data.data (), (long)data.size (), baud) < 0)
+  {
+    fprintf (stderr, "ingest_sim: no fixes in %s\n", file);
+    return (1);
+  }
+  end_time = Serial1.schedule.back ().arrival + TAIL_SECONDS * 1000000ULL;
+  Serial1.read_cost_us *= sim.cost_scale;
+
+  setup ();
+  while (sim_now < end_time)
+  {
+    pass_start = sim_now;
+    parsed = ring.Tail;
+    loop ();
+    Sim_Advance ((unsigned long long)((PASS_US + (ring.Tail - parsed) * PARSE_US) * sim.cost_scale));
+    longest_pass = std::max (longest_pass, sim_now - pass_start);
+    passes++;
+  }
+
+  std::sort (sim.latency.begin (), sim.latency.end ());
+  std::sort (sim.frame_bytes.begin (), sim.frame_bytes.end ());
+  printf ("{\n  \"baud\": %ld,\n  \"uart_buffer\": %zu,\n  \"cost_scale\": %.2f,\n"
+          "  \"bytes\": %zu,\n  \"simulated_seconds\": %.3f,\n  \"loop_passes\": %llu,\n"
+          "  \"longest_pass_ms\": %.3f,\n  \"uart_dropped\": %llu,\n  \"uart_peak\": %zu,\n"
+          "  \"ring_dropped\": %lu,\n  \"ring_peak\": %lu,\n  \"fixes\": %llu,\n"
+          "  \"frames\": %zu,\n  \"i2c_bytes\": %llu,\n  \"full_screen_bytes\": %d,\n"
+          "  \"frame_bytes\": {\"min\": %.0f, \"mean\": %.1f, \"p50\": %.0f, \"max\": %.0f},\n"
+          "  \"panel_mismatches\": %llu,\n  \"redraw_mismatches\": %llu,\n"
+          "  \"latency_ms\": {\"min\": %.2f, \"mean\": %.2f, \"p50\": %.2f, \"p99\": %.2f,"
+          " \"max\": %.2f}\n}\n",
+          baud, Serial1.buffer_size, sim.cost_scale, Serial1.schedule.size (), sim_now / 1e6, passes,
+          longest_pass / 1000.0, Serial1.dropped, Serial1.peak, ring.Dropped, ring.Peak,
+          sim.fixes, sim.latency.size (), Wire.total, FULL_SCREEN_BYTES,
+          percentile (sim.frame_bytes, 0.0), mean_of (sim.frame_bytes),
+          percentile (sim.frame_bytes, 0.5), percentile (sim.frame_bytes, 1.0),
+          sim.panel_mismatches, sim.redraw_mismatches,
+          percentile (sim.latency, 0.0), mean_of (sim.latency), percentile (sim.latency, 0.5),
+          percentile (sim.latency, 0.99), percentile (sim.latency, 1.0));
+  return (0);
+}
@@ -0,0 +1,990 @@
+/*
+ * Host benchmark and accuracy suite for the mgrs.h / utm.h / tranmerc.h
+ * pipeline.  Not part of the sketch; build and run it on the host:
+ *
+ *   g++ -O2 -std=gnu++11 -I../.. mgrs_bench.cpp -o mgrs_bench
+ *   ./mgrs_bench [scale] > results.json
+ *
+ * Each workload is timed stage by stage and end to end; every figure is
+ * the fastest of BENCH_REPEATS runs.  The inverse is staged the same way:
+ * Break_MGRS_String, Convert_MGRS_To_UTM_R, Convert_UTM_To_Geodetic_R and
+ * Convert_Transverse_Mercator_To_Geodetic_R, then Convert_MGRS_To_Geodetic
+ * end to end.  "Set_Transverse_Mercator_Parameters + convert" sets the
+ * global projection up for each point's zone before converting, as
+ * Convert_Geodetic_To_UTM once did; "UTM_Zone_Projection + convert" looks
+ * the zone's projection up instead.  Accuracy is measured against the
+ * Kruger series (TRANMERC_KRUGER_SERIES), which is good to a few
+ * nanometers across a UTM zone, so the differences reported are those of
+ * the path under test.  The microdegree path is compared with the reference
+ * at its input rounded to whole microdegrees.  Results go to stdout as one
+ * JSON object; progress goes to stderr.  scale (default 1.0) multiplies the number of
+ * points in every workload.  The datums section repeats the MGRS timing and
+ * accuracy over global_grid for each ellipsoid in MGRS_Datum_Table.
+ * grid_table_mismatches counts differences between mgrs.h's grid letter
+ * tables and the letter arithmetic they replaced, over every zone, pattern,
+ * column and row; it should be 0.  band_letter_mismatches counts
+ * latitudes by the band edges, and over the grid, where Get_Latitude_Letter
+ * differs from the division by the band height it replaced; a difference
+ * also makes the suite return 1.  datum_constant_mismatches counts the
+ * ellipsoids in MGRS_Datum_Table, and TranMerc_WGS84, whose constants as
+ * the compiler worked them out differ in any bit from those
+ * Make_Transverse_Mercator_Ellipsoid derives at run time; any makes the
+ * suite return 1.  The grid_overlay section times
+ * Update_MGRS_Grid_View drawing a viewport of 10 grid spacings a side from
+ * scratch, and panning it by 2% of its width a frame.  Convert_Geodetic_To_MGRS
+ * is timed at every precision, and precision_terms_mismatches counts strings
+ * at any precision that differ from those of the full Transverse Mercator
+ * series (UTM_To_MGRS over the stage inputs); it should be 0.
+ * shared_trig_vs_classic_easting and _northing compare
+ * TRANMERC_SHARED_TRIG_SERIES with the classic series it evaluates.
+ *
+ * batch_check compares Convert_Geodetic_To_MGRS_Batch with
+ * Convert_Geodetic_To_UTM_R in the zone the MGRS string uses, point by
+ * point over each workload with a hundredth as many points added anywhere,
+ * most of them out of range, so that error codes are compared too: the
+ * zone, band and error code must be the same and the easting and northing within
+ * TM_BATCH_TOLERANCE.  batch_mismatches totals the differences, and the
+ * suite returns 1 if there are any.  The batch kernel is the one the build
+ * selects, named by batch_isa: SSE2 as built above, AVX2 with -mavx2, and
+ * the one point at a time fallback with -DMGRS_BATCH_SCALAR; build it each
+ * way to check and time each kernel.
+ *
+ * Built with -DMGRS_PROBES it adds a probes section: the cost of a
+ * MGRS_PROBE_BEGIN/MGRS_PROBE_END pair, the probe overhead that puts on
+ * each Convert_Geodetic_To_MGRS_R, and the stage histograms of one pass of
+ * it and of Update_MGRS_Tracker over global_grid.  The timings above then
+ * include the probes; compare them with a build without.
+ */
+
+#include "../../mgrs_batch.h"
+#include "../../mgrs_tracker.h"
+#include "../../mgrs_grid.h"
+#include "../mgrs_host.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#define BENCH_REPEATS   3
+#define EARTH_RADIUS    6371000.0   /* For turning angle differences into meters */
+
+struct Workload
+{
+  const char *name;
+  std::vector<double> lat;       /* radians */
+  std::vector<double> lon;
+};
+
+/* Inputs each stage needs, prepared once per workload */
+struct Stage_Inputs
+{
+  std::vector<long> zone;
+  std::vector<char> hemisphere;
+  std::vector<double> tm_lat;    /* Normalised by Get_UTM_Zone_R */
+  std::vector<double> tm_lon;
+  std::vector<double> easting;
+  std::vector<double> northing;
+  std::vector<int> letters;      /* MGRS_LETTERS per point */
+  std::vector<long> lat_udeg;
+  std::vector<long> lon_udeg;
+  std::vector<char> mgrs;        /* 16 characters per point */
+};
+
+static volatile double bench_sink;
+
+static unsigned long long bench_seed = 12345;
+
+static double uniform (double low, double high)
+{
+  return (low + (high - low) * uniform (&bench_seed));
+}
+
+static void add_point (Workload &w, double lat_deg, double lon_deg)
+{
+  w.lat.push_back (lat_deg * DEG_TO_RAD);
+  w.lon.push_back (lon_deg * DEG_TO_RAD);
+}
+
+static void make_workloads (std::vector<Workload> &ws, double scale)
+{
+  Workload w;
+  long n;
+  long i;
+  double lat;
+  double lon;
+  double heading;
+
+  /* Regular grid over the whole UTM latitude range */
+  w.name = "global_grid";
+  n = (long)(sqrt (500000 * scale));
+  for (i = 0; i < n * n; i++)
+    add_point (w, -80.0 + 164.0 * ((i / n) + 0.5) / n, -180.0 + 360.0 * ((i % n) + 0.5) / n);
+  ws.push_back (w);
+
+  /* GPS-like track, ~1.5 m steps with a slowly wandering heading */
+  w = Workload ();
+  w.name = "dense_track";
+  lat = 59.91;
+  lon = 10.75;
+  heading = 0.3;
+  for (i = 0; i < (long)(500000 * scale); i++)
+  {
+    heading += uniform (-0.05, 0.05);
+    lat += 1.5 / 111320.0 * cos (heading);
+    lon += 1.5 / (111320.0 * cos (lat * DEG_TO_RAD)) * sin (heading);
+    add_point (w, lat, lon);
+  }
+  ws.push_back (w);
+
+  /* Norway (32V) and Svalbard (31X-37X) special zones */
+  w = Workload ();
+  w.name = "norway_svalbard";
+  for (i = 0; i < (long)(250000 * scale); i++)
+    add_point (w, uniform (56.0, 64.0), uniform (0.0, 12.0));
+  for (i = 0; i < (long)(250000 * scale); i++)
+    add_point (w, uniform (72.0, 84.0), uniform (0.0, 42.0));
+  ws.push_back (w);
+
+  /* Within about a meter of latitude band and zone edges */
+  w = Workload ();
+  w.name = "band_edges";
+  for (i = 0; i < (long)(250000 * scale); i++)
+  {
+    lat = -80.0 + 8.0 * (long)uniform (0.0, 20.0);
+    if (lat > 72.0)
+      lat = 84.0;
+    add_point (w, lat + uniform (-1.0e-5, 1.0e-5), uniform (-180.0, 180.0));
+  }
+  for (i = 0; i < (long)(250000 * scale); i++)
+  {
+    lon = -180.0 + 6.0 * (long)uniform (1.0, 60.0);
+    add_point (w, uniform (-80.0, 84.0), lon + uniform (-1.0e-5, 1.0e-5));
+  }
+  ws.push_back (w);
+}
+
+static void prepare (const Workload &w, Stage_Inputs &in)
+{
+  long n = (long)w.lat.size ();
+  long i;
+
+  in.zone.assign (n, 0);
+  in.hemisphere.assign (n, 'N');
+  in.tm_lat.assign (n, 0.0);
+  in.tm_lon.assign (n, 0.0);
+  in.easting.assign (n, 0.0);
+  in.northing.assign (n, 0.0);
+  in.letters.assign (n * MGRS_LETTERS, 0);
+  in.lat_udeg.assign (n, 0);
+  in.lon_udeg.assign (n, 0);
+  in.mgrs.assign (n * 16, 0);
+  for (i = 0; i < n; i++)
+  {
+    double la = w.lat[i];
+    double lo = w.lon[i];
+    long zone;
+    double e;
+    double nn;
+    long precision;
+
+    in.lat_udeg[i] = lround (la * RAD_TO_DEG * 1e6);
+    in.lon_udeg[i] = lround (lo * RAD_TO_DEG * 1e6);
+    Convert_Geodetic_To_UTM (la, lo, &in.zone[i], &in.hemisphere[i],
+                             &in.easting[i], &in.northing[i]);
+    Convert_Geodetic_To_MGRS (la, lo, 5, &in.mgrs[i * 16]);
+    Break_MGRS_String (&in.mgrs[i * 16], &zone, &in.letters[i * MGRS_LETTERS],
+                       &e, &nn, &precision);
+    Get_UTM_Zone_R (&UTM_State, &la, &lo, &zone);
+    if (lo > PI)
+      lo -= 2 * PI;
+    in.tm_lat[i] = la;
+    in.tm_lon[i] = lo;
+  }
+}
+
+/* Drops the points the pipeline rejects, returning how many there were */
+static long keep_valid (Workload &w)
+{
+  Workload valid;
+  char mgrs[32];
+  size_t i;
+
+  valid.name = w.name;
+  for (i = 0; i < w.lat.size (); i++)
+    if (!Convert_Geodetic_To_MGRS (w.lat[i], w.lon[i], 5, mgrs))
+    {
+      valid.lat.push_back (w.lat[i]);
+      valid.lon.push_back (w.lon[i]);
+    }
+  i = w.lat.size () - valid.lat.size ();
+  w = valid;
+  return ((long)i);
+}
+
+/* Convert_Geodetic_To_MGRS_Batch against the scalar path, point by point */
+struct Batch_Check
+{
+  long points;
+  long rejected;         /* Points both reject, with the same error code */
+  long mismatches;
+  double max_diff;       /* Largest easting or northing difference, meters */
+};
+
+static void check_batch (const Workload &workload, Batch_Check &c)
+{
+  Workload w = workload;
+  long n;
+  long i;
+
+  /* Add a hundredth as many points anywhere, most of them out of range */
+  n = (long)w.lat.size () / 100;
+  for (i = 0; i < n; i++)
+    add_point (w, uniform (-100.0, 100.0), uniform (-200.0, 400.0));
+  n = (long)w.lat.size ();
+  std::vector<long> zones (n);
+  std::vector<int> bands (n);
+  std::vector<double> eastings (n);
+  std::vector<double> northings (n);
+  std::vector<long> errors (n);
+
+  c.points = n;
+  c.rejected = 0;
+  c.mismatches = 0;
+  c.max_diff = 0.0;
+  Convert_Geodetic_To_MGRS_Batch (&MGRS_Default_Parameters, n, &w.lat[0], &w.lon[0], &zones[0],
+                                  &bands[0], &eastings[0], &northings[0], &errors[0]);
+  for (i = 0; i < n; i++)
+  {
+    UTM_Parameters utm = MGRS_Default_Parameters.UTM;
+    double la = w.lat[i];
+    double lo = w.lon[i];
+    long zone = 0;
+    char hemisphere;
+    double e = 0.0;
+    double nn = 0.0;
+    int band = 0;
+    long temp_error_code;
+    long error_code = MGRS_NO_ERROR;
+
+    /* The zone the string uses, which may be 32 for a point of 31V */
+    if ((la < -PI_OVER_2) || (la > PI_OVER_2))
+      error_code |= MGRS_LAT_ERROR;
+    if ((lo < -PI) || (lo > (2 * PI)))
+      error_code |= MGRS_LON_ERROR;
+    if (!error_code && !Get_MGRS_Zone_R (&MGRS_Default_Parameters, &la, &lo, &zone))
+      utm.Override = zone;
+    if (!error_code)
+    {
+      temp_error_code = Convert_Geodetic_To_UTM_R (&utm, w.lat[i], w.lon[i], &zone, &hemisphere,
+                                                   &e, &nn);
+      if (temp_error_code & UTM_LAT_ERROR)
+        error_code |= MGRS_LAT_ERROR;
+      if (temp_error_code & UTM_LON_ERROR)
+        error_code |= MGRS_LON_ERROR;
+      if (temp_error_code & UTM_ZONE_OVERRIDE_ERROR)
+        error_code |= MGRS_ZONE_ERROR;
+      if (temp_error_code & UTM_EASTING_ERROR)
+        error_code |= MGRS_EASTING_ERROR;
+      if (temp_error_code & UTM_NORTHING_ERROR)
+        error_code |= MGRS_NORTHING_ERROR;
+    }
+    if (!error_code)
+    {
+      la = w.lat[i];
+      if ((la <= 0.0) && (nn == 1.0e7))
+      {
+        la = 0.0;
+        nn = 0.0;
+      }
+      error_code = Get_Latitude_Letter (la, &band);
+    }
+
+    if (error_code != errors[i])
+      c.mismatches++;
+    else if (error_code)
+      c.rejected++;
+    else
+    {
+      if (fabs (eastings[i] - e) > c.max_diff)
+        c.max_diff = fabs (eastings[i] - e);
+      if (fabs (northings[i] - nn) > c.max_diff)
+        c.max_diff = fabs (northings[i] - nn);
+      if ((zones[i] != zone) || (bands[i] != band) || (fabs (eastings[i] - e) > TM_BATCH_TOLERANCE)
+          || (fabs (northings[i] - nn) > TM_BATCH_TOLERANCE))
+        c.mismatches++;
+    }
+  }
+}
+
+/* Times Body over every point of the workload, BENCH_REPEATS times */
+#define TIME_STAGE(Name, Body)                                           \
+  do {                                                                   \
+    double best = 1e30;                                                  \
+    double sum = 0.0;                                                    \
+    int r;                                                               \
+    for (r = 0; r < BENCH_REPEATS; r++)                                  \
+    {                                                                    \
+      double t = now ();                                                 \
+      for (i = 0; i < n; i++)                                            \
+      {                                                                  \
+        Body;                                                            \
+      }                                                                  \
+      t = now () - t;                                                    \
+      if (t < best)                                                      \
+        best = t;                                                        \
+    }                                                                    \
+    bench_sink = sum;                                                    \
+    printf ("%s\n        \"%s\": {\"ns_per_point\": %.1f, \"points_per_sec\": %.0f}", \
+            first ? "" : ",", Name, best / n * 1e9, n / best);            \
+    first = 0;                                                           \
+  } while (0)
+
+static void time_stages (const Workload &w, Stage_Inputs &in)
+{
+  long n = (long)w.lat.size ();
+  long i;
+  int first = 1;
+  char mgrs[32];
+  char name[64];
+  long precision;
+  double e;
+  double nn;
+  long zone;
+  char hemisphere;
+  int letter = 0;
+  int letters[MGRS_LETTERS];
+  MGRS_Tracker tracker;
+  long low;
+  long high;
+  double offset;
+  const TranMerc_Projection *projection;
+  UTM_Parameters kruger = UTM_State;
+  UTM_Parameters shared = UTM_State;
+  std::vector<long> zones (n);
+  std::vector<int> bands (n);
+  std::vector<double> eastings (n);
+  std::vector<double> northings (n);
+  std::vector<long> errors (n);
+
+  kruger.Ellipsoid.Series = TRANMERC_KRUGER_SERIES;
+  shared.Ellipsoid.Series = TRANMERC_SHARED_TRIG_SERIES;
+
+  printf ("      \"stages\": {");
+  TIME_STAGE ("Convert_Geodetic_To_Transverse_Mercator_R",
+              Convert_Geodetic_To_Transverse_Mercator_R (&UTM_State.Ellipsoid,
+                  &UTM_Zone_Projection[in.zone[i] - 1][in.tm_lat[i] < 0],
+                  in.tm_lat[i], in.tm_lon[i], &e, &nn); sum += e + nn);
+  TIME_STAGE ("Convert_Geodetic_To_Transverse_Mercator_R (kruger)",
+              Convert_Geodetic_To_Transverse_Mercator_R (&kruger.Ellipsoid,
+                  &UTM_Zone_Projection[in.zone[i] - 1][in.tm_lat[i] < 0],
+                  in.tm_lat[i], in.tm_lon[i], &e, &nn); sum += e + nn);
+  TIME_STAGE ("Convert_Geodetic_To_Transverse_Mercator_R (shared_trig)",
+              Convert_Geodetic_To_Transverse_Mercator_R (&shared.Ellipsoid,
+                  &UTM_Zone_Projection[in.zone[i] - 1][in.tm_lat[i] < 0],
+                  in.tm_lat[i], in.tm_lon[i], &e, &nn); sum += e + nn);
+  /* Setting up the zone's projection per point, as Convert_Geodetic_To_UTM did */
+  TIME_STAGE ("Set_Transverse_Mercator_Parameters + convert",
+              Set_Transverse_Mercator_Parameters (UTM_State.Ellipsoid.a, UTM_State.Ellipsoid.f,
+                                                  0.0, UTM_CENTRAL_MERIDIAN (in.zone[i]),
+                                                  500000.0,
+                                                  (in.tm_lat[i] < 0) ? 10000000.0 : 0.0,
+                                                  0.9996);
+              Convert_Geodetic_To_Transverse_Mercator (in.tm_lat[i], in.tm_lon[i], &e, &nn);
+              sum += e + nn);
+  TIME_STAGE ("UTM_Zone_Projection + convert",
+              projection = &UTM_Zone_Projection[in.zone[i] - 1][in.tm_lat[i] < 0];
+              Convert_Geodetic_To_Transverse_Mercator_R (&UTM_State.Ellipsoid, projection,
+                                                         in.tm_lat[i], in.tm_lon[i], &e, &nn);
+              sum += e + nn);
+  TIME_STAGE ("Convert_Geodetic_To_UTM",
+              Convert_Geodetic_To_UTM (w.lat[i], w.lon[i], &zone, &hemisphere, &e, &nn);
+              sum += e + nn);
+  TIME_STAGE ("Get_Latitude_Letter",
+              Get_Latitude_Letter (w.lat[i], &letter); sum += letter);
+  TIME_STAGE ("Get_Grid_Values",
+              Get_Grid_Values (in.zone[i], &low, &high, &offset); sum += low + offset);
+  TIME_STAGE ("UTM_To_MGRS",
+              UTM_To_MGRS (in.zone[i], in.hemisphere[i], w.lon[i], w.lat[i],
+                           in.easting[i], in.northing[i], 5, mgrs); sum += mgrs[7]);
+  TIME_STAGE ("Make_MGRS_String",
+              Make_MGRS_String (mgrs, in.zone[i], &in.letters[i * MGRS_LETTERS],
+                                in.easting[i], in.northing[i], 5); sum += mgrs[7]);
+  TIME_STAGE ("Convert_Geodetic_To_MGRS",
+              Convert_Geodetic_To_MGRS (w.lat[i], w.lon[i], 5, mgrs); sum += mgrs[7]);
+  for (precision = 0; precision <= MAX_PRECISION; precision++)
+  {
+    sprintf (name, "Convert_Geodetic_To_MGRS (precision %ld)", precision);
+    TIME_STAGE (name, Convert_Geodetic_To_MGRS (w.lat[i], w.lon[i], precision, mgrs);
+                sum += mgrs[4]);
+  }
+  TIME_STAGE ("Convert_Microdegrees_To_MGRS",
+              Convert_Microdegrees_To_MGRS (in.lat_udeg[i], in.lon_udeg[i], 5, mgrs);
+              sum += mgrs[7]);
+  /* Consecutive points as a track; only dense_track is really one */
+  TIME_STAGE ("Update_MGRS_Tracker",
+              if (i == 0)
+                Init_MGRS_Tracker (&tracker, &MGRS_Float_Default_Parameters);
+              Update_MGRS_Tracker (&tracker, in.lat_udeg[i], in.lon_udeg[i], 5, mgrs);
+              sum += mgrs[7]);
+  TIME_STAGE ("Break_MGRS_String",
+              Break_MGRS_String (&in.mgrs[i * 16], &zone, letters, &e, &nn, &precision);
+              sum += e + nn + letters[0]);
+  TIME_STAGE ("Convert_MGRS_To_UTM_R",
+              Convert_MGRS_To_UTM_R (&MGRS_Default_Parameters, &in.mgrs[i * 16], &zone,
+                                     &hemisphere, &e, &nn); sum += e + nn);
+  TIME_STAGE ("Convert_UTM_To_Geodetic_R",
+              Convert_UTM_To_Geodetic_R (&UTM_State, in.zone[i], in.hemisphere[i],
+                                         in.easting[i], in.northing[i], &e, &nn);
+              sum += e + nn);
+  TIME_STAGE ("Convert_Transverse_Mercator_To_Geodetic_R",
+              Convert_Transverse_Mercator_To_Geodetic_R (&UTM_State.Ellipsoid,
+                  &UTM_Zone_Projection[in.zone[i] - 1][in.hemisphere[i] == 'S'],
+                  in.easting[i], in.northing[i], &e, &nn); sum += e + nn);
+  TIME_STAGE ("Convert_MGRS_To_Geodetic",
+              Convert_MGRS_To_Geodetic (&in.mgrs[i * 16], &e, &nn); sum += e + nn);
+  /* The batch call covers every point at once; charge it per point */
+  TIME_STAGE ("Convert_Geodetic_To_MGRS_Batch",
+              if (i == 0)
+                sum += Convert_Geodetic_To_MGRS_Batch (&MGRS_Default_Parameters, n,
+                                                       &w.lat[0], &w.lon[0], &zones[0],
+                                                       &bands[0], &eastings[0],
+                                                       &northings[0], &errors[0]));
+  printf ("\n      },\n");
+}
+
+struct Error_Stats
+{
+  double max;
+  double sum2;
+  long count;
+
+  Error_Stats () : max (0.0), sum2 (0.0), count (0) {}
+  void add (double d)
+  {
+    d = fabs (d);
+    if (d > max)
+      max = d;
+    sum2 += d * d;
+    count++;
+  }
+};
+
+static void print_stats (const char *name, const Error_Stats &s, int last)
+{
+  printf ("        \"%s\": {\"max_m\": %.3e, \"rms_m\": %.3e}%s\n", name, s.max,
+          s.count ? sqrt (s.sum2 / s.count) : 0.0, last ? "" : ",");
+}
+
+static void measure_accuracy (const Workload &w, const Stage_Inputs &in)
+{
+  long n = (long)w.lat.size ();
+  long i;
+  MGRS_Parameters reference = MGRS_Default_Parameters;
+  TranMerc_Ellipsoid shared = MGRS_Default_Parameters.UTM.Ellipsoid;
+  Error_Stats utm_easting;
+  Error_Stats utm_northing;
+  Error_Stats utm_round_trip;
+  Error_Stats mgrs_round_trip;
+  Error_Stats shared_easting;
+  Error_Stats shared_northing;
+  long errors = 0;
+  long double_mismatch = 0;
+  long float_mismatch = 0;
+  long terms_mismatch = 0;
+  long precision;
+
+  reference.UTM.Ellipsoid.Series = TRANMERC_KRUGER_SERIES;
+  shared.Series = TRANMERC_SHARED_TRIG_SERIES;
+  for (i = 0; i < n; i++)
+  {
+    long zone;
+    char hemisphere;
+    double e;
+    double nn;
+    double la;
+    double lo;
+    char ref[32];
+    char flt[32];
+
+    if (Convert_Geodetic_To_UTM_R (&reference.UTM, w.lat[i], w.lon[i],
+                                                 &zone, &hemisphere, &e, &nn)
+        || Convert_Geodetic_To_MGRS_R (&reference, w.lat[i], w.lon[i], 5, ref))
+    {
+      errors++;
+      continue;
+    }
+    if (zone == in.zone[i])
+    {
+      utm_easting.add (in.easting[i] - e);
+      utm_northing.add (in.northing[i] - nn);
+    }
+    /* The shared trig kernel against the classic series it replaces */
+    Convert_Geodetic_To_Transverse_Mercator_R (&MGRS_Default_Parameters.UTM.Ellipsoid,
+        &UTM_Zone_Projection[in.zone[i] - 1][in.tm_lat[i] < 0], in.tm_lat[i], in.tm_lon[i], &e, &nn);
+    Convert_Geodetic_To_Transverse_Mercator_R (&shared,
+        &UTM_Zone_Projection[in.zone[i] - 1][in.tm_lat[i] < 0], in.tm_lat[i], in.tm_lon[i], &la, &lo);
+    shared_easting.add (la - e);
+    shared_northing.add (lo - nn);
+    Convert_UTM_To_Geodetic (in.zone[i], in.hemisphere[i], in.easting[i], in.northing[i], &la, &lo);
+    utm_round_trip.add (EARTH_RADIUS * hypot (la - w.lat[i], (lo - w.lon[i]) * cos (w.lat[i])));
+    /* A 5 digit MGRS string names the south west corner of its 1 m square */
+    if (!Convert_MGRS_To_Geodetic (&in.mgrs[i * 16], &la, &lo))
+      mgrs_round_trip.add (EARTH_RADIUS * hypot (la - w.lat[i], (lo - w.lon[i]) * cos (w.lat[i])));
+
+    if (strcmp (ref, &in.mgrs[i * 16]))
+      double_mismatch++;
+    Convert_Geodetic_To_MGRS_R (&reference, in.lat_udeg[i] * 1e-6 * DEG_TO_RAD,
+                                in.lon_udeg[i] * 1e-6 * DEG_TO_RAD, 5, ref);
+    if (Convert_Microdegrees_To_MGRS (in.lat_udeg[i], in.lon_udeg[i], 5, flt) || strcmp (ref, flt))
+      float_mismatch++;
+
+    /* Precision-adaptive terms against every term, at each precision */
+    for (precision = 0; precision <= MAX_PRECISION; precision++)
+    {
+      UTM_To_MGRS (in.zone[i], in.hemisphere[i], w.lon[i], w.lat[i],
+                   in.easting[i], in.northing[i], precision, ref);
+      if (Convert_Geodetic_To_MGRS (w.lat[i], w.lon[i], precision, flt) || strcmp (ref, flt))
+        terms_mismatch++;
+    }
+  }
+
+  printf ("      \"accuracy\": {\n");
+  printf ("        \"reference\": \"kruger\",\n");
+  printf ("        \"reference_errors\": %ld,\n", errors);
+  print_stats ("utm_easting", utm_easting, 0);
+  print_stats ("utm_northing", utm_northing, 0);
+  print_stats ("utm_round_trip", utm_round_trip, 0);
+  print_stats ("mgrs_round_trip", mgrs_round_trip, 0);
+  print_stats ("shared_trig_vs_classic_easting", shared_easting, 0);
+  print_stats ("shared_trig_vs_classic_northing", shared_northing, 0);
+  printf ("        \"mgrs_mismatch_rate\": %.3e,\n",
+          (double)double_mismatch / (n - errors));
+  printf ("        \"microdegree_mgrs_mismatch_rate\": %.3e,\n",
+          (double)float_mismatch / (n - errors));
+  printf ("        \"precision_terms_mismatches\": %ld\n", terms_mismatch);
+  printf ("      }\n");
+}
+
+/*
+ * Times and checks the conversion with every ellipsoid in MGRS_Datum_Table
+ * over workload w, against the Kruger series on the same ellipsoid.
+ */
+static void measure_datums (const Workload &w, const Stage_Inputs &in)
+{
+  long n = (long)w.lat.size ();
+  long i;
+  long d;
+  char mgrs[32];
+
+  printf ("  \"datums\": [\n");
+  for (d = 0; d < MGRS_DATUMS; d++)
+  {
+    MGRS_Parameters datum;
+    MGRS_Parameters reference;
+    MGRS_Float_Parameters datum_float;
+    Error_Stats utm_easting;
+    Error_Stats utm_northing;
+    Error_Stats mgrs_round_trip;
+    long errors = 0;
+    long mismatch = 0;
+    int first = 1;
+
+    Set_MGRS_Datum_R (&datum, MGRS_Datum_Table[d].Ellipsoid_Code);
+    datum_float = Make_MGRS_Float_Parameters (&datum);
+    reference = datum;
+    reference.UTM.Ellipsoid.Series = TRANMERC_KRUGER_SERIES;
+
+    printf ("    {\n      \"ellipsoid_code\": \"%s\",\n      \"workload\": \"%s\",\n"
+            "      \"stages\": {", MGRS_Datum_Table[d].Ellipsoid_Code, w.name);
+    TIME_STAGE ("Convert_Geodetic_To_MGRS_R",
+                Convert_Geodetic_To_MGRS_R (&datum, w.lat[i], w.lon[i], 5, mgrs);
+                sum += mgrs[7]);
+    TIME_STAGE ("Convert_Microdegrees_To_MGRS_R",
+                Convert_Microdegrees_To_MGRS_R (&datum_float, in.lat_udeg[i], in.lon_udeg[i],
+                                                5, mgrs); sum += mgrs[7]);
+    printf ("\n      },\n");
+
+    for (i = 0; i < n; i++)
+    {
+      long zone;
+      long ref_zone;
+      char hemisphere;
+      double e;
+      double nn;
+      double ref_e;
+      double ref_nn;
+      double la;
+      double lo;
+      char ref[32];
+
+      if (Convert_Geodetic_To_UTM_R (&reference.UTM, w.lat[i], w.lon[i],
+                                     &ref_zone, &hemisphere, &ref_e, &ref_nn)
+          || Convert_Geodetic_To_UTM_R (&datum.UTM, w.lat[i], w.lon[i],
+                                        &zone, &hemisphere, &e, &nn)
+          || Convert_Geodetic_To_MGRS_R (&reference, w.lat[i], w.lon[i], 5, ref)
+          || Convert_Geodetic_To_MGRS_R (&datum, w.lat[i], w.lon[i], 5, mgrs))
+      {
+        errors++;
+        continue;
+      }
+      utm_easting.add (e - ref_e);
+      utm_northing.add (nn - ref_nn);
+      if (strcmp (ref, mgrs))
+        mismatch++;
+      if (!Convert_MGRS_To_Geodetic_R (&datum, mgrs, &la, &lo))
+        mgrs_round_trip.add (EARTH_RADIUS * hypot (la - w.lat[i], (lo - w.lon[i]) * cos (w.lat[i])));
+    }
+    printf ("      \"accuracy\": {\n");
+    printf ("        \"reference_errors\": %ld,\n", errors);
+    print_stats ("utm_easting", utm_easting, 0);
+    print_stats ("utm_northing", utm_northing, 0);
+    print_stats ("mgrs_round_trip", mgrs_round_trip, 0);
+    printf ("        \"mgrs_mismatch_rate\": %.3e\n", (double)mismatch / (n - errors));
+    printf ("      }\n    }%s\n", (d + 1 < MGRS_DATUMS) ? "," : "");
+  }
+  printf ("  ],\n");
+}
+
+/*
+ * Checks the grid letter tables against the letter arithmetic they
+ * replaced, for every zone, grid pattern, 100 km column and 100 km row.
+ * Returns the number of differences.
+ */
+static long check_grid_tables ()
+{
+  long mismatches = 0;
+  long zone;
+  long set;
+  long pattern;
+  long column;
+  long row;
+  long low;
+  long letter;
+  double offset;
+
+  for (zone = 1; zone <= 60; zone++)
+  {
+    set = zone % 6 ? zone % 6 : 6;
+    low = (set == 1 || set == 4) ? LETTER_A : (set == 2 || set == 5) ? LETTER_J : LETTER_S;
+    for (pattern = MGRS_AL_PATTERN; pattern <= MGRS_AA_PATTERN; pattern++)
+    {
+      offset = ((set % 2) ? 0.0 : 500000.0) + ((pattern == MGRS_AA_PATTERN) ? 0.0 : 1000000.0);
+      if (Grid_Set_Table[zone % 6].pattern_offset[pattern] != offset)
+        mismatches++;
+    }
+    if ((Grid_Set_Table[zone % 6].ltr2_low_value != low)
+        || (Grid_Set_Table[zone % 6].ltr2_high_value != low + ((low == LETTER_J) ? 8 : 7)))
+      mismatches++;
+    for (column = 0; column <= 8; column++)
+    {
+      letter = low + column;
+      if ((low == LETTER_J) && (letter > LETTER_N))
+        letter++;
+      if (Grid_Set_Table[zone % 6].column_letter[column] != letter)
+        mismatches++;
+    }
+  }
+  for (row = 0; row < 20; row++)
+  {
+    letter = row;
+    if (letter > LETTER_H)
+      letter++;
+    if (letter > LETTER_N)
+      letter++;
+    if (Grid_Row_Letter_Table[row] != letter)
+      mismatches++;
+  }
+  return (mismatches);
+}
+
+/*
+ * Checks the constants MGRS_Datum_Table and TranMerc_WGS84 were built with
+ * at compile time against Make_Transverse_Mercator_Ellipsoid at run time,
+ * bit for bit.  Returns the number of ellipsoids that differ.
+ */
+static long check_datum_constants ()
+{
+  long mismatches = 0;
+  TranMerc_Ellipsoid made;
+  volatile double a;          /* Keeps the compiler from folding the run time call */
+  volatile double inv_f;
+  int d;
+
+  for (d = 0; d < MGRS_DATUMS; d++)
+  {
+    a = MGRS_Datum_Table[d].a;
+    inv_f = MGRS_Datum_Table[d].inv_f;
+    made = Make_Transverse_Mercator_Ellipsoid (a, 1 / inv_f);
+    if (memcmp (&made, &MGRS_Datum_Table[d].Ellipsoid, sizeof (made)))
+    {
+      fprintf (stderr, "%s: constants differ from Make_Transverse_Mercator_Ellipsoid\n",
+               MGRS_Datum_Table[d].Ellipsoid_Code);
+      mismatches++;
+    }
+  }
+  a = 6378137.0;
+  inv_f = 298.257223563;
+  made = Make_Transverse_Mercator_Ellipsoid (a, 1 / inv_f);
+  if (memcmp (&made, &TranMerc_WGS84, sizeof (made)))
+    mismatches++;
+  return (mismatches);
+}
+
+/* Get_Latitude_Letter as it was, dividing by the band height */
+static long reference_band_letter (double latitude, int *letter)
+{
+  double lat_deg = latitude * RAD_TO_DEG;
+
+  if (lat_deg >= 72 && lat_deg < 84.5)
+    *letter = LETTER_X;
+  else if (lat_deg > -80.5 && lat_deg < 72)
+    *letter = Latitude_Band_Table[(int)(((latitude + (80.0 * DEG_TO_RAD)) / (8.0 * DEG_TO_RAD))
+                                        + 1.0e-12)].letter;
+  else
+    return (MGRS_LAT_ERROR);
+  return (MGRS_NO_ERROR);
+}
+
+/*
+ * Checks Get_Latitude_Letter against the division it replaced at the
+ * BAND_DOUBLES doubles either side of every 8 degree edge, of each entry of
+ * Latitude_Band_Edge_Table and of the ends of the grid, and at as many
+ * latitudes spread evenly over the grid.  Returns the number of differences.
+ */
+static long check_band_letters ()
+{
+  static const long BAND_DOUBLES = 100000;
+  std::vector<double> edges;
+  long mismatches = 0;
+  long error_code[2];
+  int letter[2];
+  double latitude;
+  size_t e;
+  long k;
+
+  for (k = -81; k <= 85; k++)
+    edges.push_back (k * DEG_TO_RAD);
+  edges.push_back (-80.5 * DEG_TO_RAD);
+  edges.push_back (84.5 * DEG_TO_RAD);
+  for (k = 1; k < 20; k++)
+    edges.push_back (Latitude_Band_Edge_Table[k]);
+  for (e = 0; e < edges.size (); e++)
+  {
+    latitude = edges[e];
+    for (k = 0; k < BAND_DOUBLES; k++)
+      latitude = nextafter (latitude, -10.0);
+    for (k = -BAND_DOUBLES; k <= BAND_DOUBLES; k++)
+    {
+      letter[0] = letter[1] = -1;
+      error_code[0] = Get_Latitude_Letter (latitude, &letter[0]);
+      error_code[1] = reference_band_letter (latitude, &letter[1]);
+      if ((error_code[0] != error_code[1]) || (letter[0] != letter[1]))
+        mismatches++;
+      latitude = nextafter (latitude, 10.0);
+    }
+  }
+  for (k = 0; k <= BAND_DOUBLES; k++)
+  {
+    latitude = (-81.0 + 166.0 * k / BAND_DOUBLES) * DEG_TO_RAD;
+    letter[0] = letter[1] = -1;
+    error_code[0] = Get_Latitude_Letter (latitude, &letter[0]);
+    error_code[1] = reference_band_letter (latitude, &letter[1]);
+    if ((error_code[0] != error_code[1]) || (letter[0] != letter[1]))
+      mismatches++;
+  }
+  return (mismatches);
+}
+
+/*
+ * Times Update_MGRS_Grid_View over viewports of 10 grid spacings a side at
+ * 100 km, 10 km and 1 km spacing: drawing one from scratch at a spread of
+ * places, and panning one east a little at a time.
+ */
+static void measure_grid_overlay ()
+{
+  static const int frames = 200;
+  std::vector<MGRS_Grid_Line> lines (100000);
+  std::vector<MGRS_Grid_Point> points (1000000);
+  MGRS_Grid_Output output = {&lines[0], (long)lines.size (), 0,
+                             &points[0], (long)points.size (), 0};
+  MGRS_Grid_View view;
+  long precision;
+
+  printf ("  \"grid_overlay\": [");
+  for (precision = 0; precision <= 2; precision++)
+  {
+    double size = 10.0 * MGRS_Divisor_Table[precision] / MGRS_a;
+    double best_draw = 1e30;
+    double best_pan = 1e30;
+    double south;
+    double west;
+    long draw_lines = 0;
+    long draw_points = 0;
+    long pan_lines = 0;
+    long errors = 0;
+    int r;
+    int f;
+
+    for (r = 0; r < BENCH_REPEATS; r++)
+    {
+      double t = now ();
+
+      draw_lines = draw_points = 0;
+      for (f = 0; f < frames; f++)
+      {
+        south = (-60.0 + 0.6 * f) * DEG_TO_RAD;
+        west = (-170.0 + 1.5 * f) * DEG_TO_RAD;
+        Init_MGRS_Grid_View (&view, &MGRS_Default_Parameters, precision);
+        errors += Update_MGRS_Grid_View (&view, south, west, south + size,
+                                         west + size / cos (south + size), &output) != 0;
+        draw_lines += output.Line_Count;
+        draw_points += output.Point_Count;
+      }
+      t = now () - t;
+      if (t < best_draw)
+        best_draw = t;
+
+      south = 59.0 * DEG_TO_RAD;
+      west = 1.0 * DEG_TO_RAD;
+      Init_MGRS_Grid_View (&view, &MGRS_Default_Parameters, precision);
+      errors += Update_MGRS_Grid_View (&view, south, west, south + size,
+                                       west + size / cos (south), &output) != 0;
+      pan_lines = 0;
+      t = now ();
+      for (f = 0; f < frames; f++)
+      {
+        west += 0.02 * size / cos (south);
+        errors += Update_MGRS_Grid_View (&view, south, west, south + size,
+                                         west + size / cos (south), &output) != 0;
+        pan_lines += output.Line_Count;
+      }
+      t = now () - t;
+      if (t < best_pan)
+        best_pan = t;
+    }
+    printf ("%s\n    {\"spacing_m\": %ld, \"viewport_m\": %ld, \"errors\": %ld,\n"
+            "     \"draw\": {\"us_per_frame\": %.1f, \"lines\": %.1f, \"points\": %.1f},\n"
+            "     \"pan\": {\"us_per_frame\": %.1f, \"new_lines\": %.1f}}",
+            precision ? "," : "", MGRS_Divisor_Table[precision],
+            10 * MGRS_Divisor_Table[precision], errors,
+            best_draw / frames * 1e6, (double)draw_lines / frames, (double)draw_points / frames,
+            best_pan / frames * 1e6, (double)pan_lines / frames);
+  }
+  printf ("\n  ]");
+}
+
+#ifdef MGRS_PROBES
+static void measure_probes (const Workload &w, const Stage_Inputs &in)
+{
+  static const long pairs = 1000000;
+  MGRS_Probe_Ticks ticks = Get_MGRS_Probe_Ticks ();
+  double t = now ();
+  double pair_ns;
+  long probed = 0;
+  MGRS_Tracker tracker;
+  char mgrs[16];
+  size_t i;
+  long s;
+  long b;
+  int first;
+
+  Reset_MGRS_Probes ();
+  for (i = 0; i < (size_t)pairs; i++)
+  {
+    MGRS_PROBE_BEGIN (MGRS_PROBE_FLUSH);
+    MGRS_PROBE_END (MGRS_PROBE_FLUSH);
+  }
+  t = now () - t;
+  ticks = Get_MGRS_Probe_Ticks () - ticks;
+  pair_ns = t / pairs * 1e9;
+
+  Reset_MGRS_Probes ();
+  for (i = 0; i < w.lat.size (); i++)
+    Convert_Geodetic_To_MGRS_R (&MGRS_Default_Parameters, w.lat[i], w.lon[i], 5, mgrs);
+  for (s = MGRS_PROBE_GEODETIC_TO_UTM; s <= MGRS_PROBE_MGRS_STRING; s++)
+    probed += MGRS_Probe_Table[s].Count;
+  Init_MGRS_Tracker (&tracker, &MGRS_Float_Default_Parameters);
+  for (i = 0; i < in.lat_udeg.size (); i++)
+    Update_MGRS_Tracker (&tracker, in.lat_udeg[i], in.lon_udeg[i], 5, mgrs);
+
+  printf ("  \"probes\": {\n    \"tick_unit\": \"%s\",\n    \"ticks_per_ns\": %.3f,\n"
+          "    \"pair_ns\": %.2f,\n    \"pairs_per_conversion\": %.2f,\n"
+          "    \"overhead_ns_per_conversion\": %.1f,\n    \"stages\": [",
+          MGRS_PROBE_TICK_UNIT, ticks / (t * 1e9), pair_ns, (double)probed / w.lat.size (),
+          pair_ns * probed / w.lat.size ());
+  for (s = 0, first = 1; s < MGRS_PROBE_STAGES; s++)
+  {
+    const MGRS_Probe_Stage *stage = &MGRS_Probe_Table[s];
+
+    if (!stage->Count)
+      continue;
+    printf ("%s\n      {\"name\": \"%s\", \"count\": %lu, \"min\": %llu, \"mean\": %.1f,"
+            " \"max\": %llu,\n       \"log2_buckets\": {", first ? "" : ",",
+            MGRS_Probe_Names[s], stage->Count, stage->Min, (double)stage->Total / stage->Count,
+            stage->Max);
+    for (b = 0, first = 1; b < MGRS_PROBE_BUCKETS; b++)
+      if (stage->Bucket[b])
+      {
+        printf ("%s\"%ld\": %lu", first ? "" : ", ", b, stage->Bucket[b]);
+        first = 0;
+      }
+    printf ("}}");
+    first = 0;
+  }
+  printf ("\n    ]\n  }");
+}
+#endif
+
+int main (int argc, char **argv)
+{
+  double scale = (argc > 1) ? atof (argv[1]) : 1.0;
+  std::vector<Workload> ws;
+  long batch_mismatches = 0;
+  long band_mismatches = check_band_letters ();
+  long constant_mismatches = check_datum_constants ();
+  size_t k;
+
+  make_workloads (ws, scale);
+  printf ("{\n  \"repeats\": %d,\n  \"scale\": %g,\n  \"batch_isa\": \"%s\",\n"
+          "  \"grid_table_mismatches\": %ld,\n  \"band_letter_mismatches\": %ld,\n"
+          "  \"datum_constant_mismatches\": %ld,\n"
+          "  \"workloads\": [\n", BENCH_REPEATS, scale, TM_BATCH_ISA, check_grid_tables (),
+          band_mismatches, constant_mismatches);
+  for (k = 0; k < ws.size (); k++)
+  {
+    Stage_Inputs in;
+    Batch_Check batch;
+    long rejected;
+
+    check_batch (ws[k], batch);
+    batch_mismatches += batch.mismatches;
+    rejected = keep_valid (ws[k]);
+    fprintf (stderr, "%s: %lu points\n", ws[k].name, (unsigned long)ws[k].lat.size ());
+    prepare (ws[k], in);
+    printf ("    {\n      \"name\": \"%s\",\n      \"points\": %lu,\n"
+            "      \"rejected_points\": %ld,\n", ws[k].name,
+            (unsigned long)ws[k].lat.size (), rejected);
+    printf ("      \"batch_check\": {\"points\": %ld, \"rejected\": %ld, \"mismatches\": %ld,"
+            " \"max_diff_m\": %.3e},\n", batch.points, batch.rejected, batch.mismatches,
+            batch.max_diff);
+    time_stages (ws[k], in);
+    measure_accuracy (ws[k], in);
+    printf ("    }%s\n", (k + 1 < ws.size ()) ? "," : "");
+  }
+  printf ("  ],\n");
+  {
+    Stage_Inputs in;
+
+    /* global_grid, already cut down to the points the pipeline accepts */
+    prepare (ws[0], in);
+    measure_datums (ws[0], in);
+    measure_grid_overlay ();
+#ifdef MGRS_PROBES
+    printf (",\n");
+    measure_probes (ws[0], in);
+#endif
+  }
+  printf (",\n  \"batch_mismatches\": %ld\n}\n", batch_mismatches);
+  return ((batch_mismatches || band_mismatches || constant_mismatches) ? 1 : 0);
+}
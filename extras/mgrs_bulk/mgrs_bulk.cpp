@@ -0,0 +1,456 @@
+/*
+ * Bulk geodetic to MGRS conversion of a memory-mapped file of positions,
+ * on every core.  Not part of the sketch; build and run it on the host:
+ *
+ *   g++ -O2 -std=gnu++11 -pthread -I../.. mgrs_bulk.cpp -o mgrs_bulk
+ *   ./mgrs_bulk [-f csv|bin] [-p precision] [-t threads] input output
+ *   ./mgrs_bulk -s [-f csv|bin] [-p precision] [-t threads] input output
+ *   ./mgrs_bulk -g count [-f csv|bin] output
+ *
+ * Input is either CSV text, one "latitude,longitude" in decimal degrees
+ * per line, or packed binary pairs of native doubles in decimal degrees.
+ * Output is one fixed-width record per input line or pair, in input
+ * order: the MGRS string blank-padded to 5 + 2 * precision characters and
+ * a newline.  Lines that do not parse, pairs that are not finite numbers,
+ * and positions MGRS cannot represent, give an all-blank record and are
+ * counted; they cost their worker no more than a good line.
+ *
+ * The input is split into chunks (about CHUNK_BYTES of CSV, or
+ * CHUNK_POINTS binary pairs).  Each worker starts with an equal, contiguous
+ * run of chunks and, when its run is used up, steals the back half of the
+ * largest run left, since chunks full of zone exceptions or bad lines take
+ * longer.  CSV is first counted in parallel the same way to give each
+ * chunk its first record number.  Every conversion uses the shared,
+ * read-only MGRS_Default_Parameters through Convert_Geodetic_To_MGRS_R.
+ *
+ * Throughput and counts go to stderr as JSON.  -s instead converts once
+ * with each of 1, 2, 4, ... threads up to -t (default: all cores) and
+ * writes the scaling table to stdout as JSON.  -g writes count random
+ * positions, a tenth of them in the Norway and Svalbard zones and a
+ * thousandth of the lines malformed (or pairs NaN or infinite), for trying
+ * it out.
+ */
+
+#include "../../mgrs.h"
+#include "../mgrs_host.h"
+
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#define CHUNK_BYTES     (1L << 20)
+#define CHUNK_POINTS    (1L << 16)
+
+/* A worker's run of chunks, [next, end); other workers may shorten it */
+struct Run
+{
+  std::mutex lock;               /* Held to change next or end */
+  std::atomic<long> next;
+  std::atomic<long> end;
+};
+
+struct Job
+{
+  int binary;
+  long precision;
+  long width;                    /* Characters per output record */
+  const char *input;
+  long input_size;
+  char *output;
+  long chunks;
+  std::vector<long> chunk_start; /* Byte offset of each chunk, and the end */
+  std::vector<long> first_record;/* Record number of each chunk's first line */
+  std::atomic<long> bad_lines;
+  std::atomic<long> mgrs_errors;
+};
+
+/* Takes the next chunk of worker w's run, stealing when it is empty */
+static long next_chunk (std::vector<Run> &runs, long w)
+{
+  long chunk;
+  long end;
+  long victim;
+  long best;
+  long left;
+  long k;
+
+  {
+    std::lock_guard<std::mutex> g (runs[w].lock);
+    if (runs[w].next < runs[w].end)
+      return (runs[w].next++);
+  }
+  for (;;)
+  {
+    victim = -1;
+    best = 0;
+    for (k = 0; k < (long)runs.size (); k++)
+    {
+      left = runs[k].end - runs[k].next;   /* A hint only; checked below */
+      if (left > best)
+      {
+        best = left;
+        victim = k;
+      }
+    }
+    if (victim < 0)
+      return (-1);
+
+    {
+      std::lock_guard<std::mutex> g (runs[victim].lock);
+      end = runs[victim].end;
+      left = end - runs[victim].next;
+      if (left <= 0)
+        continue;
+      chunk = end - (left + 1) / 2;
+      runs[victim].end = chunk;
+    }
+    /* Only this worker adds to its own run, so no one else can be here */
+    std::lock_guard<std::mutex> own (runs[w].lock);
+    runs[w].next = chunk + 1;
+    runs[w].end = end;
+    return (chunk);
+  }
+}
+
+/* Runs body(chunk) over every chunk of job on threads workers */
+template <class Body>
+static void for_each_chunk (long chunks, long threads, Body body)
+{
+  std::vector<Run> runs (threads);
+  std::vector<std::thread> pool;
+  long w;
+
+  for (w = 0; w < threads; w++)
+  {
+    runs[w].next = chunks * w / threads;
+    runs[w].end = chunks * (w + 1) / threads;
+  }
+  for (w = 0; w < threads; w++)
+    pool.push_back (std::thread ([&runs, &body, w] ()
+      {
+        long chunk;
+
+        while ((chunk = next_chunk (runs, w)) >= 0)
+          body (chunk);
+      }));
+  for (w = 0; w < threads; w++)
+    pool[w].join ();
+}
+
+/*
+ * Parses [+-]digits[.digits] from p, stopping at end.  The digits are
+ * gathered as an integer and divided by a power of ten once, which rounds
+ * correctly for up to 15 significant digits.
+ */
+static const char *parse_degrees (const char *p, const char *end, double *value)
+{
+  static const double power[16] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8,
+                                   1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15};
+  long long mantissa = 0;
+  long digits = 0;
+  long decimals = 0;
+  int negative = 0;
+
+  while ((p < end) && (*p == ' '))
+    p++;
+  if ((p < end) && ((*p == '-') || (*p == '+')))
+    negative = (*p++ == '-');
+  for (; (p < end) && (*p >= '0') && (*p <= '9'); p++, digits++)
+    mantissa = mantissa * 10 + (*p - '0');
+  if ((p < end) && (*p == '.'))
+    for (p++; (p < end) && (*p >= '0') && (*p <= '9'); p++, digits++, decimals++)
+      mantissa = mantissa * 10 + (*p - '0');
+  if ((digits == 0) || (digits > 15))
+    return (0);
+  while ((p < end) && (*p == ' '))
+    p++;
+  *value = (double)mantissa / power[decimals];
+  if (negative)
+    *value = -*value;
+  return (p);
+}
+
+static void write_record (Job &job, long record, double latitude, double longitude, int ok)
+{
+  char *r = job.output + record * job.width;
+
+  if (!ok)
+    job.bad_lines++;
+  else if (Convert_Geodetic_To_MGRS_R (&MGRS_Default_Parameters, latitude * DEG_TO_RAD,
+                                       longitude * DEG_TO_RAD, job.precision, r))
+  {
+    job.mgrs_errors++;
+    ok = 0;
+  }
+  if (!ok)
+    memset (r, ' ', job.width - 1);
+  r[job.width - 1] = '\n';
+}
+
+/* Lines in [start, end); the last may lack its newline */
+static long count_lines (const char *start, const char *end)
+{
+  long lines = 0;
+  const char *p = start;
+
+  while ((p = (const char *)memchr (p, '\n', end - p)) != 0)
+  {
+    lines++;
+    p++;
+  }
+  if ((end > start) && (end[-1] != '\n'))
+    lines++;
+  return (lines);
+}
+
+static void convert_chunk (Job &job, long chunk)
+{
+  const char *p = job.input + job.chunk_start[chunk];
+  const char *end = job.input + job.chunk_start[chunk + 1];
+  const char *line_end;
+  const char *q;
+  long record = job.first_record[chunk];
+  double latitude;
+  double longitude;
+  double pair[2];
+
+  if (job.binary)
+  {
+    for (; p < end; p += sizeof (pair), record++)
+    {
+      memcpy (pair, p, sizeof (pair));
+      write_record (job, record, pair[0], pair[1], isfinite (pair[0]) && isfinite (pair[1]));
+    }
+    return;
+  }
+  for (; p < end; p = line_end + 1, record++)
+  {
+    line_end = (const char *)memchr (p, '\n', end - p);
+    if (!line_end)
+      line_end = end;
+    q = line_end;
+    if ((q > p) && (q[-1] == '\r'))
+      q--;
+    p = parse_degrees (p, q, &latitude);
+    if (p && (p < q) && (*p == ','))
+      p = parse_degrees (p + 1, q, &longitude);
+    else
+      p = 0;
+    write_record (job, record, latitude, longitude, p == q);
+  }
+}
+
+/* Splits the input into chunks and numbers their records; returns the count */
+static long plan (Job &job, long threads)
+{
+  long offset;
+  long k;
+  long pairs;
+  const char *p;
+
+  job.chunk_start.clear ();
+  job.first_record.clear ();
+  if (job.binary)
+  {
+    pairs = job.input_size / (2 * sizeof (double));
+    for (k = 0; k < pairs; k += CHUNK_POINTS)
+    {
+      job.chunk_start.push_back (k * 2 * sizeof (double));
+      job.first_record.push_back (k);
+    }
+    job.chunk_start.push_back (pairs * 2 * sizeof (double));
+    job.first_record.push_back (pairs);
+    job.chunks = job.chunk_start.size () - 1;
+    return (pairs);
+  }
+
+  /* CSV chunks end just after a newline */
+  for (offset = 0; offset < job.input_size; )
+  {
+    job.chunk_start.push_back (offset);
+    offset += CHUNK_BYTES;
+    if (offset >= job.input_size)
+      break;
+    p = (const char *)memchr (job.input + offset, '\n', job.input_size - offset);
+    offset = p ? p + 1 - job.input : job.input_size;
+  }
+  job.chunk_start.push_back (job.input_size);
+  job.chunks = job.chunk_start.size () - 1;
+
+  job.first_record.assign (job.chunks + 1, 0);
+  for_each_chunk (job.chunks, threads, [&job] (long chunk)
+    {
+      job.first_record[chunk + 1] = count_lines (job.input + job.chunk_start[chunk],
+                                                 job.input + job.chunk_start[chunk + 1]);
+    });
+  for (k = 0; k < job.chunks; k++)
+    job.first_record[k + 1] += job.first_record[k];
+  return (job.first_record[job.chunks]);
+}
+
+/* Converts the whole input with threads workers; returns the seconds taken */
+static double run (Job &job, long threads, const char *output_file, long *records)
+{
+  double t = now ();
+  int fd;
+
+  *records = plan (job, threads);
+  fd = open (output_file, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if ((fd < 0) || (ftruncate (fd, *records * job.width) < 0))
+  {
+    perror (output_file);
+    exit (1);
+  }
+  job.output = 0;
+  if (*records > 0)
+  {
+    job.output = (char *)mmap (0, *records * job.width, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (job.output == MAP_FAILED)
+    {
+      perror ("mmap");
+      exit (1);
+    }
+    madvise (job.output, *records * job.width, MADV_SEQUENTIAL);
+  }
+  job.bad_lines = 0;
+  job.mgrs_errors = 0;
+  for_each_chunk (job.chunks, threads, [&job] (long chunk) { convert_chunk (job, chunk); });
+  if (job.output)
+    munmap (job.output, *records * job.width);
+  close (fd);
+  return (now () - t);
+}
+
+static int generate (long count, int binary, const char *output_file)
+{
+  FILE *f = fopen (output_file, "wb");
+  unsigned long long seed = 12345;
+  double pair[2];
+  long i;
+
+  if (!f)
+  {
+    perror (output_file);
+    return (1);
+  }
+  for (i = 0; i < count; i++)
+  {
+    pair[0] = uniform (&seed);
+    pair[1] = uniform (&seed);
+    if (i % 10 == 0)
+    {
+      pair[0] = (i % 20 == 0) ? 56.0 + 8.0 * pair[0] : 72.0 + 12.0 * pair[0];
+      pair[1] = 42.0 * pair[1];
+    }
+    else
+    {
+      pair[0] = -80.0 + 164.0 * pair[0];
+      pair[1] = -180.0 + 360.0 * pair[1];
+    }
+    if (binary && (i % 1000 == 999))
+      pair[i % 2] = (i % 2000 == 999) ? NAN : -INFINITY;
+    if (binary)
+      fwrite (pair, sizeof (pair), 1, f);
+    else if (i % 1000 == 999)
+      fprintf (f, "%.7f;%.7f\n", pair[0], pair[1]);
+    else
+      fprintf (f, "%.7f,%.7f\n", pair[0], pair[1]);
+  }
+  fclose (f);
+  return (0);
+}
+
+int main (int argc, char **argv)
+{
+  static Job job;
+  long threads = std::thread::hardware_concurrency ();
+  long generate_count = -1;
+  long records;
+  long t;
+  int scaling = 0;
+  const char *files[2] = {0, 0};
+  long nfiles = 0;
+  struct stat st;
+  double seconds;
+  int fd;
+  int i;
+
+  job.binary = 0;
+  job.precision = 5;
+  for (i = 1; i < argc; i++)
+  {
+    if (!strcmp (argv[i], "-f") && (i + 1 < argc))
+      job.binary = !strcmp (argv[++i], "bin");
+    else if (!strcmp (argv[i], "-p") && (i + 1 < argc))
+      job.precision = atol (argv[++i]);
+    else if (!strcmp (argv[i], "-t") && (i + 1 < argc))
+      threads = atol (argv[++i]);
+    else if (!strcmp (argv[i], "-g") && (i + 1 < argc))
+      generate_count = atol (argv[++i]);
+    else if (!strcmp (argv[i], "-s"))
+      scaling = 1;
+    else if (nfiles < 2)
+      files[nfiles++] = argv[i];
+  }
+  if (generate_count >= 0 && nfiles == 1)
+    return (generate (generate_count, job.binary, files[0]));
+  if ((nfiles != 2) || (threads < 1) || (job.precision < 0) || (job.precision > MAX_PRECISION))
+  {
+    fprintf (stderr, "usage: mgrs_bulk [-s] [-f csv|bin] [-p 0-5] [-t threads] input output\n"
+                     "       mgrs_bulk -g count [-f csv|bin] output\n");
+    return (2);
+  }
+  job.width = 5 + 2 * job.precision + 1;
+
+  fd = open (files[0], O_RDONLY);
+  if ((fd < 0) || (fstat (fd, &st) < 0))
+  {
+    perror (files[0]);
+    return (1);
+  }
+  job.input_size = st.st_size;
+  job.input = "";
+  if (job.input_size > 0)
+  {
+    job.input = (const char *)mmap (0, job.input_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (job.input == MAP_FAILED)
+    {
+      perror ("mmap");
+      return (1);
+    }
+    madvise ((void *)job.input, job.input_size, MADV_SEQUENTIAL);
+  }
+
+  if (scaling)
+  {
+    printf ("{\n  \"input_bytes\": %ld,\n  \"scaling\": [", job.input_size);
+    for (t = 1; ; t = (2 * t < threads) ? 2 * t : threads)
+    {
+      seconds = run (job, t, files[1], &records);
+      printf ("%s\n    {\"threads\": %ld, \"seconds\": %.3f, \"records_per_sec\": %.0f}",
+              (t == 1) ? "" : ",", t, seconds, records / seconds);
+      fflush (stdout);
+      if (t == threads)
+        break;
+    }
+    printf ("\n  ]\n}\n");
+    return (0);
+  }
+
+  seconds = run (job, threads, files[1], &records);
+  fprintf (stderr, "{\"threads\": %ld, \"chunks\": %ld, \"records\": %ld, \"bad_lines\": %ld,\n"
+           " \"mgrs_errors\": %ld, \"seconds\": %.3f, \"records_per_sec\": %.0f,\n"
+           " \"mb_per_sec\": %.1f}\n", threads, job.chunks, records, job.bad_lines.load (),
+           job.mgrs_errors.load (), seconds, records / seconds, job.input_size / seconds / 1.0e6);
+  return (0);
+}
@@ -0,0 +1,174 @@
+/*
+ * Hit ratio and throughput of mgrs_cache.h on a simulated fleet, against
+ * converting every report.  Not part of the sketch; build and run it on
+ * the host:
+ *
+ *   g++ -O2 -std=gnu++11 -pthread -I../.. mgrs_cache.cpp -o mgrs_cache
+ *   ./mgrs_cache [-n reports] [-v vehicles] [-c entries] [-p precision] [-t threads]
+ *
+ * Each report comes from a random vehicle.  With the duplicate rate it is
+ * the vehicle's last position again, bit for bit; otherwise the vehicle
+ * has moved up to 50 m, to a position with 7 decimals of degrees as a
+ * receiver would give it.  For duplicate rates of 0, 50, 90 and 99 % and
+ * 1, 2, 4, ... threads up to -t (default: all cores) the reports are
+ * split evenly among the threads and converted once without and once with
+ * a fresh cache; every cached result is checked against the uncached one.
+ * The table goes to stdout as JSON.
+ */
+
+#include "mgrs_cache.h"
+#include "../mgrs_host.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <thread>
+#include <vector>
+
+#define STEP_DEGREES    0.00045  /* About 50 m */
+
+static const double duplicate_rates[] = {0.0, 0.5, 0.9, 0.99};
+
+struct Report
+{
+  double latitude;               /* Radians */
+  double longitude;
+};
+
+static void make_reports (std::vector<Report> &reports, long vehicles, double duplicate_rate)
+{
+  std::vector<double> latitude (vehicles);
+  std::vector<double> longitude (vehicles);
+  unsigned long long seed = 12345;
+  double degrees_to_radians = PI / 180.0;
+  size_t i;
+  long v;
+
+  for (v = 0; v < vehicles; v++)
+  {
+    latitude[v] = -79.0 + 162.0 * uniform (&seed);
+    longitude[v] = -179.0 + 358.0 * uniform (&seed);
+  }
+  for (i = 0; i < reports.size (); i++)
+  {
+    v = (long)(uniform (&seed) * vehicles);
+    if (uniform (&seed) >= duplicate_rate)
+    {
+      latitude[v] = floor ((latitude[v] + STEP_DEGREES * (2.0 * uniform (&seed) - 1.0)) * 1e7 + 0.5) / 1e7;
+      longitude[v] = floor ((longitude[v] + STEP_DEGREES * (2.0 * uniform (&seed) - 1.0)) * 1e7 + 0.5) / 1e7;
+    }
+    reports[i].latitude = latitude[v] * degrees_to_radians;
+    reports[i].longitude = longitude[v] * degrees_to_radians;
+  }
+}
+
+/* Converts reports[i] into text[i] on threads threads, with cache if not null */
+static double convert (const std::vector<Report> &reports, std::vector<char> &text,
+                       long precision, long threads, MGRS_Cache *cache)
+{
+  std::vector<std::thread> workers;
+  long count = reports.size ();
+  double t = now ();
+  long w;
+
+  for (w = 0; w < threads; w++)
+    workers.push_back (std::thread ([&, w] ()
+    {
+      long i;
+
+      for (i = count * w / threads; i < count * (w + 1) / threads; i++)
+        if (cache)
+          Convert_Geodetic_To_MGRS_Cached (cache, reports[i].latitude, reports[i].longitude,
+                                           precision, &text[i * MGRS_CACHE_TEXT]);
+        else
+          Convert_Geodetic_To_MGRS_R (&MGRS_Default_Parameters, reports[i].latitude,
+                                      reports[i].longitude, precision, &text[i * MGRS_CACHE_TEXT]);
+    }));
+  for (w = 0; w < threads; w++)
+    workers[w].join ();
+  return (now () - t);
+}
+
+int main (int argc, char **argv)
+{
+  long count = 2000000;
+  long vehicles = 10000;
+  long entries = 16384;
+  long precision = 5;
+  long threads = std::thread::hardware_concurrency ();
+  std::vector<Report> reports;
+  std::vector<char> expected;
+  std::vector<char> text;
+  MGRS_Cache cache;
+  MGRS_Cache_Stats stats;
+  double uncached_seconds;
+  double cached_seconds;
+  long mismatches;
+  long i;
+  long r;
+  long t;
+
+  for (i = 1; i < argc; i++)
+  {
+    if (!strcmp (argv[i], "-n") && (i + 1 < argc))
+      count = atol (argv[++i]);
+    else if (!strcmp (argv[i], "-v") && (i + 1 < argc))
+      vehicles = atol (argv[++i]);
+    else if (!strcmp (argv[i], "-c") && (i + 1 < argc))
+      entries = atol (argv[++i]);
+    else if (!strcmp (argv[i], "-p") && (i + 1 < argc))
+      precision = atol (argv[++i]);
+    else if (!strcmp (argv[i], "-t") && (i + 1 < argc))
+      threads = atol (argv[++i]);
+    else
+      count = -1;
+  }
+  if ((count < 1) || (vehicles < 1) || (entries < 1) || (threads < 1)
+      || (precision < 0) || (precision > MAX_PRECISION))
+  {
+    fprintf (stderr, "usage: mgrs_cache [-n reports] [-v vehicles] [-c entries] [-p 0-5] [-t threads]\n");
+    return (2);
+  }
+
+  reports.resize (count);
+  expected.resize (count * MGRS_CACHE_TEXT);
+  text.resize (count * MGRS_CACHE_TEXT);
+  if (!Init_MGRS_Cache (&cache, &MGRS_Default_Parameters, entries))
+  {
+    fprintf (stderr, "mgrs_cache: no memory for %ld entries\n", entries);
+    return (1);
+  }
+  Get_MGRS_Cache_Stats (&cache, &stats);
+  Free_MGRS_Cache (&cache);
+  printf ("{\n  \"reports\": %ld,\n  \"vehicles\": %ld,\n  \"precision\": %ld,\n"
+          "  \"cache_entries\": %ld,\n  \"cache_bytes\": %ld,\n  \"runs\": [",
+          count, vehicles, precision, stats.Entries, stats.Bytes);
+  for (r = 0; r < (long)(sizeof (duplicate_rates) / sizeof (duplicate_rates[0])); r++)
+  {
+    make_reports (reports, vehicles, duplicate_rates[r]);
+    for (t = 1; ; t = (2 * t < threads) ? 2 * t : threads)
+    {
+      uncached_seconds = convert (reports, expected, precision, t, 0);
+      Init_MGRS_Cache (&cache, &MGRS_Default_Parameters, entries);
+      cached_seconds = convert (reports, text, precision, t, &cache);
+      Get_MGRS_Cache_Stats (&cache, &stats);
+      Free_MGRS_Cache (&cache);
+      for (mismatches = 0, i = 0; i < count; i++)
+        if (strcmp (&expected[i * MGRS_CACHE_TEXT], &text[i * MGRS_CACHE_TEXT]))
+          mismatches++;
+      printf ("%s\n    {\"duplicate_rate\": %.2f, \"threads\": %ld, \"hit_ratio\": %.4f,"
+              " \"evictions\": %ld,\n     \"uncached_per_sec\": %.0f, \"cached_per_sec\": %.0f,"
+              " \"speedup\": %.2f, \"mismatches\": %ld}",
+              ((r == 0) && (t == 1)) ? "" : ",", duplicate_rates[r], t,
+              (double)stats.Hits / (stats.Hits + stats.Misses), stats.Evictions,
+              count / uncached_seconds, count / cached_seconds,
+              uncached_seconds / cached_seconds, mismatches);
+      fflush (stdout);
+      if (t == threads)
+        break;
+    }
+  }
+  printf ("\n  ]\n}\n");
+  return (0);
+}
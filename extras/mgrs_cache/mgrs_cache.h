@@ -0,0 +1,270 @@
+#ifndef MGRS_CACHE_H
+#define MGRS_CACHE_H
+
+/*
+ * A bounded cache of geodetic to MGRS conversions, shared by any number
+ * of threads, for servers that see the same positions over and over
+ * (parked or slow vehicles).  Host only: it needs C++11 atomics.
+ *
+ * Entries are keyed by the exact latitude, longitude and precision, so a
+ * hit returns the very string Convert_Geodetic_To_MGRS_R would.  (Keying
+ * by a coarser grid of latitude and longitude cannot: a cell of such a
+ * grid straddles the UTM cells at every precision.)  Receivers report
+ * fixed decimals, so a vehicle standing still repeats its position bit
+ * for bit.
+ *
+ * The cache is MGRS_CACHE_WAYS-way set associative.  Lookups take no
+ * lock: each entry has a sequence count, odd while it is being written,
+ * and a reader that sees it change treats the lookup as a miss.  A miss
+ * converts and then tries to take its set's lock to insert; if another
+ * thread holds it the result simply is not cached, so no thread ever
+ * waits.  The victim is chosen by CLOCK within the set.  Hits, misses
+ * and evictions are counted in MGRS_CACHE_STRIPES separate cache lines.
+ */
+
+#include "../../mgrs.h"
+
+#include <atomic>
+#include <new>
+#include <stdlib.h>
+#include <string.h>
+
+#define MGRS_CACHE_WAYS       8    /* Entries per set                       */
+#define MGRS_CACHE_STRIPES    64   /* Counter copies, to spread the writes  */
+#define MGRS_CACHE_TEXT       16   /* Longest MGRS string and terminator    */
+
+struct MGRS_Cache_Entry
+{
+  std::atomic<unsigned> Sequence;              /* Odd while being written       */
+  std::atomic<unsigned> Referenced;            /* CLOCK bit, set by hits        */
+  std::atomic<unsigned long long> Latitude;    /* Bits of the key               */
+  std::atomic<unsigned long long> Longitude;
+  std::atomic<unsigned long long> Precision;   /* Precision + 1, 0 if empty     */
+  std::atomic<unsigned long long> Text[MGRS_CACHE_TEXT / 8];
+};
+
+struct alignas (64) MGRS_Cache_Set
+{
+  std::atomic<int> Lock;                       /* Held to write an entry        */
+  unsigned Hand;                               /* CLOCK hand, under Lock        */
+  MGRS_Cache_Entry Entry[MGRS_CACHE_WAYS];
+};
+
+struct alignas (64) MGRS_Cache_Counters
+{
+  std::atomic<long> Hits;
+  std::atomic<long> Misses;
+  std::atomic<long> Evictions;
+};
+
+struct MGRS_Cache
+{
+  const MGRS_Parameters *Parameters;
+  unsigned long Set_Mask;                      /* Number of sets less 1         */
+  MGRS_Cache_Set *Sets;
+  MGRS_Cache_Counters Counters[MGRS_CACHE_STRIPES];
+};
+
+struct MGRS_Cache_Stats
+{
+  long Entries;                                /* Capacity                      */
+  long Bytes;                                  /* Memory held by the sets       */
+  long Hits;
+  long Misses;
+  long Evictions;
+};
+
+
+long Init_MGRS_Cache (MGRS_Cache *Cache,
+                      const MGRS_Parameters *Parameters,
+                      long Entries)
+/*
+ * The function Init_MGRS_Cache sets up an empty cache of conversions with
+ * Parameters, holding at least Entries (rounded up to a power of 2 sets).
+ * It returns 0 if the memory cannot be had, otherwise 1.
+ *
+ *    Cache      : Cache to initialize                  (output)
+ *    Parameters : MGRS parameters of every conversion  (input)
+ *    Entries    : Capacity in conversions              (input)
+ */
+{ /* Init_MGRS_Cache */
+  unsigned long sets = 1;
+  unsigned long s;
+  void *memory;
+  long i;
+
+  while (sets * MGRS_CACHE_WAYS < (unsigned long)Entries)
+    sets <<= 1;
+  /* Aligned by hand: new only aligns to 64 bytes from C++17 */
+  if (posix_memalign (&memory, alignof (MGRS_Cache_Set), sets * sizeof (MGRS_Cache_Set)))
+    return (0);
+  Cache->Parameters = Parameters;
+  Cache->Set_Mask = sets - 1;
+  Cache->Sets = (MGRS_Cache_Set *)memory;
+  for (s = 0; s < sets; s++)
+    new (&Cache->Sets[s]) MGRS_Cache_Set ();
+  for (i = 0; i < MGRS_CACHE_STRIPES; i++)
+  {
+    Cache->Counters[i].Hits.store (0);
+    Cache->Counters[i].Misses.store (0);
+    Cache->Counters[i].Evictions.store (0);
+  }
+  return (1);
+} /* Init_MGRS_Cache */
+
+
+void Free_MGRS_Cache (MGRS_Cache *Cache)
+/*
+ * The function Free_MGRS_Cache releases the memory of a cache.  No other
+ * thread may be using it.
+ */
+{ /* Free_MGRS_Cache */
+  free (Cache->Sets);
+  Cache->Sets = 0;
+} /* Free_MGRS_Cache */
+
+
+static unsigned long long Hash_MGRS_Cache_Key (unsigned long long Latitude,
+                                               unsigned long long Longitude,
+                                               long Precision)
+/*
+ * Mixes the key bits (the splitmix64 finalizer), so that nearby positions
+ * spread over all the sets.
+ */
+{
+  unsigned long long h = Latitude ^ (Longitude * 0x9e3779b97f4a7c15ULL) ^ (unsigned long long)Precision;
+
+  h ^= h >> 30;
+  h *= 0xbf58476d1ce4e5b9ULL;
+  h ^= h >> 27;
+  h *= 0x94d049bb133111ebULL;
+  h ^= h >> 31;
+  return (h);
+}
+
+
+long Convert_Geodetic_To_MGRS_Cached (MGRS_Cache *Cache,
+                                      double Latitude,
+                                      double Longitude,
+                                      long Precision,
+                                      char *MGRS)
+/*
+ * The function Convert_Geodetic_To_MGRS_Cached returns the conversion of
+ * Convert_Geodetic_To_MGRS_R with the cache's parameters, from the cache
+ * if it is there, and otherwise converts and caches it.  Conversions that
+ * fail are not cached, and a precision out of range is never looked up, as
+ * the entries keep Precision + 1 with 0 for empty.  Any number of threads
+ * may call it at once.
+ *
+ *    Cache      : Cache of conversions                 (input/output)
+ *    Latitude   : Latitude in radians                  (input)
+ *    Longitude  : Longitude in radians                 (input)
+ *    Precision  : Precision level of MGRS string       (input)
+ *    MGRS       : MGRS coordinate string               (output)
+ */
+{ /* Convert_Geodetic_To_MGRS_Cached */
+  unsigned long long lat_bits;
+  unsigned long long lon_bits;
+  unsigned long long text[MGRS_CACHE_TEXT / 8];
+  unsigned long long hash;
+  unsigned sequence;
+  MGRS_Cache_Set *set;
+  MGRS_Cache_Entry *entry;
+  MGRS_Cache_Counters *counters;
+  long way;
+  long error_code;
+  int unlocked = 0;
+
+  if ((Precision < 0) || (Precision > MAX_PRECISION))
+    return (Convert_Geodetic_To_MGRS_R (Cache->Parameters, Latitude, Longitude, Precision, MGRS));
+
+  memcpy (&lat_bits, &Latitude, sizeof (lat_bits));
+  memcpy (&lon_bits, &Longitude, sizeof (lon_bits));
+  hash = Hash_MGRS_Cache_Key (lat_bits, lon_bits, Precision);
+  set = &Cache->Sets[hash & Cache->Set_Mask];
+  counters = &Cache->Counters[(hash >> 32) % MGRS_CACHE_STRIPES];
+
+  for (way = 0; way < MGRS_CACHE_WAYS; way++)
+  {
+    entry = &set->Entry[way];
+    sequence = entry->Sequence.load (std::memory_order_acquire);
+    if ((sequence & 1)
+        || (entry->Latitude.load (std::memory_order_relaxed) != lat_bits)
+        || (entry->Longitude.load (std::memory_order_relaxed) != lon_bits)
+        || (entry->Precision.load (std::memory_order_relaxed) != (unsigned long long)Precision + 1))
+      continue;
+    text[0] = entry->Text[0].load (std::memory_order_relaxed);
+    text[1] = entry->Text[1].load (std::memory_order_relaxed);
+    std::atomic_thread_fence (std::memory_order_acquire);
+    if (entry->Sequence.load (std::memory_order_relaxed) != sequence)
+      break;  /* Rewritten under us: convert instead */
+    memcpy (MGRS, text, MGRS_CACHE_TEXT);
+    if (!entry->Referenced.load (std::memory_order_relaxed))
+      entry->Referenced.store (1, std::memory_order_relaxed);
+    counters->Hits.fetch_add (1, std::memory_order_relaxed);
+    return (MGRS_NO_ERROR);
+  }
+
+  counters->Misses.fetch_add (1, std::memory_order_relaxed);
+  error_code = Convert_Geodetic_To_MGRS_R (Cache->Parameters, Latitude, Longitude, Precision, MGRS);
+  if (error_code || !set->Lock.compare_exchange_strong (unlocked, 1, std::memory_order_acquire))
+    return (error_code);
+
+  /* CLOCK: take an empty entry, or the first not referenced since the hand passed */
+  for (;;)
+  {
+    entry = &set->Entry[set->Hand];
+    set->Hand = (set->Hand + 1) % MGRS_CACHE_WAYS;
+    if (!entry->Precision.load (std::memory_order_relaxed))
+      break;
+    if (!entry->Referenced.load (std::memory_order_relaxed))
+    {
+      counters->Evictions.fetch_add (1, std::memory_order_relaxed);
+      break;
+    }
+    entry->Referenced.store (0, std::memory_order_relaxed);
+  }
+
+  memset (text, 0, sizeof (text));
+  strncpy ((char *)text, MGRS, MGRS_CACHE_TEXT - 1);
+  sequence = entry->Sequence.load (std::memory_order_relaxed);
+  entry->Sequence.store (sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence (std::memory_order_release);
+  entry->Latitude.store (lat_bits, std::memory_order_relaxed);
+  entry->Longitude.store (lon_bits, std::memory_order_relaxed);
+  entry->Precision.store ((unsigned long long)Precision + 1, std::memory_order_relaxed);
+  entry->Text[0].store (text[0], std::memory_order_relaxed);
+  entry->Text[1].store (text[1], std::memory_order_relaxed);
+  entry->Referenced.store (0, std::memory_order_relaxed);
+  entry->Sequence.store (sequence + 2, std::memory_order_release);
+  set->Lock.store (0, std::memory_order_release);
+  return (MGRS_NO_ERROR);
+} /* Convert_Geodetic_To_MGRS_Cached */
+
+
+void Get_MGRS_Cache_Stats (const MGRS_Cache *Cache,
+                           MGRS_Cache_Stats *Stats)
+/*
+ * The function Get_MGRS_Cache_Stats adds up the cache's counters.  While
+ * other threads are converting the totals are only approximate.
+ *
+ *    Cache      : Cache of conversions                 (input)
+ *    Stats      : Capacity, memory and counts          (output)
+ */
+{ /* Get_MGRS_Cache_Stats */
+  long i;
+
+  Stats->Entries = (long)(Cache->Set_Mask + 1) * MGRS_CACHE_WAYS;
+  Stats->Bytes = (long)((Cache->Set_Mask + 1) * sizeof (MGRS_Cache_Set));
+  Stats->Hits = 0;
+  Stats->Misses = 0;
+  Stats->Evictions = 0;
+  for (i = 0; i < MGRS_CACHE_STRIPES; i++)
+  {
+    Stats->Hits += Cache->Counters[i].Hits.load (std::memory_order_relaxed);
+    Stats->Misses += Cache->Counters[i].Misses.load (std::memory_order_relaxed);
+    Stats->Evictions += Cache->Counters[i].Evictions.load (std::memory_order_relaxed);
+  }
+} /* Get_MGRS_Cache_Stats */
+
+#endif /* MGRS_CACHE_H */
@@ -0,0 +1,314 @@
+/*
+ * Comparison of the microdegree conversion of mgrs_float.h with the double
+ * precision one over the whole UTM grid.  Not part of the sketch; build and
+ * run it on the host:
+ *
+ *   g++ -O2 -std=gnu++11 -I../.. mgrs_float.cpp -o mgrs_float
+ *   ./mgrs_float [-s step_microdegrees] [-n random_points] [-w edge_microdegrees]
+ *                > results.json
+ *
+ * Three sets of positions in whole microdegrees are converted by both
+ * Convert_Microdegrees_To_MGRS_Values_R and Convert_Geodetic_To_MGRS_Letters_R
+ * (at the latitude and longitude in radians), and each pair written at
+ * every precision:
+ *
+ *   - a grid of -s microdegrees (default 20000) over latitudes -80.5 to
+ *     84.5 and all longitudes;
+ *   - -n random positions (default 10000000) over the same range;
+ *   - every microdegree within -w (default 3) of each band edge, and of
+ *     each zone edge, the Norway and Svalbard ones included, every 0.01
+ *     degree along it.
+ *
+ * mgrs_float.h states that the strings differ only where the double
+ * precision easting or northing is within MGRS_FLOAT_TOLERANCE of a
+ * multiple of 10^(5 - precision) meters, or the position is exactly on a
+ * zone or band edge.  Every differing string, and every position only one
+ * path takes as an error, is held to that, edges being whole degrees; each
+ * one that is not is a failure.  Where the zones and bands agree, the
+ * distance from the double precision easting and northing to the whole
+ * meter the microdegree path gives is measured, and its largest value is
+ * reported against MGRS_FLOAT_TOLERANCE.  Convert_Microdegrees_To_MGRS_R
+ * and Convert_Geodetic_To_MGRS_R must also write the same strings as the
+ * values.  The tool returns 1 if there are any failures.
+ */
+
+#include "../../mgrs_float.h"
+#include "../mgrs_host.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define STRING_SIZE  16
+
+struct Float_Check
+{
+  long points;
+  long strings;
+  long differing;                /* Strings that differ, and are allowed to */
+  long edge_differences;         /* Positions on an edge the paths put apart */
+  long failures;
+  double max_easting_error;      /* Meters */
+  double max_northing_error;
+  double max_easting_error_lat;  /* Where, in degrees */
+  double max_easting_error_lon;
+  double max_northing_error_lat;
+  double max_northing_error_lon;
+  long differing_by_precision[MAX_PRECISION + 1];
+};
+
+/* Meters from a double precision value to the whole meter [Meter, Meter + 1) */
+static double meter_distance (double Value, long Meter)
+{
+  if (Value < Meter)
+    return (Meter - Value);
+  if (Value > Meter + 1)
+    return (Value - (Meter + 1));
+  return (0.0);
+}
+
+/* Whether Value is within MGRS_FLOAT_TOLERANCE of a multiple of Cell */
+static int near_cell_edge (double Value, double Cell)
+{
+  double offset = fmod (Value, Cell);
+
+  return ((offset <= MGRS_FLOAT_TOLERANCE) || (Cell - offset <= MGRS_FLOAT_TOLERANCE));
+}
+
+static void fail (Float_Check *check, long Latitude, long Longitude, long Precision,
+                  const char *flt, const char *dbl)
+{
+  if (check->failures++ < 10)
+    fprintf (stderr, "%.6f %.6f precision %ld: %s, double precision %s\n",
+             Latitude * 1e-6, Longitude * 1e-6, Precision, flt, dbl);
+}
+
+/* Converts one position both ways and checks them against each other */
+static void check_point (long Latitude, long Longitude, Float_Check *check)
+{
+  double latitude = Latitude * 1e-6 * DEG_TO_RAD;
+  double longitude = Longitude * 1e-6 * DEG_TO_RAD;
+  char flt[STRING_SIZE];
+  char dbl[STRING_SIZE];
+  int float_letters[MGRS_LETTERS];
+  int double_letters[MGRS_LETTERS];
+  long float_zone;
+  long double_zone;
+  long float_easting;
+  long float_northing;
+  double double_easting;
+  double double_northing;
+  double error;
+  double cell;
+  long float_error;
+  long double_error;
+  long precision;
+  int on_edge = !(Latitude % MICRODEGREES) || !(Longitude % MICRODEGREES);
+  int same_square;
+
+  float_error = Convert_Microdegrees_To_MGRS_Values_R (&MGRS_Float_Default_Parameters, Latitude,
+                                                       Longitude, MAX_PRECISION, &float_zone,
+                                                       float_letters, &float_easting,
+                                                       &float_northing);
+  double_error = Convert_Geodetic_To_MGRS_Letters_R (&MGRS_Default_Parameters, latitude,
+                                                     longitude, MAX_PRECISION, &double_zone,
+                                                     double_letters, &double_easting,
+                                                     &double_northing);
+  if (float_error || double_error)
+  {
+    if (float_error == double_error)
+      return;
+    if (on_edge)
+      check->edge_differences++;
+    else
+    {
+      sprintf (flt, "error %ld", float_error);
+      sprintf (dbl, "error %ld", double_error);
+      fail (check, Latitude, Longitude, MAX_PRECISION, flt, dbl);
+    }
+    return;
+  }
+  check->points++;
+
+  same_square = (float_zone == double_zone) && (float_letters[0] == double_letters[0]);
+  if (same_square)
+  {
+    error = meter_distance (double_easting, float_easting);
+    if (error > check->max_easting_error)
+    {
+      check->max_easting_error = error;
+      check->max_easting_error_lat = Latitude * 1e-6;
+      check->max_easting_error_lon = Longitude * 1e-6;
+    }
+    error = meter_distance (double_northing, float_northing);
+    if (error > check->max_northing_error)
+    {
+      check->max_northing_error = error;
+      check->max_northing_error_lat = Latitude * 1e-6;
+      check->max_northing_error_lon = Longitude * 1e-6;
+    }
+  }
+  else if (on_edge)
+    check->edge_differences++;
+
+  for (precision = 0; precision <= MAX_PRECISION; precision++)
+  {
+    check->strings++;
+    Write_MGRS_Meters (flt, float_zone, float_letters, float_easting, float_northing, precision,
+                       TRUE);
+    Write_MGRS_String (dbl, double_zone, double_letters, double_easting, double_northing,
+                       precision, TRUE);
+    if (!strcmp (flt, dbl))
+      continue;
+    cell = (double)MGRS_Divisor_Table[precision];
+    if (same_square ? (near_cell_edge (double_easting, cell)
+                       || near_cell_edge (double_northing, cell)) : on_edge)
+    {
+      check->differing++;
+      check->differing_by_precision[precision]++;
+    }
+    else
+      fail (check, Latitude, Longitude, precision, flt, dbl);
+  }
+
+  /* The string conversions write what the values give */
+  precision = (Latitude ^ Longitude) & 7;
+  if (precision > MAX_PRECISION)
+    precision = MAX_PRECISION;
+  Write_MGRS_Meters (flt, float_zone, float_letters, float_easting, float_northing, precision,
+                     TRUE);
+  Write_MGRS_String (dbl, double_zone, double_letters, double_easting, double_northing,
+                     precision, TRUE);
+  {
+    char flt_string[STRING_SIZE];
+    char dbl_string[STRING_SIZE];
+
+    if (Convert_Microdegrees_To_MGRS_R (&MGRS_Float_Default_Parameters, Latitude, Longitude,
+                                        precision, flt_string)
+        || Convert_Geodetic_To_MGRS_R (&MGRS_Default_Parameters, latitude, longitude, precision,
+                                       dbl_string)
+        || strcmp (flt_string, flt) || strcmp (dbl_string, dbl))
+      fail (check, Latitude, Longitude, precision, flt_string, dbl_string);
+  }
+}
+
+static void print_check (const char *name, const Float_Check *check, int last)
+{
+  long precision;
+
+  printf ("  \"%s\": {\"points\": %ld, \"strings\": %ld, \"differing\": %ld,"
+          " \"edge_differences\": %ld, \"failures\": %ld,\n", name, check->points,
+          check->strings, check->differing, check->edge_differences, check->failures);
+  printf ("    \"differing_by_precision\": [");
+  for (precision = 0; precision <= MAX_PRECISION; precision++)
+    printf ("%s%ld", precision ? ", " : "", check->differing_by_precision[precision]);
+  printf ("],\n    \"max_easting_error_m\": %.4f, \"at\": [%.6f, %.6f],\n",
+          check->max_easting_error, check->max_easting_error_lat, check->max_easting_error_lon);
+  printf ("    \"max_northing_error_m\": %.4f, \"at\": [%.6f, %.6f]}%s\n",
+          check->max_northing_error, check->max_northing_error_lat,
+          check->max_northing_error_lon, last ? "" : ",");
+}
+
+int main (int argc, char **argv)
+{
+  /* Zone edges away from the regular 6 degree ones, in whole degrees of longitude */
+  static const long special_edges[] = {3, 9, 21, 33, 42};
+  Float_Check grid;
+  Float_Check random;
+  Float_Check edges;
+  unsigned long long seed = 42;
+  long step = 20000;
+  long count = 10000000;
+  long width = 3;
+  long latitude;
+  long longitude;
+  long edge;
+  long along;
+  long d;
+  long i;
+  double max_easting_error;
+  double max_northing_error;
+  int opt;
+
+  while ((opt = getopt (argc, argv, "s:n:w:")) != -1)
+    switch (opt)
+    {
+    case 's':
+      step = atol (optarg);
+      break;
+    case 'n':
+      count = atol (optarg);
+      break;
+    case 'w':
+      width = atol (optarg);
+      break;
+    default:
+      fprintf (stderr, "usage: %s [-s step_microdegrees] [-n random_points]"
+               " [-w edge_microdegrees]\n", argv[0]);
+      return (1);
+    }
+  if ((step < 1) || (count < 0) || (width < 0))
+  {
+    fprintf (stderr, "need a positive step and no negative counts\n");
+    return (1);
+  }
+  memset (&grid, 0, sizeof (grid));
+  memset (&random, 0, sizeof (random));
+  memset (&edges, 0, sizeof (edges));
+
+  for (latitude = -80500000L; latitude <= 84500000L; latitude += step)
+    for (longitude = -180 * MICRODEGREES; longitude < 180 * MICRODEGREES; longitude += step)
+      check_point (latitude, longitude, &grid);
+  fprintf (stderr, "grid done\n");
+
+  for (i = 0; i < count; i++)
+    check_point (-80500000L + (long)(165000000.0 * uniform (&seed)),
+                 -180 * MICRODEGREES + (long)(360000000.0 * uniform (&seed)), &random);
+  fprintf (stderr, "random done\n");
+
+  /* Across each band edge, and the equator */
+  for (edge = -80; edge <= 72; edge += 8)
+    for (along = -180 * MICRODEGREES; along < 180 * MICRODEGREES; along += 10000)
+      for (d = -width; d <= width; d++)
+        check_point (edge * MICRODEGREES + d, along, &edges);
+  for (along = -180 * MICRODEGREES; along < 180 * MICRODEGREES; along += 10000)
+    for (d = -width; d <= width; d++)
+      check_point (d, along, &edges);
+  /* Across each zone edge, and the Norway and Svalbard ones where they apply */
+  for (along = -80500000L; along <= 84500000L; along += 10000)
+  {
+    for (edge = -180; edge < 180; edge += 6)
+      for (d = -width; d <= width; d++)
+        check_point (along, edge * MICRODEGREES + d, &edges);
+    if (along < 56 * MICRODEGREES)
+      continue;
+    for (i = 0; i < (long)(sizeof (special_edges) / sizeof (special_edges[0])); i++)
+      for (d = -width; d <= width; d++)
+        check_point (along, special_edges[i] * MICRODEGREES + d, &edges);
+  }
+  fprintf (stderr, "edges done\n");
+
+  max_easting_error = grid.max_easting_error;
+  if (random.max_easting_error > max_easting_error)
+    max_easting_error = random.max_easting_error;
+  if (edges.max_easting_error > max_easting_error)
+    max_easting_error = edges.max_easting_error;
+  max_northing_error = grid.max_northing_error;
+  if (random.max_northing_error > max_northing_error)
+    max_northing_error = random.max_northing_error;
+  if (edges.max_northing_error > max_northing_error)
+    max_northing_error = edges.max_northing_error;
+
+  printf ("{\n  \"step_microdegrees\": %ld, \"random_points\": %ld, \"edge_microdegrees\": %ld,\n",
+          step, count, width);
+  printf ("  \"tolerance_m\": %.2f,\n", MGRS_FLOAT_TOLERANCE);
+  print_check ("grid", &grid, 0);
+  print_check ("random", &random, 0);
+  print_check ("edges", &edges, 0);
+  printf ("  \"max_easting_error_m\": %.4f, \"max_northing_error_m\": %.4f,\n",
+          max_easting_error, max_northing_error);
+  printf ("  \"failures\": %ld\n}\n", grid.failures + random.failures + edges.failures);
+  return ((grid.failures + random.failures + edges.failures) ? 1 : 0);
+}
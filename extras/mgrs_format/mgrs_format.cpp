@@ -0,0 +1,265 @@
+/*
+ * Byte for byte check and microbenchmark of the MGRS string writers of
+ * mgrs.h against the sprintf formatter they replaced.  Not part of the
+ * sketch; build and run it on the host:
+ *
+ *   g++ -O2 -std=gnu++11 -I../.. mgrs_format.cpp -o mgrs_format
+ *   ./mgrs_format [-s step_degrees] > results.json
+ *
+ * reference_string is Make_MGRS_String as it was, with sprintf ("%2.2ld"
+ * and "%*.*ld"), pow and fmod.  The global sweep converts a grid of -s
+ * degrees (default 0.1) over the whole UTM latitude range with
+ * Convert_Geodetic_To_MGRS_Letters_R at every precision, and writes each
+ * result with Make_MGRS_String, Write_MGRS_String unterminated and
+ * Write_MGRS_Records; all must give reference_string's bytes, and
+ * Convert_Geodetic_To_MGRS_R the same string.  The edge sweep does the same
+ * for every zone and precision with eastings and northings at, and the
+ * doubles either side of, each multiple of the precision's cell size in
+ * the first and last kilometer of a 100 km square, the 99999.5 clamp of
+ * the old formatter, and the top of the northing range.  Zone 0 is not
+ * compared: the old formatter wrote the letters over its two blanks.
+ *
+ * Both formatters are timed over the sweep's inputs at precision 5, the
+ * fastest of FORMAT_REPEATS runs.  The tool returns 1 if any string
+ * differs.
+ */
+
+#include "../../mgrs.h"
+#include "../mgrs_host.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <vector>
+
+#define FORMAT_REPEATS  5
+#define STRING_SIZE     16
+#define EDGE_DOUBLES    3       /* Doubles tried on each side of a cell edge */
+
+struct Format_Input
+{
+  long zone;
+  int letters[MGRS_LETTERS];
+  double easting;
+  double northing;
+};
+
+/* Make_MGRS_String as it was, with sprintf */
+static long reference_string (char *mgrs, long zone, const int letters[MGRS_LETTERS],
+                              double easting, double northing, long precision)
+{
+  long i;
+  long j;
+  double divisor;
+  long east;
+  long north;
+  char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+  i = 0;
+  if (zone)
+    i = sprintf (mgrs + i, "%2.2ld", zone);
+  else
+    memcpy (mgrs, "  ", 2);
+
+  for (j = 0; j < 3; j++)
+    mgrs[i++] = alphabet[letters[j]];
+  divisor = pow (10.0, (5 - precision));
+  easting = fmod (easting, 100000.0);
+  if (easting >= 99999.5)
+    easting = 99999.0;
+  east = (long)(easting / divisor);
+  i += sprintf (mgrs + i, "%*.*ld", (int)precision, (int)precision, east);
+  northing = fmod (northing, 100000.0);
+  if (northing >= 99999.5)
+    northing = 99999.0;
+  north = (long)(northing / divisor);
+  i += sprintf (mgrs + i, "%*.*ld", (int)precision, (int)precision, north);
+  return (i);
+}
+
+/* Writes one input every way at one precision; returns 0 if all agree */
+static int check_input (const Format_Input &in, long precision, const char *converted)
+{
+  char expected[STRING_SIZE];
+  char made[STRING_SIZE];
+  char written[STRING_SIZE];
+  char record[STRING_SIZE + 4];
+  long length;
+  int failed = 0;
+
+  memset (expected, 0, sizeof (expected));
+  memset (written, '#', sizeof (written));
+  length = reference_string (expected, in.zone, in.letters, in.easting, in.northing, precision);
+  Make_MGRS_String (made, in.zone, (int *)in.letters, in.easting, in.northing, precision);
+  if (strcmp (made, expected))
+    failed = 1;
+  if ((Write_MGRS_String (written, in.zone, in.letters, in.easting, in.northing, precision,
+                          FALSE) != length)
+      || memcmp (written, expected, length) || (written[length] != '#'))
+    failed = 1;
+  Write_MGRS_Records (record, length + 4, 1, &in.zone, in.letters, &in.easting, &in.northing,
+                      precision);
+  if (memcmp (record, expected, length) || memcmp (record + length, "    ", 4))
+    failed = 1;
+  if (converted && strcmp (converted, expected))
+    failed = 1;
+  if (failed)
+    fprintf (stderr, "zone %ld easting %.17g northing %.17g precision %ld: %s, expected %s\n",
+             in.zone, in.easting, in.northing, precision, made, expected);
+  return (failed);
+}
+
+int main (int argc, char **argv)
+{
+  std::vector<Format_Input> inputs;
+  Format_Input in;
+  char mgrs[STRING_SIZE];
+  char expected[STRING_SIZE];
+  double step = 0.1;
+  double latitude;
+  double longitude;
+  double cell;
+  double base;
+  double value;
+  double time;
+  double reference_time = 1e30;
+  double writer_time = 1e30;
+  long sweep_strings = 0;
+  long sweep_mismatches = 0;
+  long edge_strings = 0;
+  long edge_mismatches = 0;
+  long sink = 0;
+  long precision;
+  long zone;
+  long square;
+  long k;
+  long i;
+  int side;
+  int d;
+  int r;
+  int opt;
+
+  while ((opt = getopt (argc, argv, "s:")) != -1)
+    switch (opt)
+    {
+    case 's':
+      step = atof (optarg);
+      break;
+    default:
+      fprintf (stderr, "usage: %s [-s step_degrees]\n", argv[0]);
+      return (1);
+    }
+  if (step <= 0.0)
+  {
+    fprintf (stderr, "need a positive step\n");
+    return (1);
+  }
+
+  /* The whole grid, as the conversions write it */
+  for (precision = 0; precision <= MAX_PRECISION; precision++)
+    for (latitude = -80.5; latitude <= 84.5; latitude += step)
+      for (longitude = -180.0; longitude < 180.0; longitude += step)
+      {
+        if (Convert_Geodetic_To_MGRS_Letters_R (&MGRS_Default_Parameters, latitude * DEG_TO_RAD,
+                                                longitude * DEG_TO_RAD, precision, &in.zone,
+                                                in.letters, &in.easting, &in.northing)
+            || Convert_Geodetic_To_MGRS_R (&MGRS_Default_Parameters, latitude * DEG_TO_RAD,
+                                           longitude * DEG_TO_RAD, precision, mgrs))
+          continue;
+        sweep_strings++;
+        if (check_input (in, precision, mgrs))
+          sweep_mismatches++;
+        if (precision == MAX_PRECISION)
+          inputs.push_back (in);
+      }
+  fprintf (stderr, "sweep done\n");
+
+  /* Each cell edge near the ends of a 100 km square, and the old clamp */
+  in.letters[0] = LETTER_U;
+  in.letters[1] = LETTER_K;
+  in.letters[2] = LETTER_V;
+  for (precision = 0; precision <= MAX_PRECISION; precision++)
+  {
+    cell = (double)MGRS_Divisor_Table[precision];
+    for (zone = 1; zone <= 60; zone++)
+      for (square = 0; square < 100; square += 33)
+        for (k = 0; k <= 1000; k++)
+        {
+          if (cell * k > 1000.0)
+            break;
+          for (side = 0; side < 2; side++)
+          {
+            base = square * 100000.0 + (side ? 100000.0 - cell * k : cell * k);
+            if ((side && (square == 99) && (k == 0)))
+              base = 9999999.5;
+            value = base;
+            for (d = 0; d < EDGE_DOUBLES; d++)
+              value = nextafter (value, -1.0);
+            for (d = 0; d <= 2 * EDGE_DOUBLES; d++)
+            {
+              if (value >= 0.0)
+              {
+                in.zone = zone;
+                in.easting = value;
+                in.northing = 9999999.0 - (value - square * 100000.0);
+                edge_strings++;
+                if (check_input (in, precision, NULL))
+                  edge_mismatches++;
+              }
+              value = nextafter (value, 1.0e8);
+            }
+          }
+        }
+    /* The clamp: at or over 99999.5 into a square the old formatter wrote 99999 */
+    for (value = 99999.0; value < 100000.0; value += 0.0625)
+    {
+      in.zone = 33;
+      in.easting = 400000.0 + value;
+      in.northing = 7800000.0 + value;
+      edge_strings++;
+      if (check_input (in, precision, NULL))
+        edge_mismatches++;
+    }
+  }
+  fprintf (stderr, "edges done\n");
+
+  for (r = 0; r < FORMAT_REPEATS; r++)
+  {
+    time = now ();
+    for (i = 0; i < (long)inputs.size (); i++)
+    {
+      reference_string (expected, inputs[i].zone, inputs[i].letters, inputs[i].easting,
+                        inputs[i].northing, MAX_PRECISION);
+      sink += expected[7];
+    }
+    time = now () - time;
+    if (time < reference_time)
+      reference_time = time;
+    time = now ();
+    for (i = 0; i < (long)inputs.size (); i++)
+    {
+      Make_MGRS_String (mgrs, inputs[i].zone, inputs[i].letters, inputs[i].easting,
+                        inputs[i].northing, MAX_PRECISION);
+      sink += mgrs[7];
+    }
+    time = now () - time;
+    if (time < writer_time)
+      writer_time = time;
+  }
+
+  printf ("{\n  \"step_degrees\": %g,\n", step);
+  printf ("  \"global_sweep\": {\"strings\": %ld, \"mismatches\": %ld},\n", sweep_strings,
+          sweep_mismatches);
+  printf ("  \"edge_sweep\": {\"strings\": %ld, \"mismatches\": %ld},\n", edge_strings,
+          edge_mismatches);
+  printf ("  \"format_ns\": {\"strings\": %lu, \"sprintf\": %.1f, \"Make_MGRS_String\": %.1f,"
+          " \"speedup\": %.1f},\n", (unsigned long)inputs.size (),
+          reference_time * 1e9 / inputs.size (), writer_time * 1e9 / inputs.size (),
+          reference_time / writer_time);
+  printf ("  \"mismatches\": %ld\n}\n", sweep_mismatches + edge_mismatches);
+  fprintf (stderr, "checksum %ld\n", sink);
+  return ((sweep_mismatches + edge_mismatches) ? 1 : 0);
+}
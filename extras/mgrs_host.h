@@ -0,0 +1,31 @@
+#ifndef MGRS_HOST_H
+#define MGRS_HOST_H
+
+/*
+ * Helpers shared by the host tools in extras.  Not part of the sketch;
+ * each tool includes it as "../mgrs_host.h".
+ */
+
+#include <time.h>
+
+/* Monotonic wall clock time in seconds, for timing a run */
+static inline double now ()
+{
+  struct timespec t;
+
+  clock_gettime (CLOCK_MONOTONIC, &t);
+  return (t.tv_sec + t.tv_nsec * 1e-9);
+}
+
+/*
+ * Uniform double in [0, 1) from a 64 bit linear congruential generator
+ * (Knuth's MMIX constants), advancing *seed.  The tools seed it with fixed
+ * values so that every run sees the same points.
+ */
+static inline double uniform (unsigned long long *seed)
+{
+  *seed = *seed * 6364136223846793005ULL + 1442695040888963407ULL;
+  return ((double)(*seed >> 11) / 9007199254740992.0);
+}
+
+#endif
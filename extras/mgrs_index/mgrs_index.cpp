@@ -0,0 +1,378 @@
+/*
+ * Build time and query latency of the index of mgrs_index.h against the
+ * string prefix scan it replaces.  Not part of the sketch; build and run
+ * it on the host:
+ *
+ *   g++ -O2 -std=gnu++11 -I../.. mgrs_index.cpp -o mgrs_index
+ *   ./mgrs_index [-n points] [-q queries] [-r region_degrees] [-f file] > results.json
+ *
+ * -n random positions (default 4000000) within a square of -r degrees
+ * (default 10, about a country; 0 for the whole UTM grid) are converted
+ * to 1 m cells, with their number as the value, and indexed both ways:
+ * as keys by Build_MGRS_Index, and as strings sorted with std::sort.
+ * Then, at each precision from 100 km to 10 m, -q cells (default 10000)
+ * holding random positions are queried: by the index, by std::lower_bound
+ * on the sorted keys alone, and on the strings by binary searching for
+ * the 100 km square and scanning it for the cell's digits, as a prefix
+ * scan must, since the easting and northing digits are apart.  Each query
+ * sums the values of its points, and all three must agree, as must the
+ * cell with Get_MGRS_Key_Cell of the position's 1 m key.  Queries of
+ * the positions by Get_MGRS_Index_Position_R are timed too, conversion
+ * included, finding the range but not summing it.
+ * Last the index is written to -f (default mgrs_index.dat, removed after)
+ * and mapped back, timing startup and the first queries, which fault in
+ * the pages they touch, against the same queries once they are resident.
+ * Timings are the fastest of INDEX_REPEATS runs.
+ */
+
+#define MGRS_INDEX_FILES
+
+#include "../../mgrs_index.h"
+#include "../mgrs_host.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <vector>
+
+#define INDEX_REPEATS   3
+#define STRING_SIZE     16
+
+struct Row
+{
+  char s[STRING_SIZE];
+  long value;
+};
+
+struct Query_Sum
+{
+  long points;
+  long long values;
+};
+
+static bool row_less (const Row &a, const Row &b)
+{
+  return (strcmp (a.s, b.s) < 0);
+}
+
+static bool square_less (const Row &a, const char *square)
+{
+  return (strncmp (a.s, square, 5) < 0);
+}
+
+static void random_positions (std::vector<double> &lat, std::vector<double> &lon, long count,
+                              double region, unsigned long long seed)
+{
+  lat.clear ();
+  lon.clear ();
+  while ((long)lat.size () < count)
+  {
+    if (region > 0.0)
+    {
+      lat.push_back ((45.0 + region * (uniform (&seed) - 0.5)) * DEG_TO_RAD);
+      lon.push_back ((10.0 + region * (uniform (&seed) - 0.5)) * DEG_TO_RAD);
+    }
+    else
+    {
+      lat.push_back ((-80.0 + 164.0 * uniform (&seed)) * DEG_TO_RAD);
+      lon.push_back ((-180.0 + 360.0 * uniform (&seed)) * DEG_TO_RAD);
+    }
+  }
+}
+
+/* The points of a 1 m string that are in a cell's string */
+static bool in_cell (const char *point, const char *cell, long precision)
+{
+  return (!strncmp (point + 5, cell + 5, precision)
+          && !strncmp (point + 10, cell + 5 + precision, precision));
+}
+
+static Query_Sum index_query (const MGRS_Index &index, MGRS_Key cell)
+{
+  Query_Sum sum = {0, 0};
+  long first;
+  long end;
+  long i;
+
+  Get_MGRS_Index_Range (&index, cell, &first, &end);
+  for (i = first; i < end; i++)
+    sum.values += index.Values[i];
+  sum.points = end - first;
+  return (sum);
+}
+
+static Query_Sum binary_query (const std::vector<MGRS_Key> &keys, const std::vector<long> &values,
+                               MGRS_Key cell)
+{
+  Query_Sum sum = {0, 0};
+  MGRS_Key low;
+  MGRS_Key high;
+  long first;
+  long end;
+  long i;
+
+  if (Get_MGRS_Key_Range (cell, &low, &high))
+    return (sum);
+  first = std::lower_bound (keys.begin (), keys.end (), low) - keys.begin ();
+  end = std::upper_bound (keys.begin () + first, keys.end (), high) - keys.begin ();
+  for (i = first; i < end; i++)
+    sum.values += values[i];
+  sum.points = end - first;
+  return (sum);
+}
+
+static Query_Sum string_query (const std::vector<Row> &rows, const char *cell, long precision)
+{
+  Query_Sum sum = {0, 0};
+  std::vector<Row>::const_iterator row;
+
+  row = std::lower_bound (rows.begin (), rows.end (), cell, square_less);
+  for (; (row != rows.end ()) && !strncmp (row->s, cell, 5); ++row)
+    if (in_cell (row->s, cell, precision))
+    {
+      sum.points++;
+      sum.values += row->value;
+    }
+  return (sum);
+}
+
+int main (int argc, char **argv)
+{
+  long count = 4000000;
+  long query_count = 10000;
+  double region = 10.0;
+  const char *path = "mgrs_index.dat";
+  std::vector<double> lat;
+  std::vector<double> lon;
+  std::vector<MGRS_Key> keys;
+  std::vector<long> values;
+  std::vector<MGRS_Key> key_scratch;
+  std::vector<long> value_scratch;
+  std::vector<MGRS_Key> fences;
+  std::vector<Row> rows;
+  std::vector<MGRS_Key> cells;
+  std::vector<Row> cell_strings;
+  std::vector<Query_Sum> expected;
+  MGRS_Index index;
+  MGRS_Index mapped;
+  MGRS_Key cell;
+  MGRS_Key key;
+  Row row;
+  Query_Sum sum;
+  long fence_count;
+  double convert_time = 1e30;
+  double build_time = 1e30;
+  double string_time = 1e30;
+  double index_time;
+  double binary_time;
+  double scan_time;
+  double position_time;
+  double write_time;
+  double map_time;
+  double cold_time;
+  double warm_time;
+  double time;
+  long long checksum = 0;
+  long mismatches = 0;
+  long precision;
+  long first;
+  long end;
+  long points;
+  long i;
+  int r;
+  int opt;
+
+  while ((opt = getopt (argc, argv, "n:q:r:f:")) != -1)
+    switch (opt)
+    {
+    case 'n':
+      count = atol (optarg);
+      break;
+    case 'q':
+      query_count = atol (optarg);
+      break;
+    case 'r':
+      region = atof (optarg);
+      break;
+    case 'f':
+      path = optarg;
+      break;
+    default:
+      fprintf (stderr, "usage: %s [-n points] [-q queries] [-r region_degrees] [-f file]\n",
+               argv[0]);
+      return (1);
+    }
+  if ((count < 1) || (query_count < 1))
+  {
+    fprintf (stderr, "need at least 1 point and 1 query\n");
+    return (1);
+  }
+
+  random_positions (lat, lon, count, region, 42);
+  keys.resize (count);
+  values.resize (count);
+  key_scratch.resize (count);
+  value_scratch.resize (count);
+  fence_count = Get_MGRS_Index_Fence_Count (count);
+  fences.resize (fence_count + 1);  /* So &fences[0] is valid */
+  rows.resize (count);
+  for (r = 0; r < INDEX_REPEATS; r++)
+  {
+    time = now ();
+    for (i = 0; i < count; i++)
+    {
+      if (Convert_Geodetic_To_MGRS_Key_R (&MGRS_Default_Parameters, lat[i], lon[i], MAX_PRECISION,
+                                          &keys[i]))
+        keys[i] = MGRS_KEY_NONE;
+      values[i] = i;
+    }
+    convert_time = std::min (convert_time, now () - time);
+    time = now ();
+    Build_MGRS_Index (&index, &keys[0], &values[0], &key_scratch[0], &value_scratch[0],
+                      &fences[0], count);
+    build_time = std::min (build_time, now () - time);
+
+    for (i = 0; i < count; i++)
+    {
+      Convert_Geodetic_To_MGRS_R (&MGRS_Default_Parameters, lat[i], lon[i], MAX_PRECISION,
+                                  rows[i].s);
+      rows[i].value = i;
+    }
+    time = now ();
+    std::sort (rows.begin (), rows.end (), row_less);
+    string_time = std::min (string_time, now () - time);
+  }
+
+  printf ("{\n  \"points\": %ld, \"region_degrees\": %.1f, \"levels\": %ld,"
+          " \"index_bytes\": %ld, \"string_bytes\": %ld,\n", count, region, index.Levels,
+          (long)((count + fence_count) * sizeof (MGRS_Key) + count * sizeof (long)),
+          (long)(count * sizeof (Row)));
+  printf ("  \"build_ns_per_point\": {\"convert_to_key\": %.1f, \"index\": %.1f,"
+          " \"string_sort\": %.1f},\n", convert_time * 1e9 / count, build_time * 1e9 / count,
+          string_time * 1e9 / count);
+  printf ("  \"queries\": [");
+
+  for (precision = 0; precision < MAX_PRECISION; precision++)
+  {
+    /* Cells holding random points, and positions in them */
+    random_positions (lat, lon, query_count, region, 1000 + precision);
+    cells.clear ();
+    cell_strings.clear ();
+    for (i = 0; i < query_count; i++)
+    {
+      if (Convert_Geodetic_To_MGRS_Key_R (&MGRS_Default_Parameters, lat[i], lon[i], precision,
+                                          &cell)
+          || Convert_MGRS_Key_To_String (cell, row.s))
+        continue;
+      /* The same cell as the one of the 1 m key */
+      if (Convert_Geodetic_To_MGRS_Key_R (&MGRS_Default_Parameters, lat[i], lon[i],
+                                          MAX_PRECISION, &key)
+          || Get_MGRS_Key_Cell (key, precision, &key) || (key != cell))
+        mismatches++;
+      cells.push_back (cell);
+      cell_strings.push_back (row);
+    }
+
+    expected.resize (cells.size ());
+    for (i = 0; i < (long)cells.size (); i++)
+    {
+      expected[i] = string_query (rows, cell_strings[i].s, precision);
+      if ((Get_MGRS_Index_String_R (&MGRS_Default_Parameters, &index, cell_strings[i].s, &first,
+                                    &end))
+          || ((end - first) != expected[i].points))
+        mismatches++;
+      sum = index_query (index, cells[i]);
+      if ((sum.points != expected[i].points) || (sum.values != expected[i].values))
+        mismatches++;
+      sum = binary_query (keys, values, cells[i]);
+      if ((sum.points != expected[i].points) || (sum.values != expected[i].values))
+        mismatches++;
+    }
+
+    index_time = binary_time = scan_time = position_time = 1e30;
+    points = 0;
+    for (r = 0; r < INDEX_REPEATS; r++)
+    {
+      time = now ();
+      for (i = 0; i < (long)cells.size (); i++)
+        checksum += index_query (index, cells[i]).values;
+      index_time = std::min (index_time, now () - time);
+      time = now ();
+      for (i = 0; i < (long)cells.size (); i++)
+        checksum += binary_query (keys, values, cells[i]).values;
+      binary_time = std::min (binary_time, now () - time);
+      time = now ();
+      for (i = 0; i < (long)cells.size (); i++)
+        checksum += string_query (rows, cell_strings[i].s, precision).values;
+      scan_time = std::min (scan_time, now () - time);
+      time = now ();
+      points = 0;
+      for (i = 0; i < query_count; i++)
+        if (!Get_MGRS_Index_Position_R (&MGRS_Default_Parameters, &index, lat[i], lon[i],
+                                        precision, &first, &end))
+          points += end - first;
+      position_time = std::min (position_time, now () - time);
+    }
+    for (i = 0; i < (long)cells.size (); i++)
+      points -= expected[i].points;
+    if (points)
+      mismatches++;
+
+    sum.points = 0;
+    for (i = 0; i < (long)cells.size (); i++)
+      sum.points += expected[i].points;
+    printf ("%s\n    {\"precision\": %ld, \"cells\": %ld, \"mean_points\": %.1f,"
+            " \"index_ns\": %.0f, \"key_binary_search_ns\": %.0f, \"string_scan_ns\": %.0f,"
+            " \"position_query_ns\": %.0f}", precision ? "," : "", precision, (long)cells.size (),
+            (double)sum.points / cells.size (), index_time * 1e9 / cells.size (),
+            binary_time * 1e9 / cells.size (), scan_time * 1e9 / cells.size (),
+            position_time * 1e9 / query_count);
+    fflush (stdout);
+  }
+
+  /* The file, mapped back, answers the last precision's queries the same */
+  time = now ();
+  if (Write_MGRS_Index (&index, path))
+  {
+    fprintf (stderr, "%s: not written\n", path);
+    return (1);
+  }
+  write_time = now () - time;
+  time = now ();
+  if (Map_MGRS_Index (&mapped, path))
+  {
+    fprintf (stderr, "%s: not mapped\n", path);
+    return (1);
+  }
+  map_time = now () - time;
+  time = now ();
+  for (i = 0; i < (long)cells.size (); i++)
+  {
+    sum = index_query (mapped, cells[i]);
+    if ((sum.points != expected[i].points) || (sum.values != expected[i].values))
+      mismatches++;
+  }
+  cold_time = now () - time;
+  warm_time = 1e30;
+  for (r = 0; r < INDEX_REPEATS; r++)
+  {
+    time = now ();
+    for (i = 0; i < (long)cells.size (); i++)
+      checksum += index_query (mapped, cells[i]).values;
+    warm_time = std::min (warm_time, now () - time);
+  }
+  Unmap_MGRS_Index (&mapped);
+  unlink (path);
+
+  printf ("\n  ],\n  \"file\": {\"bytes\": %ld, \"write_ms\": %.1f, \"map_ms\": %.3f,"
+          " \"first_query_ns\": %.0f, \"resident_query_ns\": %.0f},\n",
+          (long)(sizeof (MGRS_Index_Header) + (count + fence_count) * sizeof (MGRS_Key)
+                 + count * sizeof (long)), write_time * 1e3, map_time * 1e3,
+          cold_time * 1e9 / cells.size (), warm_time * 1e9 / cells.size ());
+  printf ("  \"mismatches\": %ld\n}\n", mismatches);
+  fprintf (stderr, "checksum %lld\n", checksum);
+  return (mismatches ? 1 : 0);
+}
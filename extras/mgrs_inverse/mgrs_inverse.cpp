@@ -0,0 +1,282 @@
+/*
+ * Round trip check of the MGRS inverse conversions against the forward
+ * path.  Not part of the sketch; build and run it on the host:
+ *
+ *   g++ -O2 -std=gnu++11 -I../.. mgrs_inverse.cpp -o mgrs_inverse
+ *   ./mgrs_inverse [-n points] > results.json
+ *
+ * -n random points (default 1000000; a tenth in the Norway and Svalbard
+ * zones and a tenth within a meter of a zone or band edge) are converted
+ * to MGRS at every precision with Convert_Geodetic_To_MGRS_R and decoded
+ * again.  For each string:
+ *
+ *   - Convert_MGRS_To_UTM_R and Convert_MGRS_To_Geodetic_R must succeed,
+ *     MGRS_LAT_WARNING aside, which is counted;
+ *   - the point, normalised as the forward path normalises it and
+ *     projected in the decoded zone, must lie within half a cell
+ *     (5 * 10^(4 - precision) meters) of the decoded cell centre in
+ *     easting and in northing, give or take CELL_TOLERANCE;
+ *   - the cell centre, taken back to latitude and longitude by
+ *     Convert_UTM_To_Geodetic_R and projected again, must come back within
+ *     INVERSE_TOLERANCE, which allows for the inverse series being good
+ *     to millimeters, not nanometers, far from the central meridian;
+ *   - the corner Convert_MGRS_To_Geodetic_R gives must be the decoded UTM
+ *     corner taken back the same way.
+ *
+ * The largest grid offsets, inverse round trip and ground distance from
+ * the point to its cell centre (on a sphere, as a fraction of half the
+ * cell diagonal) are measured and reported.  Decoding is timed per
+ * precision, the fastest of INVERSE_REPEATS runs.  The tool returns 1 if
+ * any check fails.
+ */
+
+#include "../../mgrs.h"
+#include "../mgrs_host.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <vector>
+
+#define INVERSE_REPEATS    3
+#define STRING_SIZE        16
+#define CELL_TOLERANCE     1.0e-6      /* Meters outside its cell a point may be   */
+#define INVERSE_TOLERANCE  1.0e-2      /* Meters the centre may move going round   */
+#define EARTH_RADIUS       6371000.0   /* For turning angle differences into meters */
+
+struct Precision_Check
+{
+  long strings;
+  long failures;
+  long lat_warnings;
+  double max_offset;             /* Grid offset from the centre, cells */
+  double max_inverse;            /* Meters */
+  double max_distance;           /* Ground distance to the centre, half diagonals */
+  double decode_ns;
+};
+
+/* A northing in the other hemisphere: the equator is 0 in the north, 10,000 km in the south */
+static double to_hemisphere (double northing, char from, char to)
+{
+  if ((from == 'S') && (to == 'N'))
+    return (northing - 1.0e7);
+  if ((from == 'N') && (to == 'S'))
+    return (northing + 1.0e7);
+  return (northing);
+}
+
+/* Checks one string of the point at one precision; returns 0 if it passes */
+static int check_string (const MGRS_Parameters *parameters, double latitude, double longitude,
+                         long precision, const char *mgrs, Precision_Check *check)
+{
+  double size = MGRS_Divisor_Table[precision];
+  double half = 0.5 * size;
+  long zone;
+  long centre_zone;
+  char hemisphere;
+  char centre_hemisphere;
+  double easting;
+  double northing;
+  double corner_latitude;
+  double corner_longitude;
+  double la;
+  double lo;
+  double point_easting;
+  double point_northing;
+  double centre_easting;
+  double centre_northing;
+  double easting_bound;
+  double northing_bound;
+  double offset;
+  double distance;
+  long error_code;
+
+  error_code = Convert_MGRS_To_UTM_R (parameters, mgrs, &zone, &hemisphere, &easting, &northing);
+  if (error_code & MGRS_LAT_WARNING)
+    check->lat_warnings++;
+  if (error_code & ~MGRS_LAT_WARNING)
+    return (1);
+  if (Convert_MGRS_To_Geodetic_R (parameters, mgrs, &corner_latitude, &corner_longitude)
+      & ~MGRS_LAT_WARNING)
+    return (1);
+  if (Convert_UTM_To_Geodetic_R (&parameters->UTM, zone, hemisphere, easting, northing, &la, &lo)
+      || (la != corner_latitude) || (lo != corner_longitude))
+    return (1);
+
+  /* The point in its cell, in grid meters, normalised as the forward path has it */
+  la = latitude;
+  lo = longitude;
+  if (Get_MGRS_Zone_R (parameters, &la, &lo, &centre_zone)
+      || Convert_Geodetic_To_UTM_Zone_R (&parameters->UTM, la, lo, zone,
+                                      TRANMERC_EXACT_TERMS, &centre_hemisphere, &point_easting,
+                                      &point_northing, &easting_bound, &northing_bound))
+    return (1);
+  point_northing = to_hemisphere (point_northing, centre_hemisphere, hemisphere);
+  offset = fabs (point_easting - (easting + half));
+  if (fabs (point_northing - (northing + half)) > offset)
+    offset = fabs (point_northing - (northing + half));
+  if (offset / size > check->max_offset)
+    check->max_offset = offset / size;
+  if (offset > half + CELL_TOLERANCE)
+    return (1);
+
+  /* The centre, to latitude and longitude and back; it is north of the equator if it is over it */
+  centre_hemisphere = hemisphere;
+  centre_northing = northing + half;
+  if ((hemisphere == 'S') && (centre_northing > 1.0e7))
+  {
+    centre_hemisphere = 'N';
+    centre_northing -= 1.0e7;
+  }
+  if (Convert_UTM_To_Geodetic_R (&parameters->UTM, zone, centre_hemisphere, easting + half,
+                                 centre_northing, &la, &lo))
+    return (1);
+  lo -= longitude;
+  if (lo > PI)
+    lo -= 2 * PI;
+  if (lo < -PI)
+    lo += 2 * PI;
+  distance = EARTH_RADIUS * hypot (la - latitude, lo * cos (latitude));
+  lo += longitude;
+  if (distance / (half * sqrt (2.0)) > check->max_distance)
+    check->max_distance = distance / (half * sqrt (2.0));
+  if (Convert_Geodetic_To_UTM_Zone_R (&parameters->UTM, la, lo, zone, TRANMERC_EXACT_TERMS,
+                                      &centre_hemisphere, &centre_easting, &centre_northing,
+                                      &easting_bound, &northing_bound))
+    return (1);
+  centre_northing = to_hemisphere (centre_northing, centre_hemisphere, hemisphere);
+  offset = hypot (centre_easting - (easting + half), centre_northing - (northing + half));
+  if (offset > check->max_inverse)
+    check->max_inverse = offset;
+  if (offset > INVERSE_TOLERANCE)
+    return (1);
+  return (0);
+}
+
+int main (int argc, char **argv)
+{
+  const MGRS_Parameters *parameters = &MGRS_Default_Parameters;
+  std::vector<double> lat;
+  std::vector<double> lon;
+  std::vector<char> strings;
+  Precision_Check checks[MAX_PRECISION + 1];
+  unsigned long long seed = 42;
+  char mgrs[STRING_SIZE];
+  double latitude;
+  double longitude;
+  double time;
+  double sink = 0.0;
+  long count = 1000000;
+  long failures = 0;
+  long precision;
+  long i;
+  int r;
+  int opt;
+
+  while ((opt = getopt (argc, argv, "n:")) != -1)
+    switch (opt)
+    {
+    case 'n':
+      count = atol (optarg);
+      break;
+    default:
+      fprintf (stderr, "usage: %s [-n points]\n", argv[0]);
+      return (1);
+    }
+  if (count < 1)
+  {
+    fprintf (stderr, "need at least 1 point\n");
+    return (1);
+  }
+
+  while ((long)lat.size () < count)
+  {
+    i = (long)lat.size ();
+    if (i % 10 == 0)
+    {
+      latitude = (i % 20) ? 56.0 + 8.0 * uniform (&seed) : 72.0 + 12.0 * uniform (&seed);
+      longitude = (i % 20) ? 12.0 * uniform (&seed) : 42.0 * uniform (&seed);
+    }
+    else if (i % 10 == 1)
+    {
+      if (i % 20 == 1)
+      { /* By a band edge, the equator and the ends of the grid included */
+        latitude = -80.0 + 8.0 * (long)(21.0 * uniform (&seed)) + 1.0e-5 * (uniform (&seed) - 0.5);
+        if (latitude > 84.0)
+          latitude = 84.5 - 1.0e-5 * uniform (&seed);
+        longitude = -180.0 + 360.0 * uniform (&seed);
+      }
+      else
+      {
+        latitude = -80.0 + 164.0 * uniform (&seed);
+        longitude = -180.0 + 6.0 * (long)(60.0 * uniform (&seed))
+                    + 1.0e-5 * (uniform (&seed) - 0.5);
+      }
+    }
+    else
+    {
+      latitude = -80.0 + 164.0 * uniform (&seed);
+      longitude = -180.0 + 360.0 * uniform (&seed);
+    }
+    if ((longitude < -180.0) || (latitude < -80.5))
+      continue;
+    lat.push_back (latitude * DEG_TO_RAD);
+    lon.push_back (longitude * DEG_TO_RAD);
+  }
+
+  strings.resize (count * STRING_SIZE);
+  for (precision = 0; precision <= MAX_PRECISION; precision++)
+  {
+    Precision_Check *check = &checks[precision];
+
+    memset (check, 0, sizeof (Precision_Check));
+    for (i = 0; i < count; i++)
+    {
+      if (Convert_Geodetic_To_MGRS_R (parameters, lat[i], lon[i], precision,
+                                      &strings[i * STRING_SIZE]))
+      {
+        strings[i * STRING_SIZE] = 0;
+        continue;
+      }
+      check->strings++;
+      if (check_string (parameters, lat[i], lon[i], precision, &strings[i * STRING_SIZE], check))
+      {
+        if (check->failures++ < 10)
+          fprintf (stderr, "%.12f %.12f precision %ld: %s does not decode to its cell\n",
+                   lat[i] * RAD_TO_DEG, lon[i] * RAD_TO_DEG, precision, &strings[i * STRING_SIZE]);
+      }
+    }
+    check->decode_ns = 1e30;
+    for (r = 0; r < INVERSE_REPEATS; r++)
+    {
+      time = now ();
+      for (i = 0; i < count; i++)
+      {
+        Convert_MGRS_To_Geodetic_R (parameters, &strings[i * STRING_SIZE], &latitude, &longitude);
+        sink += latitude;
+      }
+      time = now () - time;
+      if (time * 1e9 / count < check->decode_ns)
+        check->decode_ns = time * 1e9 / count;
+    }
+    failures += check->failures;
+  }
+
+  printf ("{\n  \"points\": %ld, \"cell_tolerance_m\": %.1e, \"inverse_tolerance_m\": %.1e,\n"
+          "  \"precisions\": [", count, CELL_TOLERANCE, INVERSE_TOLERANCE);
+  for (precision = 0; precision <= MAX_PRECISION; precision++)
+    printf ("%s\n    {\"precision\": %ld, \"strings\": %ld, \"failures\": %ld,"
+            " \"lat_warnings\": %ld, \"max_offset_cells\": %.6f,\n"
+            "     \"max_inverse_round_trip_m\": %.3e, \"max_centre_distance_half_diagonals\": %.4f,"
+            " \"decode_ns\": %.1f}", precision ? "," : "", precision, checks[precision].strings,
+            checks[precision].failures, checks[precision].lat_warnings,
+            checks[precision].max_offset, checks[precision].max_inverse,
+            checks[precision].max_distance, checks[precision].decode_ns);
+  printf ("\n  ],\n  \"failures\": %ld\n}\n", failures);
+  fprintf (stderr, "checksum %g\n", sink);
+  (void)mgrs;
+  return (failures ? 1 : 0);
+}
@@ -0,0 +1,280 @@
+/*
+ * Memory, conversion and comparison benchmark of the packed keys of
+ * mgrs_key.h against MGRS strings.  Not part of the sketch; build and run
+ * it on the host:
+ *
+ *   g++ -O2 -std=gnu++11 -I../.. mgrs_key.cpp -o mgrs_key
+ *   ./mgrs_key [-n points] [-p precision] [-r region_degrees] > results.json
+ *
+ * -n random positions (default 1000000) within a square of -r degrees
+ * (default 10, about a country; 0 for the whole UTM grid) are converted
+ * at precision -p (default 5) both to strings, stored as 16 byte arrays,
+ * and to keys.  Every key must write the same string, pack back from it
+ * to the same key, and have its cell centre half a cell from the corner
+ * Convert_MGRS_To_UTM gives for the string.  The conversions are timed
+ * per position; sorting, hashing and binary searching for each position
+ * are timed on strings (strcmp, FNV-1a) and keys (integer compare, a
+ * multiplicative hash, and Sort_MGRS_Keys).
+ * Timings are the fastest of KEY_REPEATS runs.
+ */
+
+#include "../../mgrs_key.h"
+#include "../mgrs_host.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#define KEY_REPEATS     3
+#define STRING_SIZE     16
+
+struct Cell_String
+{
+  char s[STRING_SIZE];
+};
+
+static bool string_less (const Cell_String &a, const Cell_String &b)
+{
+  return (strcmp (a.s, b.s) < 0);
+}
+
+static unsigned long hash_string (const char *s)
+{
+  unsigned long h = 2166136261UL;
+
+  while (*s)
+    h = (h ^ (unsigned char)*s++) * 16777619UL;
+  return (h);
+}
+
+static unsigned long hash_key (MGRS_Key key)
+{
+  return ((unsigned long)((key * 0x9e3779b97f4a7c15ULL) >> 32));
+}
+
+/* Times Body over the positions, fastest of KEY_REPEATS, in ns each */
+#define TIME_EACH(result, count, body)          \
+  do                                            \
+  {                                             \
+    double best_ = 1e30;                        \
+    double t_;                                  \
+    int r_;                                     \
+    for (r_ = 0; r_ < KEY_REPEATS; r_++)        \
+    {                                           \
+      t_ = now ();                              \
+      body;                                     \
+      t_ = now () - t_;                         \
+      if (t_ < best_)                           \
+        best_ = t_;                             \
+    }                                           \
+    result = best_ * 1e9 / (count);             \
+  } while (0)
+
+int main (int argc, char **argv)
+{
+  long count = 1000000;
+  long precision = 5;
+  double region = 10.0;
+  unsigned long long seed = 42;
+  std::vector<double> lat;
+  std::vector<double> lon;
+  std::vector<Cell_String> strings;
+  std::vector<Cell_String> sorted_strings;
+  std::vector<MGRS_Key> keys;
+  std::vector<MGRS_Key> sorted_keys;
+  std::vector<MGRS_Key> scratch;
+  std::vector<long> values;
+  std::vector<long> value_scratch;
+  char text[STRING_SIZE];
+  double latitude;
+  double longitude;
+  double to_string_ns;
+  double to_key_ns;
+  double key_to_string_ns;
+  double string_to_key_ns;
+  double key_to_utm_ns;
+  double key_to_centre_ns;
+  double easting;
+  double northing;
+  double corner_easting;
+  double corner_northing;
+  double half;
+  long zone;
+  long corner_zone;
+  char hemisphere;
+  char corner_hemisphere;
+  double string_sort_ns;
+  double key_sort_ns;
+  double radix_sort_ns;
+  double radix_values_ns;
+  double string_hash_ns;
+  double key_hash_ns;
+  double string_search_ns;
+  double key_search_ns;
+  unsigned long sink = 0;
+  long mismatches = 0;
+  long distinct_squares = 1;
+  long i;
+  MGRS_Key key;
+  int opt;
+
+  while ((opt = getopt (argc, argv, "n:p:r:")) != -1)
+    switch (opt)
+    {
+    case 'n':
+      count = atol (optarg);
+      break;
+    case 'p':
+      precision = atol (optarg);
+      break;
+    case 'r':
+      region = atof (optarg);
+      break;
+    default:
+      fprintf (stderr, "usage: %s [-n points] [-p precision] [-r region_degrees]\n", argv[0]);
+      return (1);
+    }
+  if ((count < 1) || (precision < 0) || (precision > MAX_PRECISION))
+  {
+    fprintf (stderr, "need at least 1 point and precision 0 to %d\n", MAX_PRECISION);
+    return (1);
+  }
+
+  while ((long)lat.size () < count)
+  {
+    if (region > 0.0)
+    {
+      latitude = 45.0 + region * (uniform (&seed) - 0.5);
+      longitude = 10.0 + region * (uniform (&seed) - 0.5);
+    }
+    else
+    {
+      latitude = -80.0 + 164.0 * uniform (&seed);
+      longitude = -180.0 + 360.0 * uniform (&seed);
+    }
+    lat.push_back (latitude * DEG_TO_RAD);
+    lon.push_back (longitude * DEG_TO_RAD);
+  }
+  strings.resize (count);
+  keys.resize (count);
+
+  TIME_EACH (to_string_ns, count,
+             for (i = 0; i < count; i++)
+               Convert_Geodetic_To_MGRS_R (&MGRS_Default_Parameters, lat[i], lon[i], precision,
+                                           strings[i].s));
+  TIME_EACH (to_key_ns, count,
+             for (i = 0; i < count; i++)
+               Convert_Geodetic_To_MGRS_Key_R (&MGRS_Default_Parameters, lat[i], lon[i],
+                                               precision, &keys[i]));
+  TIME_EACH (key_to_string_ns, count,
+             for (i = 0; i < count; i++)
+             {
+               Convert_MGRS_Key_To_String (keys[i], text);
+               sink += text[5];
+             });
+  TIME_EACH (string_to_key_ns, count,
+             for (i = 0; i < count; i++)
+             {
+               Convert_MGRS_To_Key_R (&MGRS_Default_Parameters, strings[i].s, &key);
+               sink += key;
+             });
+  TIME_EACH (key_to_utm_ns, count,
+             for (i = 0; i < count; i++)
+             {
+               Convert_MGRS_Key_To_UTM_R (&MGRS_Default_Parameters, keys[i], &zone, &hemisphere,
+                                          &easting, &northing);
+               sink += (unsigned long)northing;
+             });
+  TIME_EACH (key_to_centre_ns, count,
+             for (i = 0; i < count; i++)
+             {
+               Convert_MGRS_Key_To_Geodetic_R (&MGRS_Default_Parameters, keys[i], &latitude,
+                                               &longitude);
+               sink += (unsigned long)(latitude * 1e6);
+             });
+
+  half = 0.5 * MGRS_Divisor_Table[precision];
+  for (i = 0; i < count; i++)
+  {
+    if (Convert_MGRS_Key_To_String (keys[i], text) || strcmp (text, strings[i].s)
+        || Convert_MGRS_To_Key_R (&MGRS_Default_Parameters, text, &key) || (key != keys[i])
+        || Convert_MGRS_Key_To_UTM_R (&MGRS_Default_Parameters, keys[i], &zone, &hemisphere,
+                                      &easting, &northing)
+        || (Convert_MGRS_To_UTM (text, &corner_zone, &corner_hemisphere, &corner_easting,
+                                 &corner_northing) & ~MGRS_LAT_WARNING)
+        || (zone != corner_zone) || (hemisphere != corner_hemisphere)
+        || (easting != corner_easting + half) || (northing != corner_northing + half))
+    {
+      if (mismatches++ < 10)
+        fprintf (stderr, "%s: key %016llx gives %s\n", strings[i].s,
+                 (unsigned long long)keys[i], text);
+    }
+  }
+
+  TIME_EACH (string_sort_ns, count,
+             sorted_strings = strings;
+             std::sort (sorted_strings.begin (), sorted_strings.end (), string_less));
+  TIME_EACH (key_sort_ns, count,
+             sorted_keys = keys;
+             std::sort (sorted_keys.begin (), sorted_keys.end ()));
+  scratch.resize (count);
+  TIME_EACH (radix_sort_ns, count,
+             sorted_keys = keys;
+             Sort_MGRS_Keys (&sorted_keys[0], NULL, &scratch[0], NULL, count));
+  values.resize (count);
+  value_scratch.resize (count);
+  TIME_EACH (radix_values_ns, count,
+             sorted_keys = keys;
+             for (i = 0; i < count; i++)
+               values[i] = i;
+             Sort_MGRS_Keys (&sorted_keys[0], &values[0], &scratch[0], &value_scratch[0], count));
+  for (i = 0; i < count; i++)
+    if (keys[values[i]] != sorted_keys[i])
+      mismatches++;
+  for (i = 1; i < count; i++)
+  {
+    if (sorted_keys[i] < sorted_keys[i - 1])
+      mismatches++;
+    if ((sorted_keys[i] >> MGRS_KEY_ROW_SHIFT) != (sorted_keys[i - 1] >> MGRS_KEY_ROW_SHIFT))
+      distinct_squares++;
+  }
+
+  TIME_EACH (string_hash_ns, count,
+             for (i = 0; i < count; i++)
+               sink += hash_string (strings[i].s));
+  TIME_EACH (key_hash_ns, count,
+             for (i = 0; i < count; i++)
+               sink += hash_key (keys[i]));
+  TIME_EACH (string_search_ns, count,
+             for (i = 0; i < count; i++)
+               sink += std::lower_bound (sorted_strings.begin (), sorted_strings.end (),
+                                         strings[i], string_less) - sorted_strings.begin ());
+  TIME_EACH (key_search_ns, count,
+             for (i = 0; i < count; i++)
+               sink += std::lower_bound (sorted_keys.begin (), sorted_keys.end (), keys[i])
+                       - sorted_keys.begin ());
+
+  printf ("{\n  \"points\": %ld, \"precision\": %ld, \"region_degrees\": %.1f,"
+          " \"distinct_100km_squares\": %ld,\n", count, precision, region, distinct_squares);
+  printf ("  \"bytes_per_cell\": {\"string\": %d, \"key\": %d},\n",
+          STRING_SIZE, (int)sizeof (MGRS_Key));
+  printf ("  \"convert_ns\": {\"geodetic_to_string\": %.1f, \"geodetic_to_key\": %.1f,"
+          " \"key_to_string\": %.1f, \"string_to_key\": %.1f,\n"
+          "                 \"key_to_centre_utm\": %.1f, \"key_to_centre_geodetic\": %.1f},\n",
+          to_string_ns, to_key_ns, key_to_string_ns, string_to_key_ns, key_to_utm_ns,
+          key_to_centre_ns);
+  printf ("  \"compare_ns\": {\"string_sort\": %.1f, \"key_sort\": %.1f, \"key_radix_sort\": %.1f,"
+          " \"key_radix_sort_with_values\": %.1f,\n"
+          "                 \"string_hash\": %.1f, \"key_hash\": %.1f,"
+          " \"string_search\": %.1f, \"key_search\": %.1f},\n",
+          string_sort_ns, key_sort_ns, radix_sort_ns, radix_values_ns, string_hash_ns,
+          key_hash_ns, string_search_ns, key_search_ns);
+  printf ("  \"mismatches\": %ld\n}\n", mismatches);
+  fprintf (stderr, "checksum %lu\n", sink);
+  return (mismatches ? 1 : 0);
+}
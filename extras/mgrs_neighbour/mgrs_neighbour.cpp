@@ -0,0 +1,294 @@
+/*
+ * Correctness check and benchmark of Get_MGRS_Neighbours against the
+ * round trip it replaces: decode the cell, offset the centre by a cell
+ * size in its zone's grid, project it back to latitude and longitude and
+ * convert that.  Not part of the sketch; build and run it on the host:
+ *
+ *   g++ -O2 -std=gnu++11 -I../.. mgrs_neighbour.cpp -o mgrs_neighbour
+ *   ./mgrs_neighbour [-n cells] [-e max_precision] > results.json
+ *
+ * Up to precision -e (default 1, 10 km) every cell of every grid zone is
+ * checked: each grid position whose centre or an inner corner converts
+ * into the zone, with each band letter that gives.  Finer precisions up
+ * to 5 are checked on -n random cells (default 200000), half of them
+ * within a few cells of a zone or band edge, where the arithmetic and the
+ * projection meet.  Every neighbour must be the round trip's, and
+ * MGRS_Cells_Adjacent must accept it and reject the cells two steps away.
+ * Timings are per cell, for all 8 neighbours, the fastest of
+ * NEIGHBOUR_REPEATS runs over uniformly random cells.  The full check
+ * takes a few minutes.
+ */
+
+#include "../../mgrs_neighbour.h"
+#include "../mgrs_host.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <set>
+#include <string>
+#include <vector>
+
+#define NEIGHBOUR_REPEATS  5
+#define EDGE_CELLS         3.0       /* How near an edge the edge cells are */
+#define METERS_PER_DEGREE  111000.0
+
+struct Check
+{
+  long cells;
+  long neighbours;
+  long projected;
+  long mismatches;
+  long adjacency_errors;
+};
+
+/* The neighbours as decoding, offsetting and converting back gives them */
+static void round_trip (const char *mgrs, char neighbours[MGRS_NEIGHBOURS][MGRS_NEIGHBOUR_SIZE])
+{
+  long zone;
+  char hemisphere;
+  double easting;
+  double northing;
+  double latitude;
+  double longitude;
+  double size;
+  long precision;
+  long i;
+
+  Convert_MGRS_To_UTM (mgrs, &zone, &hemisphere, &easting, &northing);
+  precision = (strlen (mgrs) - 5) / 2;
+  size = MGRS_Divisor_Table[precision];
+  for (i = 0; i < MGRS_NEIGHBOURS; i++)
+  {
+    Convert_Transverse_Mercator_To_Geodetic_R (&MGRS_Default_Parameters.UTM.Ellipsoid,
+                                               &UTM_Zone_Projection[zone - 1][hemisphere == 'S'],
+                                               easting + (0.5 + MGRS_Neighbour_Step[i][0]) * size,
+                                               northing + (0.5 + MGRS_Neighbour_Step[i][1]) * size,
+                                               &latitude, &longitude);
+    if (Convert_Geodetic_To_MGRS (latitude, longitude, precision, neighbours[i]))
+      neighbours[i][0] = 0;
+  }
+}
+
+static void check_cell (const char *mgrs, Check *check)
+{
+  char expected[MGRS_NEIGHBOURS][MGRS_NEIGHBOUR_SIZE];
+  char neighbours[MGRS_NEIGHBOURS][MGRS_NEIGHBOUR_SIZE];
+  char far[MGRS_NEIGHBOUR_SIZE];
+  long projected;
+  long i;
+
+  round_trip (mgrs, expected);
+  if (Get_MGRS_Neighbours (&MGRS_Default_Parameters, mgrs, neighbours, &projected))
+  {
+    fprintf (stderr, "%s: not a cell\n", mgrs);
+    check->mismatches++;
+    return;
+  }
+  check->cells++;
+  check->projected += projected;
+  for (i = 0; i < MGRS_NEIGHBOURS; i++)
+  {
+    check->neighbours++;
+    if (strcmp (neighbours[i], expected[i]))
+    {
+      if (check->mismatches++ < 10)
+        fprintf (stderr, "%s step %d %d: %s, round trip %s\n", mgrs, MGRS_Neighbour_Step[i][0],
+                 MGRS_Neighbour_Step[i][1], neighbours[i], expected[i]);
+    }
+    if (neighbours[i][0] && !MGRS_Cells_Adjacent (&MGRS_Default_Parameters, mgrs, neighbours[i]))
+      check->adjacency_errors++;
+    /* Two steps away is adjacent only if a zone or band edge is that near */
+    Get_MGRS_Neighbour (&MGRS_Default_Parameters, mgrs, 2 * MGRS_Neighbour_Step[i][0],
+                        2 * MGRS_Neighbour_Step[i][1], far);
+    if (far[0] && (far[0] == mgrs[0]) && (far[1] == mgrs[1]) && (far[2] == mgrs[2])
+        && MGRS_Cells_Adjacent (&MGRS_Default_Parameters, mgrs, far))
+      check->adjacency_errors++;
+  }
+}
+
+/* Every cell whose centre or an inner corner is in the zone */
+static void check_zone (long zone, long precision, Check *check)
+{
+  static const double corner[5][2] = {{0.5, 0.5}, {0.001, 0.001}, {0.999, 0.001},
+                                      {0.001, 0.999}, {0.999, 0.999}};
+  std::set<std::string> strings;
+  char mgrs[MGRS_NEIGHBOUR_SIZE];
+  long size = MGRS_Divisor_Table[precision];
+  long zone_found;
+  double latitude;
+  double longitude;
+  double east;
+  double north;
+  char hemisphere;
+  int h;
+  long k;
+
+  for (h = 0; h < 2; h++)
+    for (north = (h ? 1000000.0 : 0.0); north < (h ? 10000000.0 : 9400000.0); north += size)
+      for (east = 100000.0; east < 900000.0; east += size)
+      {
+        strings.clear ();
+        for (k = 0; k < 5; k++)
+        {
+          Convert_Transverse_Mercator_To_Geodetic_R (&MGRS_Default_Parameters.UTM.Ellipsoid,
+                                                     &UTM_Zone_Projection[zone - 1][h],
+                                                     east + corner[k][0] * size,
+                                                     north + corner[k][1] * size,
+                                                     &latitude, &longitude);
+          if (Convert_Geodetic_To_MGRS (latitude, longitude, precision, mgrs))
+            continue;
+          zone_found = (mgrs[0] - '0') * 10 + (mgrs[1] - '0');
+          if ((zone_found == zone) && ((mgrs[2] < 'N') == (h == 1)))
+            strings.insert (mgrs);
+        }
+        for (std::set<std::string>::iterator s = strings.begin (); s != strings.end (); ++s)
+        {
+          /* The corner conversions can fall in the next cell */
+          Convert_MGRS_To_UTM (s->c_str (), &zone_found, &hemisphere, &latitude, &longitude);
+          if ((latitude == east) && (longitude == north))
+            check_cell (s->c_str (), check);
+        }
+      }
+}
+
+/* Random cells, with Edges every other one within EDGE_CELLS cells of an edge */
+static void random_cells (std::vector<std::string> &cells, long count, long precision, int edges)
+{
+  static const double band_edge[21] =
+    {-80.5, -72.0, -64.0, -56.0, -48.0, -40.0, -32.0, -24.0, -16.0, -8.0, 0.0,
+     8.0, 16.0, 24.0, 32.0, 40.0, 48.0, 56.0, 64.0, 72.0, 84.5};
+  unsigned long long seed = 1000 + precision;
+  double near = EDGE_CELLS * MGRS_Divisor_Table[precision] / METERS_PER_DEGREE;
+  double latitude;
+  double longitude;
+  char mgrs[MGRS_NEIGHBOUR_SIZE];
+
+  cells.clear ();
+  while ((long)cells.size () < count)
+  {
+    latitude = -80.5 + 165.0 * uniform (&seed);
+    longitude = -180.0 + 360.0 * uniform (&seed);
+    if (edges && (cells.size () & 1))
+    {
+      if (uniform (&seed) < 0.5)
+        latitude = band_edge[(long)(21 * uniform (&seed))] + near * (2.0 * uniform (&seed) - 1.0);
+      else
+        longitude = 3.0 * floor (longitude / 3.0)
+                    + near / cos (latitude * DEG_TO_RAD) * (2.0 * uniform (&seed) - 1.0);
+    }
+    if (longitude < -180.0)
+      longitude += 360.0;
+    if (!Convert_Geodetic_To_MGRS (latitude * DEG_TO_RAD, longitude * DEG_TO_RAD, precision, mgrs))
+      cells.push_back (mgrs);
+  }
+}
+
+static void print_check (const char *name, long precision, const Check &check, int first)
+{
+  printf ("%s\n    {\"check\": \"%s\", \"precision\": %ld, \"cells\": %ld, \"neighbours\": %ld,"
+          " \"projected\": %ld, \"mismatches\": %ld, \"adjacency_errors\": %ld}",
+          first ? "" : ",", name, precision, check.cells, check.neighbours, check.projected,
+          check.mismatches, check.adjacency_errors);
+  fflush (stdout);
+}
+
+static void benchmark (long count, long precision, int first)
+{
+  std::vector<std::string> cells;
+  char neighbours[MGRS_NEIGHBOURS][MGRS_NEIGHBOUR_SIZE];
+  double grid_time = 1e30;
+  double trip_time = 1e30;
+  double time;
+  long projected = 0;
+  long p;
+  size_t i;
+  int r;
+
+  random_cells (cells, count, precision, FALSE);
+  for (r = 0; r < NEIGHBOUR_REPEATS; r++)
+  {
+    time = now ();
+    projected = 0;
+    for (i = 0; i < cells.size (); i++)
+    {
+      Get_MGRS_Neighbours (&MGRS_Default_Parameters, cells[i].c_str (), neighbours, &p);
+      projected += p;
+    }
+    time = now () - time;
+    if (time < grid_time)
+      grid_time = time;
+
+    time = now ();
+    for (i = 0; i < cells.size (); i++)
+      round_trip (cells[i].c_str (), neighbours);
+    time = now () - time;
+    if (time < trip_time)
+      trip_time = time;
+  }
+  printf ("%s\n    {\"precision\": %ld, \"cells\": %ld, \"grid_ns_per_cell\": %.0f,"
+          " \"round_trip_ns_per_cell\": %.0f, \"speedup\": %.1f, \"projected_fraction\": %.4f}",
+          first ? "" : ",", precision, (long)cells.size (), grid_time * 1e9 / cells.size (),
+          trip_time * 1e9 / cells.size (), trip_time / grid_time,
+          (double)projected / (MGRS_NEIGHBOURS * cells.size ()));
+  fflush (stdout);
+}
+
+int main (int argc, char **argv)
+{
+  std::vector<std::string> cells;
+  long count = 200000;
+  long exhaustive = 1;
+  long precision;
+  long zone;
+  size_t i;
+  int first = 1;
+  int opt;
+
+  while ((opt = getopt (argc, argv, "n:e:")) != -1)
+    switch (opt)
+    {
+    case 'n':
+      count = atol (optarg);
+      break;
+    case 'e':
+      exhaustive = atol (optarg);
+      break;
+    default:
+      fprintf (stderr, "usage: %s [-n cells] [-e max_precision]\n", argv[0]);
+      return (1);
+    }
+
+  printf ("{\n  \"checks\": [");
+  for (precision = 0; precision <= MAX_PRECISION; precision++)
+  {
+    Check check = {0, 0, 0, 0, 0};
+
+    if (precision <= exhaustive)
+    {
+      for (zone = 1; zone <= 60; zone++)
+        check_zone (zone, precision, &check);
+      print_check ("every_cell", precision, check, first);
+    }
+    else
+    {
+      random_cells (cells, count, precision, TRUE);
+      for (i = 0; i < cells.size (); i++)
+        check_cell (cells[i].c_str (), &check);
+      print_check ("random_and_edge_cells", precision, check, first);
+    }
+    first = 0;
+    fprintf (stderr, "precision %ld checked\n", precision);
+  }
+  printf ("\n  ],\n  \"timings\": [");
+  first = 1;
+  for (precision = 0; precision <= MAX_PRECISION; precision++)
+  {
+    benchmark (count, precision, first);
+    first = 0;
+  }
+  printf ("\n  ]\n}\n");
+  return (0);
+}
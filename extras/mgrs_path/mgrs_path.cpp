@@ -0,0 +1,313 @@
+/*
+ * Benchmark of Convert_Path_To_MGRS_Cells against resampling a track
+ * densely and converting every sample.  Not part of the sketch; build and
+ * run it on the host:
+ *
+ *   g++ -O2 -std=gnu++11 -I../.. mgrs_path.cpp -o mgrs_path
+ *   ./mgrs_path [-p precision] [-s step] [track.nmea ...] > results.json
+ *
+ * Each NMEA log given (GGA and RMC fixes, as nmea_mgrs reads) is one track;
+ * with none, four synthetic tracks are used: a 10 hour drive at 1 Hz, a
+ * 4 hour flight at 1 Hz through the Norway zones, a ship at 0.2 Hz past
+ * Svalbard, and a route of waypoints 20 km apart.  For each track and
+ * precision (-p, or 0, 1 and 2) the track is cut into cells both ways:
+ * resampling takes a sample every step meters (default 1/20 of the cell
+ * size) along each segment and calls Convert_Geodetic_To_MGRS on it.
+ * Timings are the fastest of PATH_REPEATS runs.  missed counts cells the
+ * segmentation found and the resampling did not, the corners it clipped;
+ * extra counts cells the resampling found and the segmentation did not,
+ * and midpoint_mismatches cells whose middle, half way between the entry
+ * and exit, Convert_Geodetic_To_MGRS puts in another cell.  Both should
+ * be 0.
+ */
+
+#include "../../mgrs_path.h"
+#include "../../nmea.h"
+#include "../mgrs_host.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <set>
+#include <string>
+#include <vector>
+
+#define PATH_REPEATS    3
+#define EARTH_RADIUS    6371000.0   /* For the length of a segment */
+#define MAX_LINE        256
+
+struct Track
+{
+  std::string name;
+  std::vector<double> lat;       /* radians */
+  std::vector<double> lon;
+};
+
+/* A wandering track of Count points Step meters apart */
+static void make_track (std::vector<Track> &tracks, const char *name, double lat_deg,
+                        double lon_deg, double heading_deg, double wander_deg, double step,
+                        long count, unsigned long long seed)
+{
+  Track t;
+  double lat = lat_deg * DEG_TO_RAD;
+  double lon = lon_deg * DEG_TO_RAD;
+  double heading = heading_deg * DEG_TO_RAD;
+  double turn = 0.0;
+  long i;
+
+  t.name = name;
+  for (i = 0; i < count; i++)
+  {
+    t.lat.push_back (lat);
+    t.lon.push_back (lon);
+    turn = 0.9 * turn + (uniform (&seed) - 0.5) * wander_deg * DEG_TO_RAD;
+    heading += turn;
+    lat += step * cos (heading) / EARTH_RADIUS;
+    lon += step * sin (heading) / (EARTH_RADIUS * cos (lat));
+    if (lon >= PI)
+      lon -= 2 * PI;
+  }
+  tracks.push_back (t);
+}
+
+static int read_track (std::vector<Track> &tracks, const char *file)
+{
+  FILE *f = fopen (file, "r");
+  char line[MAX_LINE];
+  NMEA_Fix fix;
+  Track t;
+  double lat;
+  double lon;
+
+  if (!f)
+  {
+    perror (file);
+    return (0);
+  }
+  t.name = file;
+  while (fgets (line, sizeof (line), f))
+    if (!Parse_NMEA_Sentence (line, line + strlen (line), &fix))
+    {
+      lat = fix.Latitude * 1e-6 * DEG_TO_RAD;
+      lon = fix.Longitude * 1e-6 * DEG_TO_RAD;
+      /* GGA and RMC of one epoch give the same position */
+      if (t.lat.empty () || (lat != t.lat.back ()) || (lon != t.lon.back ()))
+      {
+        t.lat.push_back (lat);
+        t.lon.push_back (lon);
+      }
+    }
+  fclose (f);
+  tracks.push_back (t);
+  return (1);
+}
+
+static double segment_length (const Track &t, size_t i)
+{
+  double d_lon = t.lon[i + 1] - t.lon[i];
+
+  if (d_lon > PI)
+    d_lon -= 2 * PI;
+  else if (d_lon < -PI)
+    d_lon += 2 * PI;
+  return (EARTH_RADIUS * hypot (t.lat[i + 1] - t.lat[i],
+                                d_lon * cos (0.5 * (t.lat[i] + t.lat[i + 1]))));
+}
+
+/* Position on the track at i + f, as Convert_Path_To_MGRS_Cells counts */
+static void track_point (const Track &t, double position, double *lat, double *lon)
+{
+  size_t i = (size_t)position;
+  double f;
+  double d_lon;
+
+  if (i + 1 >= t.lat.size ())
+    i = t.lat.size () - 2;
+  f = position - i;
+  d_lon = t.lon[i + 1] - t.lon[i];
+  if (d_lon > PI)
+    d_lon -= 2 * PI;
+  else if (d_lon < -PI)
+    d_lon += 2 * PI;
+  *lat = t.lat[i] + f * (t.lat[i + 1] - t.lat[i]);
+  *lon = t.lon[i] + f * d_lon;
+  if (*lon >= PI)
+    *lon -= 2 * PI;
+  else if (*lon < -PI)
+    *lon += 2 * PI;
+}
+
+/* The distinct consecutive cells of samples every Step meters */
+static long resample (const Track &t, long precision, double step, std::vector<std::string> &cells)
+{
+  char mgrs[32];
+  double lat;
+  double lon;
+  long samples = 0;
+  long n;
+  long k;
+  size_t i;
+
+  cells.clear ();
+  for (i = 0; i + 1 < t.lat.size (); i++)
+  {
+    n = (long)ceil (segment_length (t, i) / step);
+    if (n < 1)
+      n = 1;
+    for (k = 0; k <= n; k++)
+    {
+      if ((k == n) && (i + 2 < t.lat.size ()))
+        break;          /* The next segment starts there */
+      track_point (t, i + (double)k / n, &lat, &lon);
+      samples++;
+      if (Convert_Geodetic_To_MGRS (lat, lon, precision, mgrs))
+        continue;
+      if (cells.empty () || (cells.back () != mgrs))
+        cells.push_back (mgrs);
+    }
+  }
+  return (samples);
+}
+
+static void measure (const Track &t, long precision, double step, int first)
+{
+  MGRS_Path_Output out;
+  std::vector<MGRS_Path_Cell> cells (t.lat.size () * 4 + 1024);
+  std::vector<std::string> resampled;
+  std::set<std::string> found;
+  std::set<std::string> sampled;
+  double segment_time = 1e30;
+  double resample_time = 1e30;
+  double length = 0.0;
+  double time;
+  double lat;
+  double lon;
+  char mgrs[32];
+  long error_code = MGRS_PATH_NO_ERROR;
+  long samples = 0;
+  long missed = 0;
+  long extra = 0;
+  long midpoint = 0;
+  size_t i;
+  int r;
+
+  if (step <= 0.0)
+    step = MGRS_Divisor_Table[precision] / 20.0;
+  for (i = 0; i + 1 < t.lat.size (); i++)
+    length += segment_length (t, i);
+  out.Cells = &cells[0];
+  out.Max_Cells = (long)cells.size ();
+  for (r = 0; r < PATH_REPEATS; r++)
+  {
+    time = now ();
+    do
+    {
+      error_code = Convert_Path_To_MGRS_Cells (&MGRS_Default_Parameters, precision,
+                                               (long)t.lat.size (), &t.lat[0], &t.lon[0], &out);
+      if (error_code & MGRS_PATH_FULL_ERROR)
+      {
+        cells.resize (cells.size () * 2);
+        out.Cells = &cells[0];
+        out.Max_Cells = (long)cells.size ();
+      }
+    } while (error_code & MGRS_PATH_FULL_ERROR);
+    time = now () - time;
+    if (time < segment_time)
+      segment_time = time;
+  }
+  for (r = 0; r < PATH_REPEATS; r++)
+  {
+    time = now ();
+    samples = resample (t, precision, step, resampled);
+    time = now () - time;
+    if (time < resample_time)
+      resample_time = time;
+  }
+
+  for (i = 0; i < (size_t)out.Cell_Count; i++)
+  {
+    found.insert (out.Cells[i].Cell);
+    track_point (t, 0.5 * (out.Cells[i].Enter + out.Cells[i].Exit), &lat, &lon);
+    if (Convert_Geodetic_To_MGRS (lat, lon, precision, mgrs) || strcmp (mgrs, out.Cells[i].Cell))
+      midpoint++;
+  }
+  sampled.insert (resampled.begin (), resampled.end ());
+  for (std::set<std::string>::iterator c = found.begin (); c != found.end (); ++c)
+    if (!sampled.count (*c))
+      missed++;
+  for (std::set<std::string>::iterator c = sampled.begin (); c != sampled.end (); ++c)
+    if (!found.count (*c))
+      extra++;
+
+  printf ("%s\n    {\"track\": \"%s\", \"points\": %ld, \"length_km\": %.1f, \"precision\": %ld,\n"
+          "     \"error_code\": %ld, \"cells\": %ld, \"distinct_cells\": %ld,\n"
+          "     \"segment_ms\": %.3f, \"resample_ms\": %.3f, \"resample_step_m\": %.1f,"
+          " \"resample_samples\": %ld,\n"
+          "     \"resample_cells\": %ld, \"speedup\": %.1f, \"missed\": %ld, \"extra\": %ld,"
+          " \"midpoint_mismatches\": %ld}",
+          first ? "" : ",", t.name.c_str (), (long)t.lat.size (), length / 1000.0, precision,
+          error_code, out.Cell_Count, (long)found.size (), segment_time * 1e3,
+          resample_time * 1e3, step, samples, (long)resampled.size (),
+          resample_time / segment_time, missed, extra, midpoint);
+  fflush (stdout);
+  fprintf (stderr, "%s precision %ld done\n", t.name.c_str (), precision);
+}
+
+int main (int argc, char **argv)
+{
+  std::vector<Track> tracks;
+  long precision = -1;
+  double step = 0.0;
+  long p;
+  size_t i;
+  int first = 1;
+  int opt;
+
+  while ((opt = getopt (argc, argv, "p:s:")) != -1)
+    switch (opt)
+    {
+    case 'p':
+      precision = atol (optarg);
+      break;
+    case 's':
+      step = atof (optarg);
+      break;
+    default:
+      fprintf (stderr, "usage: %s [-p precision] [-s step] [track.nmea ...]\n", argv[0]);
+      return (1);
+    }
+  if ((precision < -1) || (precision > MAX_PRECISION))
+  {
+    fprintf (stderr, "precision must be 0 to %d\n", MAX_PRECISION);
+    return (1);
+  }
+  for (; optind < argc; optind++)
+    if (!read_track (tracks, argv[optind]))
+      return (1);
+  if (tracks.empty ())
+  {
+    make_track (tracks, "drive", 47.0, 5.0, 60.0, 2.0, 25.0, 36000, 1);
+    make_track (tracks, "flight", 57.0, 1.0, 45.0, 0.2, 250.0, 14400, 2);
+    make_track (tracks, "svalbard", 78.0, 5.0, 90.0, 1.0, 50.0, 20000, 3);
+    make_track (tracks, "waypoints", 10.0, -20.0, 70.0, 5.0, 20000.0, 1000, 4);
+  }
+  for (i = 0; i < tracks.size (); i++)
+    if (tracks[i].lat.size () < 2)
+    {
+      fprintf (stderr, "%s: fewer than 2 positions\n", tracks[i].name.c_str ());
+      return (1);
+    }
+
+  printf ("{\n  \"tracks\": [");
+  for (i = 0; i < tracks.size (); i++)
+    for (p = 0; p <= 2; p++)
+      if ((precision < 0) || (p == precision))
+      {
+        measure (tracks[i], (precision < 0) ? p : precision, step, first);
+        first = 0;
+      }
+  printf ("\n  ]\n}\n");
+  return (0);
+}
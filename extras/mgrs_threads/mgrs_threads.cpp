@@ -0,0 +1,276 @@
+/*
+ * Multi-threaded stress test and scaling table of the reentrant _R
+ * conversions.  Not part of the sketch; build and run it on the host:
+ *
+ *   g++ -O2 -std=gnu++11 -pthread -I../.. mgrs_threads.cpp -o mgrs_threads
+ *   ./mgrs_threads [-n points] [-s stress_points] [-r rounds] [-t threads]
+ *                  [-e ellipsoid_code] > results.json
+ *
+ * One MGRS_Parameters, set up once with Set_MGRS_Datum_R for -e (default
+ * WE), is shared read-only by every thread.  Each point goes through
+ * Convert_Geodetic_To_MGRS_R at a precision of its own, Convert_MGRS_To_
+ * Geodetic_R of that string, Convert_Geodetic_To_UTM_R and Convert_UTM_To_
+ * Geodetic_R, and every result and error code is kept.  Of -n random
+ * points (default 1000000), a tenth are in the Norway and Svalbard zones
+ * and a hundredth are out of range.
+ *
+ * The points are first converted on one thread; that is the reference.
+ * The scaling table then converts them with each of 1, 2, 4, ... threads
+ * up to -t (default: all cores), each thread a contiguous share, timing
+ * the fastest of THREAD_REPEATS runs.  The stress pass starts -t threads
+ * together on the first -s points (default 100000), each from its own
+ * offset around them, -r times (default 10), so that threads convert the
+ * same points at the same time.  Every run must give the reference,
+ * bit for bit; the mismatches are counted and the tool returns 1 if there
+ * are any.  Building with -fsanitize=thread as well has ThreadSanitizer
+ * report any data race in the library as it runs.
+ */
+
+#include "../../mgrs.h"
+#include "../mgrs_host.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#define THREAD_REPEATS  3
+#define STRING_SIZE     16
+
+struct Result
+{
+  char mgrs[STRING_SIZE];
+  long mgrs_error;
+  long decode_error;
+  long utm_error;
+  long inverse_error;
+  long zone;
+  char hemisphere;
+  double decoded_latitude;
+  double decoded_longitude;
+  double easting;
+  double northing;
+  double latitude;
+  double longitude;
+};
+
+/* Every conversion of one point through the shared parameters */
+static void convert_point (const MGRS_Parameters *parameters, double latitude, double longitude,
+                           long precision, Result *result)
+{
+  memset (result, 0, sizeof (Result));
+  result->mgrs_error = Convert_Geodetic_To_MGRS_R (parameters, latitude, longitude, precision,
+                                                   result->mgrs);
+  if (!result->mgrs_error)
+    result->decode_error = Convert_MGRS_To_Geodetic_R (parameters, result->mgrs,
+                                                       &result->decoded_latitude,
+                                                       &result->decoded_longitude);
+  result->utm_error = Convert_Geodetic_To_UTM_R (&parameters->UTM, latitude, longitude,
+                                                 &result->zone, &result->hemisphere,
+                                                 &result->easting, &result->northing);
+  if (!result->utm_error)
+    result->inverse_error = Convert_UTM_To_Geodetic_R (&parameters->UTM, result->zone,
+                                                       result->hemisphere, result->easting,
+                                                       result->northing, &result->latitude,
+                                                       &result->longitude);
+}
+
+/* memset above clears the padding, so whole results compare */
+static long count_mismatches (const std::vector<Result> &results,
+                              const std::vector<Result> &reference, long first, long count)
+{
+  long mismatches = 0;
+  long i;
+
+  for (i = 0; i < count; i++)
+    if (memcmp (&results[i], &reference[first + i], sizeof (Result)))
+    {
+      if (mismatches++ < 10)
+        fprintf (stderr, "point %ld: %s (%ld), reference %s (%ld)\n", first + i,
+                 results[i].mgrs, results[i].mgrs_error, reference[first + i].mgrs,
+                 reference[first + i].mgrs_error);
+    }
+  return (mismatches);
+}
+
+/* Converts points [first, first + count) into results[0 .. count) */
+static void convert_range (const MGRS_Parameters *parameters, const std::vector<double> &lat,
+                           const std::vector<double> &lon, long first, long count,
+                           Result *results)
+{
+  long i;
+
+  for (i = 0; i < count; i++)
+    convert_point (parameters, lat[first + i], lon[first + i], (first + i) % (MAX_PRECISION + 1),
+                   &results[i]);
+}
+
+int main (int argc, char **argv)
+{
+  MGRS_Parameters parameters;
+  std::vector<double> lat;
+  std::vector<double> lon;
+  std::vector<Result> reference;
+  std::vector<Result> results;
+  std::vector< std::vector<Result> > stress;
+  std::vector<std::thread> pool;
+  std::atomic<int> ready;
+  const char *ellipsoid_code = "WE";
+  unsigned long long seed = 42;
+  double single_time = 0.0;
+  double time;
+  double best;
+  double latitude;
+  double longitude;
+  long count = 1000000;
+  long stress_count = 100000;
+  long rounds = 10;
+  long threads = std::thread::hardware_concurrency ();
+  long stress_mismatches = 0;
+  long total_mismatches = 0;
+  long mismatches;
+  long round;
+  long t;
+  long w;
+  long i;
+  int r;
+  int opt;
+
+  if (threads < 1)
+    threads = 1;
+  while ((opt = getopt (argc, argv, "n:s:r:t:e:")) != -1)
+    switch (opt)
+    {
+    case 'n':
+      count = atol (optarg);
+      break;
+    case 's':
+      stress_count = atol (optarg);
+      break;
+    case 'r':
+      rounds = atol (optarg);
+      break;
+    case 't':
+      threads = atol (optarg);
+      break;
+    case 'e':
+      ellipsoid_code = optarg;
+      break;
+    default:
+      fprintf (stderr, "usage: %s [-n points] [-s stress_points] [-r rounds] [-t threads]"
+               " [-e ellipsoid_code]\n", argv[0]);
+      return (1);
+    }
+  if ((count < 1) || (stress_count < 1) || (rounds < 1) || (threads < 1))
+  {
+    fprintf (stderr, "need at least 1 point, stress point, round and thread\n");
+    return (1);
+  }
+  if (stress_count > count)
+    stress_count = count;
+  if (Set_MGRS_Datum_R (&parameters, ellipsoid_code))
+  {
+    fprintf (stderr, "unknown ellipsoid code %s\n", ellipsoid_code);
+    return (1);
+  }
+
+  for (i = 0; i < count; i++)
+  {
+    if (i % 10 == 0)
+    {
+      latitude = (i % 20) ? 56.0 + 8.0 * uniform (&seed) : 72.0 + 12.0 * uniform (&seed);
+      longitude = (i % 20) ? 12.0 * uniform (&seed) : 42.0 * uniform (&seed);
+    }
+    else if (i % 100 == 1)
+    {
+      latitude = 84.0 + 10.0 * uniform (&seed);
+      longitude = -200.0 + 600.0 * uniform (&seed);
+    }
+    else
+    {
+      latitude = -80.0 + 164.0 * uniform (&seed);
+      longitude = -180.0 + 360.0 * uniform (&seed);
+    }
+    lat.push_back (latitude * DEG_TO_RAD);
+    lon.push_back (longitude * DEG_TO_RAD);
+  }
+  reference.resize (count);
+  convert_range (&parameters, lat, lon, 0, count, &reference[0]);
+  fprintf (stderr, "reference done\n");
+
+  printf ("{\n  \"ellipsoid_code\": \"%s\", \"points\": %ld, \"hardware_threads\": %u,\n"
+          "  \"scaling\": [", parameters.Ellipsoid_Code, count,
+          std::thread::hardware_concurrency ());
+  results.resize (count);
+  for (t = 1; ; t = (2 * t < threads) ? 2 * t : threads)
+  {
+    best = 1e30;
+    mismatches = 0;
+    for (r = 0; r < THREAD_REPEATS; r++)
+    {
+      memset (&results[0], 0xa5, count * sizeof (Result));
+      pool.clear ();
+      time = now ();
+      for (w = 0; w < t; w++)
+        pool.push_back (std::thread (convert_range, &parameters, std::cref (lat), std::cref (lon),
+                                     count * w / t, count * (w + 1) / t - count * w / t,
+                                     &results[count * w / t]));
+      for (w = 0; w < t; w++)
+        pool[w].join ();
+      time = now () - time;
+      if (time < best)
+        best = time;
+      mismatches += count_mismatches (results, reference, 0, count);
+    }
+    if (t == 1)
+      single_time = best;
+    total_mismatches += mismatches;
+    printf ("%s\n    {\"threads\": %ld, \"seconds\": %.3f, \"points_per_sec\": %.0f,"
+            " \"speedup\": %.2f, \"efficiency\": %.2f, \"mismatches\": %ld}", (t > 1) ? "," : "",
+            t, best, count / best, single_time / best, single_time / best / t, mismatches);
+    fflush (stdout);
+    if (t == threads)
+      break;
+  }
+
+  /* Every thread over the same points at once, each from its own offset */
+  stress.resize (threads);
+  for (w = 0; w < threads; w++)
+    stress[w].resize (stress_count);
+  for (round = 0; round < rounds; round++)
+  {
+    pool.clear ();
+    ready = 0;
+    for (w = 0; w < threads; w++)
+      pool.push_back (std::thread ([&, w] ()
+        {
+          long offset = stress_count * w / threads;
+          long k;
+
+          ready++;
+          while (ready < threads)
+            std::this_thread::yield ();
+          for (k = 0; k < stress_count; k++)
+          {
+            long j = (offset + k) % stress_count;
+
+            convert_point (&parameters, lat[j], lon[j], j % (MAX_PRECISION + 1), &stress[w][j]);
+          }
+        }));
+    for (w = 0; w < threads; w++)
+      pool[w].join ();
+    for (w = 0; w < threads; w++)
+      stress_mismatches += count_mismatches (stress[w], reference, 0, stress_count);
+  }
+  total_mismatches += stress_mismatches;
+
+  printf ("\n  ],\n  \"stress\": {\"threads\": %ld, \"points\": %ld, \"rounds\": %ld,"
+          " \"conversions\": %ld, \"mismatches\": %ld},\n", threads, stress_count, rounds,
+          threads * rounds * stress_count, stress_mismatches);
+  printf ("  \"mismatches\": %ld\n}\n", total_mismatches);
+  return (total_mismatches ? 1 : 0);
+}
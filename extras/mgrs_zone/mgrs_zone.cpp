@@ -0,0 +1,536 @@
+/*
+ * Equivalence check and benchmark of the table driven zone selection of
+ * Get_UTM_Zone_R and Get_MGRS_Zone_R against the chain of tests and the
+ * second projection they replace.  Not part of the sketch; build and run
+ * it on the host:
+ *
+ *   g++ -O2 -std=gnu++11 -I../.. mgrs_zone.cpp -o mgrs_zone
+ *   ./mgrs_zone [-n points] [-s step_degrees] > results.json
+ *
+ * The reference is the selection as it was: reference_zone is the chain
+ * of whole degree tests, and reference_mgrs projects in that zone and,
+ * for a point of 31V at or east of its central meridian, projects again
+ * in zone 32.  Get_UTM_Zone_R must agree with reference_zone on every
+ * whole degree cell of the grid, at its corners, its centre and the
+ * doubles next to its edges, with every zone override, and Get_UTM_Zone_
+ * Microdegrees with reference_zone_microdegrees, its own chain of tests,
+ * at the same places in microdegrees.  Convert_Geodetic_
+ * To_MGRS_R must give the reference's string and error code at every
+ * precision on a grid of -s degrees (default 0.01) over 55.5 to 64.5
+ * degrees north and 1 degree west to 13 east, and at the doubles next to
+ * each whole degree edge there, the 3 degree meridian included.  Timings
+ * are per point over -n random points (default 1000000) in 56 to 64
+ * degrees north and 0 to 12 east, the fastest of ZONE_REPEATS runs.
+ * reference_reconverted counts the points the reference projected twice;
+ * it is the only work the single pass saves, so the conversion timings
+ * differ by no more than the compiler's different inlining of the
+ * reference, which is built into this file, and of the library.
+ */
+
+#include "../../mgrs_float.h"
+#include "../mgrs_host.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <vector>
+
+#define ZONE_REPEATS    5
+#define EDGE_DOUBLES    4       /* Doubles tried on each side of an edge */
+#define EDGE_MICRODEGREES  3    /* Microdegrees tried on each side of an edge */
+#define STRING_SIZE     16
+
+struct Check
+{
+  long points;
+  long mismatches;
+  long reconverted;
+};
+
+/* Get_UTM_Zone_R as it was, with the special cases as a chain of tests */
+static long reference_zone (const UTM_Parameters *parameters, double *latitude,
+                            double *longitude, long *zone)
+{
+  long lat_degrees;
+  long long_degrees;
+  long temp_zone;
+  long error_code = UTM_NO_ERROR;
+
+  if ((*latitude < MIN_LAT) || (*latitude > MAX_LAT_UTM))
+    error_code |= UTM_LAT_ERROR;
+  if ((*longitude < -PI) || (*longitude > (2 * PI)))
+    error_code |= UTM_LON_ERROR;
+  if (error_code)
+    return (error_code);
+  if ((*latitude > -1.0e-9) && (*latitude < 0))
+    *latitude = 0.0;
+  if (*longitude < 0)
+    *longitude += (2 * PI) + 1.0e-10;
+
+  lat_degrees = (long)(*latitude * 180.0 / PI);
+  long_degrees = (long)(*longitude * 180.0 / PI);
+  if (*longitude < PI)
+    temp_zone = (long)(31 + ((*longitude * 180.0 / PI) / 6.0));
+  else
+    temp_zone = (long)(((*longitude * 180.0 / PI) / 6.0) - 29);
+  if (temp_zone > 60)
+    temp_zone = 1;
+  if ((lat_degrees > 55) && (lat_degrees < 64) && (long_degrees > -1) && (long_degrees < 3))
+    temp_zone = 31;
+  if ((lat_degrees > 55) && (lat_degrees < 64) && (long_degrees > 2) && (long_degrees < 12))
+    temp_zone = 32;
+  if ((lat_degrees > 71) && (long_degrees > -1) && (long_degrees < 9))
+    temp_zone = 31;
+  if ((lat_degrees > 71) && (long_degrees > 8) && (long_degrees < 21))
+    temp_zone = 33;
+  if ((lat_degrees > 71) && (long_degrees > 20) && (long_degrees < 33))
+    temp_zone = 35;
+  if ((lat_degrees > 71) && (long_degrees > 32) && (long_degrees < 42))
+    temp_zone = 37;
+
+  if (parameters->Override)
+  {
+    if ((temp_zone == 1) && (parameters->Override == 60))
+      temp_zone = parameters->Override;
+    else if ((temp_zone == 60) && (parameters->Override == 1))
+      temp_zone = parameters->Override;
+    else if ((lat_degrees > 71) && (long_degrees > -1) && (long_degrees < 42))
+    {
+      if (((temp_zone - 2) <= parameters->Override) && (parameters->Override <= (temp_zone + 2)))
+        temp_zone = parameters->Override;
+      else
+        error_code = UTM_ZONE_OVERRIDE_ERROR;
+    }
+    else if (((temp_zone - 1) <= parameters->Override)
+             && (parameters->Override <= (temp_zone + 1)))
+      temp_zone = parameters->Override;
+    else
+      error_code = UTM_ZONE_OVERRIDE_ERROR;
+  }
+  if (!error_code)
+    *zone = temp_zone;
+  return (error_code);
+}
+
+/* Get_UTM_Zone_Microdegrees as it was, with the chain of tests */
+static long reference_zone_microdegrees (long Override, long Latitude, long Longitude,
+                                         long *Zone)
+{
+  long Lat_Degrees;
+  long Long_Degrees;
+  long temp_zone;
+  long Error_Code = UTM_NO_ERROR;
+
+  if (Longitude < 0)
+    Longitude += 360 * MICRODEGREES;
+
+  Lat_Degrees = Latitude / MICRODEGREES;
+  Long_Degrees = Longitude / MICRODEGREES;
+
+  if (Longitude < 180 * MICRODEGREES)
+    temp_zone = 31 + Longitude / (6 * MICRODEGREES);
+  else
+    temp_zone = Longitude / (6 * MICRODEGREES) - 29;
+
+  if (temp_zone > 60)
+    temp_zone = 1;
+  /* UTM special cases */
+  if ((Lat_Degrees > 55) && (Lat_Degrees < 64) && (Long_Degrees < 3))
+    temp_zone = 31;
+  if ((Lat_Degrees > 55) && (Lat_Degrees < 64) && (Long_Degrees > 2)
+      && (Long_Degrees < 12))
+    temp_zone = 32;
+  if ((Lat_Degrees > 71) && (Long_Degrees < 9))
+    temp_zone = 31;
+  if ((Lat_Degrees > 71) && (Long_Degrees > 8) && (Long_Degrees < 21))
+    temp_zone = 33;
+  if ((Lat_Degrees > 71) && (Long_Degrees > 20) && (Long_Degrees < 33))
+    temp_zone = 35;
+  if ((Lat_Degrees > 71) && (Long_Degrees > 32) && (Long_Degrees < 42))
+    temp_zone = 37;
+
+  if (Override)
+  {
+    if ((temp_zone == 1) && (Override == 60))
+      temp_zone = Override;
+    else if ((temp_zone == 60) && (Override == 1))
+      temp_zone = Override;
+    else if ((Lat_Degrees > 71) && (Long_Degrees < 42))
+    {
+      if (((temp_zone-2) <= Override) && (Override <= (temp_zone+2)))
+        temp_zone = Override;
+      else
+        Error_Code = UTM_ZONE_OVERRIDE_ERROR;
+    }
+    else if (((temp_zone-1) <= Override) && (Override <= (temp_zone+1)))
+      temp_zone = Override;
+    else
+      Error_Code = UTM_ZONE_OVERRIDE_ERROR;
+  }
+  *Zone = temp_zone;
+  return (Error_Code);
+}
+
+static long mgrs_error (long utm_error_code)
+{
+  long error_code = MGRS_NO_ERROR;
+
+  if (utm_error_code & UTM_LAT_ERROR)
+    error_code |= MGRS_LAT_ERROR;
+  if (utm_error_code & UTM_LON_ERROR)
+    error_code |= MGRS_LON_ERROR;
+  if (utm_error_code & UTM_ZONE_OVERRIDE_ERROR)
+    error_code |= MGRS_ZONE_ERROR;
+  if (utm_error_code & UTM_EASTING_ERROR)
+    error_code |= MGRS_EASTING_ERROR;
+  if (utm_error_code & UTM_NORTHING_ERROR)
+    error_code |= MGRS_NORTHING_ERROR;
+  return (error_code);
+}
+
+/* Convert_Geodetic_To_MGRS_R as it was: project, then maybe project again */
+static long reference_mgrs (double latitude, double longitude, long precision, char *mgrs,
+                            long *reconverted)
+{
+  const MGRS_Parameters *parameters = &MGRS_Default_Parameters;
+  UTM_Parameters zone_32;
+  int letters[MGRS_LETTERS];
+  double la = latitude;
+  double lo = longitude;
+  double easting;
+  double northing;
+  double easting_bound = 0.0;
+  double northing_bound;
+  char hemisphere;
+  long zone;
+  long utm_error_code;
+
+  if ((latitude < -PI_OVER_2) || (latitude > PI_OVER_2) || (longitude < -PI)
+      || (longitude > (2 * PI)) || (precision < 0) || (precision > MAX_PRECISION))
+    return (Convert_Geodetic_To_MGRS_R (parameters, latitude, longitude, precision, mgrs));
+  utm_error_code = reference_zone (&parameters->UTM, &la, &lo, &zone);
+  if (!utm_error_code)
+    utm_error_code = Convert_Geodetic_To_UTM_Zone_R (&parameters->UTM, la, lo, zone,
+                                                     MGRS_Precision_Terms[precision],
+                                                     &hemisphere, &easting, &northing,
+                                                     &easting_bound, &northing_bound);
+  if ((easting_bound > 0.0)
+      && (utm_error_code || Near_MGRS_Digit_Change (easting, easting_bound, precision)
+          || Near_MGRS_Digit_Change (northing, northing_bound, precision)))
+    utm_error_code = Convert_Geodetic_To_UTM_Zone_R (&parameters->UTM, la, lo, zone,
+                                                     TRANMERC_EXACT_TERMS, &hemisphere,
+                                                     &easting, &northing, &easting_bound,
+                                                     &northing_bound);
+  if (utm_error_code)
+    return (mgrs_error (utm_error_code));
+
+  if ((zone == 31) && (latitude >= 56.0 * DEG_TO_RAD) && (latitude < 64.0 * DEG_TO_RAD)
+      && ((longitude >= 3.0 * DEG_TO_RAD) || (easting >= 500000.0)))
+  {
+    zone_32 = parameters->UTM;
+    zone_32.Override = 32;
+    (*reconverted)++;
+    utm_error_code = Convert_Geodetic_To_UTM_R (&zone_32, latitude, longitude, &zone,
+                                                &hemisphere, &easting, &northing);
+    if (utm_error_code)
+      return (mgrs_error (utm_error_code));
+  }
+  if (UTM_To_MGRS_Letters_R (parameters, zone, latitude, &easting, &northing, letters))
+    return (MGRS_LAT_ERROR);
+  Make_MGRS_String (mgrs, zone, letters, easting, northing, precision);
+  return (MGRS_NO_ERROR);
+}
+
+/* Get_UTM_Zone_R against reference_zone at one point, every override */
+static void check_zone_point (double latitude, double longitude, Check *check)
+{
+  UTM_Parameters parameters = MGRS_Default_Parameters.UTM;
+  double la[2];
+  double lo[2];
+  long zone[2];
+  long error_code[2];
+
+  for (parameters.Override = 0; parameters.Override <= 60; parameters.Override++)
+  {
+    la[0] = la[1] = latitude;
+    lo[0] = lo[1] = longitude;
+    zone[0] = zone[1] = 0;
+    error_code[0] = Get_UTM_Zone_R (&parameters, &la[0], &lo[0], &zone[0]);
+    error_code[1] = reference_zone (&parameters, &la[1], &lo[1], &zone[1]);
+    check->points++;
+    if ((error_code[0] != error_code[1]) || (zone[0] != zone[1]) || (la[0] != la[1])
+        || (lo[0] != lo[1]))
+    {
+      if (check->mismatches++ < 10)
+        fprintf (stderr, "zone of %.17g %.17g, override %ld: %ld, reference %ld\n",
+                 latitude * RAD_TO_DEG, longitude * RAD_TO_DEG, parameters.Override, zone[0],
+                 zone[1]);
+    }
+  }
+}
+
+/* Get_UTM_Zone_Microdegrees against its chain at one point, every override */
+static void check_microdegree_point (long latitude, long longitude, Check *check)
+{
+  long override;
+  long zone[2];
+  long error_code[2];
+
+  if ((latitude < -80500000L) || (latitude > 84500000L) || (longitude < -180 * MICRODEGREES)
+      || (longitude > 360 * MICRODEGREES))
+    return;
+  for (override = 0; override <= 60; override++)
+  {
+    zone[0] = zone[1] = 0;
+    error_code[0] = Get_UTM_Zone_Microdegrees (override, latitude, longitude, &zone[0]);
+    error_code[1] = reference_zone_microdegrees (override, latitude, longitude, &zone[1]);
+    check->points++;
+    if ((error_code[0] != error_code[1]) || (zone[0] != zone[1]))
+    {
+      if (check->mismatches++ < 10)
+        fprintf (stderr, "zone of %ld %ld microdegrees, override %ld: %ld, reference %ld\n",
+                 latitude, longitude, override, zone[0], zone[1]);
+    }
+  }
+}
+
+/* Convert_Geodetic_To_MGRS_R against reference_mgrs at every precision */
+static void check_mgrs_point (double latitude, double longitude, Check *check)
+{
+  char mgrs[STRING_SIZE];
+  char expected[STRING_SIZE];
+  long error_code;
+  long expected_error_code;
+  long precision;
+
+  for (precision = 0; precision <= MAX_PRECISION; precision++)
+  {
+    mgrs[0] = expected[0] = 0;
+    error_code = Convert_Geodetic_To_MGRS_R (&MGRS_Default_Parameters, latitude, longitude,
+                                             precision, mgrs);
+    expected_error_code = reference_mgrs (latitude, longitude, precision, expected,
+                                          &check->reconverted);
+    check->points++;
+    if ((error_code != expected_error_code) || (!error_code && strcmp (mgrs, expected)))
+    {
+      if (check->mismatches++ < 10)
+        fprintf (stderr, "%.17g %.17g precision %ld: %s (%ld), reference %s (%ld)\n",
+                 latitude * RAD_TO_DEG, longitude * RAD_TO_DEG, precision, mgrs, error_code,
+                 expected, expected_error_code);
+    }
+  }
+}
+
+/* A point and the doubles next to it on each side */
+static void check_edge (double latitude, double longitude, int along_longitude,
+                        void (*check_point) (double, double, Check *), Check *check)
+{
+  double below = along_longitude ? longitude : latitude;
+  double above = below;
+  int k;
+
+  for (k = 0; k < EDGE_DOUBLES; k++)
+  {
+    below = nextafter (below, -10.0);
+    if (along_longitude)
+    {
+      check_point (latitude, below, check);
+      check_point (latitude, above, check);
+    }
+    else
+    {
+      check_point (below, longitude, check);
+      check_point (above, longitude, check);
+    }
+    above = nextafter (above, 10.0);
+  }
+}
+
+static void print_check (const char *name, const Check &check, int first)
+{
+  printf ("%s\n    {\"check\": \"%s\", \"points\": %ld, \"mismatches\": %ld,"
+          " \"reference_reconverted\": %ld}", first ? "" : ",", name, check.points,
+          check.mismatches, check.reconverted);
+  fflush (stdout);
+}
+
+int main (int argc, char **argv)
+{
+  std::vector<double> lat;
+  std::vector<double> lon;
+  UTM_Parameters parameters = MGRS_Default_Parameters.UTM;
+  Check zone_check = {0, 0, 0};
+  Check microdegree_check = {0, 0, 0};
+  Check mgrs_check = {0, 0, 0};
+  Check edge_check = {0, 0, 0};
+  char mgrs[STRING_SIZE];
+  double step = 0.01;
+  double latitude;
+  double longitude;
+  double la;
+  double lo;
+  double time;
+  double table_time = 1e30;
+  double chain_time = 1e30;
+  double new_time[MAX_PRECISION + 1];
+  double old_time[MAX_PRECISION + 1];
+  long count = 1000000;
+  long reconverted = 0;
+  long zone;
+  long sink = 0;
+  long lat_degrees;
+  long long_degrees;
+  long d;
+  long precision;
+  long i;
+  int r;
+  int opt;
+
+  while ((opt = getopt (argc, argv, "n:s:")) != -1)
+    switch (opt)
+    {
+    case 'n':
+      count = atol (optarg);
+      break;
+    case 's':
+      step = atof (optarg);
+      break;
+    default:
+      fprintf (stderr, "usage: %s [-n points] [-s step_degrees]\n", argv[0]);
+      return (1);
+    }
+  if ((count < 1) || (step <= 0.0))
+  {
+    fprintf (stderr, "need at least 1 point and a positive step\n");
+    return (1);
+  }
+
+  /* Every whole degree cell: corners, centre and the doubles by its edges */
+  for (lat_degrees = -81; lat_degrees <= 84; lat_degrees++)
+    for (long_degrees = -180; long_degrees < 360; long_degrees++)
+    {
+      latitude = lat_degrees * DEG_TO_RAD;
+      longitude = long_degrees * DEG_TO_RAD;
+      check_zone_point ((lat_degrees + 0.5) * DEG_TO_RAD, (long_degrees + 0.5) * DEG_TO_RAD,
+                        &zone_check);
+      check_edge (latitude, (long_degrees + 0.5) * DEG_TO_RAD, FALSE, check_zone_point,
+                  &zone_check);
+      check_edge ((lat_degrees + 0.5) * DEG_TO_RAD, longitude, TRUE, check_zone_point,
+                  &zone_check);
+      check_edge (latitude, longitude, TRUE, check_zone_point, &zone_check);
+    }
+  /* The same in microdegrees, either side of each edge */
+  for (lat_degrees = -81; lat_degrees <= 84; lat_degrees++)
+    for (long_degrees = -180; long_degrees < 360; long_degrees++)
+    {
+      check_microdegree_point (lat_degrees * MICRODEGREES + MICRODEGREES / 2,
+                               long_degrees * MICRODEGREES + MICRODEGREES / 2, &microdegree_check);
+      for (d = -EDGE_MICRODEGREES; d <= EDGE_MICRODEGREES; d++)
+      {
+        check_microdegree_point (lat_degrees * MICRODEGREES + d,
+                                 long_degrees * MICRODEGREES + MICRODEGREES / 2,
+                                 &microdegree_check);
+        check_microdegree_point (lat_degrees * MICRODEGREES + MICRODEGREES / 2,
+                                 long_degrees * MICRODEGREES + d, &microdegree_check);
+        check_microdegree_point (lat_degrees * MICRODEGREES + d, long_degrees * MICRODEGREES + d,
+                                 &microdegree_check);
+      }
+    }
+  fprintf (stderr, "zones checked\n");
+
+  /* The grid around Norway, and the doubles by each whole degree there */
+  for (latitude = 55.5; latitude < 64.5; latitude += step)
+    for (longitude = -1.0; longitude < 13.0; longitude += step)
+      check_mgrs_point (latitude * DEG_TO_RAD, longitude * DEG_TO_RAD, &mgrs_check);
+  fprintf (stderr, "grid checked\n");
+  for (lat_degrees = 55; lat_degrees <= 64; lat_degrees++)
+    for (longitude = -1.0; longitude < 13.0; longitude += 10 * step)
+      check_edge (lat_degrees * DEG_TO_RAD, longitude * DEG_TO_RAD, FALSE, check_mgrs_point,
+                  &edge_check);
+  for (long_degrees = -1; long_degrees <= 13; long_degrees++)
+    for (latitude = 55.5; latitude < 64.5; latitude += 10 * step)
+    {
+      check_edge (latitude * DEG_TO_RAD, long_degrees * DEG_TO_RAD, TRUE, check_mgrs_point,
+                  &edge_check);
+      /* Within the 2e-10 radians the projection rounds to the meridian */
+      if (long_degrees == 3)
+        for (i = -30; i <= 30; i++)
+          check_mgrs_point (latitude * DEG_TO_RAD,
+                            UTM_Zone_Projection[30][0].Origin_Long + i * 1.0e-11, &edge_check);
+    }
+  fprintf (stderr, "edges checked\n");
+
+  unsigned long long seed = 42;
+  for (i = 0; i < count; i++)
+  {
+    lat.push_back ((56.0 + 8.0 * uniform (&seed)) * DEG_TO_RAD);
+    lon.push_back (12.0 * uniform (&seed) * DEG_TO_RAD);
+  }
+  for (r = 0; r < ZONE_REPEATS; r++)
+  {
+    time = now ();
+    for (i = 0; i < count; i++)
+    {
+      la = lat[i];
+      lo = lon[i];
+      Get_UTM_Zone_R (&parameters, &la, &lo, &zone);
+      sink += zone;
+    }
+    time = now () - time;
+    if (time < table_time)
+      table_time = time;
+    time = now ();
+    for (i = 0; i < count; i++)
+    {
+      la = lat[i];
+      lo = lon[i];
+      reference_zone (&parameters, &la, &lo, &zone);
+      sink += zone;
+    }
+    time = now () - time;
+    if (time < chain_time)
+      chain_time = time;
+  }
+  for (precision = 0; precision <= MAX_PRECISION; precision++)
+  {
+    new_time[precision] = old_time[precision] = 1e30;
+    for (r = 0; r < ZONE_REPEATS; r++)
+    {
+      time = now ();
+      for (i = 0; i < count; i++)
+        Convert_Geodetic_To_MGRS_R (&MGRS_Default_Parameters, lat[i], lon[i], precision, mgrs);
+      time = now () - time;
+      if (time < new_time[precision])
+        new_time[precision] = time;
+      reconverted = 0;
+      time = now ();
+      for (i = 0; i < count; i++)
+        reference_mgrs (lat[i], lon[i], precision, mgrs, &reconverted);
+      time = now () - time;
+      if (time < old_time[precision])
+        old_time[precision] = time;
+    }
+  }
+
+  printf ("{\n  \"checks\": [");
+  print_check ("utm_zone_every_degree_and_override", zone_check, TRUE);
+  print_check ("utm_zone_microdegrees_every_degree_and_override", microdegree_check, FALSE);
+  print_check ("mgrs_grid_every_precision", mgrs_check, FALSE);
+  print_check ("mgrs_degree_edges_every_precision", edge_check, FALSE);
+  printf ("\n  ],\n  \"timings\": {\"points\": %ld, \"reference_reconverted\": %ld,"
+          " \"zone_table_ns\": %.1f, \"zone_chain_ns\": %.1f,\n    \"mgrs_ns\": [",
+          count, reconverted, table_time * 1e9 / count, chain_time * 1e9 / count);
+  for (precision = 0; precision <= MAX_PRECISION; precision++)
+    printf ("%s\n      {\"precision\": %ld, \"single_pass\": %.1f, \"reference\": %.1f}",
+            precision ? "," : "", precision, new_time[precision] * 1e9 / count,
+            old_time[precision] * 1e9 / count);
+  printf ("\n    ]\n  },\n  \"mismatches\": %ld\n}\n",
+          zone_check.mismatches + microdegree_check.mismatches + mgrs_check.mismatches
+          + edge_check.mismatches);
+  fprintf (stderr, "checksum %ld\n", sink);
+  return ((zone_check.mismatches + microdegree_check.mismatches + mgrs_check.mismatches
+           + edge_check.mismatches) ? 1 : 0);
+}
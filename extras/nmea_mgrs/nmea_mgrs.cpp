@@ -0,0 +1,434 @@
+/*
+ * Streams NMEA 0183 from a file, pipe or pty into timestamped MGRS
+ * records.  Not part of the sketch; build and run it on the host:
+ *
+ *   g++ -O2 -std=gnu++11 -I../.. nmea_mgrs.cpp -o nmea_mgrs
+ *   ./nmea_mgrs [-p precision] [-d] [file] > records.txt
+ *   ./nmea_mgrs -g bytes > synthetic.nmea
+ *
+ * Input is read in large blocks and every GGA and RMC sentence is parsed
+ * in place in the read buffer with Parse_NMEA_Sentence; only the partial
+ * sentence at the end of a block is moved, to the front of the buffer.
+ * Fixes are collected FIX_BATCH at a time and converted with an
+ * MGRS_Tracker (or, with -d, Convert_Geodetic_To_MGRS in double
+ * precision), one record per epoch:
+ *
+ *   2024-05-01T12:34:56.700Z 32VNM9724636209
+ *
+ * The date is that of the latest RMC sentence; records before the first
+ * one have the time only.  With no file, or "-", stdin is read.  Counts
+ * and throughput go to stderr as one JSON object when the input ends.
+ *
+ * -g writes a synthetic log of about the given number of bytes: GGA and
+ * RMC at 10 Hz along a wandering track through several zones, with a GSV
+ * sentence every second and a corrupted checksum now and then.
+ */
+
+#include "../../nmea.h"
+#include "../../mgrs_tracker.h"
+#include "../mgrs_host.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define READ_BUFFER     (1L << 20)
+#define WRITE_BUFFER    (1L << 20)
+#define MAX_RECORD      64            /* Longest output record */
+#define FIX_BATCH       256
+
+struct Stats
+{
+  long long bytes;
+  long long sentences;
+  long long fixes;
+  long long records;
+  long long checksum_errors;
+  long long format_errors;
+  long long other_sentences;
+  long long no_fix;
+  long long mgrs_errors;
+};
+
+struct Output
+{
+  int fd;
+  long used;
+  char buffer[WRITE_BUFFER + MAX_RECORD];
+};
+
+struct Converter
+{
+  MGRS_Tracker tracker;
+  long precision;
+  int use_double;
+  long date;            /* ddmmyy of the latest RMC, -1 for none */
+  long last_time;       /* Time of the last epoch written, -1 for none */
+  long count;
+  NMEA_Fix fix[FIX_BATCH];
+};
+
+static void flush_output (Output &out)
+{
+  long done = 0;
+  long n;
+
+  while (done < out.used)
+  {
+    n = write (out.fd, out.buffer + done, out.used - done);
+    if (n < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      perror ("write");
+      exit (1);
+    }
+    done += n;
+  }
+  out.used = 0;
+}
+
+static char *put_digits (char *p, long value, long digits)
+{
+  long i;
+
+  for (i = digits - 1; i >= 0; i--)
+  {
+    p[i] = (char)('0' + value % 10);
+    value /= 10;
+  }
+  return (p + digits);
+}
+
+/* Converts the batched fixes and appends a record per new epoch to out */
+static void convert_batch (Converter &c, Output &out, Stats &s)
+{
+  long i;
+  long t;
+  char *p;
+
+  for (i = 0; i < c.count; i++)
+  {
+    const NMEA_Fix &f = c.fix[i];
+    long error_code;
+
+    if (f.Type == NMEA_RMC)
+      c.date = f.Date;
+    if (f.Time == c.last_time)
+      continue;     /* GGA and RMC of the same epoch give one record */
+
+    p = out.buffer + out.used;
+    if (c.date >= 0)
+    {
+      t = c.date % 100;
+      p = put_digits (p, (t < 80) ? 2000 + t : 1900 + t, 4);
+      *p++ = '-';
+      p = put_digits (p, (c.date / 100) % 100, 2);
+      *p++ = '-';
+      p = put_digits (p, c.date / 10000, 2);
+    }
+    *p++ = 'T';
+    t = f.Time;
+    p = put_digits (p, t / 3600000, 2);
+    *p++ = ':';
+    p = put_digits (p, (t / 60000) % 60, 2);
+    *p++ = ':';
+    p = put_digits (p, (t / 1000) % 60, 2);
+    *p++ = '.';
+    p = put_digits (p, t % 1000, 3);
+    *p++ = 'Z';
+    *p++ = ' ';
+
+    if (c.use_double)
+      error_code = Convert_Geodetic_To_MGRS (f.Latitude * (DEG_TO_RAD / 1.0e6),
+                                             f.Longitude * (DEG_TO_RAD / 1.0e6),
+                                             c.precision, p);
+    else
+      error_code = Update_MGRS_Tracker (&c.tracker, f.Latitude, f.Longitude,
+                                        c.precision, p);
+    if (error_code)
+    {
+      s.mgrs_errors++;
+      continue;
+    }
+    p += 5 + 2 * c.precision;
+    *p++ = '\n';
+    out.used = p - out.buffer;
+    c.last_time = f.Time;
+    s.records++;
+    if (out.used >= WRITE_BUFFER)
+      flush_output (out);
+  }
+  c.count = 0;
+}
+
+static void parse_sentence (const char *Start, const char *End, Converter &c,
+                            Output &out, Stats &s)
+{
+  long error_code = Parse_NMEA_Sentence (Start, End, &c.fix[c.count]);
+
+  s.sentences++;
+  if (error_code == NMEA_NO_ERROR)
+  {
+    s.fixes++;
+    if (++c.count == FIX_BATCH)
+      convert_batch (c, out, s);
+  }
+  else if (error_code & NMEA_CHECKSUM_ERROR)
+    s.checksum_errors++;
+  else if (error_code & NMEA_SENTENCE_ERROR)
+    s.other_sentences++;
+  else if (error_code & NMEA_FIX_ERROR)
+    s.no_fix++;
+  else
+    s.format_errors++;
+}
+
+static int convert (int fd, long precision, int use_double)
+{
+  static char buffer[READ_BUFFER];
+  static Output out;
+  static Converter c;
+  Stats s;
+  long filled = 0;
+  long n;
+  const char *p;
+  const char *start;
+  const char *line_end;
+  double t = now ();
+
+  memset (&s, 0, sizeof (s));
+  out.fd = 1;
+  out.used = 0;
+  Init_MGRS_Tracker (&c.tracker, &MGRS_Float_Default_Parameters);
+  c.precision = precision;
+  c.use_double = use_double;
+  c.date = -1;
+  c.last_time = -1;
+  c.count = 0;
+
+  for (;;)
+  {
+    n = read (fd, buffer + filled, READ_BUFFER - filled);
+    if (n < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      perror ("read");
+      return (1);
+    }
+    s.bytes += n;
+    p = buffer;
+    if (n == 0)
+    {
+      /* A last sentence without a line ending */
+      start = (const char *)memchr (p, '$', filled);
+      if (start)
+        parse_sentence (start, buffer + filled, c, out, s);
+      break;
+    }
+    filled += n;
+
+    for (;;)
+    {
+      start = (const char *)memchr (p, '$', buffer + filled - p);
+      if (!start)
+      {
+        p = buffer + filled;
+        break;
+      }
+      line_end = (const char *)memchr (start, '\n', buffer + filled - start);
+      if (!line_end)
+      {
+        p = start;
+        break;
+      }
+      parse_sentence (start, line_end, c, out, s);
+      p = line_end + 1;
+    }
+
+    /* Keep the partial sentence, unless it is too long to be one */
+    filled = buffer + filled - p;
+    if (filled > 4 * NMEA_MAX_SENTENCE)
+      filled = 0;
+    memmove (buffer, p, filled);
+  }
+  convert_batch (c, out, s);
+  flush_output (out);
+
+  t = now () - t;
+  fprintf (stderr, "{\"bytes\": %lld, \"sentences\": %lld, \"fixes\": %lld, \"records\": %lld,\n"
+           " \"checksum_errors\": %lld, \"format_errors\": %lld, \"other_sentences\": %lld,\n"
+           " \"no_fix\": %lld, \"mgrs_errors\": %lld, \"seconds\": %.3f,\n"
+           " \"sentences_per_sec\": %.0f, \"mb_per_sec\": %.1f}\n",
+           s.bytes, s.sentences, s.fixes, s.records, s.checksum_errors, s.format_errors,
+           s.other_sentences, s.no_fix, s.mgrs_errors, t, s.sentences / t,
+           s.bytes / t / 1.0e6);
+  return (0);
+}
+
+static char *put_text (char *p, const char *Text)
+{
+  long n = strlen (Text);
+
+  memcpy (p, Text, n);
+  return (p + n);
+}
+
+/* Writes a time of day in milliseconds as hhmmss.ss */
+static char *put_time (char *p, long Time)
+{
+  p = put_digits (p, Time / 3600000, 2);
+  p = put_digits (p, (Time / 60000) % 60, 2);
+  p = put_digits (p, (Time / 1000) % 60, 2);
+  *p++ = '.';
+  return (put_digits (p, (Time % 1000) / 10, 2));
+}
+
+/* Appends "*hh\r\n" to the sentence from Start ('$') to p */
+static char *end_sentence (char *Start, char *p)
+{
+  static const char hex[] = "0123456789ABCDEF";
+  long checksum = 0;
+  char *q;
+
+  for (q = Start + 1; q < p; q++)
+    checksum ^= *q;
+  *p++ = '*';
+  *p++ = hex[checksum >> 4];
+  *p++ = hex[checksum & 15];
+  *p++ = '\r';
+  *p++ = '\n';
+  return (p);
+}
+
+/* Writes an angle in microdegrees as (d)ddmm.mmmmm,H */
+static char *put_angle (char *p, long Angle, long Degree_Digits, char Positive, char Negative)
+{
+  long a = (Angle < 0) ? -Angle : Angle;
+  long long minutes = ((long long)(a % 1000000) * 60 + 5) / 10;  /* 1e-5 minutes */
+
+  if (minutes >= 6000000)
+  {
+    minutes -= 6000000;
+    a += 1000000;
+  }
+  p = put_digits (p, a / 1000000, Degree_Digits);
+  p = put_digits (p, (long)(minutes / 100000), 2);
+  *p++ = '.';
+  p = put_digits (p, (long)(minutes % 100000), 5);
+  *p++ = ',';
+  *p++ = (Angle < 0) ? Negative : Positive;
+  return (p);
+}
+
+static int generate (long long Bytes)
+{
+  static Output out;
+  long long written = 0;
+  long lat = 47000000L;     /* Microdegrees */
+  long lon = -3000000L;
+  long dlat = 3;
+  long dlon = 40;           /* About 30 m/s east */
+  long time = 0;            /* Milliseconds of the day */
+  long day = 1;
+  long epoch = 0;
+  char *p;
+  char *start;
+
+  out.fd = 1;
+  out.used = 0;
+  while (written < Bytes)
+  {
+    p = out.buffer + out.used;
+
+    start = p;
+    p = put_time (put_text (p, "$GPGGA,"), time);
+    *p++ = ',';
+    p = put_angle (p, lat, 2, 'N', 'S');
+    *p++ = ',';
+    p = put_angle (p, lon, 3, 'E', 'W');
+    p = end_sentence (start, put_text (p, ",1,09,0.9,545.4,M,46.9,M,,"));
+
+    start = p;
+    p = put_time (put_text (p, "$GPRMC,"), time);
+    p = put_angle (put_text (p, ",A,"), lat, 2, 'N', 'S');
+    *p++ = ',';
+    p = put_angle (p, lon, 3, 'E', 'W');
+    p = put_digits (put_text (p, ",058.3,084.4,"), day * 10000 + 524, 6);
+    p = end_sentence (start, put_text (p, ",,,A"));
+    if (epoch % 1009 == 0)
+      p[-4] = (p[-4] == '0') ? '1' : '0';   /* Corrupt the checksum */
+
+    if (epoch % 10 == 0)
+    {
+      start = p;
+      p = end_sentence (start, put_text (p, "$GPGSV,3,1,11,03,03,111,00,04,15,270,00,"
+                                            "06,01,010,00,13,06,292,00"));
+    }
+
+    written += p - (out.buffer + out.used);
+    out.used = p - out.buffer;
+    if (out.used >= WRITE_BUFFER - 4 * NMEA_MAX_SENTENCE)
+      flush_output (out);
+
+    /* Next epoch: wander, and turn back before leaving the UTM latitudes */
+    epoch++;
+    time += 100;
+    if (time >= 86400000)
+    {
+      time = 0;
+      day = day % 28 + 1;
+    }
+    if (epoch % 600 == 0)
+      dlat = -dlat;
+    if ((lat > 80000000L) || (lat < -79000000L))
+      dlat = (lat > 0) ? -3 : 3;
+    lat += dlat + 1;      /* Drifting north at 10 microdegrees a second */
+    lon += dlon;
+    if (lon >= 180000000L)
+      lon -= 360000000L;
+  }
+  flush_output (out);
+  return (0);
+}
+
+int main (int argc, char **argv)
+{
+  long precision = 5;
+  int use_double = 0;
+  const char *file = "-";
+  int fd = 0;
+  int i;
+
+  for (i = 1; i < argc; i++)
+  {
+    if (!strcmp (argv[i], "-g") && (i + 1 < argc))
+      return (generate (atoll (argv[i + 1])));
+    else if (!strcmp (argv[i], "-p") && (i + 1 < argc))
+      precision = atol (argv[++i]);
+    else if (!strcmp (argv[i], "-d"))
+      use_double = 1;
+    else
+      file = argv[i];
+  }
+  if ((precision < 0) || (precision > MAX_PRECISION))
+  {
+    fprintf (stderr, "precision must be 0 to %d\n", MAX_PRECISION);
+    return (2);
+  }
+  if (strcmp (file, "-"))
+  {
+    fd = open (file, O_RDONLY);
+    if (fd < 0)
+    {
+      perror (file);
+      return (1);
+    }
+  }
+  return (convert (fd, precision, use_double));
+}
@@ -1,7 +1,9 @@
+#ifndef MGRS_H
+#define MGRS_H
+
 #include "utm.h"
 #include "pi.h"
 
-#include <stdio.h>
 #include <string.h>
 
 #define PI180 0.01745329251
@@ -65,6 +67,9 @@ const char* CLARKE_1880 = "CD";
 const char* BESSEL_1841 = "BR";
 const char* BESSEL_1841_NAMIBIA = "BN";
 
+#define MGRS_AL_PATTERN              0  /* Grid pattern of the Clarke and Bessel ellipsoids */
+#define MGRS_AA_PATTERN              1  /* Grid pattern of all other ellipsoids           */
+
 #define MGRS_NO_ERROR                0x0000
 #define MGRS_LAT_ERROR               0x0001
 #define MGRS_LON_ERROR               0x0002
@@ -77,6 +82,38 @@ const char* BESSEL_1841_NAMIBIA = "BN";
 #define MGRS_ZONE_ERROR              0x0100
 #define MGRS_HEMISPHERE_ERROR        0x0200
 #define MGRS_LAT_WARNING             0x0400
+#define MGRS_ELLIPSOID_ERROR         0x0800
+
+typedef struct MGRS_Parameters_Value
+{
+  UTM_Parameters UTM;        /* Ellipsoid, with no zone override        */
+  char Ellipsoid_Code[3];    /* 2-letter code for ellipsoid             */
+  long Grid_Pattern;         /* MGRS_AA_PATTERN or MGRS_AL_PATTERN      */
+} MGRS_Parameters;
+
+typedef struct MGRS_Datum_Value
+{
+  const char *Ellipsoid_Code;  /* 2-letter code for ellipsoid             */
+  double a;                    /* Semi-major axis of ellipsoid in meters  */
+  double inv_f;                /* Inverse flattening of ellipsoid         */
+  TranMerc_Ellipsoid Ellipsoid;  /* Derived ellipsoid constants           */
+} MGRS_Datum;
+
+#define MGRS_DATUM(code, a, inv_f) {(code), (a), (inv_f), TRANMERC_ELLIPSOID((a), 1 / (inv_f))}
+
+/* Ellipsoids selectable by code with Set_MGRS_Datum_R, constants worked out at build time */
+#define MGRS_DATUMS  5
+static constexpr MGRS_Datum MGRS_Datum_Table[MGRS_DATUMS] =
+  {MGRS_DATUM("WE", 6378137.0, 298.257223563),    /* WGS 84                   */
+   MGRS_DATUM("CC", 6378206.4, 294.9786982),      /* Clarke 1866              */
+   MGRS_DATUM("CD", 6378249.145, 293.465),        /* Clarke 1880              */
+   MGRS_DATUM("BR", 6377397.155, 299.1528128),    /* Bessel 1841              */
+   MGRS_DATUM("BN", 6377483.865, 299.1528128)};   /* Bessel 1841 (Namibia)    */
+
+/* Parameters used by the functions without an explicit context */
+static const MGRS_Parameters MGRS_Default_Parameters =
+  {{TranMerc_WGS84, 0},
+   {MGRS_Ellipsoid_Code[0], MGRS_Ellipsoid_Code[1], 0}, MGRS_AA_PATTERN};
 
 typedef struct Latitude_Band_Value
 {
@@ -88,7 +125,7 @@ typedef struct Latitude_Band_Value
 } Latitude_Band;
 
 static const Latitude_Band Latitude_Band_Table[20] =
-  {{LETTER_C, 1100000.0, -72.0, -80.5, 0.0},
+  {{LETTER_C, 1000000.0, -72.0, -80.5, 0.0},  /* covers the extension to -80.5 */
   {LETTER_D, 2000000.0, -64.0, -72.0, 2000000.0},
   {LETTER_E, 2800000.0, -56.0, -64.0, 2000000.0},
   {LETTER_F, 3700000.0, -48.0, -56.0, 2000000.0},
@@ -108,7 +145,304 @@ static const Latitude_Band Latitude_Band_Table[20] =
   {LETTER_V, 6200000.0, 64.0, 56.0, 6000000.0},
   {LETTER_W, 7000000.0, 72.0, 64.0, 6000000.0},
   {LETTER_X, 7900000.0, 84.5, 72.0, 6000000.0}};
-  
+
+/* Reciprocal of the 8 degree latitude band height, in radians */
+#define RECIP_BAND_HEIGHT  (1.0 / (8.0 * DEG_TO_RAD))
+
+/*
+ * Least latitude in radians of each entry of Latitude_Band_Table, as
+ * (latitude + 80 degrees) / 8 degrees + 1.0e-12 has always chosen it: each
+ * 8 degree edge less that bias, to the double.  The first and last entries
+ * bound every latitude.
+ */
+static const double Latitude_Band_Edge_Table[21] =
+  {-PI, -1.2566370614360567, -1.1170107212765104, -0.97738438111696413,
+   -0.83775804095741779, -0.69813170079787146, -0.55850536063832501, -0.41887902047877873,
+   -0.27925268031923245, -0.13962634015968609, -1.3977707880030721e-13, 0.13962634015940659,
+   0.27925268031895317, 0.41887902047849945, 0.5585053606380459, 0.69813170079759213,
+   0.83775804095713868, 0.97738438111668524, 1.1170107212762312, 1.2566370614357778, PI};
+
+typedef struct Grid_Set_Value
+{
+  long ltr2_low_value;       /* 2nd letter low number                      */
+  long ltr2_high_value;      /* 2nd letter high number                     */
+  double pattern_offset[2];  /* Pattern offset, indexed by grid pattern    */
+  int column_letter[9];      /* 2nd letter, indexed by easting / 100,000   */
+                             /* less 1                                     */
+} Grid_Set;
+
+/*
+ * 2nd letter range, pattern offsets and 2nd letters of each set of UTM
+ * zones, indexed by zone % 6 (set 6 first).  The last column is an easting
+ * of exactly 900,000 meters, and holds the letter the old arithmetic gave.
+ */
+static const Grid_Set Grid_Set_Table[6] =
+  {{LETTER_S, LETTER_Z, {1500000.0, 500000.0},
+    {LETTER_S, LETTER_T, LETTER_U, LETTER_V, LETTER_W, LETTER_X, LETTER_Y, LETTER_Z, LETTER_Z + 1}},
+  {LETTER_A, LETTER_H, {1000000.0, 0.0},
+    {LETTER_A, LETTER_B, LETTER_C, LETTER_D, LETTER_E, LETTER_F, LETTER_G, LETTER_H, LETTER_I}},
+  {LETTER_J, LETTER_R, {1500000.0, 500000.0},
+    {LETTER_J, LETTER_K, LETTER_L, LETTER_M, LETTER_N, LETTER_P, LETTER_Q, LETTER_R, LETTER_S}},
+  {LETTER_S, LETTER_Z, {1000000.0, 0.0},
+    {LETTER_S, LETTER_T, LETTER_U, LETTER_V, LETTER_W, LETTER_X, LETTER_Y, LETTER_Z, LETTER_Z + 1}},
+  {LETTER_A, LETTER_H, {1500000.0, 500000.0},
+    {LETTER_A, LETTER_B, LETTER_C, LETTER_D, LETTER_E, LETTER_F, LETTER_G, LETTER_H, LETTER_I}},
+  {LETTER_J, LETTER_R, {1000000.0, 0.0},
+    {LETTER_J, LETTER_K, LETTER_L, LETTER_M, LETTER_N, LETTER_P, LETTER_Q, LETTER_R, LETTER_S}}};
+
+/* 3rd letter, indexed by grid northing / 100,000, skipping I and O */
+static const int Grid_Row_Letter_Table[20] =
+  {LETTER_A, LETTER_B, LETTER_C, LETTER_D, LETTER_E, LETTER_F, LETTER_G, LETTER_H,
+   LETTER_J, LETTER_K, LETTER_L, LETTER_M, LETTER_N, LETTER_P, LETTER_Q, LETTER_R,
+   LETTER_S, LETTER_T, LETTER_U, LETTER_V};
+
+
+long Get_Grid_Pattern (const char *Ellipsoid_Code)
+/*
+ * The function Get_Grid_Pattern returns the grid pattern used for the
+ * 100,000 meter square letters with the given ellipsoid: MGRS_AL_PATTERN
+ * for the Clarke 1866, Clarke 1880, Bessel 1841 and Bessel 1841 (Namibia)
+ * ellipsoids, otherwise MGRS_AA_PATTERN.
+ *
+ *    Ellipsoid_Code  : 2-letter ellipsoid code (input)
+ */
+{ /* Get_Grid_Pattern */
+  if (!strcmp(Ellipsoid_Code,CLARKE_1866) || !strcmp(Ellipsoid_Code, CLARKE_1880) ||
+      !strcmp(Ellipsoid_Code,BESSEL_1841) || !strcmp(Ellipsoid_Code,BESSEL_1841_NAMIBIA))
+    return (MGRS_AL_PATTERN);
+  else
+    return (MGRS_AA_PATTERN);
+} /* Get_Grid_Pattern */
+
+
+long Set_MGRS_Parameters_R (MGRS_Parameters *Parameters,
+                            double a,
+                            double f,
+                            const char *Ellipsoid_Code)
+/*
+ * The function Set_MGRS_Parameters_R receives the ellipsoid parameters
+ * and stores them, with the derived ellipsoid constants, in Parameters.
+ * A context set up this way may be shared read-only between threads.
+ * If any errors occur, the error code(s) are returned by the function and
+ * Parameters is left unchanged, otherwise MGRS_NO_ERROR is returned.
+ *
+ *   Parameters     : MGRS parameters                 (output)
+ *   a              : Semi-major axis of ellipsoid in meters (input)
+ *   f              : Flattening of ellipsoid         (input)
+ *   Ellipsoid_Code : 2-letter code for ellipsoid     (input)
+ */
+{ /* Set_MGRS_Parameters_R */
+  long temp_error_code;
+  long error_code = MGRS_NO_ERROR;
+
+  temp_error_code = Set_UTM_Parameters_R (&Parameters->UTM, a, f, 0);
+  if (temp_error_code)
+  {
+    if (temp_error_code & UTM_A_ERROR)
+      error_code |= MGRS_A_ERROR;
+    if (temp_error_code & UTM_INV_F_ERROR)
+      error_code |= MGRS_INV_F_ERROR;
+  }
+  else
+  {
+    Parameters->Ellipsoid_Code[0] = Ellipsoid_Code[0];
+    Parameters->Ellipsoid_Code[1] = Ellipsoid_Code[1];
+    Parameters->Ellipsoid_Code[2] = 0;
+    Parameters->Grid_Pattern = Get_Grid_Pattern(Ellipsoid_Code);
+  }
+  return (error_code);
+} /* Set_MGRS_Parameters_R */
+
+
+long Set_MGRS_Datum_R (MGRS_Parameters *Parameters,
+                       const char *Ellipsoid_Code)
+/*
+ * The function Set_MGRS_Datum_R looks up the ellipsoid with the given code
+ * in MGRS_Datum_Table and sets Parameters up for it, as
+ * Set_MGRS_Parameters_R does, copying the table's constants rather than
+ * deriving them.  If the code is not in the table, MGRS_ELLIPSOID_ERROR is
+ * returned and Parameters is left unchanged, otherwise MGRS_NO_ERROR is
+ * returned.
+ *
+ *   Parameters     : MGRS parameters                 (output)
+ *   Ellipsoid_Code : 2-letter code for ellipsoid     (input)
+ */
+{ /* Set_MGRS_Datum_R */
+  long i;
+
+  for (i = 0; i < MGRS_DATUMS; i++)
+  {
+    if (!strcmp(Ellipsoid_Code, MGRS_Datum_Table[i].Ellipsoid_Code))
+    {
+      Parameters->UTM.Ellipsoid = MGRS_Datum_Table[i].Ellipsoid;
+      Parameters->UTM.Override = 0;
+      Parameters->Ellipsoid_Code[0] = Ellipsoid_Code[0];
+      Parameters->Ellipsoid_Code[1] = Ellipsoid_Code[1];
+      Parameters->Ellipsoid_Code[2] = 0;
+      Parameters->Grid_Pattern = Get_Grid_Pattern(Ellipsoid_Code);
+      return (MGRS_NO_ERROR);
+    }
+  }
+  return (MGRS_ELLIPSOID_ERROR);
+} /* Set_MGRS_Datum_R */
+
+
+/* Divisor taking a 5 digit easting or northing down to each precision */
+static const long MGRS_Divisor_Table[MAX_PRECISION + 1] =
+  {100000, 10000, 1000, 100, 10, 1};
+
+/*
+ * Transverse Mercator terms tried first at each precision.  The 4th order
+ * terms are within a few meters at the edge of a zone, so at 1 km and
+ * coarser only points that close to a digit change need every term.
+ */
+static const long MGRS_Precision_Terms[MAX_PRECISION + 1] =
+  {TRANMERC_4TH_ORDER_TERMS, TRANMERC_4TH_ORDER_TERMS, TRANMERC_4TH_ORDER_TERMS,
+   TRANMERC_ALL_TERMS, TRANMERC_ALL_TERMS, TRANMERC_ALL_TERMS};
+
+static long Near_MGRS_Digit_Change (double Value,
+                                    double Bound,
+                                    long Precision)
+/*
+ * Returns TRUE if an easting or northing known to within Bound meters might
+ * give other digits at Precision, or other 100 km letters, than Value.
+ * Every UTM grid limit is a multiple of 100 km, so it is also caught.
+ */
+{
+  double divisor = (double)MGRS_Divisor_Table[Precision];
+
+  return (floor((Value - Bound) / divisor) != floor((Value + Bound) / divisor));
+}
+
+long Write_MGRS_Meters (char* MGRS,
+                        long Zone,
+                        const int Letters[MGRS_LETTERS],
+                        long Easting,
+                        long Northing,
+                        long Precision,
+                        long Terminate)
+/*
+ * The function Write_MGRS_Meters writes an MGRS string from its
+ * component parts directly into MGRS, using integer arithmetic only:
+ * 2 zone digits (blanks when Zone is 0), the 3 letters, then Precision
+ * easting and Precision northing digits.  A terminating 0 is appended
+ * only when Terminate is TRUE, so MGRS needs 5 + 2 * Precision
+ * characters, plus one for the terminator.  The number of characters
+ * written, not counting the terminator, is returned.  Easting and
+ * Northing are whole meters and must not be negative.
+ *
+ *   MGRS           : MGRS coordinate string          (output)
+ *   Zone           : UTM Zone                        (input)
+ *   Letters        : MGRS coordinate string letters  (input)
+ *   Easting        : Easting in whole meters         (input)
+ *   Northing       : Northing in whole meters        (input)
+ *   Precision      : Precision level of MGRS string  (input)
+ *   Terminate      : Append a terminating 0          (input)
+ */
+{ /* Write_MGRS_Meters */
+  long i = 0;
+  long j;
+  long east;
+  long north;
+  MGRS_PROBE_BEGIN(MGRS_PROBE_MGRS_STRING);
+
+  if (Zone)
+  {
+    MGRS[i++] = (char)('0' + Zone / 10);
+    MGRS[i++] = (char)('0' + Zone % 10);
+  }
+  else
+  {
+    MGRS[i++] = ' ';
+    MGRS[i++] = ' ';
+  }
+
+  for (j=0;j<3;j++)
+    MGRS[i++] = (char)('A' + Letters[j]);
+
+  east = (Easting % 100000) / MGRS_Divisor_Table[Precision];
+  north = (Northing % 100000) / MGRS_Divisor_Table[Precision];
+  for (j = Precision - 1; j >= 0; j--)
+  {
+    MGRS[i + j] = (char)('0' + east % 10);
+    east /= 10;
+    MGRS[i + Precision + j] = (char)('0' + north % 10);
+    north /= 10;
+  }
+  i += 2 * Precision;
+
+  if (Terminate)
+    MGRS[i] = 0;
+  MGRS_PROBE_END(MGRS_PROBE_MGRS_STRING);
+  return (i);
+} /* Write_MGRS_Meters */
+
+long Write_MGRS_String (char* MGRS,
+                        long Zone,
+                        const int Letters[MGRS_LETTERS],
+                        double Easting,
+                        double Northing,
+                        long Precision,
+                        long Terminate)
+/*
+ * The function Write_MGRS_String writes an MGRS string from its
+ * component parts directly into MGRS, with no formatted I/O and no
+ * floating point division, as Write_MGRS_Meters does.  The number of
+ * characters written, not counting the terminator, is returned.
+ * Easting and Northing must not be negative.
+ *
+ *   MGRS           : MGRS coordinate string          (output)
+ *   Zone           : UTM Zone                        (input)
+ *   Letters        : MGRS coordinate string letters  (input)
+ *   Easting        : Easting value                   (input)
+ *   Northing       : Northing value                  (input)
+ *   Precision      : Precision level of MGRS string  (input)
+ *   Terminate      : Append a terminating 0          (input)
+ */
+{ /* Write_MGRS_String */
+  /* Truncating the whole meters is the same as truncating the meters */
+  return (Write_MGRS_Meters (MGRS, Zone, Letters, (long)Easting,
+                             (long)Northing, Precision, Terminate));
+} /* Write_MGRS_String */
+
+long Write_MGRS_Records (char* Records,
+                         long Record_Width,
+                         long Count,
+                         const long *Zone,
+                         const int *Letters,
+                         const double *Easting,
+                         const double *Northing,
+                         long Precision)
+/*
+ * The function Write_MGRS_Records writes Count MGRS strings into
+ * consecutive fixed-width records of Record_Width characters each,
+ * padding every record with blanks and writing no terminators.
+ * Record_Width must be at least 5 + 2 * Precision.  The number of
+ * characters written is returned.
+ *
+ *   Records        : Fixed-width MGRS records        (output)
+ *   Record_Width   : Characters per record           (input)
+ *   Count          : Number of records               (input)
+ *   Zone           : UTM Zones                       (input)
+ *   Letters        : MGRS letters, 3 per record      (input)
+ *   Easting        : Easting values                  (input)
+ *   Northing       : Northing values                 (input)
+ *   Precision      : Precision level of MGRS strings (input)
+ */
+{ /* Write_MGRS_Records */
+  long n;
+  long i;
+
+  for (n = 0; n < Count; n++)
+  {
+    i = Write_MGRS_String (Records, Zone[n], Letters + n * MGRS_LETTERS,
+                           Easting[n], Northing[n], Precision, FALSE);
+    while (i < Record_Width)
+      Records[i++] = ' ';
+    Records += Record_Width;
+  }
+  return (Count * Record_Width);
+} /* Write_MGRS_Records */
 
 long Make_MGRS_String (char* MGRS,
                        long Zone,
@@ -128,35 +462,35 @@ long Make_MGRS_String (char* MGRS,
  *   Precision      : Precision level of MGRS string  (input)
  */
 { /* Make_MGRS_String */
-  long i;
-  long j;
-  double divisor;
-  long east;
-  long north;
-  char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
-  long error_code = MGRS_NO_ERROR;
+  Write_MGRS_String (MGRS, Zone, Letters, Easting, Northing, Precision, TRUE);
+  return (MGRS_NO_ERROR);
+} /* Make_MGRS_String */
 
-  i = 0;
-  if (Zone)
-    i = sprintf (MGRS+i,"%2.2ld",Zone);
-  else
-    strncpy(MGRS, "  ", 2);  // 2 spaces
+void Get_Grid_Values_R (const MGRS_Parameters *Parameters,
+                        long zone,
+                        long* ltr2_low_value,
+                        long* ltr2_high_value,
+                        double *pattern_offset)
+/*
+ * The function Get_Grid_Values_R sets the letter range used for
+ * the 2nd letter in the MGRS coordinate string, based on the set
+ * number of the utm zone. It also sets the pattern offset using a
+ * value of A for the second letter of the grid square, based on
+ * the grid pattern in Parameters and set number of the utm zone.
+ *
+ *    Parameters      : MGRS parameters         (input)
+ *    zone            : Zone number             (input)
+ *    ltr2_low_value  : 2nd letter low number   (output)
+ *    ltr2_high_value : 2nd letter high number  (output)
+ *    pattern_offset  : Pattern offset          (output)
+ */
+{ /* BEGIN Get_Grid_Values_R */
+  const Grid_Set *set = &Grid_Set_Table[zone % 6];
 
-  for (j=0;j<3;j++)
-    MGRS[i++] = alphabet[Letters[j]];
-  divisor = pow (10.0, (5 - Precision));
-  Easting = fmod (Easting, 100000.0);
-  if (Easting >= 99999.5)
-    Easting = 99999.0;
-  east = (long)(Easting/divisor);
-  i += sprintf (MGRS+i, "%*.*ld", (int)Precision, (int)Precision, east);
-  Northing = fmod (Northing, 100000.0);
-  if (Northing >= 99999.5)
-    Northing = 99999.0;
-  north = (long)(Northing/divisor);
-  i += sprintf (MGRS+i, "%*.*ld", (int)Precision, (int)Precision, north);
-  return (error_code);
-} /* Make_MGRS_String */
+  *ltr2_low_value = set->ltr2_low_value;
+  *ltr2_high_value = set->ltr2_high_value;
+  *pattern_offset = set->pattern_offset[Parameters->Grid_Pattern];
+} /* END OF Get_Grid_Values_R */
 
 void Get_Grid_Values (long zone,
                       long* ltr2_low_value,
@@ -175,51 +509,8 @@ void Get_Grid_Values (long zone,
  *    pattern_offset  : Pattern offset          (output)
  */
 { /* BEGIN Get_Grid_Values */
-  long set_number;    /* Set number (1-6) based on UTM zone number */
-  long aa_pattern;    /* Pattern based on ellipsoid code */
-
-  set_number = zone % 6;
-
-  if (!set_number)
-    set_number = 6;
-
-  if (!strcmp(MGRS_Ellipsoid_Code,CLARKE_1866) || !strcmp(MGRS_Ellipsoid_Code, CLARKE_1880) ||
-      !strcmp(MGRS_Ellipsoid_Code,BESSEL_1841) || !strcmp(MGRS_Ellipsoid_Code,BESSEL_1841_NAMIBIA))
-    aa_pattern = FALSE;
-  else
-    aa_pattern = TRUE;
-
-  if ((set_number == 1) || (set_number == 4))
-  {
-    *ltr2_low_value = LETTER_A;
-    *ltr2_high_value = LETTER_H;
-  }
-  else if ((set_number == 2) || (set_number == 5))
-  {
-    *ltr2_low_value = LETTER_J;
-    *ltr2_high_value = LETTER_R;
-  }
-  else if ((set_number == 3) || (set_number == 6))
-  {
-    *ltr2_low_value = LETTER_S;
-    *ltr2_high_value = LETTER_Z;
-  }
-
-  /* False northing at A for second letter of grid square */
-  if (aa_pattern)
-  {
-    if ((set_number % 2) ==  0)
-      *pattern_offset = 500000.0;
-    else
-      *pattern_offset = 0.0;
-  }
-  else
-  {
-    if ((set_number % 2) == 0)
-      *pattern_offset =  1500000.0;
-    else
-      *pattern_offset = 1000000.00;
-  }
+  Get_Grid_Values_R (&MGRS_Default_Parameters, zone, ltr2_low_value, ltr2_high_value,
+                     pattern_offset);
 } /* END OF Get_Grid_Values */
 
 long Get_Latitude_Letter(double latitude, int* letter)
@@ -232,16 +523,18 @@ long Get_Latitude_Letter(double latitude, int* letter)
  *   letter     : Latitude band letter  (output)
  */
 { /* Get_Latitude_Letter */
-  double temp = 0.0;
+  long band;
   long error_code = MGRS_NO_ERROR;
   double lat_deg = latitude * RAD_TO_DEG;
 
   if (lat_deg >= 72 && lat_deg < 84.5)
     *letter = LETTER_X;
   else if (lat_deg > -80.5 && lat_deg < 72)
-  {
-    temp = ((latitude + (80.0 * DEG_TO_RAD)) / (8.0 * DEG_TO_RAD)) + 1.0e-12;
-    *letter = Latitude_Band_Table[(int)temp].letter;
+  { /* Within one band of the right one, then settled exactly by its edges */
+    band = (long)((latitude + (80.0 * DEG_TO_RAD)) * RECIP_BAND_HEIGHT);
+    band -= (latitude < Latitude_Band_Edge_Table[band]);
+    band += (latitude >= Latitude_Band_Edge_Table[band + 1]);
+    *letter = Latitude_Band_Table[band].letter;
   }
   else
     error_code |= MGRS_LAT_ERROR;
@@ -249,18 +542,134 @@ long Get_Latitude_Letter(double latitude, int* letter)
   return error_code;
 } /* Get_Latitude_Letter */
 
-long UTM_To_MGRS (long Zone,
-                  char Hemisphere,
-                  double Longitude,
-                  double Latitude,
-                  double Easting,
-                  double Northing,
-                  long Precision,
-                  char *MGRS)
+long Get_MGRS_Zone_R (const MGRS_Parameters *Parameters,
+                      double *Latitude,
+                      double *Longitude,
+                      long   *Zone)
 /*
- * The function UTM_To_MGRS calculates an MGRS coordinate string
- * based on the zone, latitude, easting and northing.
+ * The function Get_MGRS_Zone_R selects the UTM zone an MGRS coordinate
+ * string of a geodetic position is made in, before any projection: the
+ * zone of Get_UTM_Zone_R, except that a point of 31V at or east of its
+ * central meridian is in zone 32, where the truncated 31V ends.  That is
+ * a point of 31V at 3 degrees east or more, or whose longitude less the
+ * central meridian, as the projection works it out, is not negative, so
+ * its easting would be 500,000 meters or more.  Latitude and Longitude
+ * are normalised as Get_UTM_Zone_R leaves them.  If any errors occur,
+ * the UTM error code(s) are returned by the function, otherwise
+ * UTM_NO_ERROR is returned.
+ *
+ *    Parameters : MGRS parameters                  (input)
+ *    Latitude   : Latitude in radians              (input/output)
+ *    Longitude  : Longitude in radians             (input/output)
+ *    Zone       : UTM Zone                         (output)
+ */
+{ /* Get_MGRS_Zone_R */
+  double latitude = *Latitude;
+  double longitude = *Longitude;
+  double dlam;
+  long error_code = UTM_NO_ERROR;
+
+  error_code = Get_UTM_Zone_R (&Parameters->UTM, Latitude, Longitude, Zone);
+  if (!error_code && (*Zone == 31) && (latitude >= 56.0 * DEG_TO_RAD)
+      && (latitude < 64.0 * DEG_TO_RAD)
+      && ((longitude >= 3.0 * DEG_TO_RAD)
+          || (!Get_Transverse_Mercator_Delta_Long (&UTM_Zone_Projection[30][0], *Latitude,
+                                                   *Longitude, &dlam) && (dlam >= 0.0))))
+    *Zone = 32;
+  return (error_code);
+} /* Get_MGRS_Zone_R */
+
+long UTM_To_MGRS_Letters_R (const MGRS_Parameters *Parameters,
+                            long   Zone,
+                            double Latitude,
+                            double *Easting,
+                            double *Northing,
+                            int    Letters[MGRS_LETTERS])
+/*
+ * The function UTM_To_MGRS_Letters_R works out the 3 letters of the MGRS
+ * coordinate string based on the zone, latitude, easting and northing,
+ * using the grid pattern in Parameters, and the easting and northing the
+ * string is made of.  The zone must be the one Get_MGRS_Zone_R gives.  A
+ * zone, easting or northing outside the UTM grid gives MGRS_ZONE_ERROR,
+ * MGRS_EASTING_ERROR and/or MGRS_NORTHING_ERROR, as the letters are looked
+ * up by them.  No global state is read or written.
  *
+ *    Parameters: MGRS parameters         (input)
+ *    Zone      : Zone number             (input)
+ *    Latitude  : Latitude in radians     (input)
+ *    Easting   : Easting                 (input/output)
+ *    Northing  : Northing                (input/output)
+ *    Letters   : MGRS coordinate string letters (output)
+ */
+{ /* UTM_To_MGRS_Letters_R */
+  const Grid_Set *set;        /* Letter values for the zone's set            */
+  double grid_easting;        /* Easting used to derive 2nd letter of MGRS   */
+  double grid_northing;       /* Northing used to derive 3rd letter of MGRS  */
+  long error_code = MGRS_NO_ERROR;
+
+  /* The letter tables hold the UTM grid and no more; NaNs fail too */
+  if ((Zone < 1) || (Zone > 60))
+    error_code |= MGRS_ZONE_ERROR;
+  if (!((*Easting >= MIN_EASTING) && (*Easting <= MAX_EASTING)))
+    error_code |= MGRS_EASTING_ERROR;
+  if (!((*Northing >= MIN_NORTHING) && (*Northing <= MAX_NORTHING)))
+    error_code |= MGRS_NORTHING_ERROR;
+  if (error_code)
+    return error_code;
+
+  if( Latitude <= 0.0 && *Northing == 1.0e7)
+  {
+    Latitude = 0.0;
+    *Northing = 0.0;
+  }
+
+  set = &Grid_Set_Table[Zone % 6];
+
+  error_code = Get_Latitude_Letter(Latitude, &Letters[0]);
+
+  if (!error_code)
+  {
+    grid_northing = *Northing;
+
+    while (grid_northing >= TWOMIL)
+    {
+      grid_northing = grid_northing - TWOMIL;
+    }
+    grid_northing = grid_northing + set->pattern_offset[Parameters->Grid_Pattern];
+    if(grid_northing >= TWOMIL)
+      grid_northing = grid_northing - TWOMIL;
+
+    Letters[2] = Grid_Row_Letter_Table[(long)(grid_northing / ONEHT)];
+
+    grid_easting = *Easting;
+    if (((Letters[0] == LETTER_V) && (Zone == 31)) && (grid_easting == 500000.0))
+      grid_easting = grid_easting - 1.0; /* SUBTRACT 1 METER */
+
+    Letters[1] = set->column_letter[(long)(grid_easting / ONEHT) - 1];
+    *Easting = grid_easting;
+  }
+  return error_code;
+} /* UTM_To_MGRS_Letters_R */
+
+long UTM_To_MGRS_R (const MGRS_Parameters *Parameters,
+                    long Zone,
+                    char Hemisphere,
+                    double Longitude,
+                    double Latitude,
+                    double Easting,
+                    double Northing,
+                    long Precision,
+                    char *MGRS)
+/*
+ * The function UTM_To_MGRS_R calculates an MGRS coordinate string
+ * based on the zone, latitude, easting and northing, using the
+ * ellipsoid in Parameters.  A point given in zone 31 where Get_MGRS_Zone_R
+ * would choose zone 32 is reconverted to zone 32 first; conversions from
+ * latitude and longitude choose the zone before projecting instead.  A
+ * zone, easting or northing outside the UTM grid is returned as an error
+ * and no string is written.  No global state is read or written.
+ *
+ *    Parameters: MGRS parameters         (input)
  *    Zone      : Zone number             (input)
  *    Hemisphere: Hemisphere              (input)
  *    Longitude : Longitude in radians    (input)
@@ -271,21 +680,17 @@ long UTM_To_MGRS (long Zone,
  *    MGRS      : MGRS coordinate string  (output)
  */
 { /* BEGIN UTM_To_MGRS */
-  double pattern_offset;      /* Northing offset for 3rd letter               */
-  double grid_easting;        /* Easting used to derive 2nd letter of MGRS   */
-  double grid_northing;       /* Northing used to derive 3rd letter of MGRS  */
-  long ltr2_low_value;        /* 2nd letter range - low number               */
-  long ltr2_high_value;       /* 2nd letter range - high number              */
   int letters[MGRS_LETTERS];  /* Number location of 3 letters in alphabet    */
+  UTM_Parameters zone_32;     /* Parameters forcing UTM zone 32              */
   long temp_error_code = MGRS_NO_ERROR;
   long error_code = MGRS_NO_ERROR;
 
-
   /* Special check for rounding to (truncated) eastern edge of zone 31V */
   if ((Zone == 31) && (((Latitude >= 56.0 * DEG_TO_RAD) && (Latitude < 64.0 * DEG_TO_RAD)) && ((Longitude >= 3.0 * DEG_TO_RAD) || (Easting >= 500000.0))))
   { /* Reconvert to UTM zone 32 */
-    Set_UTM_Parameters (MGRS_a, MGRS_f, 32);
-    temp_error_code = Convert_Geodetic_To_UTM (Latitude, Longitude, &Zone, &Hemisphere, &Easting, &Northing);
+    zone_32 = Parameters->UTM;
+    zone_32.Override = 32;
+    temp_error_code = Convert_Geodetic_To_UTM_R (&zone_32, Latitude, Longitude, &Zone, &Hemisphere, &Easting, &Northing);
     if(temp_error_code)
     {
       if(temp_error_code & UTM_LAT_ERROR)
@@ -303,48 +708,166 @@ long UTM_To_MGRS (long Zone,
     }
   }
 
-  if( Latitude <= 0.0 && Northing == 1.0e7)
-  {
-    Latitude = 0.0;
-    Northing = 0.0;
-  }
+  error_code = UTM_To_MGRS_Letters_R (Parameters, Zone, Latitude, &Easting, &Northing, letters);
+  if (!error_code)
+    Make_MGRS_String (MGRS, Zone, letters, Easting, Northing, Precision);
+  return error_code;
+} /* END UTM_To_MGRS_R */
 
-  Get_Grid_Values(Zone, &ltr2_low_value, &ltr2_high_value, &pattern_offset);
+long UTM_To_MGRS (long Zone,
+                  char Hemisphere,
+                  double Longitude,
+                  double Latitude,
+                  double Easting,
+                  double Northing,
+                  long Precision,
+                  char *MGRS)
+/*
+ * The function UTM_To_MGRS calculates an MGRS coordinate string
+ * based on the zone, latitude, easting and northing.
+ *
+ *    Zone      : Zone number             (input)
+ *    Hemisphere: Hemisphere              (input)
+ *    Longitude : Longitude in radians    (input)
+ *    Latitude  : Latitude in radians     (input)
+ *    Easting   : Easting                 (input)
+ *    Northing  : Northing                (input)
+ *    Precision : Precision               (input)
+ *    MGRS      : MGRS coordinate string  (output)
+ */
+{ /* BEGIN UTM_To_MGRS */
+  return (UTM_To_MGRS_R(&MGRS_Default_Parameters, Zone, Hemisphere, Longitude,
+                        Latitude, Easting, Northing, Precision, MGRS));
+} /* END UTM_To_MGRS */
+  
 
-  error_code = Get_Latitude_Letter(Latitude, &letters[0]);
+long Convert_Geodetic_To_MGRS_Letters_R (const MGRS_Parameters *Parameters,
+                                         double Latitude,
+                                         double Longitude,
+                                         long Precision,
+                                         long *Zone,
+                                         int Letters[MGRS_LETTERS],
+                                         double *Easting,
+                                         double *Northing)
+/*
+ * The function Convert_Geodetic_To_MGRS_Letters_R converts Geodetic
+ * (latitude and longitude) coordinates to the zone, letters, easting and
+ * northing an MGRS coordinate string is made of, as
+ * Convert_Geodetic_To_MGRS_R does before writing the string, including
+ * its choice of Transverse Mercator terms for Precision.  If any errors
+ * occur, the error code(s) are returned by the function, otherwise
+ * MGRS_NO_ERROR is returned.
+ *
+ *    Parameters : MGRS parameters                  (input)
+ *    Latitude   : Latitude in radians              (input)
+ *    Longitude  : Longitude in radians             (input)
+ *    Precision  : Precision level of MGRS string   (input)
+ *    Zone       : UTM Zone                         (output)
+ *    Letters    : MGRS coordinate string letters   (output)
+ *    Easting    : Easting (X) in meters            (output)
+ *    Northing   : Northing (Y) in meters           (output)
+ *
+ */
+{ /* Convert_Geodetic_To_MGRS_Letters_R */
+  char hemisphere;
+  double latitude = Latitude;
+  double longitude = Longitude;
+  double easting_bound;
+  double northing_bound;
+  long temp_error_code = MGRS_NO_ERROR;
+  long error_code = MGRS_NO_ERROR;
 
+  if (!((Latitude >= -PI_OVER_2) && (Latitude <= PI_OVER_2)))
+  { /* Latitude out of range, or NaN */
+    error_code |= MGRS_LAT_ERROR;
+  }
+  if (!((Longitude >= -PI) && (Longitude <= (2*PI))))
+  { /* Longitude out of range, or NaN */
+    error_code |= MGRS_LON_ERROR;
+  }
+  if ((Precision < 0) || (Precision > MAX_PRECISION))
+    error_code |= MGRS_PRECISION_ERROR;
   if (!error_code)
   {
-    grid_northing = Northing;
-
-    while (grid_northing >= TWOMIL)
+    MGRS_PROBE_BEGIN(MGRS_PROBE_GEODETIC_TO_UTM);
+    /* The final zone first, so the point is projected once */
+    temp_error_code = Get_MGRS_Zone_R (Parameters, &latitude, &longitude, Zone);
+    if (!temp_error_code)
     {
-      grid_northing = grid_northing - TWOMIL;
+      temp_error_code = Convert_Geodetic_To_UTM_Zone_R (&Parameters->UTM, latitude, longitude,
+                                                        *Zone, MGRS_Precision_Terms[Precision],
+                                                        &hemisphere, Easting, Northing,
+                                                        &easting_bound, &northing_bound);
+      if ((easting_bound > 0.0)
+          && (temp_error_code || Near_MGRS_Digit_Change (*Easting, easting_bound, Precision)
+              || Near_MGRS_Digit_Change (*Northing, northing_bound, Precision)))
+      { /* Too close to call: every term */
+        temp_error_code = Convert_Geodetic_To_UTM_Zone_R (&Parameters->UTM, latitude, longitude,
+                                                          *Zone, TRANMERC_EXACT_TERMS,
+                                                          &hemisphere, Easting, Northing,
+                                                          &easting_bound, &northing_bound);
+      }
     }
-    grid_northing = grid_northing + pattern_offset;
-    if(grid_northing >= TWOMIL)
-      grid_northing = grid_northing - TWOMIL;
-
-    letters[2] = (long)(grid_northing / ONEHT);
-    if (letters[2] > LETTER_H)
-      letters[2] = letters[2] + 1;
-
-    if (letters[2] > LETTER_N)
-      letters[2] = letters[2] + 1;
-
-    grid_easting = Easting;
-    if (((letters[0] == LETTER_V) && (Zone == 31)) && (grid_easting == 500000.0))
-      grid_easting = grid_easting - 1.0; /* SUBTRACT 1 METER */
+    MGRS_PROBE_END(MGRS_PROBE_GEODETIC_TO_UTM);
+    if(!temp_error_code)
+    {
+      MGRS_PROBE_BEGIN(MGRS_PROBE_UTM_TO_MGRS);
+      error_code |= UTM_To_MGRS_Letters_R (Parameters, *Zone, Latitude, Easting, Northing, Letters);
+      MGRS_PROBE_END(MGRS_PROBE_UTM_TO_MGRS);
+    }
+    else
+    {
+      if(temp_error_code & UTM_LAT_ERROR)
+        error_code |= MGRS_LAT_ERROR;
+      if(temp_error_code & UTM_LON_ERROR)
+        error_code |= MGRS_LON_ERROR;
+      if(temp_error_code & UTM_ZONE_OVERRIDE_ERROR)
+        error_code |= MGRS_ZONE_ERROR;
+      if(temp_error_code & UTM_EASTING_ERROR)
+        error_code |= MGRS_EASTING_ERROR;
+      if(temp_error_code & UTM_NORTHING_ERROR)
+        error_code |= MGRS_NORTHING_ERROR;
+    }
+  }
+  return (error_code);
+} /* Convert_Geodetic_To_MGRS_Letters_R */
 
-    letters[1] = ltr2_low_value + ((long)(grid_easting / ONEHT) -1);
-    if ((ltr2_low_value == LETTER_J) && (letters[1] > LETTER_N))
-      letters[1] = letters[1] + 1;
+long Convert_Geodetic_To_MGRS_R (const MGRS_Parameters *Parameters,
+                                 double Latitude,
+                                 double Longitude,
+                                 long Precision,
+                                 char* MGRS)
+/*
+ * The function Convert_Geodetic_To_MGRS_R converts Geodetic (latitude and
+ * longitude) coordinates to an MGRS coordinate string, according to the
+ * ellipsoid in Parameters.  It reads and writes no global state, so any
+ * number of threads may convert at once, sharing Parameters or not.  Only
+ * the Transverse Mercator terms in MGRS_Precision_Terms are evaluated
+ * unless the easting or northing is within their error bound of a change
+ * of digit, so the string is always that of the full series.  If any
+ * errors occur, the error code(s) are returned by the function, otherwise
+ * MGRS_NO_ERROR is returned.
+ *
+ *    Parameters : MGRS parameters                  (input)
+ *    Latitude   : Latitude in radians              (input)
+ *    Longitude  : Longitude in radians             (input)
+ *    Precision  : Precision level of MGRS string   (input)
+ *    MGRS       : MGRS coordinate string           (output)
+ *
+ */
+{ /* Convert_Geodetic_To_MGRS */
+  long zone;
+  int letters[MGRS_LETTERS];
+  double easting;
+  double northing;
+  long error_code = MGRS_NO_ERROR;
 
-    Make_MGRS_String (MGRS, Zone, letters, grid_easting, Northing, Precision);
-  }
-  return error_code;
-} /* END UTM_To_MGRS */
-  
+  error_code = Convert_Geodetic_To_MGRS_Letters_R (Parameters, Latitude, Longitude, Precision,
+                                                   &zone, letters, &easting, &northing);
+  if (!error_code)
+    Make_MGRS_String (MGRS, zone, letters, easting, northing, Precision);
+  return (error_code);
+} /* Convert_Geodetic_To_MGRS_R */
 
 long Convert_Geodetic_To_MGRS (double Latitude,
                                double Longitude,
@@ -363,55 +886,456 @@ long Convert_Geodetic_To_MGRS (double Latitude,
  *
  */
 { /* Convert_Geodetic_To_MGRS */
-  long zone;
-  char hemisphere;
-  double easting;
-  double northing;
-  long temp_error_code = MGRS_NO_ERROR;
+  return (Convert_Geodetic_To_MGRS_R(&MGRS_Default_Parameters, Latitude,
+                                     Longitude, Precision, MGRS));
+} /* Convert_Geodetic_To_MGRS */
+
+long Break_MGRS_String (const char* MGRS,
+                        long* Zone,
+                        int Letters[MGRS_LETTERS],
+                        double* Easting,
+                        double* Northing,
+                        long* Precision)
+/*
+ * The function Break_MGRS_String breaks down an MGRS
+ * coordinate string into its component parts: a zone of up to two
+ * digits (zero when absent), three letters, and an even number of up to
+ * ten easting and northing digits.  Leading blanks are skipped and
+ * letters may be lower case.
+ *
+ *   MGRS           : MGRS coordinate string          (input)
+ *   Zone           : UTM Zone                        (output)
+ *   Letters        : MGRS coordinate string letters  (output)
+ *   Easting        : Easting value                   (output)
+ *   Northing       : Northing value                  (output)
+ *   Precision      : Precision level of MGRS string  (output)
+ */
+{ /* Break_MGRS_String */
+  long num_digits;
+  long num_letters;
+  long i = 0;
+  long j = 0;
+  long n;
+  long east;
+  long north;
+  double multiplier;
   long error_code = MGRS_NO_ERROR;
 
-  if ((Latitude < -PI_OVER_2) || (Latitude > PI_OVER_2))
-  { /* Latitude out of range */
-    error_code |= MGRS_LAT_ERROR;
+  while (MGRS[i] == ' ')
+    i++;  /* skip any leading blanks */
+  j = i;
+  *Zone = 0;
+  while ((MGRS[i] >= '0') && (MGRS[i] <= '9'))
+  { /* a longer run is an error; only count the rest, so it cannot overflow */
+    if (i - j < 2)
+      *Zone = *Zone * 10 + (MGRS[i] - '0');
+    i++;
   }
-  if ((Longitude < -PI) || (Longitude > (2*PI)))
-  { /* Longitude out of range */
-    error_code |= MGRS_LON_ERROR;
+  num_digits = i - j;
+  if (num_digits > 2)
+    error_code |= MGRS_STRING_ERROR;
+  else if ((num_digits > 0) && ((*Zone < 1) || (*Zone > 60)))
+    error_code |= MGRS_STRING_ERROR;
+  j = i;
+
+  while (((MGRS[i] >= 'A') && (MGRS[i] <= 'Z')) || ((MGRS[i] >= 'a') && (MGRS[i] <= 'z')))
+    i++;
+  num_letters = i - j;
+  if (num_letters == 3)
+  {
+    /* get letters */
+    for (n = 0; n < MGRS_LETTERS; n++)
+    {
+      Letters[n] = (MGRS[j+n] & ~0x20) - 'A';  /* upper case letter index */
+      if ((Letters[n] == LETTER_I) || (Letters[n] == LETTER_O))
+        error_code |= MGRS_STRING_ERROR;
+    }
   }
-  if ((Precision < 0) || (Precision > MAX_PRECISION))
-    error_code |= MGRS_PRECISION_ERROR;
+  else
+    error_code |= MGRS_STRING_ERROR;
+  j = i;
+  while ((MGRS[i] >= '0') && (MGRS[i] <= '9'))
+    i++;
+  num_digits = i - j;
+  if ((num_digits <= 10) && (num_digits%2 == 0))
+  {
+    /* get easting & northing */
+    n = num_digits/2;
+    *Precision = n;
+    east = 0;
+    north = 0;
+    for (i = 0; i < n; i++)
+    {
+      east = east * 10 + (MGRS[j+i] - '0');
+      north = north * 10 + (MGRS[j+n+i] - '0');
+    }
+    multiplier = pow (10.0, 5 - n);
+    *Easting = east * multiplier;
+    *Northing = north * multiplier;
+  }
+  else
+    error_code |= MGRS_STRING_ERROR;
+
+  return (error_code);
+} /* Break_MGRS_String */
+
+long Get_Latitude_Band_Min_Northing(int letter, double* min_northing, double* northing_offset)
+/*
+ * The function Get_Latitude_Band_Min_Northing receives a latitude band letter
+ * and uses the Latitude_Band_Table to determine the minimum northing and northing offset
+ * for that latitude band letter.
+ *
+ *   letter          : Latitude band letter            (input)
+ *   min_northing    : Minimum northing for that letter (output)
+ *   northing_offset : Latitude band northing offset   (output)
+ */
+{ /* Get_Latitude_Band_Min_Northing */
+  long error_code = MGRS_NO_ERROR;
+
+  if ((letter >= LETTER_C) && (letter <= LETTER_H))
+  {
+    *min_northing = Latitude_Band_Table[letter-2].min_northing;
+    *northing_offset = Latitude_Band_Table[letter-2].northing_offset;
+  }
+  else if ((letter >= LETTER_J) && (letter <= LETTER_N))
+  {
+    *min_northing = Latitude_Band_Table[letter-3].min_northing;
+    *northing_offset = Latitude_Band_Table[letter-3].northing_offset;
+  }
+  else if ((letter >= LETTER_P) && (letter <= LETTER_X))
+  {
+    *min_northing = Latitude_Band_Table[letter-4].min_northing;
+    *northing_offset = Latitude_Band_Table[letter-4].northing_offset;
+  }
+  else
+    error_code |= MGRS_STRING_ERROR;
+
+  return error_code;
+} /* Get_Latitude_Band_Min_Northing */
+
+long Get_Latitude_Range(int letter, double* north, double* south)
+/*
+ * The function Get_Latitude_Range receives a latitude band letter
+ * and uses the Latitude_Band_Table to determine the latitude band
+ * boundaries for that latitude band letter.
+ *
+ *   letter   : Latitude band letter                        (input)
+ *   north    : Northern latitude boundary for that letter, radians (output)
+ *   south    : Southern latitude boundary for that letter, radians (output)
+ */
+{ /* Get_Latitude_Range */
+  long error_code = MGRS_NO_ERROR;
+
+  if ((letter >= LETTER_C) && (letter <= LETTER_H))
+  {
+    *north = Latitude_Band_Table[letter-2].north * DEG_TO_RAD;
+    *south = Latitude_Band_Table[letter-2].south * DEG_TO_RAD;
+  }
+  else if ((letter >= LETTER_J) && (letter <= LETTER_N))
+  {
+    *north = Latitude_Band_Table[letter-3].north * DEG_TO_RAD;
+    *south = Latitude_Band_Table[letter-3].south * DEG_TO_RAD;
+  }
+  else if ((letter >= LETTER_P) && (letter <= LETTER_X))
+  {
+    *north = Latitude_Band_Table[letter-4].north * DEG_TO_RAD;
+    *south = Latitude_Band_Table[letter-4].south * DEG_TO_RAD;
+  }
+  else
+    error_code |= MGRS_STRING_ERROR;
+
+  return error_code;
+} /* Get_Latitude_Range */
+
+long Get_MGRS_Square_Origin_R (const MGRS_Parameters *Parameters,
+                               long   Zone,
+                               const int Letters[MGRS_LETTERS],
+                               double *Easting,
+                               double *Northing)
+/*
+ * The function Get_MGRS_Square_Origin_R works out the UTM easting and
+ * northing of the south-west corner of the 100,000 meter square named by
+ * the 3 letters of an MGRS coordinate string in the given zone, by grid
+ * arithmetic alone.  The square letters fix the northing only to within a
+ * 2,000,000 meter cycle; the latitude band's minimum northing picks the
+ * cycle.  If any errors occur, the error code(s) are returned by the
+ * function, otherwise MGRS_NO_ERROR is returned.
+ *
+ *    Parameters : MGRS parameters                  (input)
+ *    Zone       : UTM Zone                         (input)
+ *    Letters    : MGRS coordinate string letters   (input)
+ *    Easting    : Easting (X) in meters            (output)
+ *    Northing   : Northing (Y) in meters           (output)
+ */
+{ /* Get_MGRS_Square_Origin_R */
+  double min_northing;
+  double northing_offset;
+  long ltr2_low_value;
+  long ltr2_high_value;
+  double pattern_offset;
+  double grid_easting;        /* Easting for 100,000 meter grid square      */
+  double grid_northing;       /* Northing for 100,000 meter grid square     */
+  long error_code = MGRS_NO_ERROR;
+
+  ltr2_low_value = Grid_Set_Table[Zone % 6].ltr2_low_value;
+  ltr2_high_value = Grid_Set_Table[Zone % 6].ltr2_high_value;
+  pattern_offset = Grid_Set_Table[Zone % 6].pattern_offset[Parameters->Grid_Pattern];
+
+  /* Check that the second letter of the MGRS string is within
+   * the range of valid second letter values
+   * Also check that the third letter is valid */
+  if ((Letters[1] < ltr2_low_value) || (Letters[1] > ltr2_high_value) || (Letters[2] > LETTER_V))
+    error_code |= MGRS_STRING_ERROR;
+
   if (!error_code)
   {
+    /* Undo the I and O skipping and the pattern offset of UTM_To_MGRS */
+    grid_northing = (double)(Letters[2]) * ONEHT - pattern_offset;
+    if (Letters[2] > LETTER_O)
+      grid_northing = grid_northing - ONEHT;
+
+    if (Letters[2] > LETTER_I)
+      grid_northing = grid_northing - ONEHT;
+
+    if (grid_northing < 0.0)
+      grid_northing = grid_northing + TWOMIL;
+
+    grid_easting = (double)((Letters[1]) - ltr2_low_value + 1) * ONEHT;
+    if ((ltr2_low_value == LETTER_J) && (Letters[1] > LETTER_O))
+      grid_easting = grid_easting - ONEHT;
+
+    error_code = Get_Latitude_Band_Min_Northing(Letters[0], &min_northing, &northing_offset);
+    if (!error_code)
+    {
+      /* Pick the 2,000,000 meter cycle that falls within the latitude band */
+      grid_northing = grid_northing + northing_offset;
+      if (grid_northing < min_northing)
+        grid_northing += TWOMIL;
 
-      temp_error_code = Set_UTM_Parameters (MGRS_a, MGRS_f, 0);
-      if(!temp_error_code)
+      *Easting = grid_easting;
+      *Northing = grid_northing;
+    }
+  }
+  return (error_code);
+} /* Get_MGRS_Square_Origin_R */
+
+long Convert_MGRS_To_UTM_Grid_R (const MGRS_Parameters *Parameters,
+                                 const char *MGRS,
+                                 long   *Zone,
+                                 int    Letters[MGRS_LETTERS],
+                                 char   *Hemisphere,
+                                 double *Easting,
+                                 double *Northing,
+                                 long   *Precision)
+/*
+ * The function Convert_MGRS_To_UTM_Grid_R converts an MGRS coordinate
+ * string to the UTM zone, hemisphere, easting and northing of the
+ * south-west corner of the MGRS cell, as Convert_MGRS_To_UTM_R does, but
+ * by grid arithmetic alone: the point is not projected, so whether it lies
+ * in its latitude band is not checked.  The letters and precision of the
+ * string are returned as well.  If any errors occur, the error code(s) are
+ * returned by the function, otherwise MGRS_NO_ERROR is returned.
+ *
+ *    Parameters : MGRS parameters                  (input)
+ *    MGRS       : MGRS coordinate string           (input)
+ *    Zone       : UTM Zone                         (output)
+ *    Letters    : MGRS coordinate string letters   (output)
+ *    Hemisphere : North or South hemisphere        (output)
+ *    Easting    : Easting (X) in meters            (output)
+ *    Northing   : Northing (Y) in meters           (output)
+ *    Precision  : Precision level of MGRS string   (output)
+ */
+{ /* Convert_MGRS_To_UTM_Grid_R */
+  double grid_easting;        /* Easting for 100,000 meter grid square      */
+  double grid_northing;       /* Northing for 100,000 meter grid square     */
+  long error_code = MGRS_NO_ERROR;
+
+  error_code = Break_MGRS_String (MGRS, Zone, Letters, Easting, Northing, Precision);
+  if (!*Zone)
+    error_code |= MGRS_STRING_ERROR;
+  if (!error_code)
+  {
+    if ((Letters[0] == LETTER_X) && ((*Zone == 32) || (*Zone == 34) || (*Zone == 36)))
+      error_code |= MGRS_STRING_ERROR;
+    else
+    {
+      if (Letters[0] < LETTER_N)
+        *Hemisphere = 'S';
+      else
+        *Hemisphere = 'N';
+
+      error_code = Get_MGRS_Square_Origin_R (Parameters, *Zone, Letters, &grid_easting, &grid_northing);
+      if (!error_code)
       {
-        temp_error_code = Convert_Geodetic_To_UTM (Latitude, Longitude, &zone, &hemisphere, &easting, &northing);
-        if(!temp_error_code)
-          error_code |= UTM_To_MGRS (zone, hemisphere, Longitude, Latitude, easting, northing, Precision, MGRS);
-        else
-        {
-          if(temp_error_code & UTM_LAT_ERROR)
-            error_code |= MGRS_LAT_ERROR;
-          if(temp_error_code & UTM_LON_ERROR)
-            error_code |= MGRS_LON_ERROR;
-          if(temp_error_code & UTM_ZONE_OVERRIDE_ERROR)
-            error_code |= MGRS_ZONE_ERROR;
-          if(temp_error_code & UTM_EASTING_ERROR)
-            error_code |= MGRS_EASTING_ERROR;
-          if(temp_error_code & UTM_NORTHING_ERROR)
-            error_code |= MGRS_NORTHING_ERROR;
-        }
+        *Easting = grid_easting + *Easting;
+        *Northing = grid_northing + *Northing;
       }
-      else
+    }
+  }
+  return (error_code);
+} /* Convert_MGRS_To_UTM_Grid_R */
+
+static long Convert_MGRS_To_UTM_Geodetic_R (const MGRS_Parameters *Parameters,
+                                            const char *MGRS,
+                                            long   *Zone,
+                                            char   *Hemisphere,
+                                            double *Easting,
+                                            double *Northing,
+                                            double *Latitude,
+                                            double *Longitude)
+/*
+ * Convert_MGRS_To_UTM_R, also giving the latitude and longitude of the
+ * cell corner that its latitude band check works out, so that they need
+ * not be worked out again.  They are set whenever no error other than
+ * MGRS_LAT_WARNING is returned.
+ */
+{
+  double upper_lat_limit;     /* North latitude limits based on 1st letter  */
+  double lower_lat_limit;     /* South latitude limits based on 1st letter  */
+  int letters[MGRS_LETTERS];
+  long in_precision;
+  double divisor = 1.0;
+  long utm_error_code = UTM_NO_ERROR;
+  long error_code = MGRS_NO_ERROR;
+
+  error_code = Convert_MGRS_To_UTM_Grid_R (Parameters, MGRS, Zone, letters, Hemisphere,
+                                           Easting, Northing, &in_precision);
+  if (!error_code)
+  {
+    /* check that point is within Zone Letter bounds */
+    utm_error_code = Convert_UTM_To_Geodetic_R(&Parameters->UTM, *Zone, *Hemisphere, *Easting, *Northing, Latitude, Longitude);
+    if (!utm_error_code)
+    {
+      divisor = pow (10.0, in_precision);
+      error_code = Get_Latitude_Range(letters[0], &upper_lat_limit, &lower_lat_limit);
+      if (!error_code)
       {
-        if(temp_error_code & UTM_A_ERROR)
-          error_code |= MGRS_A_ERROR;
-        if(temp_error_code & UTM_INV_F_ERROR)
-          error_code |= MGRS_INV_F_ERROR;
-        if(temp_error_code & UTM_ZONE_OVERRIDE_ERROR)
-          error_code |= MGRS_ZONE_ERROR;
+        if (!(((lower_lat_limit - DEG_TO_RAD/divisor) <= *Latitude) && (*Latitude <= (upper_lat_limit + DEG_TO_RAD/divisor))))
+          error_code |= MGRS_LAT_WARNING;
       }
+    }
+    else
+    {
+      if (utm_error_code & UTM_ZONE_ERROR)
+        error_code |= MGRS_ZONE_ERROR;
+      if (utm_error_code & UTM_HEMISPHERE_ERROR)
+        error_code |= MGRS_HEMISPHERE_ERROR;
+      if (utm_error_code & UTM_EASTING_ERROR)
+        error_code |= MGRS_EASTING_ERROR;
+      if (utm_error_code & UTM_NORTHING_ERROR)
+        error_code |= MGRS_NORTHING_ERROR;
+    }
   }
   return (error_code);
-} /* Convert_Geodetic_To_MGRS */
+}
+
+long Convert_MGRS_To_UTM_R (const MGRS_Parameters *Parameters,
+                            const char *MGRS,
+                            long   *Zone,
+                            char   *Hemisphere,
+                            double *Easting,
+                            double *Northing)
+/*
+ * The function Convert_MGRS_To_UTM_R converts an MGRS coordinate string
+ * to UTM projection (zone, hemisphere, easting and northing) coordinates
+ * of the south-west corner of the MGRS cell, according to the ellipsoid
+ * in Parameters.  The 100,000 meter square letters fix the northing only
+ * to within a 2,000,000 meter cycle; the latitude band's minimum northing
+ * picks the cycle.  MGRS_LAT_WARNING is set when the point lies outside
+ * its latitude band.  If any errors occur, the error code(s) are returned
+ * by the function, otherwise MGRS_NO_ERROR is returned.
+ *
+ *    Parameters : MGRS parameters                  (input)
+ *    MGRS       : MGRS coordinate string           (input)
+ *    Zone       : UTM Zone                         (output)
+ *    Hemisphere : North or South hemisphere        (output)
+ *    Easting    : Easting (X) in meters            (output)
+ *    Northing   : Northing (Y) in meters           (output)
+ */
+{ /* Convert_MGRS_To_UTM_R */
+  double latitude = 0.0;
+  double longitude = 0.0;
+
+  return (Convert_MGRS_To_UTM_Geodetic_R (Parameters, MGRS, Zone, Hemisphere, Easting, Northing,
+                                          &latitude, &longitude));
+} /* Convert_MGRS_To_UTM_R */
+
+long Convert_MGRS_To_UTM (const char *MGRS,
+                          long   *Zone,
+                          char   *Hemisphere,
+                          double *Easting,
+                          double *Northing)
+/*
+ * The function Convert_MGRS_To_UTM converts an MGRS coordinate string
+ * to UTM projection (zone, hemisphere, easting and northing) coordinates
+ * according to the current ellipsoid parameters.  If any errors occur,
+ * the error code(s) are returned by the function, otherwise MGRS_NO_ERROR
+ * is returned.
+ *
+ *    MGRS       : MGRS coordinate string           (input)
+ *    Zone       : UTM Zone                         (output)
+ *    Hemisphere : North or South hemisphere        (output)
+ *    Easting    : Easting (X) in meters            (output)
+ *    Northing   : Northing (Y) in meters           (output)
+ */
+{ /* Convert_MGRS_To_UTM */
+  return (Convert_MGRS_To_UTM_R(&MGRS_Default_Parameters, MGRS, Zone,
+                                Hemisphere, Easting, Northing));
+} /* Convert_MGRS_To_UTM */
+
+long Convert_MGRS_To_Geodetic_R (const MGRS_Parameters *Parameters,
+                                 const char* MGRS,
+                                 double *Latitude,
+                                 double *Longitude)
+/*
+ * The function Convert_MGRS_To_Geodetic_R converts an MGRS coordinate
+ * string to Geodetic (latitude and longitude) coordinates of the
+ * south-west corner of the MGRS cell, according to the ellipsoid in
+ * Parameters.  Only zoned (UTM) strings are accepted.  If any errors
+ * occur, the error code(s) are returned by the function, otherwise
+ * MGRS_NO_ERROR is returned.
+ *
+ *    Parameters : MGRS parameters                  (input)
+ *    MGRS       : MGRS coordinate string           (input)
+ *    Latitude   : Latitude in radians              (output)
+ *    Longitude  : Longitude in radians             (output)
+ */
+{ /* Convert_MGRS_To_Geodetic_R */
+  long zone;
+  char hemisphere;
+  double easting;
+  double northing;
+  double latitude;
+  double longitude;
+  long error_code = MGRS_NO_ERROR;
+
+  /* The band check has already inverted the projection */
+  error_code = Convert_MGRS_To_UTM_Geodetic_R (Parameters, MGRS, &zone, &hemisphere, &easting,
+                                               &northing, &latitude, &longitude);
+  if (!error_code || (error_code & MGRS_LAT_WARNING))
+  {
+    *Latitude = latitude;
+    *Longitude = longitude;
+  }
+  return (error_code);
+} /* Convert_MGRS_To_Geodetic_R */
+
+long Convert_MGRS_To_Geodetic (const char* MGRS,
+                               double *Latitude,
+                               double *Longitude)
+/*
+ * The function Convert_MGRS_To_Geodetic converts an MGRS coordinate string
+ * to Geodetic (latitude and longitude) coordinates according to the
+ * current ellipsoid parameters.  If any errors occur, the error code(s)
+ * are returned by the function, otherwise MGRS_NO_ERROR is returned.
+ *
+ *    MGRS       : MGRS coordinate string           (input)
+ *    Latitude   : Latitude in radians              (output)
+ *    Longitude  : Longitude in radians             (output)
+ */
+{ /* Convert_MGRS_To_Geodetic */
+  return (Convert_MGRS_To_Geodetic_R(&MGRS_Default_Parameters, MGRS,
+                                     Latitude, Longitude));
+} /* Convert_MGRS_To_Geodetic */
+
+#endif /* MGRS_H */
@@ -0,0 +1,341 @@
+#ifndef MGRS_BATCH_H
+#define MGRS_BATCH_H
+
+#include "mgrs.h"
+
+/*
+ * Batch conversion of geodetic positions to MGRS grid components.
+ *
+ * The positions are passed as contiguous latitude and longitude arrays and
+ * the results come back as zone, band, easting and northing arrays plus a
+ * per-element MGRS_*_ERROR bitmask.  Zone selection, by Get_MGRS_Zone_R
+ * with its 31V edge case, stays scalar; the Transverse Mercator series is
+ * evaluated TM_BATCH_WIDTH points at a time with AVX2 or SSE2 on x86-64,
+ * or one at a time elsewhere.
+ *
+ * The vector kernel derives sin/cos of the latitude from one polynomial
+ * sincos and the multiple-angle sines of the meridional arc from double
+ * angle identities, instead of calling libm.  Easting and northing agree
+ * with Convert_Geodetic_To_UTM_R to within TM_BATCH_TOLERANCE meters.
+ * Defining MGRS_BATCH_SCALAR selects the one point at a time kernel on
+ * x86-64 too; TM_BATCH_ISA names the kernel built.
+ */
+
+#if defined(__x86_64__) && defined(__AVX2__) && !defined(MGRS_BATCH_SCALAR)
+#include <immintrin.h>
+#define TM_BATCH_ISA           "avx2"
+#define TM_BATCH_WIDTH         4
+typedef double TM_Vector __attribute__ ((vector_size (32)));
+#define TM_SQRT(a)             ((TM_Vector) _mm256_sqrt_pd ((__m256d) (a)))
+#elif defined(__x86_64__) && defined(__SSE2__) && !defined(MGRS_BATCH_SCALAR)
+#include <emmintrin.h>
+#define TM_BATCH_ISA           "sse2"
+#define TM_BATCH_WIDTH         2
+typedef double TM_Vector __attribute__ ((vector_size (16)));
+#define TM_SQRT(a)             ((TM_Vector) _mm_sqrt_pd ((__m128d) (a)))
+#else
+#define TM_BATCH_ISA           "scalar"
+#define TM_BATCH_WIDTH         1
+typedef double TM_Vector;
+#define TM_SQRT(a)             sqrt(a)
+#endif
+
+#define TM_LOAD(v, p)          memcpy (&(v), (p), sizeof (TM_Vector))
+#define TM_STORE(p, v)         memcpy ((p), &(v), sizeof (TM_Vector))
+
+#define TM_BATCH_BLOCK         64        /* Points per kernel call, multiple of TM_BATCH_WIDTH */
+#define TM_BATCH_TOLERANCE     1.0e-6    /* Max easting/northing difference from scalar path, meters */
+
+#define TM_PIO4                0.78539816339744830962  /* PI/4                        */
+#define TM_PIO2_HI             1.57079632679489655800  /* PI/2, high part             */
+#define TM_PIO2_LO             6.12323399573676603587e-17 /* PI/2, low part           */
+
+static inline void TM_Batch_Sincos(TM_Vector x, TM_Vector *s, TM_Vector *c)
+/*
+ * Sine and cosine of latitudes in [-PI/2, PI/2].  The absolute value is
+ * folded onto [0, PI/4] with PI/2 - |x| where needed; that subtraction is
+ * exact on the folded range, so only the low part of PI/2 has to be added.
+ * The polynomials are the Cephes ones, accurate to 1 ulp on [0, PI/4].
+ */
+{
+  TM_Vector ax = (x < 0) ? -x : x;
+  TM_Vector r = (ax > TM_PIO4) ? (TM_PIO2_HI - ax) + TM_PIO2_LO : ax;
+  TM_Vector z = r * r;
+  TM_Vector sr;
+  TM_Vector cr;
+
+  sr = r + r * z * (((((1.58962301576546568060e-10 * z - 2.50507477628578072866e-8) * z
+                       + 2.75573136213857245213e-6) * z - 1.98412698295895385996e-4) * z
+                     + 8.33333333332211858878e-3) * z - 1.66666666666666307295e-1);
+  cr = 1.0 - 0.5 * z + z * z * (((((-1.13585365213876817300e-11 * z + 2.08757008419747316778e-9) * z
+                                   - 2.75573141792967388112e-7) * z + 2.48015872888517045348e-5) * z
+                                 - 1.38888888888730564116e-3) * z + 4.16666666666665929218e-2);
+  *s = (ax > TM_PIO4) ? cr : sr;
+  *s = (x < 0) ? -*s : *s;
+  *c = (ax > TM_PIO4) ? sr : cr;
+}
+
+void Convert_Geodetic_To_Transverse_Mercator_Batch (const TranMerc_Ellipsoid *Ellipsoid,
+                                                    double Scale_Factor,
+                                                    double False_Easting,
+                                                    double tmdo,
+                                                    long Count,
+                                                    const double *Latitude,
+                                                    const double *Delta_Longitude,
+                                                    const double *False_Northing,
+                                                    double *Easting,
+                                                    double *Northing)
+/*
+ * The function Convert_Geodetic_To_Transverse_Mercator_Batch evaluates the
+ * Transverse Mercator series of Convert_Geodetic_To_Transverse_Mercator_R
+ * for Count points.  Each point has its own longitude difference from its
+ * central meridian (already wrapped and rounded to zero as the scalar
+ * function does) and its own false northing; the ellipsoid, scale factor,
+ * false easting and origin meridional distance are shared.  No range
+ * checking is done.  Count must be a multiple of TM_BATCH_WIDTH.  When the
+ * ellipsoid selects TRANMERC_KRUGER_SERIES the points are passed to
+ * Transverse_Mercator_Kruger one at a time instead.
+ *
+ *    Ellipsoid       : Ellipsoid constants                     (input)
+ *    Scale_Factor    : Projection scale factor                 (input)
+ *    False_Easting   : False easting in meters                 (input)
+ *    tmdo            : True meridional distance of origin      (input)
+ *    Count           : Number of points                        (input)
+ *    Latitude        : Latitudes in radians                    (input)
+ *    Delta_Longitude : Longitudes less central meridian, radians (input)
+ *    False_Northing  : False northings in meters               (input)
+ *    Easting         : Eastings in meters                      (output)
+ *    Northing        : Northings in meters                     (output)
+ */
+{ /* BEGIN Convert_Geodetic_To_Transverse_Mercator_Batch */
+  long i;
+
+  if (Ellipsoid->Series == TRANMERC_KRUGER_SERIES)
+  { /* The Kruger series is evaluated one point at a time */
+    double x;
+    double y;
+
+    for (i = 0; i < Count; i++)
+    {
+      Transverse_Mercator_Kruger(&Ellipsoid->Kruger, Latitude[i], Delta_Longitude[i], &x, &y);
+      Easting[i] = False_Easting + Scale_Factor * x;
+      Northing[i] = False_Northing[i] + Scale_Factor * (y - tmdo);
+    }
+    return;
+  }
+
+  for (i = 0; i < Count; i += TM_BATCH_WIDTH)
+  {
+    TM_Vector lat, dlam, dlam2, fn;
+    TM_Vector s, c, c2, c3, c5, c7;
+    TM_Vector t, tan2, tan4, tan6;
+    TM_Vector eta, eta2, eta3, eta4;
+    TM_Vector s2, c2a, s4, c4a, s6, s8;
+    TM_Vector sn, tmd, snk;
+    TM_Vector t1, t2, t3, t4, t5, t6, t7, t8, t9;
+    TM_Vector east, north;
+
+    TM_LOAD(lat, Latitude + i);
+    TM_LOAD(dlam, Delta_Longitude + i);
+    TM_LOAD(fn, False_Northing + i);
+    dlam2 = dlam * dlam;
+
+    TM_Batch_Sincos(lat, &s, &c);
+    c2 = c * c;
+    c3 = c2 * c;
+    c5 = c3 * c2;
+    c7 = c5 * c2;
+    t = s / c;
+    tan2 = t * t;
+    tan4 = tan2 * tan2;
+    tan6 = tan4 * tan2;
+    eta = Ellipsoid->ebs * c2;
+    eta2 = eta * eta;
+    eta3 = eta2 * eta;
+    eta4 = eta3 * eta;
+
+    /* radius of curvature in prime vertical */
+    sn = Ellipsoid->a / TM_SQRT(1.e0 - Ellipsoid->es * (s * s));
+
+    /* True Meridianal Distance, sines of 2, 4, 6 and 8 times latitude */
+    s2 = 2.e0 * s * c;
+    c2a = c2 - s * s;
+    s4 = 2.e0 * s2 * c2a;
+    c4a = 1.e0 - 2.e0 * s2 * s2;
+    s6 = s4 * c2a + c4a * s2;
+    s8 = 2.e0 * s4 * c4a;
+    tmd = Ellipsoid->ap * lat - Ellipsoid->bp * s2 + Ellipsoid->cp * s4
+          - Ellipsoid->dp * s6 + Ellipsoid->ep * s8;
+
+    /* northing */
+    snk = sn * Scale_Factor;
+    t1 = (tmd - tmdo) * Scale_Factor;
+    t2 = snk * s * c / 2.e0;
+    t3 = snk * s * c3 * (5.e0 - tan2 + 9.e0 * eta + 4.e0 * eta2) / 24.e0;
+    t4 = snk * s * c5 * (61.e0 - 58.e0 * tan2 + tan4 + 270.e0 * eta
+                         - 330.e0 * tan2 * eta + 445.e0 * eta2 + 324.e0 * eta3
+                         - 680.e0 * tan2 * eta2 + 88.e0 * eta4
+                         - 600.e0 * tan2 * eta3 - 192.e0 * tan2 * eta4) / 720.e0;
+    t5 = snk * s * c7 * (1385.e0 - 3111.e0 * tan2 + 543.e0 * tan4 - tan6) / 40320.e0;
+
+    north = fn + t1 + dlam2 * (t2 + dlam2 * (t3 + dlam2 * (t4 + dlam2 * t5)));
+
+    /* Easting */
+    t6 = snk * c;
+    t7 = snk * c3 * (1.e0 - tan2 + eta) / 6.e0;
+    t8 = snk * c5 * (5.e0 - 18.e0 * tan2 + tan4 + 14.e0 * eta - 58.e0 * tan2 * eta
+                     + 13.e0 * eta2 + 4.e0 * eta3 - 64.e0 * tan2 * eta2
+                     - 24.e0 * tan2 * eta3) / 120.e0;
+    t9 = snk * c7 * (61.e0 - 479.e0 * tan2 + 179.e0 * tan4 - tan6) / 5040.e0;
+
+    east = False_Easting + dlam * (t6 + dlam2 * (t7 + dlam2 * (t8 + dlam2 * t9)));
+
+    TM_STORE(Northing + i, north);
+    TM_STORE(Easting + i, east);
+  }
+} /* END OF Convert_Geodetic_To_Transverse_Mercator_Batch */
+
+long Convert_Geodetic_To_MGRS_Batch (const MGRS_Parameters *Parameters,
+                                     long Count,
+                                     const double *Latitude,
+                                     const double *Longitude,
+                                     long *Zone,
+                                     int *Band,
+                                     double *Easting,
+                                     double *Northing,
+                                     long *Error)
+/*
+ * The function Convert_Geodetic_To_MGRS_Batch converts Count geodetic
+ * (latitude and longitude) coordinates to the MGRS zone, latitude band
+ * letter index (LETTER_C .. LETTER_X), and UTM easting and northing of the
+ * zone the MGRS string would use, with the same error checks, 31V edge
+ * handling and equator adjustment as Convert_Geodetic_To_MGRS_R.  Each
+ * element's error code is written to Error; its other outputs are only
+ * meaningful when that code is MGRS_NO_ERROR.  The bitwise OR of all
+ * element error codes is returned.
+ *
+ *    Parameters : MGRS parameters                  (input)
+ *    Count      : Number of points                 (input)
+ *    Latitude   : Latitudes in radians             (input)
+ *    Longitude  : Longitudes in radians            (input)
+ *    Zone       : UTM zones                        (output)
+ *    Band       : Latitude band letter indices     (output)
+ *    Easting    : Eastings in meters               (output)
+ *    Northing   : Northings in meters              (output)
+ *    Error      : Per-element error codes          (output)
+ */
+{ /* Convert_Geodetic_To_MGRS_Batch */
+  double lat[TM_BATCH_BLOCK];
+  double dlam[TM_BATCH_BLOCK];
+  double false_northing[TM_BATCH_BLOCK];
+  double east[TM_BATCH_BLOCK];
+  double north[TM_BATCH_BLOCK];
+  long all_error_code = MGRS_NO_ERROR;
+  long base;
+  long n;
+  long i;
+
+  for (base = 0; base < Count; base += TM_BATCH_BLOCK)
+  {
+    n = Count - base;
+    if (n > TM_BATCH_BLOCK)
+      n = TM_BATCH_BLOCK;
+
+    /* Range checks, zone selection and longitude difference */
+    for (i = 0; i < n; i++)
+    {
+      double la = Latitude[base + i];
+      double lo = Longitude[base + i];
+      long temp_error_code;
+      long error_code = MGRS_NO_ERROR;
+      const TranMerc_Projection *projection;
+
+      lat[i] = 0.0;
+      dlam[i] = 0.0;
+      false_northing[i] = 0.0;
+      if (!((la >= -PI_OVER_2) && (la <= PI_OVER_2)))   /* NaNs fail too */
+        error_code |= MGRS_LAT_ERROR;
+      if (!((lo >= -PI) && (lo <= (2*PI))))
+        error_code |= MGRS_LON_ERROR;
+      if (!error_code)
+      {
+        temp_error_code = Get_MGRS_Zone_R(Parameters, &la, &lo, &Zone[base + i]);
+        if (temp_error_code & UTM_LAT_ERROR)
+          error_code |= MGRS_LAT_ERROR;
+        if (temp_error_code & UTM_LON_ERROR)
+          error_code |= MGRS_LON_ERROR;
+        if (temp_error_code & UTM_ZONE_OVERRIDE_ERROR)
+          error_code |= MGRS_ZONE_ERROR;
+      }
+      if (!error_code)
+      {
+        projection = &UTM_Zone_Projection[Zone[base + i] - 1][la < 0];
+        if (lo > PI)
+          lo -= (2 * PI);
+        lat[i] = la;
+        dlam[i] = lo - projection->Origin_Long;
+        if (dlam[i] > PI)
+          dlam[i] -= (2 * PI);
+        if (dlam[i] < -PI)
+          dlam[i] += (2 * PI);
+        if (fabs(dlam[i]) < 2.e-10)
+          dlam[i] = 0.0;
+        false_northing[i] = projection->False_Northing;
+      }
+      Error[base + i] = error_code;
+    }
+    for (; i % TM_BATCH_WIDTH; i++)
+    {
+      lat[i] = 0.0;
+      dlam[i] = 0.0;
+      false_northing[i] = 0.0;
+    }
+
+    Convert_Geodetic_To_Transverse_Mercator_Batch(&Parameters->UTM.Ellipsoid,
+                                                  UTM_Zone_Projection[0][0].Scale_Factor,
+                                                  UTM_Zone_Projection[0][0].False_Easting,
+                                                  UTM_Zone_Projection[0][0].tmdo,
+                                                  i, lat, dlam, false_northing,
+                                                  east, north);
+
+    /* Grid range checks and latitude band */
+    for (i = 0; i < n; i++)
+    {
+      double la = Latitude[base + i];
+      long temp_error_code = UTM_NO_ERROR;
+      long error_code = Error[base + i];
+
+      if (error_code)
+      {
+        all_error_code |= error_code;
+        continue;
+      }
+      if ((east[i] < MIN_EASTING) || (east[i] > MAX_EASTING))
+        temp_error_code = UTM_EASTING_ERROR;
+      if ((north[i] < MIN_NORTHING) || (north[i] > MAX_NORTHING))
+        temp_error_code |= UTM_NORTHING_ERROR;
+
+      if (temp_error_code & UTM_EASTING_ERROR)
+        error_code |= MGRS_EASTING_ERROR;
+      if (temp_error_code & UTM_NORTHING_ERROR)
+        error_code |= MGRS_NORTHING_ERROR;
+
+      if (!error_code)
+      {
+        if (la <= 0.0 && north[i] == 1.0e7)
+        {
+          la = 0.0;
+          north[i] = 0.0;
+        }
+        error_code = Get_Latitude_Letter(la, &Band[base + i]);
+        Easting[base + i] = east[i];
+        Northing[base + i] = north[i];
+      }
+      Error[base + i] = error_code;
+      all_error_code |= error_code;
+    }
+  }
+  return (all_error_code);
+} /* Convert_Geodetic_To_MGRS_Batch */
+
+#endif /* MGRS_BATCH_H */
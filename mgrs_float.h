@@ -0,0 +1,425 @@
+#ifndef MGRS_FLOAT_H
+#define MGRS_FLOAT_H
+
+#include "mgrs.h"
+
+/*
+ * Geodetic to MGRS conversion for targets without a floating point unit,
+ * taking latitude and longitude in millionths of a degree, as TinyGPS's
+ * get_position returns them.
+ *
+ * The zone, the Norway and Svalbard special cases and the latitude band are
+ * decided on the integer microdegrees, so zone and band edges are exact.
+ * The leading term of the meridional distance is a 64 bit fixed point
+ * product of the latitude in microdegrees; the rest of the Transverse
+ * Mercator series is evaluated in single precision.  No double precision
+ * arithmetic is done per point.
+ *
+ * Against Convert_Geodetic_To_MGRS_R on the same position, the easting and
+ * northing differ by at most MGRS_FLOAT_TOLERANCE meters.  The strings are
+ * therefore identical unless the double precision easting or northing lies
+ * within MGRS_FLOAT_TOLERANCE of a multiple of 10^(5 - Precision) meters,
+ * or the position lies exactly on a zone or band edge, where the double
+ * precision path's own rounding of the edge decides.
+ */
+
+#define MGRS_FLOAT_TOLERANCE   0.15      /* Max easting/northing difference from double path, meters */
+#define MICRODEGREES           1000000L  /* Microdegrees in a degree                   */
+#define MGRS_FIXED_BITS        38        /* Fraction bits of fixed point northings     */
+#define MGRS_FIXED_ONE         274877906944.0f  /* 2^MGRS_FIXED_BITS                   */
+#define DEG_TO_RAD_F           0.0174532925199432958f     /* PI/180                    */
+#define MICRODEG_TO_RAD_F      1.74532925199432958e-8f    /* PI/180000000              */
+
+typedef struct MGRS_Float_Parameters_Value
+{
+  long Override;             /* Zone override, zero for none               */
+  float ka;                  /* Scale factor times semi-major axis         */
+  float es;                  /* Eccentricity squared                       */
+  float ebs;                 /* Second eccentricity squared                */
+  float kbp;                 /* Scale factor times meridional distance     */
+  float kcp;                 /* sine coefficients                          */
+  float kdp;
+  float kep;
+  long long kap;             /* Scale factor times meridional distance per */
+                             /* microdegree, MGRS_FIXED_BITS fraction bits */
+  long Pattern_Offset[6];    /* 3rd letter pattern offset, by zone % 6     */
+} MGRS_Float_Parameters;
+
+MGRS_Float_Parameters Make_MGRS_Float_Parameters (const MGRS_Parameters *Parameters)
+/*
+ * The function Make_MGRS_Float_Parameters derives the single precision and
+ * fixed point constants and pattern offsets Convert_Microdegrees_To_MGRS_R
+ * uses from the ellipsoid, zone override and grid pattern in Parameters.
+ * It is the only place double precision arithmetic is done.
+ *
+ *    Parameters : MGRS parameters                  (input)
+ */
+{ /* Make_MGRS_Float_Parameters */
+  MGRS_Float_Parameters p;
+  const TranMerc_Ellipsoid *e = &Parameters->UTM.Ellipsoid;
+  double k = UTM_Zone_Projection[0][0].Scale_Factor;
+  long zone;
+
+  p.Override = Parameters->UTM.Override;
+  for (zone = 0; zone < 6; zone++)
+    p.Pattern_Offset[zone] = (long)Grid_Set_Table[zone].pattern_offset[Parameters->Grid_Pattern];
+  p.ka = (float)(k * e->a);
+  p.es = (float)e->es;
+  p.ebs = (float)e->ebs;
+  p.kbp = (float)(k * e->bp);
+  p.kcp = (float)(k * e->cp);
+  p.kdp = (float)(k * e->dp);
+  p.kep = (float)(k * e->ep);
+  p.kap = (long long)(k * e->ap * (PI / 180.0e6) * (double)MGRS_FIXED_ONE + 0.5);
+  return (p);
+} /* Make_MGRS_Float_Parameters */
+
+/* Derived from MGRS_Default_Parameters, which is initialised first */
+static const MGRS_Float_Parameters MGRS_Float_Default_Parameters =
+  Make_MGRS_Float_Parameters(&MGRS_Default_Parameters);
+
+static float Microdegrees_To_Radians (long Angle)
+/*
+ * Converts Angle to radians without first rounding it to the 24 bits of a
+ * float, which would lose up to 8 microdegrees.
+ */
+{
+  long degrees = Angle / MICRODEGREES;
+
+  return ((float)degrees * DEG_TO_RAD_F
+          + (float)(Angle - degrees * MICRODEGREES) * MICRODEG_TO_RAD_F);
+}
+
+long Get_UTM_Zone_Microdegrees (long Override,
+                                long Latitude,
+                                long Longitude,
+                                long *Zone)
+/*
+ * The function Get_UTM_Zone_Microdegrees selects the UTM zone of a position
+ * given in microdegrees, as Get_UTM_Zone_R does in radians, applying the
+ * Norway and Svalbard special cases and the zone override.  The position
+ * must already be within the UTM latitude and longitude ranges.  If the
+ * override is not allowed here, UTM_ZONE_OVERRIDE_ERROR is returned,
+ * otherwise UTM_NO_ERROR is returned.
+ *
+ *    Override          : Zone override, zero for none        (input)
+ *    Latitude          : Latitude in microdegrees            (input)
+ *    Longitude         : Longitude in microdegrees           (input)
+ *    Zone              : UTM zone                            (output)
+ */
+{ /* Get_UTM_Zone_Microdegrees */
+  long Lat_Degrees;
+  long Long_Degrees;
+  long temp_zone;
+  long Error_Code = UTM_NO_ERROR;
+
+  if (Longitude < 0)
+    Longitude += 360 * MICRODEGREES;
+
+  Lat_Degrees = Latitude / MICRODEGREES;
+  Long_Degrees = Longitude / MICRODEGREES;
+
+  if (Longitude < 180 * MICRODEGREES)
+    temp_zone = 31 + Longitude / (6 * MICRODEGREES);
+  else
+    temp_zone = Longitude / (6 * MICRODEGREES) - 29;
+
+  if (temp_zone > 60)
+    temp_zone = 1;
+  /* UTM special cases, by whole degrees as Get_UTM_Zone_R looks them up */
+  if ((Lat_Degrees > 55) && (Long_Degrees < UTM_SPECIAL_LONGITUDES)
+      && UTM_Special_Zone_Table[(Lat_Degrees - 56) / 8][Long_Degrees])
+    temp_zone = UTM_Special_Zone_Table[(Lat_Degrees - 56) / 8][Long_Degrees];
+
+  if (Override)
+  {
+    if ((temp_zone == 1) && (Override == 60))
+      temp_zone = Override;
+    else if ((temp_zone == 60) && (Override == 1))
+      temp_zone = Override;
+    else if ((Lat_Degrees > 71) && (Long_Degrees < UTM_SPECIAL_LONGITUDES))
+    {
+      if (((temp_zone-2) <= Override) && (Override <= (temp_zone+2)))
+        temp_zone = Override;
+      else
+        Error_Code = UTM_ZONE_OVERRIDE_ERROR;
+    }
+    else if (((temp_zone-1) <= Override) && (Override <= (temp_zone+1)))
+      temp_zone = Override;
+    else
+      Error_Code = UTM_ZONE_OVERRIDE_ERROR;
+  }
+  *Zone = temp_zone;
+  return (Error_Code);
+} /* Get_UTM_Zone_Microdegrees */
+
+long Get_UTM_Meters (const MGRS_Float_Parameters *Parameters,
+                     long Latitude,
+                     long Delta_Longitude,
+                     long *Easting,
+                     long *Northing)
+/*
+ * The function Get_UTM_Meters evaluates the Transverse Mercator series for
+ * a UTM zone in single precision and fixed point, giving the easting and
+ * northing truncated to whole meters.  If they are outside the UTM grid,
+ * MGRS_EASTING_ERROR and/or MGRS_NORTHING_ERROR are returned, otherwise
+ * MGRS_NO_ERROR is returned.
+ *
+ *    Parameters      : Single precision MGRS parameters       (input)
+ *    Latitude        : Latitude in microdegrees               (input)
+ *    Delta_Longitude : Longitude less central meridian,       (input)
+ *                      in microdegrees
+ *    Easting         : Easting in whole meters                (output)
+ *    Northing        : Northing in whole meters               (output)
+ */
+{ /* Get_UTM_Meters */
+  float dlam;
+  float dlam2;
+  float phi;
+  float s, c, c2, c3, c5, c7;
+  float tan2, tan4, tan6;
+  float eta, eta2, eta3, eta4;
+  float s2, c2a, s4, c4a, s6, s8;
+  float snk;
+  float t2, t3, t4, t5, t6, t7, t8, t9;
+  float north;        /* Northing less the fixed point meridional term  */
+  float east;         /* Easting less the false easting                 */
+  long long north_fixed;
+  long error_code = MGRS_NO_ERROR;
+  MGRS_PROBE_BEGIN(MGRS_PROBE_TRANSVERSE_MERCATOR);
+
+  dlam = Microdegrees_To_Radians(Delta_Longitude);
+  dlam2 = dlam * dlam;
+
+  phi = Microdegrees_To_Radians(Latitude);
+  s = sinf(phi);
+  c = cosf(phi);
+  c2 = c * c;
+  c3 = c2 * c;
+  c5 = c3 * c2;
+  c7 = c5 * c2;
+  tan2 = (s * s) / c2;
+  tan4 = tan2 * tan2;
+  tan6 = tan4 * tan2;
+  eta = Parameters->ebs * c2;
+  eta2 = eta * eta;
+  eta3 = eta2 * eta;
+  eta4 = eta3 * eta;
+
+  /* radius of curvature in prime vertical, times scale factor */
+  snk = Parameters->ka / sqrtf(1.0f - Parameters->es * (s * s));
+
+  /* Meridional distance, less its fixed point leading term */
+  s2 = 2.0f * s * c;
+  c2a = c2 - s * s;
+  s4 = 2.0f * s2 * c2a;
+  c4a = 1.0f - 2.0f * s2 * s2;
+  s6 = s4 * c2a + c4a * s2;
+  s8 = 2.0f * s4 * c4a;
+
+  /* northing */
+  t2 = snk * s * c / 2.0f;
+  t3 = snk * s * c3 * (5.0f - tan2 + 9.0f * eta + 4.0f * eta2) / 24.0f;
+  t4 = snk * s * c5 * (61.0f - 58.0f * tan2 + tan4 + 270.0f * eta
+                       - 330.0f * tan2 * eta + 445.0f * eta2 + 324.0f * eta3
+                       - 680.0f * tan2 * eta2 + 88.0f * eta4
+                       - 600.0f * tan2 * eta3 - 192.0f * tan2 * eta4) / 720.0f;
+  t5 = snk * s * c7 * (1385.0f - 3111.0f * tan2 + 543.0f * tan4 - tan6) / 40320.0f;
+  north = - Parameters->kbp * s2 + Parameters->kcp * s4
+          - Parameters->kdp * s6 + Parameters->kep * s8
+          + dlam2 * (t2 + dlam2 * (t3 + dlam2 * (t4 + dlam2 * t5)));
+
+  north_fixed = (long long)Latitude * Parameters->kap + (long long)(north * MGRS_FIXED_ONE);
+  if (Latitude < 0)
+    north_fixed += (long long)MAX_NORTHING << MGRS_FIXED_BITS;
+  *Northing = (long)(north_fixed >> MGRS_FIXED_BITS);
+
+  /* Easting */
+  t6 = snk * c;
+  t7 = snk * c3 * (1.0f - tan2 + eta) / 6.0f;
+  t8 = snk * c5 * (5.0f - 18.0f * tan2 + tan4 + 14.0f * eta - 58.0f * tan2 * eta
+                   + 13.0f * eta2 + 4.0f * eta3 - 64.0f * tan2 * eta2
+                   - 24.0f * tan2 * eta3) / 120.0f;
+  t9 = snk * c7 * (61.0f - 479.0f * tan2 + 179.0f * tan4 - tan6) / 5040.0f;
+  east = dlam * (t6 + dlam2 * (t7 + dlam2 * (t8 + dlam2 * t9)));
+  *Easting = 500000L + (long)floorf(east);
+
+  if ((*Easting < MIN_EASTING) || (*Easting > MAX_EASTING))
+    error_code |= MGRS_EASTING_ERROR;
+  if ((*Northing < MIN_NORTHING) || (*Northing > MAX_NORTHING))
+    error_code |= MGRS_NORTHING_ERROR;
+  MGRS_PROBE_END(MGRS_PROBE_TRANSVERSE_MERCATOR);
+  return (error_code);
+} /* Get_UTM_Meters */
+
+long Get_Latitude_Letter_Microdegrees (long Latitude, int *letter)
+/*
+ * The function Get_Latitude_Letter_Microdegrees determines the latitude
+ * band letter for a latitude in microdegrees, as Get_Latitude_Letter does
+ * in radians.
+ *
+ *   Latitude   : Latitude in microdegrees  (input)
+ *   letter     : Latitude band letter      (output)
+ */
+{ /* Get_Latitude_Letter_Microdegrees */
+  if ((Latitude >= 72 * MICRODEGREES) && (Latitude < 84500000L))
+    *letter = LETTER_X;
+  else if ((Latitude > -80500000L) && (Latitude < 72 * MICRODEGREES))
+    *letter = Latitude_Band_Table[(Latitude + 80 * MICRODEGREES) / (8 * MICRODEGREES)].letter;
+  else
+    return (MGRS_LAT_ERROR);
+  return (MGRS_NO_ERROR);
+} /* Get_Latitude_Letter_Microdegrees */
+
+void Get_Square_Letters (const MGRS_Float_Parameters *Parameters,
+                         long Zone,
+                         long Easting,
+                         long Northing,
+                         int Letters[MGRS_LETTERS])
+/*
+ * The function Get_Square_Letters sets the 2nd and 3rd MGRS letters, which
+ * name the 100 km square holding Easting and Northing in the given zone.
+ *
+ *    Parameters : Single precision MGRS parameters (input)
+ *    Zone       : UTM zone                         (input)
+ *    Easting    : Easting in whole meters          (input)
+ *    Northing   : Northing in whole meters         (input)
+ *    Letters    : MGRS letters, 2nd and 3rd set    (output)
+ */
+{ /* Get_Square_Letters */
+  long grid_northing;
+
+  grid_northing = Northing % 2000000L + Parameters->Pattern_Offset[Zone % 6];
+  if (grid_northing >= 2000000L)
+    grid_northing -= 2000000L;
+
+  Letters[2] = Grid_Row_Letter_Table[grid_northing / 100000L];
+  Letters[1] = Grid_Set_Table[Zone % 6].column_letter[Easting / 100000L - 1];
+} /* Get_Square_Letters */
+
+long Convert_Microdegrees_To_MGRS_Values_R (const MGRS_Float_Parameters *Parameters,
+                                            long Latitude,
+                                            long Longitude,
+                                            long Precision,
+                                            long *Zone,
+                                            int Letters[MGRS_LETTERS],
+                                            long *Easting,
+                                            long *Northing)
+/*
+ * The function Convert_Microdegrees_To_MGRS_Values_R does the work of
+ * Convert_Microdegrees_To_MGRS_R up to, but not including, writing the
+ * string: it returns the zone, the three MGRS letters and the UTM easting
+ * and northing in whole meters.  If any errors occur, the error code(s)
+ * are returned by the function, otherwise MGRS_NO_ERROR is returned.
+ *
+ *    Parameters : Single precision MGRS parameters (input)
+ *    Latitude   : Latitude in microdegrees         (input)
+ *    Longitude  : Longitude in microdegrees        (input)
+ *    Precision  : Precision level of MGRS string   (input)
+ *    Zone       : UTM zone                         (output)
+ *    Letters    : MGRS letters                     (output)
+ *    Easting    : Easting in whole meters          (output)
+ *    Northing   : Northing in whole meters         (output)
+ */
+{ /* Convert_Microdegrees_To_MGRS_Values_R */
+  long zone;
+  long dlam_u;        /* Longitude less central meridian, microdegrees */
+  long error_code = MGRS_NO_ERROR;
+
+  if ((Latitude < -90 * MICRODEGREES) || (Latitude > 90 * MICRODEGREES))
+    error_code |= MGRS_LAT_ERROR;
+  if ((Longitude < -180 * MICRODEGREES) || (Longitude > 360 * MICRODEGREES))
+    error_code |= MGRS_LON_ERROR;
+  if ((Precision < 0) || (Precision > MAX_PRECISION))
+    error_code |= MGRS_PRECISION_ERROR;
+  if (error_code)
+    return (error_code);
+
+  if ((Latitude < -80500000L) || (Latitude > 84500000L))
+    return (MGRS_LAT_ERROR);
+  if (Get_UTM_Zone_Microdegrees(Parameters->Override, Latitude, Longitude, &zone))
+    return (MGRS_ZONE_ERROR);
+
+  if (Longitude > 180 * MICRODEGREES)
+    Longitude -= 360 * MICRODEGREES;
+
+  /* Points of 31V east of its central meridian are given in zone 32 */
+  if ((zone == 31) && (Latitude >= 56 * MICRODEGREES) && (Latitude < 64 * MICRODEGREES)
+      && (Longitude >= 3 * MICRODEGREES))
+    zone = 32;
+
+  dlam_u = Longitude - (6 * zone - 183) * MICRODEGREES;
+  if (dlam_u > 180 * MICRODEGREES)
+    dlam_u -= 360 * MICRODEGREES;
+  if (dlam_u < -180 * MICRODEGREES)
+    dlam_u += 360 * MICRODEGREES;
+
+  error_code = Get_UTM_Meters(Parameters, Latitude, dlam_u, Easting, Northing);
+  if (!error_code)
+    error_code = Get_Latitude_Letter_Microdegrees(Latitude, &Letters[0]);
+  if (error_code)
+    return (error_code);
+
+  Get_Square_Letters(Parameters, zone, *Easting, *Northing, Letters);
+  *Zone = zone;
+  return (MGRS_NO_ERROR);
+} /* Convert_Microdegrees_To_MGRS_Values_R */
+
+long Convert_Microdegrees_To_MGRS_R (const MGRS_Float_Parameters *Parameters,
+                                     long Latitude,
+                                     long Longitude,
+                                     long Precision,
+                                     char *MGRS)
+/*
+ * The function Convert_Microdegrees_To_MGRS_R converts a latitude and
+ * longitude in microdegrees to an MGRS coordinate string, with the same
+ * error checks as Convert_Geodetic_To_MGRS_R but in single precision and
+ * fixed point arithmetic.  The classic Transverse Mercator series is used
+ * whichever series Parameters was made from.  If any errors occur, the
+ * error code(s) are returned by the function, otherwise MGRS_NO_ERROR is
+ * returned.
+ *
+ *    Parameters : Single precision MGRS parameters (input)
+ *    Latitude   : Latitude in microdegrees         (input)
+ *    Longitude  : Longitude in microdegrees        (input)
+ *    Precision  : Precision level of MGRS string   (input)
+ *    MGRS       : MGRS coordinate string           (output)
+ */
+{ /* Convert_Microdegrees_To_MGRS_R */
+  long zone;
+  long easting;
+  long northing;
+  int letters[MGRS_LETTERS];
+  long error_code;
+
+  error_code = Convert_Microdegrees_To_MGRS_Values_R(Parameters, Latitude, Longitude,
+                                                     Precision, &zone, letters,
+                                                     &easting, &northing);
+  if (error_code)
+    return (error_code);
+
+  Write_MGRS_Meters (MGRS, zone, letters, easting, northing, Precision, TRUE);
+  return (MGRS_NO_ERROR);
+} /* Convert_Microdegrees_To_MGRS_R */
+
+long Convert_Microdegrees_To_MGRS (long Latitude,
+                                   long Longitude,
+                                   long Precision,
+                                   char *MGRS)
+/*
+ * The function Convert_Microdegrees_To_MGRS converts a latitude and
+ * longitude in microdegrees to an MGRS coordinate string, according to the
+ * default (WGS 84) parameters.  If any errors occur, the error code(s) are
+ * returned by the function, otherwise MGRS_NO_ERROR is returned.
+ *
+ *    Latitude   : Latitude in microdegrees         (input)
+ *    Longitude  : Longitude in microdegrees        (input)
+ *    Precision  : Precision level of MGRS string   (input)
+ *    MGRS       : MGRS coordinate string           (output)
+ */
+{ /* Convert_Microdegrees_To_MGRS */
+  return (Convert_Microdegrees_To_MGRS_R(&MGRS_Float_Default_Parameters,
+                                         Latitude, Longitude, Precision, MGRS));
+} /* Convert_Microdegrees_To_MGRS */
+
+#endif /* MGRS_FLOAT_H */
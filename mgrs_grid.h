@@ -0,0 +1,677 @@
+#ifndef MGRS_GRID_H
+#define MGRS_GRID_H
+
+#include "mgrs.h"
+
+/*
+ * MGRS grid lines for drawing over a map, as latitude/longitude polylines.
+ *
+ * A viewport is cut into tiles of about MGRS_GRID_TILE_LINES grid spacings
+ * on a side, aligned in latitude and longitude, and each tile is cut again
+ * along the latitude band and UTM zone boundaries, with the Norway and
+ * Svalbard special cases of Get_UTM_Zone_R.  Each piece is a single grid
+ * zone, whose easting and northing lines are traced by the inverse
+ * Transverse Mercator projection and clipped to it.  Every line belongs to
+ * one tile, so when the viewport moves only the tiles that come into view
+ * are worked out.  Longitudes are in [-PI, PI); viewports crossing the 180
+ * degree meridian are drawn as two.
+ */
+
+#define MGRS_GRID_NO_ERROR        0x0000
+#define MGRS_GRID_PRECISION_ERROR 0x0001
+#define MGRS_GRID_VIEW_ERROR      0x0002  /* South above North, or West east of East */
+#define MGRS_GRID_FULL_ERROR      0x0004  /* Output arrays too small                 */
+
+#define MGRS_GRID_EASTING_LINE    0
+#define MGRS_GRID_NORTHING_LINE   1
+#define MGRS_GRID_ZONE_LINE       2       /* West edge of a grid zone                */
+#define MGRS_GRID_BAND_LINE       3       /* South edge of a grid zone, or the north */
+                                          /* edge of band X                          */
+
+#define MGRS_GRID_TILE_LINES      8       /* Grid spacings per tile side             */
+#define MGRS_GRID_FLATNESS        0.001   /* Largest gap between a traced line and   */
+                                          /* its polyline, in grid spacings          */
+#define MGRS_GRID_MAX_SAMPLES     256     /* Most points per line of a tile          */
+#define MGRS_GRID_MAX_DEPTH       16      /* Most halvings of a segment              */
+#define MGRS_GRID_LABEL_SIZE      8
+
+typedef struct MGRS_Grid_Point_Value
+{
+  double Latitude;        /* Latitude in radians                         */
+  double Longitude;       /* Longitude in radians                        */
+} MGRS_Grid_Point;
+
+typedef struct MGRS_Grid_Line_Value
+{
+  long Type;              /* MGRS_GRID_EASTING_LINE, ... */
+  long Zone;              /* UTM zone of the grid zone the line is in    */
+  long Tile_Row;          /* Tile the line was worked out for            */
+  long Tile_Column;
+  long First_Point;       /* Index of the first point in the output      */
+  long Points;            /* Number of points, at least 2                */
+  char Label[MGRS_GRID_LABEL_SIZE];  /* Easting or northing digits, the  */
+                          /* 2nd or 3rd letter for 100 km lines, or the  */
+                          /* grid zone designator for zone and band lines */
+} MGRS_Grid_Line;
+
+typedef struct MGRS_Grid_Output_Value
+{
+  MGRS_Grid_Line *Lines;
+  long Max_Lines;
+  long Line_Count;
+  MGRS_Grid_Point *Points;
+  long Max_Points;
+  long Point_Count;
+} MGRS_Grid_Output;
+
+typedef struct MGRS_Grid_View_Value
+{
+  const MGRS_Parameters *Parameters;
+  long Precision;         /* 0 for 100 km lines, 1 for 10 km, 2 for 1 km... */
+  double Spacing;         /* Grid spacing in meters                      */
+  double Tile_Size;       /* Tile side in radians                        */
+  long Valid;             /* TRUE once a viewport has been drawn         */
+  long South_Row;         /* Tiles of the last viewport, inclusive       */
+  long North_Row;
+  long West_Column;
+  long East_Column;
+} MGRS_Grid_View;
+
+
+long Init_MGRS_Grid_View (MGRS_Grid_View *View,
+                          const MGRS_Parameters *Parameters,
+                          long Precision)
+/*
+ * The function Init_MGRS_Grid_View sets up an empty view drawing the grid
+ * lines of a precision level: 0 for the 100 km lines, 1 for 10 km,
+ * 2 for 1 km and so on.  If the precision is out of range
+ * MGRS_GRID_PRECISION_ERROR is returned, otherwise MGRS_GRID_NO_ERROR.
+ *
+ *    View       : View to initialize                   (output)
+ *    Parameters : MGRS parameters                      (input)
+ *    Precision  : Precision level of the grid lines    (input)
+ */
+{ /* Init_MGRS_Grid_View */
+  if ((Precision < 0) || (Precision > MAX_PRECISION))
+    return (MGRS_GRID_PRECISION_ERROR);
+  View->Parameters = Parameters;
+  View->Precision = Precision;
+  View->Spacing = (double)MGRS_Divisor_Table[Precision];
+  View->Tile_Size = MGRS_GRID_TILE_LINES * View->Spacing / Parameters->UTM.Ellipsoid.a;
+  View->Valid = FALSE;
+  return (MGRS_GRID_NO_ERROR);
+} /* Init_MGRS_Grid_View */
+
+
+long MGRS_Grid_Line_Visible (const MGRS_Grid_View *View,
+                             const MGRS_Grid_Line *Line)
+/*
+ * The function MGRS_Grid_Line_Visible returns TRUE if a line from an
+ * earlier update belongs to a tile of the view's last viewport, so that a
+ * caller keeping the lines of earlier updates knows which to throw away.
+ */
+{ /* MGRS_Grid_Line_Visible */
+  return (View->Valid
+          && (Line->Tile_Row >= View->South_Row) && (Line->Tile_Row <= View->North_Row)
+          && (Line->Tile_Column >= View->West_Column)
+          && (Line->Tile_Column <= View->East_Column));
+} /* MGRS_Grid_Line_Visible */
+
+
+static long Get_MGRS_Grid_Zone_Span (long Band,
+                                     double Longitude,
+                                     long *West,
+                                     long *East)
+/*
+ * The function Get_MGRS_Grid_Zone_Span returns the UTM zone holding a
+ * longitude within a latitude band, and sets the zone's west and east
+ * edges in whole degrees, following the Norway and Svalbard special cases.
+ *
+ *    Band       : Index into Latitude_Band_Table       (input)
+ *    Longitude  : Longitude in degrees, in [-180, 180) (input)
+ *    West       : West edge of the zone in degrees     (output)
+ *    East       : East edge of the zone in degrees     (output)
+ */
+{ /* Get_MGRS_Grid_Zone_Span */
+  long zone = (long)((Longitude + 180.0) / 6.0) + 1;
+  long letter = Latitude_Band_Table[Band].letter;
+
+  if (zone > 60)
+    zone = 60;
+  *West = 6 * zone - 186;
+  *East = 6 * zone - 180;
+  if ((letter == LETTER_V) && ((zone == 31) || (zone == 32)))
+  {
+    if (Longitude < 3.0)
+    {
+      zone = 31;
+      *East = 3;
+    }
+    else if (Longitude < 12.0)
+    {
+      zone = 32;
+      *West = 3;
+      *East = 12;
+    }
+  }
+  else if ((letter == LETTER_X) && (Longitude >= 0.0) && (Longitude < 42.0))
+  {
+    zone = 31 + 2 * (long)((Longitude + 3.0) / 12.0);
+    *West = (zone == 31) ? 0 : 6 * zone - 189;
+    *East = (zone == 37) ? 42 : 6 * zone - 177;
+  }
+  return (zone);
+} /* Get_MGRS_Grid_Zone_Span */
+
+
+static long Add_MGRS_Grid_Line (MGRS_Grid_Output *Output,
+                                const MGRS_Grid_Line *Line,
+                                const MGRS_Grid_Point *Points,
+                                long Count)
+/*
+ * Appends a line and its points to Output, or returns MGRS_GRID_FULL_ERROR.
+ */
+{
+  MGRS_Grid_Line *line;
+  long i;
+
+  if ((Output->Line_Count >= Output->Max_Lines)
+      || (Output->Point_Count + Count > Output->Max_Points))
+    return (MGRS_GRID_FULL_ERROR);
+  line = &Output->Lines[Output->Line_Count++];
+  *line = *Line;
+  line->First_Point = Output->Point_Count;
+  line->Points = Count;
+  for (i = 0; i < Count; i++)
+    Output->Points[Output->Point_Count++] = Points[i];
+  return (MGRS_GRID_NO_ERROR);
+}
+
+
+static long Clip_MGRS_Grid_Segment (double South,
+                                    double West,
+                                    double North,
+                                    double East,
+                                    MGRS_Grid_Point *From,
+                                    MGRS_Grid_Point *To)
+/*
+ * Clips the segment From-To to a latitude/longitude rectangle in place
+ * (Liang-Barsky).  Returns FALSE if no part of it lies inside.
+ */
+{
+  double p[4];
+  double q[4];
+  double t0 = 0.0;
+  double t1 = 1.0;
+  double t;
+  double d_lat = To->Latitude - From->Latitude;
+  double d_lon = To->Longitude - From->Longitude;
+  long k;
+
+  p[0] = -d_lat;  q[0] = From->Latitude - South;
+  p[1] = d_lat;   q[1] = North - From->Latitude;
+  p[2] = -d_lon;  q[2] = From->Longitude - West;
+  p[3] = d_lon;   q[3] = East - From->Longitude;
+  for (k = 0; k < 4; k++)
+  {
+    if (p[k] == 0.0)
+    {
+      if (q[k] < 0.0)
+        return (FALSE);
+    }
+    else
+    {
+      t = q[k] / p[k];
+      if (p[k] < 0.0)
+      {
+        if (t > t1)
+          return (FALSE);
+        if (t > t0)
+          t0 = t;
+      }
+      else
+      {
+        if (t < t0)
+          return (FALSE);
+        if (t < t1)
+          t1 = t;
+      }
+    }
+  }
+  if (t1 < 1.0)
+  {
+    To->Latitude = From->Latitude + t1 * d_lat;
+    To->Longitude = From->Longitude + t1 * d_lon;
+  }
+  if (t0 > 0.0)
+  {
+    From->Latitude += t0 * d_lat;
+    From->Longitude += t0 * d_lon;
+  }
+  return (TRUE);
+}
+
+
+static void Get_MGRS_Grid_Sample (const MGRS_Grid_View *View,
+                                  const TranMerc_Projection *Projection,
+                                  double Easting,
+                                  double Northing,
+                                  MGRS_Grid_Point *Point)
+/*
+ * Projects a point of a grid line back to latitude and longitude, keeping
+ * the longitude continuous across the 180 degree meridian.
+ */
+{
+  Convert_Transverse_Mercator_To_Geodetic_R(&View->Parameters->UTM.Ellipsoid, Projection,
+                                            Easting, Northing,
+                                            &Point->Latitude, &Point->Longitude);
+  if (Point->Longitude - Projection->Origin_Long > PI)
+    Point->Longitude -= 2 * PI;
+  else if (Point->Longitude - Projection->Origin_Long < -PI)
+    Point->Longitude += 2 * PI;
+}
+
+
+static long Trace_MGRS_Grid_Line (const MGRS_Grid_View *View,
+                                  const TranMerc_Projection *Projection,
+                                  double South,
+                                  double West,
+                                  double North,
+                                  double East,
+                                  double Easting_0,
+                                  double Northing_0,
+                                  double Easting_1,
+                                  double Northing_1,
+                                  MGRS_Grid_Line *Line,
+                                  MGRS_Grid_Output *Output)
+/*
+ * Traces the straight grid line from (Easting_0, Northing_0) to
+ * (Easting_1, Northing_1), clips it to the piece South, West, North, East
+ * and appends what is left to Output.  The line starts out in segments of
+ * one grid spacing, and each segment inside the piece is halved until the
+ * middle of the line is within MGRS_GRID_FLATNESS of the middle of the
+ * segment.
+ */
+{
+  MGRS_Grid_Point sample[MGRS_GRID_MAX_SAMPLES];
+  double sample_t[MGRS_GRID_MAX_SAMPLES];       /* Distance along the line, 0 to 1 */
+  MGRS_Grid_Point pending[MGRS_GRID_MAX_DEPTH];  /* Ends of the segments still to split */
+  double pending_t[MGRS_GRID_MAX_DEPTH];
+  MGRS_Grid_Point points[MGRS_GRID_MAX_SAMPLES];
+  MGRS_Grid_Point middle;
+  MGRS_Grid_Point *last;
+  MGRS_Grid_Point from;
+  MGRS_Grid_Point to;
+  double tolerance = View->Spacing * MGRS_GRID_FLATNESS / View->Parameters->UTM.Ellipsoid.a;
+  double middle_t;
+  double d_lat;
+  double d_lon;
+  long segments;
+  long depth;
+  long samples = 1;
+  long count = 0;
+  long i;
+  long error_code;
+
+  segments = (long)ceil((fabs(Easting_1 - Easting_0) + fabs(Northing_1 - Northing_0))
+                        / View->Spacing);
+  if (segments < 1)
+    segments = 1;
+  if (segments > MGRS_GRID_MAX_SAMPLES / 4)
+    segments = MGRS_GRID_MAX_SAMPLES / 4;
+  Get_MGRS_Grid_Sample(View, Projection, Easting_0, Northing_0, &sample[0]);
+  sample_t[0] = 0.0;
+
+  for (i = 1; i <= segments; i++)
+  {
+    pending_t[0] = (double)i / segments;
+    Get_MGRS_Grid_Sample(View, Projection, Easting_0 + (Easting_1 - Easting_0) * pending_t[0],
+                         Northing_0 + (Northing_1 - Northing_0) * pending_t[0], &pending[0]);
+    depth = 1;
+    while (depth)
+    {
+      last = &sample[samples - 1];
+      to = pending[depth - 1];
+      if (((last->Latitude < South) && (to.Latitude < South))
+          || ((last->Latitude > North) && (to.Latitude > North))
+          || ((last->Longitude < West) && (to.Longitude < West))
+          || ((last->Longitude > East) && (to.Longitude > East))
+          || (samples + 2 * depth + segments - i >= MGRS_GRID_MAX_SAMPLES))
+      { /* Segment outside the piece, or no room left to split it */
+        sample[samples] = to;
+        sample_t[samples++] = pending_t[--depth];
+        continue;
+      }
+      middle_t = 0.5 * (sample_t[samples - 1] + pending_t[depth - 1]);
+      Get_MGRS_Grid_Sample(View, Projection, Easting_0 + (Easting_1 - Easting_0) * middle_t,
+                           Northing_0 + (Northing_1 - Northing_0) * middle_t, &middle);
+      d_lat = middle.Latitude - 0.5 * (last->Latitude + to.Latitude);
+      d_lon = (middle.Longitude - 0.5 * (last->Longitude + to.Longitude)) * cos(middle.Latitude);
+      if ((d_lat * d_lat + d_lon * d_lon > tolerance * tolerance) && (depth < MGRS_GRID_MAX_DEPTH))
+      {
+        pending[depth] = middle;
+        pending_t[depth++] = middle_t;
+      }
+      else
+      { /* Flat enough: keep the middle too, as it is already worked out */
+        sample[samples] = middle;
+        sample_t[samples++] = middle_t;
+        sample[samples] = to;
+        sample_t[samples++] = pending_t[--depth];
+      }
+    }
+  }
+
+  for (i = 0; i + 1 < samples; i++)
+  {
+    from = sample[i];
+    to = sample[i + 1];
+    if (!Clip_MGRS_Grid_Segment(South, West, North, East, &from, &to))
+      continue;
+    if (count && ((from.Latitude != points[count - 1].Latitude)
+                  || (from.Longitude != points[count - 1].Longitude)))
+    { /* Left the piece and came back: start a new line */
+      if (count > 1)
+      {
+        error_code = Add_MGRS_Grid_Line(Output, Line, points, count);
+        if (error_code)
+          return (error_code);
+      }
+      count = 0;
+    }
+    if (!count)
+      points[count++] = from;
+    points[count++] = to;
+  }
+  if (count > 1)
+    return (Add_MGRS_Grid_Line(Output, Line, points, count));
+  return (MGRS_GRID_NO_ERROR);
+}
+
+
+static void Set_MGRS_Grid_Label (const MGRS_Grid_View *View,
+                                 long Zone,
+                                 long Type,
+                                 double Value,
+                                 char *Label)
+/*
+ * Labels an easting or northing line with its digits at the view's
+ * precision, or for 100 km lines with the 2nd letter of the squares to the
+ * east or the 3rd letter of those to the north.
+ */
+{
+  const Grid_Set *set = &Grid_Set_Table[Zone % 6];
+  long meters = (long)(Value + 0.5);
+  long digits;
+  long column;
+  double grid_northing;
+  long i;
+
+  if (View->Precision > 0)
+  {
+    digits = (meters % 100000) / MGRS_Divisor_Table[View->Precision];
+    for (i = View->Precision - 1; i >= 0; i--)
+    {
+      Label[i] = (char)('0' + digits % 10);
+      digits /= 10;
+    }
+    Label[View->Precision] = 0;
+  }
+  else if (Type == MGRS_GRID_EASTING_LINE)
+  {
+    column = meters / 100000 - 1;
+    if ((column >= 0) && (column < 8))
+    {
+      Label[0] = (char)('A' + set->column_letter[column]);
+      Label[1] = 0;
+    }
+    else
+      Label[0] = 0;
+  }
+  else
+  {
+    grid_northing = fmod((double)meters, TWOMIL) + set->pattern_offset[View->Parameters->Grid_Pattern];
+    if (grid_northing >= TWOMIL)
+      grid_northing -= TWOMIL;
+    Label[0] = (char)('A' + Grid_Row_Letter_Table[(long)(grid_northing / ONEHT)]);
+    Label[1] = 0;
+  }
+}
+
+
+static long Get_MGRS_Grid_Piece_Lines (const MGRS_Grid_View *View,
+                                       long Row,
+                                       long Column,
+                                       long Band,
+                                       long Zone,
+                                       double South,
+                                       double West,
+                                       double North,
+                                       double East,
+                                       long Zone_West,
+                                       long Band_South,
+                                       MGRS_Grid_Output *Output)
+/*
+ * Appends the lines of the part of a tile within one grid zone: the zone's
+ * west edge and band's south edge where they run through it, and the
+ * easting and northing lines crossing it.
+ */
+{
+  const TranMerc_Projection *projection = &UTM_Zone_Projection[Zone - 1][Band < 10];
+  const TranMerc_Ellipsoid *ellipsoid = &View->Parameters->UTM.Ellipsoid;
+  MGRS_Grid_Line line;
+  MGRS_Grid_Point edge[2];
+  double easting[6];
+  double northing[6];
+  double min_easting;
+  double max_easting;
+  double min_northing;
+  double max_northing;
+  double value;
+  long corners = 4;
+  long i;
+  long error_code = MGRS_GRID_NO_ERROR;
+
+  line.Zone = Zone;
+  line.Tile_Row = Row;
+  line.Tile_Column = Column;
+  line.Label[0] = (char)('0' + Zone / 10);
+  line.Label[1] = (char)('0' + Zone % 10);
+  line.Label[2] = (char)('A' + Latitude_Band_Table[Band].letter);
+  line.Label[3] = 0;
+
+  if (Zone_West)
+  {
+    line.Type = MGRS_GRID_ZONE_LINE;
+    edge[0].Latitude = South;
+    edge[0].Longitude = West;
+    edge[1].Latitude = North;
+    edge[1].Longitude = West;
+    error_code = Add_MGRS_Grid_Line(Output, &line, edge, 2);
+  }
+  if (!error_code && (Band_South || (North == Latitude_Band_Table[19].north * DEG_TO_RAD)))
+  {
+    line.Type = MGRS_GRID_BAND_LINE;
+    edge[0].Latitude = edge[1].Latitude = Band_South ? South : North;
+    edge[0].Longitude = West;
+    edge[1].Longitude = East;
+    error_code = Add_MGRS_Grid_Line(Output, &line, edge, 2);
+  }
+  if (error_code)
+    return (error_code);
+
+  /*
+   * The extreme eastings of a piece are at its corners; the extreme
+   * northings are at its corners or where it crosses the central meridian.
+   */
+  Convert_Geodetic_To_Transverse_Mercator_R(ellipsoid, projection, South, West, &easting[0], &northing[0]);
+  Convert_Geodetic_To_Transverse_Mercator_R(ellipsoid, projection, South, East, &easting[1], &northing[1]);
+  Convert_Geodetic_To_Transverse_Mercator_R(ellipsoid, projection, North, West, &easting[2], &northing[2]);
+  Convert_Geodetic_To_Transverse_Mercator_R(ellipsoid, projection, North, East, &easting[3], &northing[3]);
+  if ((projection->Origin_Long > West) && (projection->Origin_Long < East))
+  {
+    Convert_Geodetic_To_Transverse_Mercator_R(ellipsoid, projection, South, projection->Origin_Long,
+                                              &easting[4], &northing[4]);
+    Convert_Geodetic_To_Transverse_Mercator_R(ellipsoid, projection, North, projection->Origin_Long,
+                                              &easting[5], &northing[5]);
+    corners = 6;
+  }
+  min_easting = max_easting = easting[0];
+  min_northing = max_northing = northing[0];
+  for (i = 1; i < corners; i++)
+  {
+    if (easting[i] < min_easting)
+      min_easting = easting[i];
+    if (easting[i] > max_easting)
+      max_easting = easting[i];
+    if (northing[i] < min_northing)
+      min_northing = northing[i];
+    if (northing[i] > max_northing)
+      max_northing = northing[i];
+  }
+
+  line.Type = MGRS_GRID_EASTING_LINE;
+  for (value = ceil(min_easting / View->Spacing) * View->Spacing;
+       !error_code && (value <= max_easting); value += View->Spacing)
+  {
+    Set_MGRS_Grid_Label(View, Zone, MGRS_GRID_EASTING_LINE, value, line.Label);
+    error_code = Trace_MGRS_Grid_Line(View, projection, South, West, North, East,
+                                      value, min_northing, value, max_northing,
+                                      &line, Output);
+  }
+  line.Type = MGRS_GRID_NORTHING_LINE;
+  for (value = ceil(min_northing / View->Spacing) * View->Spacing;
+       !error_code && (value <= max_northing); value += View->Spacing)
+  {
+    Set_MGRS_Grid_Label(View, Zone, MGRS_GRID_NORTHING_LINE, value, line.Label);
+    error_code = Trace_MGRS_Grid_Line(View, projection, South, West, North, East,
+                                      min_easting, value, max_easting, value,
+                                      &line, Output);
+  }
+  return (error_code);
+}
+
+
+static long Get_MGRS_Grid_Tile_Lines (const MGRS_Grid_View *View,
+                                      long Row,
+                                      long Column,
+                                      MGRS_Grid_Output *Output)
+/*
+ * Appends the lines of one tile, cutting it along the latitude band and
+ * UTM zone boundaries.
+ */
+{
+  double tile_south = Row * View->Tile_Size - PI_OVER_2;
+  double tile_north = tile_south + View->Tile_Size;
+  double tile_west = Column * View->Tile_Size - PI;
+  double tile_east = tile_west + View->Tile_Size;
+  double band_south;
+  double band_north;
+  double south;
+  double north;
+  double west;
+  double east;
+  double longitude;       /* Degrees */
+  long band;
+  long zone;
+  long zone_west;
+  long zone_east;
+  long error_code = MGRS_GRID_NO_ERROR;
+
+  if (tile_east > PI)
+    tile_east = PI;
+  for (band = 0; !error_code && (band < 20); band++)
+  {
+    band_south = Latitude_Band_Table[band].south * DEG_TO_RAD;
+    band_north = Latitude_Band_Table[band].north * DEG_TO_RAD;
+    if ((band_north <= tile_south) || (band_south >= tile_north))
+      continue;
+    south = (band_south > tile_south) ? band_south : tile_south;
+    north = (band_north < tile_north) ? band_north : tile_north;
+
+    for (longitude = tile_west * RAD_TO_DEG;
+         !error_code && (longitude < tile_east * RAD_TO_DEG); longitude = zone_east)
+    {
+      zone = Get_MGRS_Grid_Zone_Span(band, longitude, &zone_west, &zone_east);
+      west = zone_west * DEG_TO_RAD;
+      east = zone_east * DEG_TO_RAD;
+      error_code = Get_MGRS_Grid_Piece_Lines(View, Row, Column, band, zone, south,
+                                             (west > tile_west) ? west : tile_west, north,
+                                             (east < tile_east) ? east : tile_east,
+                                             west >= tile_west, band_south >= tile_south,
+                                             Output);
+    }
+  }
+  return (error_code);
+}
+
+
+long Update_MGRS_Grid_View (MGRS_Grid_View *View,
+                            double South,
+                            double West,
+                            double North,
+                            double East,
+                            MGRS_Grid_Output *Output)
+/*
+ * The function Update_MGRS_Grid_View moves a view to a new viewport and
+ * writes to Output the grid lines of the tiles which were not in the
+ * view's last viewport.  The lines of earlier updates that are still
+ * wanted can be picked out with MGRS_Grid_Line_Visible.  Output's counts
+ * are reset first.  Latitudes beyond the extent of Latitude_Band_Table
+ * are ignored.  If any errors occur the error code(s) are returned and the
+ * view is left as it was, otherwise MGRS_GRID_NO_ERROR is returned.
+ *
+ *    View       : View of the last viewport            (input/output)
+ *    South      : South edge of viewport in radians    (input)
+ *    West       : West edge of viewport in radians     (input)
+ *    North      : North edge of viewport in radians    (input)
+ *    East       : East edge of viewport in radians     (input)
+ *    Output     : Lines and points of the new tiles    (output)
+ */
+{ /* Update_MGRS_Grid_View */
+  double min_lat = Latitude_Band_Table[0].south * DEG_TO_RAD;
+  double max_lat = Latitude_Band_Table[19].north * DEG_TO_RAD;
+  long south_row;
+  long north_row;
+  long west_column;
+  long east_column;
+  long row;
+  long column;
+  long error_code = MGRS_GRID_NO_ERROR;
+
+  Output->Line_Count = 0;
+  Output->Point_Count = 0;
+  if ((South > North) || (West > East) || (West < -PI) || (East > PI))
+    return (MGRS_GRID_VIEW_ERROR);
+  if (South < min_lat)
+    South = min_lat;
+  if (North > max_lat)
+    North = max_lat;
+  if (South > North)
+    North = South;
+
+  south_row = (long)((South + PI_OVER_2) / View->Tile_Size);
+  north_row = (long)((North + PI_OVER_2) / View->Tile_Size);
+  west_column = (long)((West + PI) / View->Tile_Size);
+  east_column = (long)((East + PI) / View->Tile_Size);
+  if (east_column * View->Tile_Size >= 2 * PI)
+    east_column--;
+
+  for (row = south_row; !error_code && (row <= north_row); row++)
+    for (column = west_column; !error_code && (column <= east_column); column++)
+      if (!View->Valid || (row < View->South_Row) || (row > View->North_Row)
+          || (column < View->West_Column) || (column > View->East_Column))
+        error_code = Get_MGRS_Grid_Tile_Lines(View, row, column, Output);
+
+  if (!error_code)
+  {
+    View->South_Row = south_row;
+    View->North_Row = north_row;
+    View->West_Column = west_column;
+    View->East_Column = east_column;
+    View->Valid = TRUE;
+  }
+  return (error_code);
+} /* Update_MGRS_Grid_View */
+
+#endif /* MGRS_GRID_H */
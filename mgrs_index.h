@@ -0,0 +1,409 @@
+#ifndef MGRS_INDEX_H
+#define MGRS_INDEX_H
+
+#include "mgrs_key.h"
+
+/*
+ * An index of values, such as row numbers, by the MGRS key of each, for
+ * queries of every value in a cell at any precision.
+ *
+ * The keys are kept sorted in one array, so the keys in a cell are the
+ * contiguous range Get_MGRS_Key_Range gives, found by two searches.  The
+ * search goes down a static B+-tree over the array: level 1 holds every
+ * MGRS_INDEX_FANOUT-th key of the array, level 2 every MGRS_INDEX_FANOUT-th
+ * key of level 1, and so on up to a level of at most MGRS_INDEX_FANOUT
+ * keys.  Each level narrows the search to one node of MGRS_INDEX_FANOUT
+ * keys below, two cache lines, which is counted through without branches,
+ * so a search reads one node a level instead of the scattered cache lines
+ * of a binary search.  The levels take about 1 / (MGRS_INDEX_FANOUT - 1)
+ * of the keys' memory.
+ *
+ * The index holds pointers to arrays its caller owns; nothing here
+ * allocates.  With MGRS_INDEX_FILES defined an index can also be written
+ * to a file and mapped back read only, levels and all, with no loading
+ * or sorting, on POSIX hosts.
+ */
+
+#define MGRS_INDEX_NO_ERROR     0x0000
+#define MGRS_INDEX_CELL_ERROR   0x0001  /* Not a valid cell, string or position */
+#define MGRS_INDEX_FILE_ERROR   0x0002  /* File not written, or not an index    */
+                                        /* of this build                        */
+
+#define MGRS_INDEX_FANOUT       16      /* Keys per node                        */
+#define MGRS_INDEX_MAX_LEVELS   16      /* Array included                       */
+
+typedef struct MGRS_Index_Value
+{
+  const MGRS_Key *Level[MGRS_INDEX_MAX_LEVELS];  /* Level 0 is the sorted keys */
+  long Level_Count[MGRS_INDEX_MAX_LEVELS];
+  long Levels;
+  const long *Values;     /* Value of each key, or NULL                  */
+  long Count;             /* Number of keys                              */
+  void *Map;              /* The mapped file, if mapped, and its size    */
+  long Map_Size;
+} MGRS_Index;
+
+
+long Get_MGRS_Index_Fence_Count (long Count)
+/*
+ * The function Get_MGRS_Index_Fence_Count gives the number of keys the
+ * levels above the array take, for an index of Count keys.
+ *
+ *    Count         : Number of keys                (input)
+ */
+{ /* Get_MGRS_Index_Fence_Count */
+  long fences = 0;
+
+  while (Count > MGRS_INDEX_FANOUT)
+  {
+    Count = (Count + MGRS_INDEX_FANOUT - 1) / MGRS_INDEX_FANOUT;
+    fences += Count;
+  }
+  return (fences);
+} /* Get_MGRS_Index_Fence_Count */
+
+
+static void Set_MGRS_Index_Levels (MGRS_Index *Index,
+                                   const MGRS_Key *Keys,
+                                   const MGRS_Key *Fences,
+                                   long Count)
+/*
+ * Points the levels of Index at the array of Count keys and at Fences,
+ * which holds level 1 first, then level 2 and so on.
+ */
+{
+  long level = 0;
+
+  Index->Level[0] = Keys;
+  Index->Level_Count[0] = Count;
+  while (Index->Level_Count[level] > MGRS_INDEX_FANOUT)
+  {
+    level++;
+    Index->Level[level] = Fences;
+    Index->Level_Count[level] = (Index->Level_Count[level - 1] + MGRS_INDEX_FANOUT - 1)
+                                / MGRS_INDEX_FANOUT;
+    Fences += Index->Level_Count[level];
+  }
+  Index->Levels = level + 1;
+  Index->Count = Count;
+  Index->Map = NULL;
+  Index->Map_Size = 0;
+}
+
+
+void Build_MGRS_Index (MGRS_Index *Index,
+                       MGRS_Key *Keys,
+                       long *Values,
+                       MGRS_Key *Key_Scratch,
+                       long *Value_Scratch,
+                       MGRS_Key *Fences,
+                       long Count)
+/*
+ * The function Build_MGRS_Index sorts Count keys, with their values
+ * unless Values is NULL, by Sort_MGRS_Keys, and builds the levels of an
+ * index over them in Fences, which needs room for
+ * Get_MGRS_Index_Fence_Count (Count) keys.  The index uses Keys, Values
+ * and Fences in place, and is valid while they are; the scratch arrays
+ * are only needed while building.
+ *
+ *    Index         : MGRS index                    (output)
+ *    Keys          : MGRS keys                     (input/output)
+ *    Values        : Value of each key, or NULL    (input/output)
+ *    Key_Scratch   : Scratch keys                  (input)
+ *    Value_Scratch : Scratch values, or NULL       (input)
+ *    Fences        : Keys of the levels            (output)
+ *    Count         : Number of keys                (input)
+ */
+{ /* Build_MGRS_Index */
+  const MGRS_Key *from = Keys;
+  MGRS_Key *to = Fences;
+  long level;
+  long i;
+
+  Sort_MGRS_Keys (Keys, Values, Key_Scratch, Value_Scratch, Count);
+  Set_MGRS_Index_Levels (Index, Keys, Fences, Count);
+  Index->Values = Values;
+  for (level = 1; level < Index->Levels; level++)
+  {
+    for (i = 0; i < Index->Level_Count[level]; i++)
+      to[i] = from[i * MGRS_INDEX_FANOUT];
+    from = to;
+    to += Index->Level_Count[level];
+  }
+} /* Build_MGRS_Index */
+
+
+long Find_MGRS_Index_Key (const MGRS_Index *Index,
+                          MGRS_Key Key)
+/*
+ * The function Find_MGRS_Index_Key gives the position in the sorted keys
+ * of the first key not below Key, or the number of keys if there is none.
+ *
+ *    Index         : MGRS index                    (input)
+ *    Key           : MGRS key                      (input)
+ */
+{ /* Find_MGRS_Index_Key */
+  const MGRS_Key *node;
+  long position = 0;
+  long start = 0;
+  long size;
+  long level;
+  long i;
+
+  for (level = Index->Levels - 1; level >= 0; level--)
+  {
+    /* Every key of the level before start is below Key, and from */
+    /* start + MGRS_INDEX_FANOUT on none is                        */
+    node = Index->Level[level] + start;
+    size = Index->Level_Count[level] - start;
+    if (size > MGRS_INDEX_FANOUT)
+      size = MGRS_INDEX_FANOUT;
+    position = start;
+    for (i = 0; i < size; i++)
+      position += (node[i] < Key);
+    start = (position ? position - 1 : 0) * MGRS_INDEX_FANOUT;
+  }
+  return (position);
+} /* Find_MGRS_Index_Key */
+
+
+long Get_MGRS_Index_Range (const MGRS_Index *Index,
+                           MGRS_Key Cell,
+                           long *First,
+                           long *End)
+/*
+ * The function Get_MGRS_Index_Range gives the positions in the sorted keys
+ * and values of the entries in a cell: from First up to but not including
+ * End.  The cell's own key and the keys of every finer cell inside it are
+ * in the range.  If the precision of Cell is not valid
+ * MGRS_INDEX_CELL_ERROR is returned, otherwise MGRS_INDEX_NO_ERROR.
+ *
+ *    Index         : MGRS index                    (input)
+ *    Cell          : MGRS key of the cell          (input)
+ *    First         : First entry in the cell       (output)
+ *    End           : Entry after the last one      (output)
+ */
+{ /* Get_MGRS_Index_Range */
+  MGRS_Key low;
+  MGRS_Key high;
+
+  if (Get_MGRS_Key_Range (Cell, &low, &high))
+    return (MGRS_INDEX_CELL_ERROR);
+  *First = Find_MGRS_Index_Key (Index, low);
+  *End = Find_MGRS_Index_Key (Index, high + 1);
+  return (MGRS_INDEX_NO_ERROR);
+} /* Get_MGRS_Index_Range */
+
+
+long Get_MGRS_Index_String_R (const MGRS_Parameters *Parameters,
+                              const MGRS_Index *Index,
+                              const char *MGRS,
+                              long *First,
+                              long *End)
+/*
+ * The function Get_MGRS_Index_String_R gives the entries in the cell of
+ * an MGRS coordinate string, such as every entry in "18SUJ", as
+ * Get_MGRS_Index_Range does.  If the string is not valid
+ * MGRS_INDEX_CELL_ERROR is returned, otherwise MGRS_INDEX_NO_ERROR.
+ *
+ *    Parameters    : MGRS parameters               (input)
+ *    Index         : MGRS index                    (input)
+ *    MGRS          : MGRS coordinate string        (input)
+ *    First         : First entry in the cell       (output)
+ *    End           : Entry after the last one      (output)
+ */
+{ /* Get_MGRS_Index_String_R */
+  MGRS_Key cell;
+
+  if (Convert_MGRS_To_Key_R (Parameters, MGRS, &cell))
+    return (MGRS_INDEX_CELL_ERROR);
+  return (Get_MGRS_Index_Range (Index, cell, First, End));
+} /* Get_MGRS_Index_String_R */
+
+
+long Get_MGRS_Index_Position_R (const MGRS_Parameters *Parameters,
+                                const MGRS_Index *Index,
+                                double Latitude,
+                                double Longitude,
+                                long Precision,
+                                long *First,
+                                long *End)
+/*
+ * The function Get_MGRS_Index_Position_R gives the entries in the cell at
+ * Precision that holds a position, as Get_MGRS_Index_Range does.  If the
+ * position has no MGRS cell at Precision MGRS_INDEX_CELL_ERROR is
+ * returned, otherwise MGRS_INDEX_NO_ERROR.
+ *
+ *    Parameters    : MGRS parameters               (input)
+ *    Index         : MGRS index                    (input)
+ *    Latitude      : Latitude in radians           (input)
+ *    Longitude     : Longitude in radians          (input)
+ *    Precision     : Precision level of the cell   (input)
+ *    First         : First entry in the cell       (output)
+ *    End           : Entry after the last one      (output)
+ */
+{ /* Get_MGRS_Index_Position_R */
+  MGRS_Key cell;
+
+  if (Convert_Geodetic_To_MGRS_Key_R (Parameters, Latitude, Longitude, Precision, &cell))
+    return (MGRS_INDEX_CELL_ERROR);
+  return (Get_MGRS_Index_Range (Index, cell, First, End));
+} /* Get_MGRS_Index_Position_R */
+
+
+#ifdef MGRS_INDEX_FILES
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+ * An index file is this header, then the sorted keys, the values if any
+ * and the levels' keys, in the byte order and sizes of the host that
+ * wrote it, which a host mapping it must share.
+ */
+
+#define MGRS_INDEX_MAGIC        "MGRSIDX1"
+#define MGRS_INDEX_BYTE_ORDER   0x0102030405060708ULL
+
+typedef struct MGRS_Index_Header_Value
+{
+  char Magic[8];
+  uint64_t Byte_Order;    /* MGRS_INDEX_BYTE_ORDER as written            */
+  uint32_t Key_Size;
+  uint32_t Value_Size;    /* 0 if there are no values                    */
+  uint32_t Fanout;
+  uint32_t Reserved;
+  uint64_t Count;
+} MGRS_Index_Header;
+
+
+static int Write_MGRS_Index_Block (FILE *File,
+                                   const void *Block,
+                                   long Size)
+/*
+ * Writes Size bytes, returning FALSE if they could not all be written.
+ */
+{
+  return ((Size == 0) || (fwrite (Block, Size, 1, File) == 1));
+}
+
+
+long Write_MGRS_Index (const MGRS_Index *Index,
+                       const char *Path)
+/*
+ * The function Write_MGRS_Index writes an index to a file for
+ * Map_MGRS_Index.  If it cannot be written MGRS_INDEX_FILE_ERROR is
+ * returned, otherwise MGRS_INDEX_NO_ERROR.
+ *
+ *    Index         : MGRS index                    (input)
+ *    Path          : File name                     (input)
+ */
+{ /* Write_MGRS_Index */
+  MGRS_Index_Header header;
+  FILE *file;
+  long level;
+  int written;
+
+  memset (&header, 0, sizeof (header));
+  memcpy (header.Magic, MGRS_INDEX_MAGIC, sizeof (header.Magic));
+  header.Byte_Order = MGRS_INDEX_BYTE_ORDER;
+  header.Key_Size = sizeof (MGRS_Key);
+  header.Value_Size = Index->Values ? sizeof (long) : 0;
+  header.Fanout = MGRS_INDEX_FANOUT;
+  header.Count = Index->Count;
+  file = fopen (Path, "wb");
+  if (!file)
+    return (MGRS_INDEX_FILE_ERROR);
+  written = Write_MGRS_Index_Block (file, &header, sizeof (header))
+            && Write_MGRS_Index_Block (file, Index->Level[0], Index->Count * sizeof (MGRS_Key))
+            && Write_MGRS_Index_Block (file, Index->Values, Index->Count * header.Value_Size);
+  for (level = 1; level < Index->Levels; level++)
+    written = written && Write_MGRS_Index_Block (file, Index->Level[level],
+                                                 Index->Level_Count[level] * sizeof (MGRS_Key));
+  if (fclose (file))
+    written = FALSE;
+  return (written ? MGRS_INDEX_NO_ERROR : MGRS_INDEX_FILE_ERROR);
+} /* Write_MGRS_Index */
+
+
+long Map_MGRS_Index (MGRS_Index *Index,
+                     const char *Path)
+/*
+ * The function Map_MGRS_Index maps an index file written by
+ * Write_MGRS_Index into memory, read only, and sets up Index to search it
+ * in place; pages are read as searches touch them.  If the file cannot be
+ * mapped, or was not written by a host with the same key and value sizes,
+ * byte order and MGRS_INDEX_FANOUT, MGRS_INDEX_FILE_ERROR is returned,
+ * otherwise MGRS_INDEX_NO_ERROR.  Unmap_MGRS_Index releases it.
+ *
+ *    Index         : MGRS index                    (output)
+ *    Path          : File name                     (input)
+ */
+{ /* Map_MGRS_Index */
+  const MGRS_Index_Header *header;
+  const char *keys;
+  struct stat status;
+  void *map;
+  long value_size;
+  long count;
+  int file;
+
+  file = open (Path, O_RDONLY);
+  if (file < 0)
+    return (MGRS_INDEX_FILE_ERROR);
+  if ((fstat (file, &status) < 0) || (status.st_size < (off_t)sizeof (MGRS_Index_Header)))
+  {
+    close (file);
+    return (MGRS_INDEX_FILE_ERROR);
+  }
+  map = mmap (NULL, status.st_size, PROT_READ, MAP_SHARED, file, 0);
+  close (file);
+  if (map == MAP_FAILED)
+    return (MGRS_INDEX_FILE_ERROR);
+
+  header = (const MGRS_Index_Header *)map;
+  count = (long)header->Count;
+  value_size = header->Value_Size;
+  if (memcmp (header->Magic, MGRS_INDEX_MAGIC, sizeof (header->Magic))
+      || (header->Byte_Order != MGRS_INDEX_BYTE_ORDER) || (header->Key_Size != sizeof (MGRS_Key))
+      || (value_size && (value_size != sizeof (long))) || (header->Fanout != MGRS_INDEX_FANOUT)
+      || (status.st_size != (off_t)(sizeof (MGRS_Index_Header)
+                                    + (count + Get_MGRS_Index_Fence_Count (count))
+                                      * sizeof (MGRS_Key)
+                                    + count * value_size)))
+  {
+    munmap (map, status.st_size);
+    return (MGRS_INDEX_FILE_ERROR);
+  }
+  keys = (const char *)map + sizeof (MGRS_Index_Header);
+  Set_MGRS_Index_Levels (Index, (const MGRS_Key *)keys,
+                         (const MGRS_Key *)(keys + count * (sizeof (MGRS_Key) + value_size)),
+                         count);
+  Index->Values = value_size ? (const long *)(keys + count * sizeof (MGRS_Key)) : NULL;
+  Index->Map = map;
+  Index->Map_Size = (long)status.st_size;
+  return (MGRS_INDEX_NO_ERROR);
+} /* Map_MGRS_Index */
+
+
+void Unmap_MGRS_Index (MGRS_Index *Index)
+/*
+ * The function Unmap_MGRS_Index releases an index Map_MGRS_Index mapped.
+ *
+ *    Index         : MGRS index                    (input/output)
+ */
+{ /* Unmap_MGRS_Index */
+  if (Index->Map)
+    munmap (Index->Map, Index->Map_Size);
+  Index->Map = NULL;
+  Index->Map_Size = 0;
+  Index->Levels = 0;
+  Index->Count = 0;
+} /* Unmap_MGRS_Index */
+
+#endif /* MGRS_INDEX_FILES */
+
+#endif /* MGRS_INDEX_H */
@@ -0,0 +1,410 @@
+#ifndef MGRS_KEY_H
+#define MGRS_KEY_H
+
+#include "mgrs.h"
+
+#include <stdint.h>
+
+/*
+ * MGRS cells packed into one 64 bit key, for indexes that would otherwise
+ * hash and compare 16 byte strings.
+ *
+ * From the most significant bit down a key holds the zone (6 bits), the
+ * latitude band as an index into Latitude_Band_Table (5 bits), the 100 km
+ * column as easting / 100,000 - 1 (4 bits) and the row as an index into
+ * Grid_Row_Letter_Table (5 bits), then 5 pairs of an easting and a
+ * northing digit, each pair stored as 10 * easting digit + northing digit
+ * in 7 bits, from the 10 km digits down, and last the precision (3 bits).
+ * Digits beyond the precision are zero.  Keys compare as numbers in the
+ * order of zone, band and 100 km square, so the cells of one square, and
+ * likewise of one 10 km, 1 km ... cell within it, are next to each other,
+ * a coarser cell just ahead of the finer ones inside it.  The letters of
+ * the string follow from the indexes with no ellipsoid; only the cell's
+ * position needs the grid pattern of the MGRS parameters.  No valid key
+ * is 0.
+ */
+
+typedef uint64_t MGRS_Key;
+
+#define MGRS_KEY_NONE           ((MGRS_Key)0)
+#define MGRS_KEY_BITS           58
+#define MGRS_KEY_ZONE_SHIFT     52
+#define MGRS_KEY_BAND_SHIFT     47
+#define MGRS_KEY_COLUMN_SHIFT   43
+#define MGRS_KEY_ROW_SHIFT      38
+#define MGRS_KEY_PAIR_BITS      7       /* An easting and northing digit pair  */
+#define MGRS_KEY_PRECISION_BITS 3
+#define MGRS_KEY_RADIX_BITS     11      /* Key bits sorted per pass            */
+#define MGRS_KEY_RADIX          (1L << MGRS_KEY_RADIX_BITS)
+
+#define MGRS_KEY_ZONE(Key)      ((long)((Key) >> MGRS_KEY_ZONE_SHIFT))
+#define MGRS_KEY_PRECISION(Key) ((long)((Key) & ((1 << MGRS_KEY_PRECISION_BITS) - 1)))
+
+/* Shift of the digit pair of each precision, 1 for the 10 km digits */
+static const int MGRS_Key_Pair_Shift[MAX_PRECISION + 1] =
+  {0, 31, 24, 17, 10, 3};
+
+/* Key bits below the letters or digits of each precision */
+static const int MGRS_Key_Cell_Shift[MAX_PRECISION + 1] =
+  {MGRS_KEY_ROW_SHIFT, 31, 24, 17, 10, 3};
+
+
+MGRS_Key Make_MGRS_Key (long Zone,
+                        const int Letters[MGRS_LETTERS],
+                        long Easting,
+                        long Northing,
+                        long Precision)
+/*
+ * The function Make_MGRS_Key packs the component parts of an MGRS
+ * coordinate string, as UTM_To_MGRS_Letters_R gives them, into a key.
+ * Easting and Northing are whole meters, truncated to Precision as
+ * Write_MGRS_Meters does.
+ *
+ *   Zone           : UTM Zone                        (input)
+ *   Letters        : MGRS coordinate string letters  (input)
+ *   Easting        : Easting in whole meters         (input)
+ *   Northing       : Northing in whole meters        (input)
+ *   Precision      : Precision level of MGRS string  (input)
+ */
+{ /* Make_MGRS_Key */
+  long band = Letters[0] - LETTER_C - (Letters[0] > LETTER_I) - (Letters[0] > LETTER_O);
+  long row = Letters[2] - (Letters[2] > LETTER_I) - (Letters[2] > LETTER_O);
+  long east = (Easting % 100000) / MGRS_Divisor_Table[Precision];
+  long north = (Northing % 100000) / MGRS_Divisor_Table[Precision];
+  MGRS_Key key;
+  long i;
+
+  key = ((MGRS_Key)Zone << MGRS_KEY_ZONE_SHIFT) | ((MGRS_Key)band << MGRS_KEY_BAND_SHIFT)
+        | ((MGRS_Key)(Easting / 100000 - 1) << MGRS_KEY_COLUMN_SHIFT)
+        | ((MGRS_Key)row << MGRS_KEY_ROW_SHIFT) | (MGRS_Key)Precision;
+  for (i = Precision; i > 0; i--)
+  {
+    key |= (MGRS_Key)(east % 10 * 10 + north % 10) << MGRS_Key_Pair_Shift[i];
+    east /= 10;
+    north /= 10;
+  }
+  return (key);
+} /* Make_MGRS_Key */
+
+
+static long Break_MGRS_Key (MGRS_Key Key,
+                            long *Zone,
+                            int Letters[MGRS_LETTERS],
+                            long *Column,
+                            long *East,
+                            long *North,
+                            long *Precision)
+/*
+ * Unpacks a key into its zone, letters, 100 km column and the easting and
+ * northing digits within the square, in meters.  Returns
+ * MGRS_STRING_ERROR if it is not a valid key.
+ */
+{
+  long band = (long)(Key >> MGRS_KEY_BAND_SHIFT) & 0x1f;
+  long row = (long)(Key >> MGRS_KEY_ROW_SHIFT) & 0x1f;
+  long pair;
+  long i;
+
+  *Zone = MGRS_KEY_ZONE(Key);
+  *Column = (long)(Key >> MGRS_KEY_COLUMN_SHIFT) & 0xf;
+  *Precision = MGRS_KEY_PRECISION(Key);
+  if ((*Zone < 1) || (*Zone > 60) || (band >= 20) || (*Column > 8) || (row >= 20)
+      || (*Precision > MAX_PRECISION))
+    return (MGRS_STRING_ERROR);
+  Letters[0] = (int)Latitude_Band_Table[band].letter;
+  Letters[1] = Grid_Set_Table[*Zone % 6].column_letter[*Column];
+  Letters[2] = Grid_Row_Letter_Table[row];
+  *East = 0;
+  *North = 0;
+  for (i = 1; i <= MAX_PRECISION; i++)
+  {
+    pair = (long)(Key >> MGRS_Key_Pair_Shift[i]) & ((1 << MGRS_KEY_PAIR_BITS) - 1);
+    if ((pair > 99) || ((i > *Precision) && pair))
+      return (MGRS_STRING_ERROR);
+    *East = *East * 10 + pair / 10;
+    *North = *North * 10 + pair % 10;
+  }
+  return (MGRS_NO_ERROR);
+}
+
+
+long Convert_Geodetic_To_MGRS_Key_R (const MGRS_Parameters *Parameters,
+                                     double Latitude,
+                                     double Longitude,
+                                     long Precision,
+                                     MGRS_Key *Key)
+/*
+ * The function Convert_Geodetic_To_MGRS_Key_R converts Geodetic (latitude
+ * and longitude) coordinates to the key of the MGRS coordinate string
+ * Convert_Geodetic_To_MGRS_R gives, without writing the string.  If any
+ * errors occur, the error code(s) are returned by the function, otherwise
+ * MGRS_NO_ERROR is returned.
+ *
+ *    Parameters : MGRS parameters                  (input)
+ *    Latitude   : Latitude in radians              (input)
+ *    Longitude  : Longitude in radians             (input)
+ *    Precision  : Precision level of MGRS string   (input)
+ *    Key        : MGRS key                         (output)
+ */
+{ /* Convert_Geodetic_To_MGRS_Key_R */
+  long zone;
+  int letters[MGRS_LETTERS];
+  double easting;
+  double northing;
+  long error_code = MGRS_NO_ERROR;
+
+  error_code = Convert_Geodetic_To_MGRS_Letters_R (Parameters, Latitude, Longitude, Precision,
+                                                   &zone, letters, &easting, &northing);
+  if (!error_code)
+    *Key = Make_MGRS_Key (zone, letters, (long)easting, (long)northing, Precision);
+  return (error_code);
+} /* Convert_Geodetic_To_MGRS_Key_R */
+
+
+long Convert_MGRS_To_Key_R (const MGRS_Parameters *Parameters,
+                            const char *MGRS,
+                            MGRS_Key *Key)
+/*
+ * The function Convert_MGRS_To_Key_R packs an MGRS coordinate string into
+ * a key, checking it as Convert_MGRS_To_UTM_Grid_R does.  If any errors
+ * occur, the error code(s) are returned by the function, otherwise
+ * MGRS_NO_ERROR is returned.
+ *
+ *    Parameters : MGRS parameters                  (input)
+ *    MGRS       : MGRS coordinate string           (input)
+ *    Key        : MGRS key                         (output)
+ */
+{ /* Convert_MGRS_To_Key_R */
+  long zone;
+  int letters[MGRS_LETTERS];
+  char hemisphere;
+  double easting;
+  double northing;
+  long precision;
+  long error_code = MGRS_NO_ERROR;
+
+  error_code = Convert_MGRS_To_UTM_Grid_R (Parameters, MGRS, &zone, letters, &hemisphere,
+                                           &easting, &northing, &precision);
+  if (!error_code)
+    *Key = Make_MGRS_Key (zone, letters, (long)easting, (long)northing, precision);
+  return (error_code);
+} /* Convert_MGRS_To_Key_R */
+
+
+long Convert_MGRS_Key_To_String (MGRS_Key Key,
+                                 char *MGRS)
+/*
+ * The function Convert_MGRS_Key_To_String writes the MGRS coordinate
+ * string of a key, as Make_MGRS_String would, with table lookups alone.
+ * MGRS needs 16 characters.  If the key is not valid MGRS_STRING_ERROR is
+ * returned, otherwise MGRS_NO_ERROR.
+ *
+ *    Key        : MGRS key                         (input)
+ *    MGRS       : MGRS coordinate string           (output)
+ */
+{ /* Convert_MGRS_Key_To_String */
+  long zone;
+  int letters[MGRS_LETTERS];
+  long column;
+  long east;
+  long north;
+  long precision;
+  long error_code = MGRS_NO_ERROR;
+
+  error_code = Break_MGRS_Key (Key, &zone, letters, &column, &east, &north, &precision);
+  if (!error_code)
+    Write_MGRS_Meters (MGRS, zone, letters, east, north, precision, TRUE);
+  return (error_code);
+} /* Convert_MGRS_Key_To_String */
+
+
+long Convert_MGRS_Key_To_UTM_R (const MGRS_Parameters *Parameters,
+                                MGRS_Key Key,
+                                long   *Zone,
+                                char   *Hemisphere,
+                                double *Easting,
+                                double *Northing)
+/*
+ * The function Convert_MGRS_Key_To_UTM_R converts a key to the UTM zone,
+ * hemisphere, easting and northing of the centre of its cell, by grid
+ * arithmetic alone.  If any errors occur, the error code(s) are returned
+ * by the function, otherwise MGRS_NO_ERROR is returned.
+ *
+ *    Parameters : MGRS parameters                  (input)
+ *    Key        : MGRS key                         (input)
+ *    Zone       : UTM Zone                         (output)
+ *    Hemisphere : North or South hemisphere        (output)
+ *    Easting    : Easting (X) in meters            (output)
+ *    Northing   : Northing (Y) in meters           (output)
+ */
+{ /* Convert_MGRS_Key_To_UTM_R */
+  int letters[MGRS_LETTERS];
+  long column;
+  long east;
+  long north;
+  long precision;
+  long error_code = MGRS_NO_ERROR;
+
+  error_code = Break_MGRS_Key (Key, Zone, letters, &column, &east, &north, &precision);
+  if (!error_code)
+    error_code = Get_MGRS_Square_Origin_R (Parameters, *Zone, letters, Easting, Northing);
+  if (!error_code)
+  {
+    *Hemisphere = (letters[0] < LETTER_N) ? 'S' : 'N';
+    *Easting += east + 0.5 * MGRS_Divisor_Table[precision];
+    *Northing += north + 0.5 * MGRS_Divisor_Table[precision];
+  }
+  return (error_code);
+} /* Convert_MGRS_Key_To_UTM_R */
+
+
+long Convert_MGRS_Key_To_Geodetic_R (const MGRS_Parameters *Parameters,
+                                     MGRS_Key Key,
+                                     double *Latitude,
+                                     double *Longitude)
+/*
+ * The function Convert_MGRS_Key_To_Geodetic_R converts a key to Geodetic
+ * (latitude and longitude) coordinates of the centre of its cell,
+ * according to the ellipsoid in Parameters.  If any errors occur, the
+ * error code(s) are returned by the function, otherwise MGRS_NO_ERROR is
+ * returned.
+ *
+ *    Parameters : MGRS parameters                  (input)
+ *    Key        : MGRS key                         (input)
+ *    Latitude   : Latitude in radians              (output)
+ *    Longitude  : Longitude in radians             (output)
+ */
+{ /* Convert_MGRS_Key_To_Geodetic_R */
+  long zone;
+  char hemisphere;
+  double easting;
+  double northing;
+  long error_code = MGRS_NO_ERROR;
+
+  error_code = Convert_MGRS_Key_To_UTM_R (Parameters, Key, &zone, &hemisphere, &easting, &northing);
+  if (!error_code)
+    Convert_Transverse_Mercator_To_Geodetic_R (&Parameters->UTM.Ellipsoid,
+                                               &UTM_Zone_Projection[zone - 1][hemisphere == 'S'],
+                                               easting, northing, Latitude, Longitude);
+  return (error_code);
+} /* Convert_MGRS_Key_To_Geodetic_R */
+
+
+long Get_MGRS_Key_Cell (MGRS_Key Key,
+                        long Precision,
+                        MGRS_Key *Cell)
+/*
+ * The function Get_MGRS_Key_Cell gives the key of the cell at a coarser
+ * (or the same) Precision that holds the cell of Key, dropping its finer
+ * digits as truncating the string would.  If Precision is finer than the
+ * key's MGRS_PRECISION_ERROR is returned, otherwise MGRS_NO_ERROR.
+ *
+ *    Key        : MGRS key                         (input)
+ *    Precision  : Precision level of the cell      (input)
+ *    Cell       : MGRS key of the cell             (output)
+ */
+{ /* Get_MGRS_Key_Cell */
+  if ((Precision < 0) || (Precision > MGRS_KEY_PRECISION(Key)))
+    return (MGRS_PRECISION_ERROR);
+  *Cell = ((Key >> MGRS_Key_Cell_Shift[Precision]) << MGRS_Key_Cell_Shift[Precision])
+          | (MGRS_Key)Precision;
+  return (MGRS_NO_ERROR);
+} /* Get_MGRS_Key_Cell */
+
+
+long Get_MGRS_Key_Range (MGRS_Key Cell,
+                         MGRS_Key *Low,
+                         MGRS_Key *High)
+/*
+ * The function Get_MGRS_Key_Range gives the range of keys of the cell
+ * itself and every finer cell inside it: those from Low to High, both
+ * included.  A coarser cell with the same digits sorts before Low.  If the
+ * precision of Cell is not valid MGRS_PRECISION_ERROR is returned,
+ * otherwise MGRS_NO_ERROR.
+ *
+ *    Cell       : MGRS key of the cell             (input)
+ *    Low        : Lowest key in the cell           (output)
+ *    High       : Highest key in the cell          (output)
+ */
+{ /* Get_MGRS_Key_Range */
+  long precision = MGRS_KEY_PRECISION(Cell);
+
+  if (precision > MAX_PRECISION)
+    return (MGRS_PRECISION_ERROR);
+  *Low = Cell;
+  *High = Cell | ((((MGRS_Key)1) << MGRS_Key_Cell_Shift[precision]) - 1);
+  return (MGRS_NO_ERROR);
+} /* Get_MGRS_Key_Range */
+
+
+void Sort_MGRS_Keys (MGRS_Key *Keys,
+                     long *Values,
+                     MGRS_Key *Key_Scratch,
+                     long *Value_Scratch,
+                     long Count)
+/*
+ * The function Sort_MGRS_Keys sorts Count keys into ascending order by
+ * radix sort, MGRS_KEY_RADIX_BITS bits a pass from the least significant,
+ * carrying a value with each key unless Values is NULL.  A pass over bits
+ * all the keys share, such as the zone of a regional data set, is skipped.
+ * The scratch arrays need room for Count entries; the result is left in
+ * Keys and Values.  The sort is stable, and takes MGRS_KEY_RADIX longs of
+ * stack.
+ *
+ *    Keys          : MGRS keys                     (input/output)
+ *    Values        : Value of each key, or NULL    (input/output)
+ *    Key_Scratch   : Scratch keys                  (input)
+ *    Value_Scratch : Scratch values, or NULL       (input)
+ *    Count         : Number of keys                (input)
+ */
+{ /* Sort_MGRS_Keys */
+  long count[MGRS_KEY_RADIX];
+  MGRS_Key *from_keys = Keys;
+  MGRS_Key *to_keys = Key_Scratch;
+  MGRS_Key *swap_keys;
+  long *from_values = Values;
+  long *to_values = Value_Scratch;
+  long *swap_values;
+  long shift;
+  long digit;
+  long total;
+  long n;
+  long i;
+
+  for (shift = 0; shift < MGRS_KEY_BITS; shift += MGRS_KEY_RADIX_BITS)
+  {
+    memset (count, 0, sizeof (count));
+    for (i = 0; i < Count; i++)
+      count[(from_keys[i] >> shift) & (MGRS_KEY_RADIX - 1)]++;
+    if ((Count == 0) || (count[(from_keys[0] >> shift) & (MGRS_KEY_RADIX - 1)] == Count))
+      continue;  /* Every key has the same digit */
+    total = 0;
+    for (digit = 0; digit < MGRS_KEY_RADIX; digit++)
+    {
+      n = count[digit];
+      count[digit] = total;
+      total += n;
+    }
+    for (i = 0; i < Count; i++)
+    {
+      n = count[(from_keys[i] >> shift) & (MGRS_KEY_RADIX - 1)]++;
+      to_keys[n] = from_keys[i];
+      if (Values)
+        to_values[n] = from_values[i];
+    }
+    swap_keys = from_keys;
+    from_keys = to_keys;
+    to_keys = swap_keys;
+    swap_values = from_values;
+    from_values = to_values;
+    to_values = swap_values;
+  }
+  if (from_keys != Keys)
+  {
+    memcpy (Keys, from_keys, Count * sizeof (MGRS_Key));
+    if (Values)
+      memcpy (Values, from_values, Count * sizeof (long));
+  }
+} /* Sort_MGRS_Keys */
+
+#endif /* MGRS_KEY_H */
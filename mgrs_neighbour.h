@@ -0,0 +1,286 @@
+#ifndef MGRS_NEIGHBOUR_H
+#define MGRS_NEIGHBOUR_H
+
+#include "mgrs.h"
+
+/*
+ * The 8 MGRS cells around a cell, at the cell's own precision.
+ *
+ * The neighbour one step east, north, ... of a cell is the cell holding
+ * the point one cell size away from its centre in its zone's grid, as
+ * decoding the cell, offsetting the easting and northing and converting
+ * back with Convert_Geodetic_To_MGRS_R gives.  Inside a grid zone that is
+ * grid arithmetic alone: the easting and northing step by the cell size,
+ * and the 2nd and 3rd letters follow from them with Grid_Set_Table and
+ * Grid_Row_Letter_Table, the I and O skipping and the 2,000,000 meter row
+ * cycle included.  Only a point that may be across a zone or latitude
+ * band edge, or in one of the Norway and Svalbard grid zones, is projected
+ * back to latitude and longitude and converted in full.
+ *
+ * The tables below bound every standard grid zone in its own grid, with
+ * at least 100 meters to spare for each ellipsoid in MGRS_Datum_Table.
+ */
+
+#define MGRS_NEIGHBOURS         8
+#define MGRS_NEIGHBOUR_SIZE     16      /* Characters of an MGRS string with its  */
+                                        /* terminator, at any precision           */
+
+/* Steps east and north of each neighbour: north west, north, north east, */
+/* west, east, south west, south and south east                           */
+static const int MGRS_Neighbour_Step[MGRS_NEIGHBOURS][2] =
+  {{-1, 1}, {0, 1}, {1, 1}, {-1, 0}, {1, 0}, {-1, -1}, {0, -1}, {1, -1}};
+
+/*
+ * Northings, in the band's own hemisphere, between which every point of a
+ * standard grid zone is within the latitude band, indexed as
+ * Latitude_Band_Table.  Parallels bow away from the equator, so the band's
+ * lower edge is reached at the zone edge and its upper edge at the central
+ * meridian (the other way round south of the equator).
+ */
+static const long MGRS_Neighbour_Band_Northing[20][2] =
+  {{1063700, 2008300}, {2012100, 2899400}, {2903900, 3789700}, {3794700, 4679200},
+   {4684400, 5567800}, {5572800, 6455500}, {6460100, 7342400}, {7346200, 8228600},
+   {8231400, 9114300}, {9115900, 9999900}, {100, 884100}, {885700, 1768600},
+   {1771400, 2653800}, {2657600, 3539900}, {3544500, 4427200}, {4432200, 5315600},
+   {5320800, 6205300}, {6210300, 7096100}, {7100600, 7987900}, {7991700, 9382700}};
+
+/*
+ * Half width in meters of a standard grid zone, about the central meridian,
+ * for northings from each multiple of 100,000 meters from the equator to
+ * the next.  Meridians converge towards the pole, so it is taken at the
+ * poleward end.
+ */
+#define MGRS_NEIGHBOUR_ROWS     94
+static const long MGRS_Neighbour_Half_Width[MGRS_NEIGHBOUR_ROWS] =
+  {333700, 333600, 333400, 333100, 332800, 332300, 331800, 331100, 330400, 329700,
+   328800, 327900, 326800, 325700, 324500, 323300, 321900, 320500, 319000, 317400,
+   315700, 314000, 312200, 310300, 308300, 306200, 304100, 301900, 299600, 297300,
+   294900, 292400, 289800, 287200, 284500, 281700, 278800, 275900, 272900, 269900,
+   266700, 263600, 260300, 257000, 253600, 250200, 246700, 243100, 239500, 235800,
+   232000, 228200, 224400, 220500, 216500, 212500, 208400, 204300, 200100, 195900,
+   191600, 187300, 182900, 178500, 174100, 169600, 165100, 160500, 155900, 151200,
+   146500, 141800, 137000, 132200, 127400, 122500, 117600, 112700, 107800, 102800,
+   97800, 92800, 87700, 82700, 77600, 72500, 67300, 62200, 57100, 51900,
+   46700, 41500, 36300, 31100};
+
+
+static long Get_MGRS_Neighbour_Band (int Letter)
+/*
+ * Index into Latitude_Band_Table of a valid latitude band letter.
+ */
+{
+  if (Letter <= LETTER_H)
+    return (Letter - LETTER_C);
+  else if (Letter <= LETTER_N)
+    return (Letter - LETTER_D);
+  else
+    return (Letter - LETTER_E);
+}
+
+
+static long Get_MGRS_Neighbour_Cell (const MGRS_Parameters *Parameters,
+                                     long Zone,
+                                     const int Letters[MGRS_LETTERS],
+                                     char Hemisphere,
+                                     long Easting,
+                                     long Northing,
+                                     long Precision,
+                                     long Step_East,
+                                     long Step_North,
+                                     char *Neighbour)
+/*
+ * Writes the neighbour Step_East and Step_North cells from the cell whose
+ * south west corner is at Easting and Northing, or an empty string if that
+ * is north or south of the UTM grid zones.  Returns TRUE if it had to be
+ * projected.
+ */
+{
+  const Grid_Set *set = &Grid_Set_Table[Zone % 6];
+  long divisor = MGRS_Divisor_Table[Precision];
+  long band = Get_MGRS_Neighbour_Band (Letters[0]);
+  long grid_northing;
+  double centre_easting;
+  double centre_northing;
+  double from_equator;
+  double latitude;
+  double longitude;
+  int letters[MGRS_LETTERS];
+
+  Easting += Step_East * divisor;
+  Northing += Step_North * divisor;
+  centre_easting = Easting + 0.5 * divisor;
+  centre_northing = Northing + 0.5 * divisor;
+
+  if (!(((Zone == 31) || (Zone == 32)) && (Letters[0] == LETTER_V))
+      && !((Zone >= 31) && (Zone <= 37) && (Letters[0] == LETTER_X))
+      && (centre_northing >= MGRS_Neighbour_Band_Northing[band][0])
+      && (centre_northing < MGRS_Neighbour_Band_Northing[band][1]))
+  {
+    from_equator = (Hemisphere == 'S') ? (10000000.0 - centre_northing) : centre_northing;
+    if (fabs(centre_easting - 500000.0) < MGRS_Neighbour_Half_Width[(long)(from_equator / ONEHT)])
+    { /* Same grid zone */
+      grid_northing = (Northing % (long)TWOMIL) + (long)set->pattern_offset[Parameters->Grid_Pattern];
+      if (grid_northing >= TWOMIL)
+        grid_northing -= (long)TWOMIL;
+      letters[0] = Letters[0];
+      letters[1] = set->column_letter[Easting / (long)ONEHT - 1];
+      letters[2] = Grid_Row_Letter_Table[grid_northing / (long)ONEHT];
+      Write_MGRS_Meters (Neighbour, Zone, letters, Easting, Northing, Precision, TRUE);
+      return (FALSE);
+    }
+  }
+
+  Convert_Transverse_Mercator_To_Geodetic_R (&Parameters->UTM.Ellipsoid,
+                                             &UTM_Zone_Projection[Zone - 1][Hemisphere == 'S'],
+                                             centre_easting, centre_northing, &latitude, &longitude);
+  if (Convert_Geodetic_To_MGRS_R (Parameters, latitude, longitude, Precision, Neighbour))
+    Neighbour[0] = 0;
+  return (TRUE);
+}
+
+
+long Get_MGRS_Neighbours (const MGRS_Parameters *Parameters,
+                          const char *MGRS,
+                          char Neighbours[MGRS_NEIGHBOURS][MGRS_NEIGHBOUR_SIZE],
+                          long *Projected)
+/*
+ * The function Get_MGRS_Neighbours writes the 8 cells around an MGRS
+ * cell, in the order of MGRS_Neighbour_Step, at the precision of MGRS.
+ * A neighbour north or south of the UTM grid zones is an empty string.
+ * A neighbour across a zone edge need not touch the cell along a whole
+ * side, and at a zone edge two steps may give the same cell.  If any
+ * errors occur, the error code(s) are returned by the function, otherwise
+ * MGRS_NO_ERROR is returned.
+ *
+ *    Parameters : MGRS parameters                    (input)
+ *    MGRS       : MGRS coordinate string of the cell (input)
+ *    Neighbours : MGRS strings of its neighbours     (output)
+ *    Projected  : Number of neighbours that had to   (output)
+ *                 be projected
+ */
+{ /* Get_MGRS_Neighbours */
+  long zone;
+  int letters[MGRS_LETTERS];
+  char hemisphere;
+  double easting;
+  double northing;
+  long precision;
+  long i;
+  long error_code = MGRS_NO_ERROR;
+
+  *Projected = 0;
+  error_code = Convert_MGRS_To_UTM_Grid_R (Parameters, MGRS, &zone, letters, &hemisphere,
+                                           &easting, &northing, &precision);
+  if (!error_code)
+  {
+    for (i = 0; i < MGRS_NEIGHBOURS; i++)
+      *Projected += Get_MGRS_Neighbour_Cell (Parameters, zone, letters, hemisphere,
+                                             (long)easting, (long)northing, precision,
+                                             MGRS_Neighbour_Step[i][0], MGRS_Neighbour_Step[i][1],
+                                             Neighbours[i]);
+  }
+  return (error_code);
+} /* Get_MGRS_Neighbours */
+
+
+long Get_MGRS_Neighbour (const MGRS_Parameters *Parameters,
+                         const char *MGRS,
+                         long Step_East,
+                         long Step_North,
+                         char *Neighbour)
+/*
+ * The function Get_MGRS_Neighbour writes the cell Step_East cells east and
+ * Step_North cells north of an MGRS cell, in the cell's zone grid, as
+ * Get_MGRS_Neighbours does for single steps.  Neighbour needs
+ * MGRS_NEIGHBOUR_SIZE characters.  If any errors occur, the error code(s)
+ * are returned by the function, otherwise MGRS_NO_ERROR is returned.
+ *
+ *    Parameters : MGRS parameters                    (input)
+ *    MGRS       : MGRS coordinate string of the cell (input)
+ *    Step_East  : Cells east, negative for west      (input)
+ *    Step_North : Cells north, negative for south    (input)
+ *    Neighbour  : MGRS string of the neighbour       (output)
+ */
+{ /* Get_MGRS_Neighbour */
+  long zone;
+  int letters[MGRS_LETTERS];
+  char hemisphere;
+  double easting;
+  double northing;
+  long precision;
+  long error_code = MGRS_NO_ERROR;
+
+  error_code = Convert_MGRS_To_UTM_Grid_R (Parameters, MGRS, &zone, letters, &hemisphere,
+                                           &easting, &northing, &precision);
+  if (!error_code)
+    Get_MGRS_Neighbour_Cell (Parameters, zone, letters, hemisphere, (long)easting,
+                             (long)northing, precision, Step_East, Step_North, Neighbour);
+  return (error_code);
+} /* Get_MGRS_Neighbour */
+
+
+long MGRS_Cells_Adjacent (const MGRS_Parameters *Parameters,
+                          const char *MGRS,
+                          const char *Other)
+/*
+ * The function MGRS_Cells_Adjacent returns TRUE if the MGRS cell Other is
+ * one of the 8 neighbours Get_MGRS_Neighbours gives for the cell MGRS,
+ * otherwise FALSE, as it does for strings that are not valid cells.
+ * Cells of the same zone more than a step apart are rejected without
+ * working out any neighbours.
+ *
+ *    Parameters : MGRS parameters                    (input)
+ *    MGRS       : MGRS coordinate string of the cell (input)
+ *    Other      : MGRS coordinate string to test     (input)
+ */
+{ /* MGRS_Cells_Adjacent */
+  long zone[2];
+  int letters[2][MGRS_LETTERS];
+  char hemisphere[2];
+  double easting[2];
+  double northing[2];
+  long precision[2];
+  long step_east;
+  long step_north;
+  char other[MGRS_NEIGHBOUR_SIZE];
+  char neighbour[MGRS_NEIGHBOUR_SIZE];
+  long i;
+
+  if (Convert_MGRS_To_UTM_Grid_R (Parameters, MGRS, &zone[0], letters[0], &hemisphere[0],
+                                  &easting[0], &northing[0], &precision[0])
+      || Convert_MGRS_To_UTM_Grid_R (Parameters, Other, &zone[1], letters[1], &hemisphere[1],
+                                     &easting[1], &northing[1], &precision[1])
+      || (precision[0] != precision[1]))
+    return (FALSE);
+  /* As Get_MGRS_Neighbour_Cell writes it */
+  Write_MGRS_Meters (other, zone[1], letters[1], (long)easting[1], (long)northing[1],
+                     precision[1], TRUE);
+
+  if ((zone[0] == zone[1]) && (hemisphere[0] == hemisphere[1]))
+  {
+    step_east = (long)(easting[1] - easting[0]) / MGRS_Divisor_Table[precision[0]];
+    step_north = (long)(northing[1] - northing[0]) / MGRS_Divisor_Table[precision[0]];
+    if ((step_east < -1) || (step_east > 1) || (step_north < -1) || (step_north > 1))
+      return (FALSE);
+    if (step_east || step_north)
+    {
+      Get_MGRS_Neighbour_Cell (Parameters, zone[0], letters[0], hemisphere[0],
+                               (long)easting[0], (long)northing[0], precision[0],
+                               step_east, step_north, neighbour);
+      if (!strcmp(neighbour, other))
+        return (TRUE);
+    }
+  }
+
+  for (i = 0; i < MGRS_NEIGHBOURS; i++)
+  {
+    Get_MGRS_Neighbour_Cell (Parameters, zone[0], letters[0], hemisphere[0],
+                             (long)easting[0], (long)northing[0], precision[0],
+                             MGRS_Neighbour_Step[i][0], MGRS_Neighbour_Step[i][1], neighbour);
+    if (!strcmp(neighbour, other))
+      return (TRUE);
+  }
+  return (FALSE);
+} /* MGRS_Cells_Adjacent */
+
+#endif /* MGRS_NEIGHBOUR_H */
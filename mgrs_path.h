@@ -0,0 +1,413 @@
+#ifndef MGRS_PATH_H
+#define MGRS_PATH_H
+
+#include "mgrs_grid.h"
+
+/*
+ * The MGRS cells a track passes through, in order, with where along the
+ * track it enters and leaves each one.
+ *
+ * Each segment between two track points is first cut where it crosses a
+ * latitude band boundary or a meridian that is a multiple of 3 degrees,
+ * which takes in every UTM zone edge including the Norway and Svalbard
+ * ones; each piece is then within one grid zone, found as Get_UTM_Zone_R
+ * would from its middle.  The ends of a piece are projected, and the
+ * piece is walked in that zone's grid from one easting or northing line
+ * to the next, with no conversion per cell or per sample.  Segments are
+ * straight in latitude and longitude, which is curved in the grid: a
+ * piece too long to be within MGRS_PATH_FLATNESS cell sizes of straight
+ * however it curves is halved, as Trace_MGRS_Grid_Line does, until it is.
+ * GPS tracks rarely need that, so most track points are projected once.
+ * Segments cross the 180 degree meridian the short way round.
+ */
+
+#define MGRS_PATH_NO_ERROR        0x0000
+#define MGRS_PATH_PRECISION_ERROR 0x0001
+#define MGRS_PATH_POINT_ERROR     0x0002  /* A latitude or longitude out of range    */
+#define MGRS_PATH_FULL_ERROR      0x0004  /* Output array too small                  */
+#define MGRS_PATH_POLAR_WARNING   0x0008  /* Part of the track is north or south of  */
+                                          /* the UTM grid zones, and has no cells    */
+
+#define MGRS_PATH_CELL_SIZE       16
+#define MGRS_PATH_FLATNESS        1.0e-5  /* Largest gap between a piece and the     */
+                                          /* track, in cell sizes                    */
+#define MGRS_PATH_MAX_CURVATURE   2.0e-6  /* Of a track segment in the grid, in 1/m, */
+                                          /* with some margin, up to 84.5 degrees    */
+#define MGRS_PATH_MAX_DEPTH       24      /* Most halvings of a piece                */
+
+typedef struct MGRS_Path_Cell_Value
+{
+  char Cell[MGRS_PATH_CELL_SIZE];  /* MGRS string of the cell, at the precision */
+  long Zone;              /* UTM zone                                    */
+  long Band;              /* Index into Latitude_Band_Table              */
+  long Easting;           /* South west corner of the cell, in meters    */
+  long Northing;
+  double Enter;           /* Where the track enters the cell and leaves  */
+  double Exit;            /* it: i + f is the fraction f of the way from */
+                          /* point i to point i + 1                      */
+} MGRS_Path_Cell;
+
+typedef struct MGRS_Path_Output_Value
+{
+  MGRS_Path_Cell *Cells;
+  long Max_Cells;
+  long Cell_Count;
+} MGRS_Path_Output;
+
+/* Latitude band boundaries in degrees, south to north */
+static const double MGRS_Path_Band_Edge[21] =
+  {-80.5, -72.0, -64.0, -56.0, -48.0, -40.0, -32.0, -24.0, -16.0, -8.0, 0.0,
+   8.0, 16.0, 24.0, 32.0, 40.0, 48.0, 56.0, 64.0, 72.0, 84.5};
+
+
+static double Get_MGRS_Path_Longitude (double Degrees)
+/*
+ * Converts a longitude in degrees, from -540 to 540, to radians in
+ * [-PI, PI).
+ */
+{
+  while (Degrees >= 180.0)
+    Degrees -= 360.0;
+  while (Degrees < -180.0)
+    Degrees += 360.0;
+  return (Degrees * DEG_TO_RAD);
+}
+
+
+static long Add_MGRS_Path_Cell (const MGRS_Parameters *Parameters,
+                                long Precision,
+                                long Zone,
+                                long Band,
+                                long Column,
+                                long Row,
+                                double Enter,
+                                double Exit,
+                                MGRS_Path_Output *Output)
+/*
+ * Extends the last cell in Output to Exit if it is the one in column
+ * Column and row Row of the grid at Precision in a grid zone, or else
+ * appends and names that cell, or returns MGRS_PATH_FULL_ERROR.
+ */
+{
+  const Grid_Set *set = &Grid_Set_Table[Zone % 6];
+  long divisor = MGRS_Divisor_Table[Precision];
+  double grid_northing;
+  int letters[MGRS_LETTERS];
+  long column;
+  MGRS_Path_Cell *cell;
+
+  if (Output->Cell_Count)
+  {
+    cell = &Output->Cells[Output->Cell_Count - 1];
+    if ((cell->Exit == Enter) && (cell->Zone == Zone) && (cell->Band == Band)
+        && (cell->Easting == Column * divisor) && (cell->Northing == Row * divisor))
+    {
+      cell->Exit = Exit;
+      return (MGRS_PATH_NO_ERROR);
+    }
+  }
+  if (Output->Cell_Count >= Output->Max_Cells)
+    return (MGRS_PATH_FULL_ERROR);
+  cell = &Output->Cells[Output->Cell_Count++];
+  cell->Zone = Zone;
+  cell->Band = Band;
+  cell->Easting = Column * divisor;
+  cell->Northing = Row * divisor;
+  cell->Enter = Enter;
+  cell->Exit = Exit;
+
+  column = cell->Easting / 100000 - 1;
+  if (column < 0)
+    column = 0;
+  if (column > 8)
+    column = 8;
+  grid_northing = fmod((double)cell->Northing, TWOMIL) + set->pattern_offset[Parameters->Grid_Pattern];
+  if (grid_northing >= TWOMIL)
+    grid_northing -= TWOMIL;
+  letters[0] = Latitude_Band_Table[Band].letter;
+  letters[1] = set->column_letter[column];
+  letters[2] = Grid_Row_Letter_Table[(long)(grid_northing / ONEHT)];
+  Make_MGRS_String(cell->Cell, Zone, letters, (double)cell->Easting, (double)cell->Northing,
+                   Precision);
+  return (MGRS_PATH_NO_ERROR);
+}
+
+
+static long Walk_MGRS_Path_Piece (const MGRS_Parameters *Parameters,
+                                  long Precision,
+                                  long Zone,
+                                  long Band,
+                                  double Easting_0,
+                                  double Northing_0,
+                                  double Easting_1,
+                                  double Northing_1,
+                                  double Enter,
+                                  double Exit,
+                                  MGRS_Path_Output *Output)
+/*
+ * Appends the cells of a piece of track within one grid zone, straight in
+ * the grid from (Easting_0, Northing_0) at track position Enter to
+ * (Easting_1, Northing_1) at Exit, stepping from each easting or northing
+ * line it crosses to the next.  A piece through the very corner of a cell
+ * steps diagonally past the cells that only touch it there.
+ */
+{
+  double divisor = (double)MGRS_Divisor_Table[Precision];
+  double d_easting = Easting_1 - Easting_0;
+  double d_northing = Northing_1 - Northing_0;
+  double u = 0.0;         /* Fraction of the piece walked */
+  double u_column;        /* Fraction at the next easting line  */
+  double u_row;           /* Fraction at the next northing line */
+  double u_next;
+  long column;
+  long row;
+  long error_code = MGRS_PATH_NO_ERROR;
+
+  /* On a line, the cell is the one the piece is heading into */
+  column = (long)((d_easting < 0.0) ? ceil(Easting_0 / divisor) - 1 : floor(Easting_0 / divisor));
+  row = (long)((d_northing < 0.0) ? ceil(Northing_0 / divisor) - 1 : floor(Northing_0 / divisor));
+  while (!error_code && (u < 1.0))
+  {
+    if (d_easting > 0.0)
+      u_column = ((column + 1) * divisor - Easting_0) / d_easting;
+    else if (d_easting < 0.0)
+      u_column = (column * divisor - Easting_0) / d_easting;
+    else
+      u_column = 2.0;
+    if (d_northing > 0.0)
+      u_row = ((row + 1) * divisor - Northing_0) / d_northing;
+    else if (d_northing < 0.0)
+      u_row = (row * divisor - Northing_0) / d_northing;
+    else
+      u_row = 2.0;
+    u_next = (u_column < u_row) ? u_column : u_row;
+    if (u_next > 1.0)
+      u_next = 1.0;
+    if (u_next > u)
+      error_code = Add_MGRS_Path_Cell(Parameters, Precision, Zone, Band, column, row,
+                                      Enter + (Exit - Enter) * u,
+                                      (u_next < 1.0) ? Enter + (Exit - Enter) * u_next : Exit,
+                                      Output);
+    if (u_column <= u_next)
+      column += (d_easting > 0.0) ? 1 : -1;
+    if (u_row <= u_next)
+      row += (d_northing > 0.0) ? 1 : -1;
+    u = u_next;
+  }
+  return (error_code);
+}
+
+
+static long Trace_MGRS_Path_Piece (const MGRS_Parameters *Parameters,
+                                   const TranMerc_Ellipsoid *Ellipsoid,
+                                   const TranMerc_Projection *Projection,
+                                   long Precision,
+                                   long Zone,
+                                   long Band,
+                                   const double *Segment,
+                                   double T_0,
+                                   double T_1,
+                                   const double *Grid_0,
+                                   const double *Grid_1,
+                                   MGRS_Path_Output *Output)
+/*
+ * Appends the cells of the piece of track from fraction T_0 to T_1 of a
+ * segment, which starts at latitude and longitude Segment[0], Segment[1]
+ * degrees and runs Segment[2], Segment[3] degrees, position Segment[4] on
+ * the track.  Its ends are at easting and northing Grid_0 and Grid_1.
+ * Parts long enough to curve by more than the flatness are halved while
+ * their middle is further than that from the middle of the track.
+ */
+{
+  double flatness = MGRS_PATH_FLATNESS * MGRS_Divisor_Table[Precision];
+  double chord2 = 8.0 * flatness / MGRS_PATH_MAX_CURVATURE;  /* Squared */
+  double d_easting;
+  double d_northing;
+  double from[3];         /* Fraction, easting and northing of the part start */
+  double pending[MGRS_PATH_MAX_DEPTH][3];  /* Ends of the parts still to walk */
+  double middle[3];
+  double *to;
+  long depth = 1;
+  long error_code = MGRS_PATH_NO_ERROR;
+
+  from[0] = T_0;
+  from[1] = Grid_0[0];
+  from[2] = Grid_0[1];
+  pending[0][0] = T_1;
+  pending[0][1] = Grid_1[0];
+  pending[0][2] = Grid_1[1];
+  while (depth && !error_code)
+  {
+    to = pending[depth - 1];
+    d_easting = to[1] - from[1];
+    d_northing = to[2] - from[2];
+    if ((depth < MGRS_PATH_MAX_DEPTH)
+        && (d_easting * d_easting + d_northing * d_northing > chord2))
+    {
+      middle[0] = 0.5 * (from[0] + to[0]);
+      Convert_Geodetic_To_Transverse_Mercator_R(
+        Ellipsoid, Projection, (Segment[0] + middle[0] * Segment[2]) * DEG_TO_RAD,
+        Get_MGRS_Path_Longitude(Segment[1] + middle[0] * Segment[3]), &middle[1], &middle[2]);
+      d_easting = middle[1] - 0.5 * (from[1] + to[1]);
+      d_northing = middle[2] - 0.5 * (from[2] + to[2]);
+      if (d_easting * d_easting + d_northing * d_northing > flatness * flatness)
+      {
+        pending[depth][0] = middle[0];
+        pending[depth][1] = middle[1];
+        pending[depth++][2] = middle[2];
+        continue;
+      }
+      /* Flat enough: walk both halves, as the middle is worked out */
+      error_code = Walk_MGRS_Path_Piece(Parameters, Precision, Zone, Band, from[1], from[2],
+                                        middle[1], middle[2], Segment[4] + from[0],
+                                        Segment[4] + middle[0], Output);
+      from[0] = middle[0];
+      from[1] = middle[1];
+      from[2] = middle[2];
+      if (error_code)
+        break;
+    }
+    error_code = Walk_MGRS_Path_Piece(Parameters, Precision, Zone, Band, from[1], from[2],
+                                      to[1], to[2], Segment[4] + from[0], Segment[4] + to[0],
+                                      Output);
+    from[0] = to[0];
+    from[1] = to[1];
+    from[2] = to[2];
+    depth--;
+  }
+  return (error_code);
+}
+
+
+long Convert_Path_To_MGRS_Cells (const MGRS_Parameters *Parameters,
+                                 long Precision,
+                                 long Count,
+                                 const double *Latitude,
+                                 const double *Longitude,
+                                 MGRS_Path_Output *Output)
+/*
+ * The function Convert_Path_To_MGRS_Cells writes to Output the MGRS cells
+ * at Precision (0 for 100 km squares, 1 for 10 km, 2 for 1 km and so on)
+ * that the track through Count points passes through, in order, each with
+ * the track positions at which it enters and leaves the cell.  A cell
+ * left and entered again appears again; a cell crossed over two or more
+ * segments appears once.  Output's count is reset first.  If any errors
+ * occur the error code(s) are returned, and Output holds the cells up to
+ * the error, otherwise MGRS_PATH_NO_ERROR, or MGRS_PATH_POLAR_WARNING.
+ *
+ *    Parameters : MGRS parameters                      (input)
+ *    Precision  : Precision level of the cells         (input)
+ *    Count      : Number of track points               (input)
+ *    Latitude   : Latitudes of the points in radians   (input)
+ *    Longitude  : Longitudes of the points in radians  (input)
+ *    Output     : Cells the track passes through       (output)
+ */
+{ /* Convert_Path_To_MGRS_Cells */
+  TranMerc_Ellipsoid ellipsoid = Parameters->UTM.Ellipsoid;
+  const TranMerc_Projection *projection;
+  const TranMerc_Projection *last_projection = 0;  /* Of the last piece's end */
+  double last_grid[2] = {0.0, 0.0};
+  double last_position = -1.0;
+  double segment[5];      /* Start and run in degrees, and track position */
+  double grid_0[2];       /* Easting and northing of the piece's ends */
+  double grid_1[2];
+  double t;               /* Fraction of the segment done */
+  double t_band;          /* Fraction at the next band boundary */
+  double t_meridian;      /* Fraction at the next 3 degree meridian */
+  double t_next;
+  double lat;
+  double lon;
+  long band_edge;
+  long meridian;
+  long band;
+  long zone;
+  long zone_west;
+  long zone_east;
+  long i;
+  long error_code = MGRS_PATH_NO_ERROR;
+
+  Output->Cell_Count = 0;
+  if ((Precision < 0) || (Precision > MAX_PRECISION))
+    return (MGRS_PATH_PRECISION_ERROR);
+  for (i = 0; i < Count; i++)
+    if (!((Latitude[i] >= -PI_OVER_2) && (Latitude[i] <= PI_OVER_2)
+          && (Longitude[i] >= -PI) && (Longitude[i] <= (2 * PI))))   /* NaNs fail too */
+      return (MGRS_PATH_POINT_ERROR);
+  /* The same series, from one sin and cos */
+  if (ellipsoid.Series == TRANMERC_CLASSIC_SERIES)
+    ellipsoid.Series = TRANMERC_SHARED_TRIG_SERIES;
+
+  for (i = 0; (i + 1 < Count) && !(error_code & ~MGRS_PATH_POLAR_WARNING); i++)
+  {
+    segment[0] = Latitude[i] * RAD_TO_DEG;
+    segment[1] = Longitude[i] * RAD_TO_DEG;
+    segment[2] = Latitude[i + 1] * RAD_TO_DEG - segment[0];
+    segment[3] = Get_MGRS_Path_Longitude(Longitude[i + 1] * RAD_TO_DEG - segment[1]) * RAD_TO_DEG;
+    segment[4] = (double)i;
+
+    /* The band boundaries and 3 degree meridians ahead, nearest first */
+    band_edge = 0;
+    while ((band_edge < 21) && (MGRS_Path_Band_Edge[band_edge] <= segment[0]))
+      band_edge++;
+    if (segment[2] < 0.0)
+      while ((band_edge > 0) && (MGRS_Path_Band_Edge[band_edge - 1] >= segment[0]))
+        band_edge--;
+    meridian = (long)((segment[3] < 0.0) ? ceil(segment[1] / 3.0) - 1 : floor(segment[1] / 3.0) + 1);
+
+    for (t = 0.0; (t < 1.0) && !(error_code & ~MGRS_PATH_POLAR_WARNING); t = t_next)
+    {
+      if ((segment[2] > 0.0) && (band_edge < 21))
+        t_band = (MGRS_Path_Band_Edge[band_edge] - segment[0]) / segment[2];
+      else if ((segment[2] < 0.0) && (band_edge > 0))
+        t_band = (MGRS_Path_Band_Edge[band_edge - 1] - segment[0]) / segment[2];
+      else
+        t_band = 2.0;
+      t_meridian = (segment[3] != 0.0) ? (meridian * 3.0 - segment[1]) / segment[3] : 2.0;
+      t_next = (t_band < t_meridian) ? t_band : t_meridian;
+      if (t_next > 1.0)
+        t_next = 1.0;
+      if (t_band <= t_next)
+        band_edge += (segment[2] > 0.0) ? 1 : -1;
+      if (t_meridian <= t_next)
+        meridian += (segment[3] > 0.0) ? 1 : -1;
+      if (t_next <= t)
+        continue;
+
+      /* The grid zone of the piece, from its middle */
+      lat = segment[0] + 0.5 * (t + t_next) * segment[2];
+      lon = Get_MGRS_Path_Longitude(segment[1] + 0.5 * (t + t_next) * segment[3]) * RAD_TO_DEG;
+      if ((lat <= MGRS_Path_Band_Edge[0]) || (lat >= MGRS_Path_Band_Edge[20]))
+      {
+        error_code |= MGRS_PATH_POLAR_WARNING;
+        continue;
+      }
+      band = (lat >= 72.0) ? 19 : (long)((lat + 80.0) / 8.0);
+      zone = Get_MGRS_Grid_Zone_Span(band, lon, &zone_west, &zone_east);
+      projection = &UTM_Zone_Projection[zone - 1][band < 10];
+
+      if ((projection == last_projection) && (i + t == last_position))
+      { /* Where the last piece ended */
+        grid_0[0] = last_grid[0];
+        grid_0[1] = last_grid[1];
+      }
+      else
+        Convert_Geodetic_To_Transverse_Mercator_R(&ellipsoid, projection,
+                                                  (segment[0] + t * segment[2]) * DEG_TO_RAD,
+                                                  Get_MGRS_Path_Longitude(segment[1] + t * segment[3]),
+                                                  &grid_0[0], &grid_0[1]);
+      Convert_Geodetic_To_Transverse_Mercator_R(&ellipsoid, projection,
+                                                (segment[0] + t_next * segment[2]) * DEG_TO_RAD,
+                                                Get_MGRS_Path_Longitude(segment[1] + t_next * segment[3]),
+                                                &grid_1[0], &grid_1[1]);
+      error_code |= Trace_MGRS_Path_Piece(Parameters, &ellipsoid, projection, Precision, zone,
+                                          band, segment, t, t_next, grid_0, grid_1, Output);
+      last_projection = projection;
+      last_grid[0] = grid_1[0];
+      last_grid[1] = grid_1[1];
+      last_position = i + t_next;
+    }
+  }
+  return (error_code);
+} /* Convert_Path_To_MGRS_Cells */
+
+#endif /* MGRS_PATH_H */
@@ -0,0 +1,192 @@
+#ifndef MGRS_PROBE_H
+#define MGRS_PROBE_H
+
+/*
+ * Optional timing probes around the stages from an NMEA sentence to the
+ * MGRS string on the display.
+ *
+ * With MGRS_PROBES defined, MGRS_PROBE_BEGIN(Stage) and MGRS_PROBE_END(Stage)
+ * around a stage add the ticks it took to that stage's histogram, whose
+ * bucket i counts the times of 2^i to 2^(i+1) - 1 ticks.  Without it the
+ * macros are empty and nothing here is compiled.  Ticks are CPU cycles
+ * from the DWT cycle counter on Cortex-M3 and up (SAMD51), cycles from
+ * SysTick and millis() on Cortex-M0+ (SAMD21, which has no DWT counter),
+ * the time stamp counter on x86 and nanoseconds elsewhere.  On ARM the
+ * Arduino core (and its CMSIS headers) must be included first.  The
+ * histograms are plain globals: probe a single thread, or take the counts
+ * from several as approximate.
+ */
+
+#define MGRS_PROBE_NMEA_PARSE           0  /* Parse_NMEA_Sentence                 */
+#define MGRS_PROBE_GEODETIC_TO_UTM      1  /* Geodetic to UTM, zone and series    */
+#define MGRS_PROBE_TRANSVERSE_MERCATOR  2  /* The series alone, double or float   */
+#define MGRS_PROBE_UTM_TO_MGRS          3  /* UTM_To_MGRS_Letters_R               */
+#define MGRS_PROBE_MGRS_STRING          4  /* Write_MGRS_Meters                   */
+#define MGRS_PROBE_TRACKER              5  /* Update_MGRS_Tracker                 */
+#define MGRS_PROBE_DRAW                 6  /* Drawing a fix into the frame buffer */
+#define MGRS_PROBE_FLUSH                7  /* One step of sending the frame       */
+#define MGRS_PROBE_FIX_TO_FRAME         8  /* Fix parsed to its frame all sent    */
+#define MGRS_PROBE_STAGES               9
+#define MGRS_PROBE_BUCKETS              32
+
+#ifdef MGRS_PROBES
+
+#include <stdio.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define MGRS_PROBE_TICK_UNIT    "tsc"
+#elif defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)
+#define MGRS_PROBE_TICK_UNIT    "cycles"
+#elif defined(__arm__)
+#define MGRS_PROBE_TICK_UNIT    "cycles"
+#else
+#include <time.h>
+#define MGRS_PROBE_TICK_UNIT    "ns"
+#endif
+
+typedef unsigned long long MGRS_Probe_Ticks;
+
+typedef struct MGRS_Probe_Stage_Value
+{
+  unsigned long Count;
+  MGRS_Probe_Ticks Total;
+  MGRS_Probe_Ticks Min;
+  MGRS_Probe_Ticks Max;
+  unsigned long Bucket[MGRS_PROBE_BUCKETS];
+} MGRS_Probe_Stage;
+
+static MGRS_Probe_Stage MGRS_Probe_Table[MGRS_PROBE_STAGES];
+
+static const char *const MGRS_Probe_Names[MGRS_PROBE_STAGES] =
+  {"nmea_parse", "geodetic_to_utm", "transverse_mercator", "utm_to_mgrs",
+   "mgrs_string", "tracker", "draw", "flush", "fix_to_frame"};
+
+
+static inline MGRS_Probe_Ticks Get_MGRS_Probe_Ticks ()
+/*
+ * Reads the tick counter.
+ */
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return (__rdtsc());
+#elif defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)
+  return (DWT->CYCCNT);
+#elif defined(__arm__)
+  /* SysTick counts down from LOAD once a millisecond; retry if it wrapped */
+  unsigned long ms;
+  unsigned long count;
+
+  do
+  {
+    ms = millis();
+    count = SysTick->VAL;
+  } while (ms != millis());
+  return ((MGRS_Probe_Ticks)ms * (SysTick->LOAD + 1) + (SysTick->LOAD - count));
+#else
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return ((MGRS_Probe_Ticks)t.tv_sec * 1000000000ULL + t.tv_nsec);
+#endif
+}
+
+
+void Reset_MGRS_Probes ()
+/*
+ * The function Reset_MGRS_Probes empties every histogram, and on
+ * Cortex-M3 and up starts the DWT cycle counter, so it must be called
+ * once before the first probe there.
+ */
+{ /* Reset_MGRS_Probes */
+  long i;
+  long j;
+
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+  for (i = 0; i < MGRS_PROBE_STAGES; i++)
+  {
+    MGRS_Probe_Table[i].Count = 0;
+    MGRS_Probe_Table[i].Total = 0;
+    MGRS_Probe_Table[i].Min = 0;
+    MGRS_Probe_Table[i].Max = 0;
+    for (j = 0; j < MGRS_PROBE_BUCKETS; j++)
+      MGRS_Probe_Table[i].Bucket[j] = 0;
+  }
+} /* Reset_MGRS_Probes */
+
+
+void Record_MGRS_Probe (long Stage,
+                        MGRS_Probe_Ticks Ticks)
+/*
+ * The function Record_MGRS_Probe adds one time to a stage's histogram.
+ *
+ *    Stage      : MGRS_PROBE_* stage                 (input)
+ *    Ticks      : Time the stage took                (input)
+ */
+{ /* Record_MGRS_Probe */
+  MGRS_Probe_Stage *stage = &MGRS_Probe_Table[Stage];
+  long bucket = Ticks ? 63 - __builtin_clzll(Ticks) : 0;
+
+  if (bucket >= MGRS_PROBE_BUCKETS)
+    bucket = MGRS_PROBE_BUCKETS - 1;
+  if (!stage->Count || (Ticks < stage->Min))
+    stage->Min = Ticks;
+  if (Ticks > stage->Max)
+    stage->Max = Ticks;
+  stage->Bucket[bucket]++;
+  stage->Count++;
+  stage->Total += Ticks;
+} /* Record_MGRS_Probe */
+
+
+void Dump_MGRS_Probes (void (*Write_Line) (const char *Line))
+/*
+ * The function Dump_MGRS_Probes writes two lines of text for each stage
+ * that has been timed, through Write_Line (to a serial port, stdout, ...):
+ * its count and minimum, mean and maximum ticks, then its histogram as
+ * "bucket:count" for the buckets that are not empty.
+ *
+ *    Write_Line : Called with each line, no newline   (input)
+ */
+{ /* Dump_MGRS_Probes */
+  char line[MGRS_PROBE_BUCKETS * 16 + 64];
+  const MGRS_Probe_Stage *stage;
+  long length;
+  long i;
+  long j;
+
+  for (i = 0; i < MGRS_PROBE_STAGES; i++)
+  {
+    stage = &MGRS_Probe_Table[i];
+    if (!stage->Count)
+      continue;
+    snprintf(line, sizeof(line), "%s %s count %lu min %lu mean %lu max %lu",
+             MGRS_Probe_Names[i], MGRS_PROBE_TICK_UNIT, stage->Count,
+             (unsigned long)stage->Min, (unsigned long)(stage->Total / stage->Count),
+             (unsigned long)stage->Max);
+    Write_Line(line);
+    length = snprintf(line, sizeof(line), "%s log2", MGRS_Probe_Names[i]);
+    for (j = 0; j < MGRS_PROBE_BUCKETS; j++)
+      if (stage->Bucket[j])
+        length += snprintf(line + length, sizeof(line) - length, " %ld:%lu",
+                           j, stage->Bucket[j]);
+    Write_Line(line);
+  }
+} /* Dump_MGRS_Probes */
+
+#define MGRS_PROBE_BEGIN(Stage) \
+  MGRS_Probe_Ticks MGRS_Probe_Start_##Stage = Get_MGRS_Probe_Ticks()
+#define MGRS_PROBE_END(Stage) \
+  Record_MGRS_Probe(Stage, Get_MGRS_Probe_Ticks() - MGRS_Probe_Start_##Stage)
+
+#else
+
+#define MGRS_PROBE_BEGIN(Stage)
+#define MGRS_PROBE_END(Stage)
+
+#endif /* MGRS_PROBES */
+
+#endif /* MGRS_PROBE_H */
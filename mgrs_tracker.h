@@ -0,0 +1,191 @@
+#ifndef MGRS_TRACKER_H
+#define MGRS_TRACKER_H
+
+#include "mgrs_float.h"
+
+/*
+ * Incremental conversion of a track of GPS fixes in microdegrees to MGRS.
+ *
+ * Consecutive fixes almost always share their UTM zone, latitude band and
+ * 100 km square.  The tracker keeps the latitude and longitude limits of
+ * the zone and band of the last fix; while fixes stay inside them the zone
+ * selection, the Norway and Svalbard special cases and the band lookup are
+ * skipped, and the square letters are reused while the easting and northing
+ * stay in the same 100 km square.  Only the Transverse Mercator series and
+ * the digits are worked out per fix.
+ *
+ * The strings and error codes are those of Convert_Microdegrees_To_MGRS_R.
+ * With a zone override every fix takes the full path.
+ */
+
+typedef struct MGRS_Tracker_Value
+{
+  const MGRS_Float_Parameters *Parameters;
+  long Valid;             /* TRUE once a fix has been converted          */
+  long Cell_Changed;      /* TRUE if the last fix changed zone, band or  */
+                          /* 100 km square                               */
+  long Zone;
+  int Letters[MGRS_LETTERS];
+  long South;             /* Zone and band limits in microdegrees,       */
+  long North;             /* South and West inclusive, North and East    */
+  long West;              /* exclusive, longitude in [-180, 180)         */
+  long East;
+  long Central_Meridian;  /* Central meridian in microdegrees            */
+  long Square_Easting;    /* Easting and northing of the 100 km square,  */
+  long Square_Northing;   /* in units of 100 km                          */
+} MGRS_Tracker;
+
+
+void Init_MGRS_Tracker (MGRS_Tracker *Tracker,
+                        const MGRS_Float_Parameters *Parameters)
+/*
+ * The function Init_MGRS_Tracker empties a tracker, so that its next
+ * update takes the full conversion path.
+ *
+ *    Tracker    : Tracker to initialize                (output)
+ *    Parameters : Single precision MGRS parameters     (input)
+ */
+{ /* Init_MGRS_Tracker */
+  Tracker->Parameters = Parameters;
+  Tracker->Valid = FALSE;
+  Tracker->Cell_Changed = FALSE;
+} /* Init_MGRS_Tracker */
+
+
+static void Set_MGRS_Tracker_Limits (MGRS_Tracker *Tracker,
+                                     long Latitude)
+/*
+ * The function Set_MGRS_Tracker_Limits sets the latitude and longitude
+ * limits of the tracker's zone and band, following the band edges of
+ * Get_Latitude_Letter_Microdegrees and the special cases of
+ * Get_UTM_Zone_Microdegrees.
+ *
+ *    Tracker    : Tracker with Zone and Letters set    (input/output)
+ *    Latitude   : Latitude in microdegrees of the fix  (input)
+ */
+{ /* Set_MGRS_Tracker_Limits */
+  long band;
+  long zone = Tracker->Zone;
+
+  if (Tracker->Letters[0] == LETTER_X)
+  {
+    Tracker->South = 72 * MICRODEGREES;
+    Tracker->North = 84500000L;
+  }
+  else
+  {
+    band = (Latitude + 80 * MICRODEGREES) / (8 * MICRODEGREES);
+    Tracker->South = (band == 0) ? -80499999L : (8 * band - 80) * MICRODEGREES;
+    Tracker->North = (8 * band - 72) * MICRODEGREES;
+  }
+
+  Tracker->Central_Meridian = (6 * zone - 183) * MICRODEGREES;
+  Tracker->West = (6 * zone - 186) * MICRODEGREES;
+  Tracker->East = (6 * zone - 180) * MICRODEGREES;
+
+  if (Tracker->Letters[0] == LETTER_V)
+  {
+    if (zone == 31)
+      Tracker->East = 3 * MICRODEGREES;
+    else if (zone == 32)
+      Tracker->West = 3 * MICRODEGREES;
+  }
+  else if ((Tracker->Letters[0] == LETTER_X) && (zone >= 31) && (zone <= 37))
+  {
+    if (zone == 31)
+      Tracker->West = 0;
+    else
+      Tracker->West = (6 * zone - 189) * MICRODEGREES;
+    if (zone == 37)
+      Tracker->East = 42 * MICRODEGREES;
+    else
+      Tracker->East = (6 * zone - 177) * MICRODEGREES;
+  }
+} /* Set_MGRS_Tracker_Limits */
+
+
+long Update_MGRS_Tracker (MGRS_Tracker *Tracker,
+                          long Latitude,
+                          long Longitude,
+                          long Precision,
+                          char *MGRS)
+/*
+ * The function Update_MGRS_Tracker converts the next fix of a track to an
+ * MGRS coordinate string, reusing the zone, band and 100 km square of the
+ * previous fix where they still apply.  Tracker->Cell_Changed is set TRUE
+ * if the grid zone designator or 100 km square differs from that of the
+ * previous successful update, or there was none.  If any errors occur,
+ * the error code(s) are returned by the function and the tracker is
+ * emptied, otherwise MGRS_NO_ERROR is returned.
+ *
+ *    Tracker    : Tracker of the previous fixes        (input/output)
+ *    Latitude   : Latitude in microdegrees             (input)
+ *    Longitude  : Longitude in microdegrees            (input)
+ *    Precision  : Precision level of MGRS string       (input)
+ *    MGRS       : MGRS coordinate string               (output)
+ */
+{ /* Update_MGRS_Tracker */
+  long zone;
+  long easting;
+  long northing;
+  long square_easting;
+  long square_northing;
+  long lon = Longitude;  /* Longitude in [-180, 180) microdegrees */
+  int letters[MGRS_LETTERS];
+  long error_code;
+
+  if ((lon >= 180 * MICRODEGREES) && (lon <= 360 * MICRODEGREES))
+    lon -= 360 * MICRODEGREES;
+
+  if (Tracker->Valid && !Tracker->Parameters->Override
+      && (Latitude >= Tracker->South) && (Latitude < Tracker->North)
+      && (lon >= Tracker->West) && (lon < Tracker->East)
+      && (Precision >= 0) && (Precision <= MAX_PRECISION)
+      && !Get_UTM_Meters(Tracker->Parameters, Latitude,
+                         lon - Tracker->Central_Meridian,
+                         &easting, &northing))
+  {
+    square_easting = easting / 100000L;
+    square_northing = northing / 100000L;
+    Tracker->Cell_Changed = (square_easting != Tracker->Square_Easting)
+                            || (square_northing != Tracker->Square_Northing);
+    if (Tracker->Cell_Changed)
+    {
+      Get_Square_Letters(Tracker->Parameters, Tracker->Zone, easting, northing,
+                         Tracker->Letters);
+      Tracker->Square_Easting = square_easting;
+      Tracker->Square_Northing = square_northing;
+    }
+    Write_MGRS_Meters (MGRS, Tracker->Zone, Tracker->Letters, easting, northing,
+                       Precision, TRUE);
+    return (MGRS_NO_ERROR);
+  }
+
+  error_code = Convert_Microdegrees_To_MGRS_Values_R(Tracker->Parameters, Latitude,
+                                                     Longitude, Precision, &zone,
+                                                     letters, &easting, &northing);
+  if (error_code)
+  {
+    Tracker->Valid = FALSE;
+    Tracker->Cell_Changed = FALSE;
+    return (error_code);
+  }
+
+  Tracker->Cell_Changed = !Tracker->Valid || (zone != Tracker->Zone)
+                          || (letters[0] != Tracker->Letters[0])
+                          || (letters[1] != Tracker->Letters[1])
+                          || (letters[2] != Tracker->Letters[2]);
+  Tracker->Zone = zone;
+  Tracker->Letters[0] = letters[0];
+  Tracker->Letters[1] = letters[1];
+  Tracker->Letters[2] = letters[2];
+  Tracker->Square_Easting = easting / 100000L;
+  Tracker->Square_Northing = northing / 100000L;
+  Tracker->Valid = TRUE;
+  Set_MGRS_Tracker_Limits(Tracker, Latitude);
+
+  Write_MGRS_Meters (MGRS, zone, letters, easting, northing, Precision, TRUE);
+  return (MGRS_NO_ERROR);
+} /* Update_MGRS_Tracker */
+
+#endif /* MGRS_TRACKER_H */
@@ -0,0 +1,233 @@
+#ifndef NMEA_H
+#define NMEA_H
+
+/*
+ * In place parsing of NMEA 0183 GGA and RMC sentences into fixes in
+ * microdegrees, ready for Convert_Microdegrees_To_MGRS_R or an
+ * MGRS_Tracker.
+ *
+ * Sentences are parsed where they lie in the caller's buffer: nothing is
+ * copied or allocated, and the only state kept between sentences is the
+ * caller's.  The checksum is checked before any field is looked at.
+ * Latitude and longitude are converted from degrees and decimal minutes
+ * with integer arithmetic, rounded to the nearest microdegree.  Any talker
+ * (GP, GN, GL, ...) is accepted.
+ */
+
+#define NMEA_NO_ERROR           0x0000
+#define NMEA_CHECKSUM_ERROR     0x0001
+#define NMEA_FORMAT_ERROR       0x0002
+#define NMEA_SENTENCE_ERROR     0x0004  /* Not a GGA or RMC sentence       */
+#define NMEA_FIX_ERROR          0x0008  /* Receiver reports no valid fix   */
+
+#define NMEA_GGA                1
+#define NMEA_RMC                2
+#define NMEA_MAX_FIELDS         20      /* Fields looked at per sentence   */
+#define NMEA_MAX_SENTENCE       82      /* Longest sentence in the standard */
+
+typedef struct NMEA_Fix_Value
+{
+  long Type;         /* NMEA_GGA or NMEA_RMC                         */
+  long Time;         /* UTC time of day in milliseconds              */
+  long Date;         /* UTC date as ddmmyy from RMC, -1 from GGA     */
+  long Latitude;     /* Latitude in microdegrees                     */
+  long Longitude;    /* Longitude in microdegrees                    */
+} NMEA_Fix;
+
+
+static long NMEA_Hex_Digit (char c)
+{
+  if ((c >= '0') && (c <= '9'))
+    return (c - '0');
+  if ((c >= 'A') && (c <= 'F'))
+    return (c - 'A' + 10);
+  if ((c >= 'a') && (c <= 'f'))
+    return (c - 'a' + 10);
+  return (-1);
+}
+
+
+static long Parse_NMEA_Angle (const char *Field,
+                              const char *End,
+                              long Degree_Digits,
+                              char Negative,
+                              long *Angle)
+/*
+ * Converts a (d)ddmm.mmmm field and its hemisphere letter, which follows
+ * it after a comma, to microdegrees.  Degree_Digits is 2 for latitude and
+ * 3 for longitude.  Up to 7 decimals of minutes are used.  Returns
+ * NMEA_FIX_ERROR for an empty field, NMEA_FORMAT_ERROR for a bad one.
+ */
+{
+  long degrees = 0;
+  long long minutes = 0;    /* Minutes times scale */
+  long long scale = 1;
+  long i;
+
+  if (Field == End)
+    return (NMEA_FIX_ERROR);
+  if (End - Field < Degree_Digits + 2)
+    return (NMEA_FORMAT_ERROR);
+  for (i = 0; i < Degree_Digits; i++, Field++)
+  {
+    if ((*Field < '0') || (*Field > '9'))
+      return (NMEA_FORMAT_ERROR);
+    degrees = degrees * 10 + (*Field - '0');
+  }
+  for (i = 0; i < 2; i++, Field++)
+  {
+    if ((*Field < '0') || (*Field > '9'))
+      return (NMEA_FORMAT_ERROR);
+    minutes = minutes * 10 + (*Field - '0');
+  }
+  if ((Field < End) && (*Field == '.'))
+  {
+    for (Field++; (Field < End) && (scale < 10000000); Field++)
+    {
+      if ((*Field < '0') || (*Field > '9'))
+        return (NMEA_FORMAT_ERROR);
+      minutes = minutes * 10 + (*Field - '0');
+      scale *= 10;
+    }
+  }
+  if ((Field < End) && ((*Field < '0') || (*Field > '9')))
+    return (NMEA_FORMAT_ERROR);
+  if (minutes >= 60 * scale)
+    return (NMEA_FORMAT_ERROR);
+
+  /* Hemisphere letter, one field on */
+  End++;
+  if ((*End != Negative) && (*End != (Negative == 'S' ? 'N' : 'E')))
+    return ((*End == ',') || (*End == '*') ? NMEA_FIX_ERROR : NMEA_FORMAT_ERROR);
+
+  *Angle = degrees * 1000000L + (long)((minutes * 1000000 + 30 * scale) / (60 * scale));
+  if (*End == Negative)
+    *Angle = -*Angle;
+  return (NMEA_NO_ERROR);
+}
+
+
+static long Parse_NMEA_Time (const char *Field,
+                             const char *End,
+                             long *Time)
+/*
+ * Converts an hhmmss(.sss) field to milliseconds of the day.
+ */
+{
+  long value = 0;
+  long scale = 1000;
+  long i;
+
+  if (End - Field < 6)
+    return (NMEA_FORMAT_ERROR);
+  for (i = 0; i < 6; i++)
+  {
+    if ((Field[i] < '0') || (Field[i] > '9'))
+      return (NMEA_FORMAT_ERROR);
+    value = value * 10 + (Field[i] - '0');
+  }
+  value = ((value / 10000) * 3600 + ((value / 100) % 100) * 60 + value % 100) * 1000;
+  Field += 6;
+  if ((Field < End) && (*Field == '.'))
+    for (Field++; (Field < End) && (scale > 1); Field++)
+    {
+      if ((*Field < '0') || (*Field > '9'))
+        return (NMEA_FORMAT_ERROR);
+      scale /= 10;
+      value += (*Field - '0') * scale;
+    }
+  *Time = value;
+  return (NMEA_NO_ERROR);
+}
+
+
+long Parse_NMEA_Sentence (const char *Sentence,
+                          const char *End,
+                          NMEA_Fix *Fix)
+/*
+ * The function Parse_NMEA_Sentence parses one GGA or RMC sentence in place.
+ * Sentence points at its '$' and End just past its checksum (line endings
+ * may or may not be included).  If the sentence is corrupt, of another
+ * type or reports no fix, the error code is returned and Fix holds
+ * nothing of use, otherwise NMEA_NO_ERROR is returned.
+ *
+ *    Sentence   : Start of the sentence             (input)
+ *    End        : End of the sentence               (input)
+ *    Fix        : Time, date and position           (output)
+ */
+{ /* Parse_NMEA_Sentence */
+  const char *field[NMEA_MAX_FIELDS + 1];   /* Start of each field, and one past the last */
+  const char *p;
+  long fields = 0;
+  long checksum = 0;
+  long high;
+  long low;
+  long status;
+  long position;     /* Index of the latitude field */
+  long error_code;
+
+  while ((End > Sentence) && ((End[-1] == '\n') || (End[-1] == '\r')))
+    End--;
+  if ((End - Sentence < 10) || (*Sentence != '$') || (End[-3] != '*'))
+    return (NMEA_FORMAT_ERROR);
+
+  field[0] = Sentence + 1;
+  for (p = Sentence + 1; p < End - 3; p++)
+  {
+    checksum ^= *p;
+    if ((*p == ',') && (fields < NMEA_MAX_FIELDS))
+      field[++fields] = p + 1;
+  }
+  high = NMEA_Hex_Digit(End[-2]);
+  low = NMEA_Hex_Digit(End[-1]);
+  if ((high < 0) || (low < 0) || (((high << 4) | low) != checksum))
+    return (NMEA_CHECKSUM_ERROR);
+  if (fields < NMEA_MAX_FIELDS)
+    field[++fields] = End - 2;   /* As though a comma stood in place of the '*' */
+
+  /* Sentence type, after the 2 letter talker */
+  if (field[1] - field[0] != 6)
+    return (NMEA_SENTENCE_ERROR);
+  p = field[0] + 2;
+  if ((p[0] == 'G') && (p[1] == 'G') && (p[2] == 'A') && (fields > 7))
+  {
+    Fix->Type = NMEA_GGA;
+    Fix->Date = -1;
+    if ((field[6] + 1 == field[7]) || (*field[6] == '0'))
+      return (NMEA_FIX_ERROR);
+    position = 2;
+  }
+  else if ((p[0] == 'R') && (p[1] == 'M') && (p[2] == 'C') && (fields > 10))
+  {
+    Fix->Type = NMEA_RMC;
+    status = *field[2];
+    if (status != 'A')
+      return ((status == 'V') ? NMEA_FIX_ERROR : NMEA_FORMAT_ERROR);
+    if (field[10] - field[9] != 7)
+      return (NMEA_FORMAT_ERROR);
+    for (Fix->Date = 0, p = field[9]; p < field[9] + 6; p++)
+    {
+      if ((*p < '0') || (*p > '9'))
+        return (NMEA_FORMAT_ERROR);
+      Fix->Date = Fix->Date * 10 + (*p - '0');
+    }
+    position = 3;
+  }
+  else
+    return (NMEA_SENTENCE_ERROR);
+
+  /* Latitude, N/S, longitude and E/W are consecutive fields */
+  error_code = Parse_NMEA_Time(field[1], field[2] - 1, &Fix->Time);
+  if (!error_code)
+    error_code = Parse_NMEA_Angle(field[position], field[position + 1] - 1, 2, 'S',
+                                  &Fix->Latitude);
+  if (!error_code)
+    error_code = Parse_NMEA_Angle(field[position + 2], field[position + 3] - 1, 3, 'W',
+                                  &Fix->Longitude);
+  if (!error_code && ((Fix->Latitude > 90000000L) || (Fix->Longitude > 180000000L)
+                      || (Fix->Latitude < -90000000L) || (Fix->Longitude < -180000000L)))
+    error_code = NMEA_FORMAT_ERROR;
+  return (error_code);
+} /* Parse_NMEA_Sentence */
+
+#endif /* NMEA_H */
@@ -1,3 +1,8 @@
+#ifndef PI_H
+#define PI_H
+
 #define PI              3.14159265358979323e0   /* PI     */
 #define PI_OVER_2         (PI/2.0e0)            /* PI over 2 */
 #define MAX_LAT    ((PI * 90)/180.0)    /* 90 degrees in radians */
+
+#endif /* PI_H */
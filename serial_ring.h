@@ -0,0 +1,93 @@
+#ifndef SERIAL_RING_H
+#define SERIAL_RING_H
+
+/*
+ * Single producer, single consumer ring buffer of received serial bytes.
+ *
+ * The producer (a UART interrupt handler, or a drain of the core's own
+ * receive buffer) only writes Head and the consumer (the main loop) only
+ * writes Tail, so neither ever waits for or disables the other.  Head and
+ * Tail count bytes from the start and wrap by themselves; the slot of a
+ * count is its low bits, so SERIAL_RING_SIZE must be a power of 2.  A
+ * byte that arrives with the ring full is dropped and counted.
+ */
+
+#ifndef SERIAL_RING_SIZE
+#define SERIAL_RING_SIZE        1024    /* Bytes, a power of 2 */
+#endif
+
+typedef struct Serial_Ring_Value
+{
+  volatile unsigned long Head;     /* Bytes put, written by the producer only */
+  volatile unsigned long Tail;     /* Bytes got, written by the consumer only */
+  volatile unsigned long Dropped;  /* Bytes lost to a full ring               */
+  volatile unsigned long Peak;     /* Most bytes ever held at once            */
+  unsigned char Data[SERIAL_RING_SIZE];
+} Serial_Ring;
+
+
+void Init_Serial_Ring (Serial_Ring *Ring)
+/*
+ * The function Init_Serial_Ring empties a ring and its counts.  Neither
+ * side may be using it.
+ *
+ *    Ring       : Ring to initialize                 (output)
+ */
+{ /* Init_Serial_Ring */
+  Ring->Head = 0;
+  Ring->Tail = 0;
+  Ring->Dropped = 0;
+  Ring->Peak = 0;
+} /* Init_Serial_Ring */
+
+
+int Put_Serial_Ring (Serial_Ring *Ring,
+                     unsigned char Byte)
+/*
+ * The function Put_Serial_Ring appends a byte for the consumer.  It may be
+ * called from an interrupt handler.  It returns 0 if the ring was full and
+ * the byte was dropped, otherwise 1.
+ *
+ *    Ring       : Ring to append to                  (input/output)
+ *    Byte       : Byte received                      (input)
+ */
+{ /* Put_Serial_Ring */
+  unsigned long head = Ring->Head;
+  unsigned long used = head - Ring->Tail;
+
+  if (used >= SERIAL_RING_SIZE)
+  {
+    Ring->Dropped++;
+    return (0);
+  }
+  Ring->Data[head & (SERIAL_RING_SIZE - 1)] = Byte;
+  if (used + 1 > Ring->Peak)
+    Ring->Peak = used + 1;
+  __sync_synchronize();   /* The byte before the count that publishes it */
+  Ring->Head = head + 1;
+  return (1);
+} /* Put_Serial_Ring */
+
+
+int Get_Serial_Ring (Serial_Ring *Ring,
+                     unsigned char *Byte)
+/*
+ * The function Get_Serial_Ring takes the oldest byte from the ring.  It
+ * returns 0 if the ring is empty, otherwise 1.
+ *
+ *    Ring       : Ring to take from                  (input/output)
+ *    Byte       : Oldest byte                        (output)
+ */
+{ /* Get_Serial_Ring */
+  unsigned long tail = Ring->Tail;
+
+  if (tail == Ring->Head)
+    return (0);
+  __sync_synchronize();   /* The count before the byte it publishes */
+  *Byte = Ring->Data[tail & (SERIAL_RING_SIZE - 1)];
+  __sync_synchronize();   /* The byte before the slot is given back */
+  Ring->Tail = tail + 1;
+  return (1);
+} /* Get_Serial_Ring */
+
+#endif /* SERIAL_RING_H */
@@ -1,3 +1,6 @@
+#ifndef TRANMERC_H
+#define TRANMERC_H
+
 #include <math.h>
 #include "pi.h"
 
@@ -17,17 +20,222 @@
 #define MIN_SCALE_FACTOR  0.3
 #define MAX_SCALE_FACTOR  3.0
 
-#define SPHTMD(Latitude) ((double) (TranMerc_ap * Latitude \
-      - TranMerc_bp * sin(2.e0 * Latitude) + TranMerc_cp * sin(4.e0 * Latitude) \
-      - TranMerc_dp * sin(6.e0 * Latitude) + TranMerc_ep * sin(8.e0 * Latitude) ) )
+/* Series used for the projection, see TranMerc_Ellipsoid.Series */
+#define TRANMERC_CLASSIC_SERIES     0   /* 8th order power series in longitude  */
+#define TRANMERC_KRUGER_SERIES      1   /* Kruger 6th order series in n         */
+#define TRANMERC_SHARED_TRIG_SERIES 2   /* Classic series from one sin and cos  */
+
+/* Series selected by Make_Transverse_Mercator_Ellipsoid; build with
+ * -DTRANMERC_DEFAULT_SERIES=TRANMERC_KRUGER_SERIES to change it */
+#ifndef TRANMERC_DEFAULT_SERIES
+#define TRANMERC_DEFAULT_SERIES     TRANMERC_CLASSIC_SERIES
+#endif
+
+#define TRANMERC_KRUGER_ORDER       6
+
+/*
+ * Terms of the classic series evaluated by
+ * Convert_Geodetic_To_Transverse_Mercator_Terms_R, which bounds how far its
+ * result may be from that of Convert_Geodetic_To_Transverse_Mercator_R.
+ */
+#define TRANMERC_EXACT_TERMS        0   /* Convert_Geodetic_To_Transverse_Mercator_R itself */
+#define TRANMERC_ALL_TERMS          1   /* Every term, from one sin and cos of latitude     */
+#define TRANMERC_4TH_ORDER_TERMS    2   /* Northing to dlam^4 and sin 4 lat, easting to     */
+                                        /* dlam^3                                           */
+#define TRANMERC_TERMS_MAX_DELTA_LONG  (6.0 * PI / 180)  /* Widest UTM zone half-width   */
+#define TRANMERC_TERMS_MAX_EBS      0.0069  /* Largest second eccentricity squared bounded */
+#define TRANMERC_TERMS_ROUNDING     1.0e-6  /* Allowance for rounding, in meters          */
 
-#define SPHSN(Latitude) ((double) (TranMerc_a / sqrt( 1.e0 - TranMerc_es * \
+#define SPHTMD(Ellipsoid, Latitude) ((double) ((Ellipsoid)->ap * Latitude \
+      - (Ellipsoid)->bp * sin(2.e0 * Latitude) + (Ellipsoid)->cp * sin(4.e0 * Latitude) \
+      - (Ellipsoid)->dp * sin(6.e0 * Latitude) + (Ellipsoid)->ep * sin(8.e0 * Latitude) ) )
+
+#define SPHSN(Ellipsoid, Latitude) ((double) ((Ellipsoid)->a / sqrt( 1.e0 - (Ellipsoid)->es * \
       pow(sin(Latitude), 2))))
 
-#define SPHSR(Latitude) ((double) (TranMerc_a * (1.e0 - TranMerc_es) / \
-    pow(DENOM(Latitude), 3)))
+#define SPHSR(Ellipsoid, Latitude) ((double) ((Ellipsoid)->a * (1.e0 - (Ellipsoid)->es) / \
+    pow(DENOM(Ellipsoid, Latitude), 3)))
+
+#define DENOM(Ellipsoid, Latitude) ((double) (sqrt(1.e0 - (Ellipsoid)->es * pow(sin(Latitude),2))))
+
+
+typedef struct Transverse_Mercator_Kruger
+{
+  double e;      /* Eccentricity                                       */
+  double A;      /* Rectifying radius in meters                        */
+  double alpha[TRANMERC_KRUGER_ORDER];  /* Conformal to rectifying coefficients */
+  double beta[TRANMERC_KRUGER_ORDER];   /* Rectifying to conformal coefficients */
+} TranMerc_Kruger;
 
-#define DENOM(Latitude) ((double) (sqrt(1.e0 - TranMerc_es * pow(sin(Latitude),2))))
+typedef struct Transverse_Mercator_Ellipsoid
+{
+  double a;      /* Semi-major axis of ellipsoid in meters             */
+  double f;      /* Flattening of ellipsoid                            */
+  double es;     /* Eccentricity squared                               */
+  double ebs;    /* Second eccentricity squared                        */
+  double ap;     /* True meridional distance coefficients              */
+  double bp;
+  double cp;
+  double dp;
+  double ep;
+  long Series;   /* TRANMERC_CLASSIC_SERIES, ..._KRUGER_ or ..._SHARED_TRIG_ */
+  TranMerc_Kruger Kruger;
+} TranMerc_Ellipsoid;
+
+typedef struct Transverse_Mercator_Projection
+{
+  double Origin_Lat;      /* Latitude of origin in radians                  */
+  double Origin_Long;     /* Longitude of origin in radians, in [-PI, PI]   */
+  double False_Easting;   /* False easting in meters                        */
+  double False_Northing;  /* False northing in meters                       */
+  double Scale_Factor;    /* Scale factor                                   */
+  double tmdo;            /* True meridional distance for latitude of origin */
+} TranMerc_Projection;
+
+/* Square root by Newton's method, for the ellipsoid constants below */
+static constexpr double Transverse_Mercator_Sqrt_Step (double x, double y, int steps)
+{
+  return ((steps == 0) || ((y + x / y) / 2 == y)) ? y
+    : Transverse_Mercator_Sqrt_Step (x, (y + x / y) / 2, steps - 1);
+}
+
+/* Rounding error of y * y, given the high half hi of y (Dekker's product) */
+static constexpr double Transverse_Mercator_Square_Error (double y, double hi)
+{
+  return (((hi * hi - y * y) + 2 * hi * (y - hi)) + (y - hi) * (y - hi));
+}
+
+/* Last Newton step, from the exact residual y * y - x, so y rounds as sqrt() does */
+static constexpr double Transverse_Mercator_Sqrt_Round (double x, double y)
+{
+  return (y - ((y * y - x)
+               + Transverse_Mercator_Square_Error (y, 134217729.0 * y
+                                                   - (134217729.0 * y - y))) / (2 * y));
+}
+
+static constexpr double Transverse_Mercator_Sqrt (double x)
+{
+  return ((x <= 0) ? 0
+          : Transverse_Mercator_Sqrt_Round (x, Transverse_Mercator_Sqrt_Step (x, (x < 1) ? 1 : x,
+                                                                              100)));
+}
+
+/* Kruger constants from the eccentricity e and powers of the third flattening n */
+static constexpr TranMerc_Kruger Transverse_Mercator_Kruger_Series (double a, double e,
+                                                                    double n, double n2,
+                                                                    double n3, double n4,
+                                                                    double n5, double n6)
+{
+  return {e,
+          a / (1 + n) * (1 + n2 / 4 + n4 / 64 + n6 / 256),
+          {n / 2 - 2 * n2 / 3 + 5 * n3 / 16 + 41 * n4 / 180
+           - 127 * n5 / 288 + 7891 * n6 / 37800,
+           13 * n2 / 48 - 3 * n3 / 5 + 557 * n4 / 1440
+           + 281 * n5 / 630 - 1983433 * n6 / 1935360,
+           61 * n3 / 240 - 103 * n4 / 140 + 15061 * n5 / 26880
+           + 167603 * n6 / 181440,
+           49561 * n4 / 161280 - 179 * n5 / 168 + 6601661 * n6 / 7257600,
+           34729 * n5 / 80640 - 3418889 * n6 / 1995840,
+           212378941 * n6 / 319334400},
+          {n / 2 - 2 * n2 / 3 + 37 * n3 / 96 - n4 / 360
+           - 81 * n5 / 512 + 96199 * n6 / 604800,
+           n2 / 48 + n3 / 15 - 437 * n4 / 1440 + 46 * n5 / 105
+           - 1118711 * n6 / 3870720,
+           17 * n3 / 480 - 37 * n4 / 840 - 209 * n5 / 4480
+           + 5569 * n6 / 90720,
+           4397 * n4 / 161280 - 11 * n5 / 504 - 830251 * n6 / 7257600,
+           4583 * n5 / 161280 - 108847 * n6 / 3991680,
+           20648693 * n6 / 638668800}};
+}
+
+static constexpr TranMerc_Kruger Transverse_Mercator_Kruger_N (double a, double e, double n)
+{
+  return (Transverse_Mercator_Kruger_Series (a, e, n, n * n, n * n * n, n * n * n * n,
+                                             n * n * n * n * n, n * n * n * n * n * n));
+}
+
+TranMerc_Kruger Make_Transverse_Mercator_Kruger(double a, double f)
+{
+/*
+ * The function Make_Transverse_Mercator_Kruger derives the rectifying
+ * radius and the Kruger series coefficients, to 6th order in the third
+ * flattening n, of the ellipsoid given by its semi-major axis and
+ * flattening (C. F. F. Karney, Transverse Mercator with an accuracy of a
+ * few nanometers, J. Geodesy 85(8), 2011).
+ *
+ *    a                 : Semi-major axis of ellipsoid, in meters    (input)
+ *    f                 : Flattening of ellipsoid                     (input)
+ */
+
+  return (Transverse_Mercator_Kruger_N(a, sqrt(f * (2 - f)), f / (2 - f)));
+} /* END OF Make_Transverse_Mercator_Kruger */
+
+/* True meridional distance constants from the powers of tn = (a - b) / (a + b) */
+static constexpr TranMerc_Ellipsoid Transverse_Mercator_Ellipsoid_Series (double a, double f,
+                                                                          double es, double tn,
+                                                                          double tn2, double tn3,
+                                                                          double tn4, double tn5,
+                                                                          TranMerc_Kruger Kruger)
+{
+  return {a,
+          f,
+          es,
+          (1 / (1 - es)) - 1,
+          a * (1.e0 - tn + 5.e0 * (tn2 - tn3)/4.e0
+               + 81.e0 * (tn4 - tn5)/64.e0 ),
+          3.e0 * a * (tn - tn2 + 7.e0 * (tn3 - tn4)
+                      /8.e0 + 55.e0 * tn5/64.e0 )/2.e0,
+          15.e0 * a * (tn2 - tn3 + 3.e0 * (tn4 - tn5 )/4.e0) /16.0,
+          35.e0 * a * (tn3 - tn4 + 11.e0 * tn5 / 16.e0) / 48.e0,
+          315.e0 * a * (tn4 - tn5) / 512.e0,
+          TRANMERC_DEFAULT_SERIES,
+          Kruger};
+}
+
+static constexpr TranMerc_Ellipsoid Transverse_Mercator_Ellipsoid_Tn (double a, double f,
+                                                                      double tn,
+                                                                      TranMerc_Kruger Kruger)
+{
+  return (Transverse_Mercator_Ellipsoid_Series (a, f, 2 * f - f * f, tn, tn * tn,
+                                                tn * tn * tn, tn * tn * tn * tn,
+                                                tn * tn * tn * tn * tn, Kruger));
+}
+
+TranMerc_Ellipsoid Make_Transverse_Mercator_Ellipsoid(double a, double f)
+{
+/*
+ * The function Make_Transverse_Mercator_Ellipsoid derives the eccentricities,
+ * true meridional distance coefficients and Kruger series coefficients of
+ * the ellipsoid given by its semi-major axis and flattening, and selects
+ * TRANMERC_DEFAULT_SERIES.  No range checking is done here; see
+ * Set_Transverse_Mercator_Parameters.
+ *
+ *    a                 : Semi-major axis of ellipsoid, in meters    (input)
+ *    f                 : Flattening of ellipsoid                     (input)
+ */
+
+  double b = a * (1 - f);   /* Semi-minor axis of ellipsoid, in meters */
+
+  return (Transverse_Mercator_Ellipsoid_Tn(a, f, (a - b) / (a + b),
+                                           Make_Transverse_Mercator_Kruger(a, f)));
+} /* END OF Make_Transverse_Mercator_Ellipsoid */
+
+/*
+ * The constants of Make_Transverse_Mercator_Ellipsoid, worked out by the
+ * compiler so that an ellipsoid known at build time lives in flash with
+ * no startup code.  The square root is by Newton's method rather than
+ * sqrt(); mgrs_bench checks every datum's constants against
+ * Make_Transverse_Mercator_Ellipsoid bit for bit.
+ */
+#define TRANMERC_ELLIPSOID(a, f) \
+  Transverse_Mercator_Ellipsoid_Tn((a), (f), \
+    ((a) - (a) * (1 - (f))) / ((a) + (a) * (1 - (f))), \
+    Transverse_Mercator_Kruger_N((a), Transverse_Mercator_Sqrt((f) * (2 - (f))), \
+                                 (f) / (2 - (f))))
+
+/* WGS 84 */
+static constexpr TranMerc_Ellipsoid TranMerc_WGS84 =
+  TRANMERC_ELLIPSOID(6378137.0, 1 / 298.257223563);
 
 
 /**************************************************************************/
@@ -36,80 +244,253 @@
  */
 
 /* Ellipsoid Parameters, default to WGS 84  */
-static double TranMerc_a = 6378137.0;              /* Semi-major axis of ellipsoid in meters */
-static double TranMerc_f = 1 / 298.257223563;      /* Flattening of ellipsoid  */
-static double TranMerc_es = 0.0066943799901413800; /* Eccentricity (0.08181919084262188000) squared */
-static double TranMerc_ebs = 0.0067394967565869;   /* Second Eccentricity squared */
+static TranMerc_Ellipsoid TranMerc_Ellipsoid_State =
+  {6378137.0,               /* Semi-major axis of ellipsoid in meters */
+   1 / 298.257223563,       /* Flattening of ellipsoid  */
+   0.0066943799901413800,   /* Eccentricity (0.08181919084262188000) squared */
+   0.0067394967565869,      /* Second Eccentricity squared */
+   /* Isometeric to geodetic latitude parameters */
+   6367449.1458008,
+   16038.508696861,
+   16.832613334334,
+   0.021984404273757,
+   3.1148371319283e-005,
+   TRANMERC_DEFAULT_SERIES,
+   TranMerc_WGS84.Kruger};
 
 /* Transverse_Mercator projection Parameters */
-static double TranMerc_Origin_Lat = 0.0;           /* Latitude of origin in radians */
-static double TranMerc_Origin_Long = 0.0;          /* Longitude of origin in radians */
-static double TranMerc_False_Northing = 0.0;       /* False northing in meters */
-static double TranMerc_False_Easting = 0.0;        /* False easting in meters */
-static double TranMerc_Scale_Factor = 1.0;         /* Scale factor  */
-
-/* Isometeric to geodetic latitude parameters, default to WGS 84 */
-static double TranMerc_ap = 6367449.1458008;
-static double TranMerc_bp = 16038.508696861;
-static double TranMerc_cp = 16.832613334334;
-static double TranMerc_dp = 0.021984404273757;
-static double TranMerc_ep = 3.1148371319283e-005;
+static TranMerc_Projection TranMerc_Projection_State =
+  {0.0,                     /* Latitude of origin in radians */
+   0.0,                     /* Longitude of origin in radians */
+   0.0,                     /* False easting in meters */
+   0.0,                     /* False northing in meters */
+   1.0,                     /* Scale factor  */
+   0.0};                    /* True meridional distance of origin */
 
 /* Maximum variance for easting and northing values for WGS 84. */
 static double TranMerc_Delta_Easting = 40000000.0;
 static double TranMerc_Delta_Northing = 40000000.0;
 
-long Convert_Geodetic_To_Transverse_Mercator (double Latitude,
-                                              double Longitude,
-                                              double *Easting,
-                                              double *Northing)
+static double Transverse_Mercator_Kruger_Taup (const TranMerc_Kruger *Kruger,
+                                               double tau)
+/*
+ * Tangent of the conformal latitude, given the tangent of the geodetic
+ * latitude tau.
+ */
+{
+  double tau1 = sqrt(1 + tau * tau);
+  double sig = sinh(Kruger->e * atanh(Kruger->e * tau / tau1));
 
-{      /* BEGIN Convert_Geodetic_To_Transverse_Mercator */
+  return (sqrt(1 + sig * sig) * tau - sig * tau1);
+}
 
-  /*
-   * The function Convert_Geodetic_To_Transverse_Mercator converts geodetic
-   * (latitude and longitude) coordinates to Transverse Mercator projection
-   * (easting and northing) coordinates, according to the current ellipsoid
-   * and Transverse Mercator projection coordinates.  If any errors occur, the
-   * error code(s) are returned by the function, otherwise TRANMERC_NO_ERROR is
-   * returned.
-   *
-   *    Latitude      : Latitude in radians                         (input)
-   *    Longitude     : Longitude in radians                        (input)
-   *    Easting       : Easting/X in meters                         (output)
-   *    Northing      : Northing/Y in meters                        (output)
-   */
+static void Transverse_Mercator_Kruger_Sum (const double *Coefficients,
+                                            double Xi,
+                                            double Eta,
+                                            double *Sum_Xi,
+                                            double *Sum_Eta)
+/*
+ * Clenshaw summation of Coefficients[j-1] * sin(2j * (Xi + i Eta)) for
+ * j = 1 .. TRANMERC_KRUGER_ORDER, with complex arithmetic written out so
+ * that only one sin/cos of 2 Xi and one exponential of 2 Eta are needed.
+ */
+{
+  double s2 = sin(2 * Xi);
+  double c2 = cos(2 * Xi);
+  double ex = exp(2 * Eta);
+  double sh2 = (ex - 1 / ex) / 2;
+  double ch2 = (ex + 1 / ex) / 2;
+  double ar = 2 * c2 * ch2;     /* 2 cos(2 zeta) */
+  double ai = -2 * s2 * sh2;
+  double yr0 = 0, yi0 = 0;
+  double yr1 = 0, yi1 = 0;
+  double yr, yi;
+  int j;
 
-  double c;       /* Cosine of latitude                          */
-  double c2;
-  double c3;
-  double c5;
-  double c7;
-  double dlam;    /* Delta longitude - Difference in Longitude       */
-  double eta;     /* constant - TranMerc_ebs *c *c                   */
-  double eta2;
-  double eta3;
-  double eta4;
-  double s;       /* Sine of latitude                        */
-  double sn;      /* Radius of curvature in the prime vertical       */
-  double t;       /* Tangent of latitude                             */
-  double tan2;
-  double tan3;
-  double tan4;
-  double tan5;
-  double tan6;
-  double t1;      /* Term in coordinate conversion formula - GP to Y */
-  double t2;      /* Term in coordinate conversion formula - GP to Y */
-  double t3;      /* Term in coordinate conversion formula - GP to Y */
-  double t4;      /* Term in coordinate conversion formula - GP to Y */
-  double t5;      /* Term in coordinate conversion formula - GP to Y */
-  double t6;      /* Term in coordinate conversion formula - GP to Y */
-  double t7;      /* Term in coordinate conversion formula - GP to Y */
-  double t8;      /* Term in coordinate conversion formula - GP to Y */
-  double t9;      /* Term in coordinate conversion formula - GP to Y */
-  double tmd;     /* True Meridional distance                        */
-  double tmdo;    /* True Meridional distance for latitude of origin */
+  for (j = TRANMERC_KRUGER_ORDER - 1; j >= 0; j--)
+  {
+    yr = ar * yr1 - ai * yi1 - yr0 + Coefficients[j];
+    yi = ar * yi1 + ai * yr1 - yi0;
+    yr0 = yr1;
+    yi0 = yi1;
+    yr1 = yr;
+    yi1 = yi;
+  }
+  /* times sin(2 zeta) */
+  *Sum_Xi = s2 * ch2 * yr1 - c2 * sh2 * yi1;
+  *Sum_Eta = s2 * ch2 * yi1 + c2 * sh2 * yr1;
+}
+
+void Transverse_Mercator_Kruger (const TranMerc_Kruger *Kruger,
+                                 double Latitude,
+                                 double Delta_Longitude,
+                                 double *X,
+                                 double *Y)
+/*
+ * The function Transverse_Mercator_Kruger evaluates the Kruger series for
+ * the unscaled Transverse Mercator coordinates of a point, measured from
+ * the equator on the central meridian, where Y is the true meridional
+ * distance.  Callers apply the scale factor, false easting and northing
+ * and latitude of origin.
+ *
+ *    Kruger          : Kruger series constants                 (input)
+ *    Latitude        : Latitude in radians                     (input)
+ *    Delta_Longitude : Longitude less central meridian, radians (input)
+ *    X               : Unscaled easting in meters              (output)
+ *    Y               : Unscaled northing in meters             (output)
+ */
+{
+  double cl = cos(Delta_Longitude);
+  double taup = Transverse_Mercator_Kruger_Taup(Kruger, sin(Latitude) / cos(Latitude));
+  double xip = atan2(taup, cl);
+  double etap = asinh(sin(Delta_Longitude) / sqrt(taup * taup + cl * cl));
+  double dxi;
+  double deta;
+
+  Transverse_Mercator_Kruger_Sum(Kruger->alpha, xip, etap, &dxi, &deta);
+  *X = Kruger->A * (etap + deta);
+  *Y = Kruger->A * (xip + dxi);
+}
+
+void Transverse_Mercator_Kruger_Inverse (const TranMerc_Kruger *Kruger,
+                                         double X,
+                                         double Y,
+                                         double *Latitude,
+                                         double *Delta_Longitude)
+/*
+ * The function Transverse_Mercator_Kruger_Inverse inverts
+ * Transverse_Mercator_Kruger.  The geodetic latitude is recovered from the
+ * conformal latitude by Newton's method, which converges in 2 or 3 steps.
+ *
+ *    Kruger          : Kruger series constants                 (input)
+ *    X               : Unscaled easting in meters              (input)
+ *    Y               : Unscaled northing in meters             (input)
+ *    Latitude        : Latitude in radians                     (output)
+ *    Delta_Longitude : Longitude less central meridian, radians (output)
+ */
+{
+  double e2m = 1 - Kruger->e * Kruger->e;
+  double xi = Y / Kruger->A;
+  double eta = X / Kruger->A;
+  double dxi;
+  double deta;
+  double sh;
+  double c;
+  double taup;
+  double taupa;
+  double tau;
+  double dtau;
+  double tol;
+  int i;
+
+  Transverse_Mercator_Kruger_Sum(Kruger->beta, xi, eta, &dxi, &deta);
+  xi -= dxi;
+  eta -= deta;
+  sh = sinh(eta);
+  c = cos(xi);
+  taup = sin(xi) / sqrt(sh * sh + c * c);
+  *Delta_Longitude = atan2(sh, c);
+
+  tau = taup / e2m;
+  tol = 1.5e-9 * ((fabs(taup) > 1) ? fabs(taup) : 1);
+  for (i = 0; i < 5; i++)
+  {
+    taupa = Transverse_Mercator_Kruger_Taup(Kruger, tau);
+    dtau = (taup - taupa) * (1 + e2m * tau * tau)
+           / (e2m * sqrt(1 + tau * tau) * sqrt(1 + taupa * taupa));
+    tau += dtau;
+    if (fabs(dtau) < tol)
+      break;
+  }
+  *Latitude = atan(tau);
+}
+
+void Transverse_Mercator_Shared_Trig (const TranMerc_Ellipsoid *Ellipsoid,
+                                      double Latitude,
+                                      double Delta_Longitude,
+                                      double *X,
+                                      double *Y)
+/*
+ * The function Transverse_Mercator_Shared_Trig evaluates the classic
+ * series as Convert_Geodetic_To_Transverse_Mercator_R does, for the
+ * unscaled coordinates of a point measured as Transverse_Mercator_Kruger's
+ * are, but from one sin and cos of the latitude (a single sincos where the
+ * compiler and libm provide one): the tangent is their quotient, the
+ * sines of 2, 4, 6 and 8 times the latitude in the meridional distance
+ * are summed by Clenshaw's recurrence, and the series in the longitude is
+ * evaluated in Horner form.  Of the classic series' 6 sin, cos, tan, 8 pow,
+ * sqrt and 9 divisions that leaves sin, cos, sqrt and 2 divisions, for
+ * about 70 multiplies and 45 additions, which is what counts on a
+ * soft-float core such as the Cortex-M0+.  It agrees with the classic
+ * series to well under a millimeter.
+ *
+ *    Ellipsoid       : Ellipsoid constants                     (input)
+ *    Latitude        : Latitude in radians                     (input)
+ *    Delta_Longitude : Longitude less central meridian, radians (input)
+ *    X               : Unscaled easting in meters              (output)
+ *    Y               : Unscaled northing in meters             (output)
+ */
+{
+  double s = sin(Latitude);
+  double c = cos(Latitude);
+  double t = s / c;
+  double c2 = c * c;
+  double c4 = c2 * c2;
+  double tan2 = t * t;
+  double eta = Ellipsoid->ebs * c2;
+  double sn = Ellipsoid->a / sqrt(1.e0 - Ellipsoid->es * s * s);
+  double snc = sn * c;
+  double snsc = snc * s;
+  double dlam2 = Delta_Longitude * Delta_Longitude;
+  double cos2 = 2.e0 * (c2 - s * s);   /* 2 cos(2 * latitude) */
+  double b1;      /* Clenshaw sums of the meridional distance sines  */
+  double b2;
+  double b3;
+  double b4 = Ellipsoid->ep;
+  double e3;      /* Coefficients of the odd powers of dlam, easting */
+  double e5;
+  double e7;
+  double n4;      /* Coefficients of the even powers of dlam, northing */
+  double n6;
+  double n8;
+
+  b3 = cos2 * b4 - Ellipsoid->dp;
+  b2 = cos2 * b3 - b4 + Ellipsoid->cp;
+  b1 = cos2 * b2 - b3 - Ellipsoid->bp;
+
+  e3 = snc * c2 * (1.e0 - tan2 + eta) * (1.e0 / 6.e0);
+  e5 = snc * c4 * (5.e0 + tan2 * (tan2 - 18.e0)
+                   + eta * (14.e0 - 58.e0 * tan2 + eta * (13.e0 - 64.e0 * tan2
+                                                          + eta * (4.e0 - 24.e0 * tan2))))
+       * (1.e0 / 120.e0);
+  e7 = snc * c4 * c2 * (61.e0 + tan2 * (tan2 * (179.e0 - tan2) - 479.e0)) * (1.e0 / 5040.e0);
+
+  n4 = snsc * c2 * (5.e0 - tan2 + eta * (9.e0 + 4.e0 * eta)) * (1.e0 / 24.e0);
+  n6 = snsc * c4 * (61.e0 + tan2 * (tan2 - 58.e0)
+                    + eta * (270.e0 - 330.e0 * tan2 + eta * (445.e0 - 680.e0 * tan2
+                                                             + eta * (324.e0 - 600.e0 * tan2
+                                                                      + eta * (88.e0 - 192.e0 * tan2)))))
+       * (1.e0 / 720.e0);
+  n8 = snsc * c4 * c2 * (1385.e0 + tan2 * (tan2 * (543.e0 - tan2) - 3111.e0)) * (1.e0 / 40320.e0);
+
+  *X = Delta_Longitude * (snc + dlam2 * (e3 + dlam2 * (e5 + dlam2 * e7)));
+  *Y = Ellipsoid->ap * Latitude + b1 * 2.e0 * s * c
+       + dlam2 * (0.5e0 * snsc + dlam2 * (n4 + dlam2 * (n6 + dlam2 * n8)));
+}
+
+static long Get_Transverse_Mercator_Delta_Long (const TranMerc_Projection *Projection,
+                                                double Latitude,
+                                                double Longitude,
+                                                double *Delta_Longitude)
+/*
+ * Checks a geodetic position against a projection and works out its
+ * longitude less the central meridian, in [-PI, PI], as every forward
+ * conversion does.  The error code(s) are returned; Delta_Longitude is set
+ * unless TRANMERC_LAT_ERROR or TRANMERC_LON_ERROR is among them.
+ */
+{
   long    Error_Code = TRANMERC_NO_ERROR;
+  double dlam;
   double temp_Origin;
   double temp_Long;
 
@@ -119,17 +500,17 @@ long Convert_Geodetic_To_Transverse_Mercator (double Latitude,
   }
   if (Longitude > PI)
     Longitude -= (2 * PI);
-  if ((Longitude < (TranMerc_Origin_Long - MAX_DELTA_LONG))
-      || (Longitude > (TranMerc_Origin_Long + MAX_DELTA_LONG)))
+  if ((Longitude < (Projection->Origin_Long - MAX_DELTA_LONG))
+      || (Longitude > (Projection->Origin_Long + MAX_DELTA_LONG)))
   {
     if (Longitude < 0)
       temp_Long = Longitude + 2 * PI;
     else
       temp_Long = Longitude;
-    if (TranMerc_Origin_Long < 0)
-      temp_Origin = TranMerc_Origin_Long + 2 * PI;
+    if (Projection->Origin_Long < 0)
+      temp_Origin = Projection->Origin_Long + 2 * PI;
     else
-      temp_Origin = TranMerc_Origin_Long;
+      temp_Origin = Projection->Origin_Long;
     if ((temp_Long < (temp_Origin - MAX_DELTA_LONG))
         || (temp_Long > (temp_Origin + MAX_DELTA_LONG)))
       Error_Code|= TRANMERC_LON_ERROR;
@@ -140,7 +521,7 @@ long Convert_Geodetic_To_Transverse_Mercator (double Latitude,
     /* 
      *  Delta Longitude
      */
-    dlam = Longitude - TranMerc_Origin_Long;
+    dlam = Longitude - Projection->Origin_Long;
 
     if (fabs(dlam) > (9.0 * PI / 180))
     { /* Distortion will result if Longitude is more than 9 degrees from the Central Meridian */
@@ -153,6 +534,87 @@ long Convert_Geodetic_To_Transverse_Mercator (double Latitude,
       dlam += (2 * PI);
     if (fabs(dlam) < 2.e-10)
       dlam = 0.0;
+    *Delta_Longitude = dlam;
+  }
+  return (Error_Code);
+}
+
+long Convert_Geodetic_To_Transverse_Mercator_R (const TranMerc_Ellipsoid *Ellipsoid,
+                                                const TranMerc_Projection *Projection,
+                                                double Latitude,
+                                                double Longitude,
+                                                double *Easting,
+                                                double *Northing)
+
+{      /* BEGIN Convert_Geodetic_To_Transverse_Mercator_R */
+
+  /*
+   * The function Convert_Geodetic_To_Transverse_Mercator_R converts geodetic
+   * (latitude and longitude) coordinates to Transverse Mercator projection
+   * (easting and northing) coordinates, according to the given ellipsoid
+   * and Transverse Mercator projection parameters, using the series
+   * selected by Ellipsoid->Series.  It reads no global state.  If any
+   * errors occur, the error code(s) are returned by the function, otherwise
+   * TRANMERC_NO_ERROR is returned.
+   *
+   *    Ellipsoid     : Ellipsoid constants                         (input)
+   *    Projection    : Projection parameters                       (input)
+   *    Latitude      : Latitude in radians                         (input)
+   *    Longitude     : Longitude in radians                        (input)
+   *    Easting       : Easting/X in meters                         (output)
+   *    Northing      : Northing/Y in meters                        (output)
+   */
+
+  double c;       /* Cosine of latitude                          */
+  double c2;
+  double c3;
+  double c5;
+  double c7;
+  double dlam;    /* Delta longitude - Difference in Longitude       */
+  double eta;     /* constant - Ellipsoid->ebs *c *c                 */
+  double eta2;
+  double eta3;
+  double eta4;
+  double s;       /* Sine of latitude                        */
+  double sn;      /* Radius of curvature in the prime vertical       */
+  double t;       /* Tangent of latitude                             */
+  double tan2;
+  double tan3;
+  double tan4;
+  double tan5;
+  double tan6;
+  double t1;      /* Term in coordinate conversion formula - GP to Y */
+  double t2;      /* Term in coordinate conversion formula - GP to Y */
+  double t3;      /* Term in coordinate conversion formula - GP to Y */
+  double t4;      /* Term in coordinate conversion formula - GP to Y */
+  double t5;      /* Term in coordinate conversion formula - GP to Y */
+  double t6;      /* Term in coordinate conversion formula - GP to Y */
+  double t7;      /* Term in coordinate conversion formula - GP to Y */
+  double t8;      /* Term in coordinate conversion formula - GP to Y */
+  double t9;      /* Term in coordinate conversion formula - GP to Y */
+  double tmd;     /* True Meridional distance                        */
+  double x;       /* Unscaled Kruger or shared trig easting          */
+  double y;       /* Unscaled Kruger or shared trig northing         */
+  long    Error_Code;
+
+  Error_Code = Get_Transverse_Mercator_Delta_Long(Projection, Latitude, Longitude, &dlam);
+  if (!(Error_Code & ~TRANMERC_LON_WARNING))
+  { /* no errors */
+    if (Ellipsoid->Series == TRANMERC_KRUGER_SERIES)
+    {
+      /* On the central meridian y is the true meridional distance */
+      Transverse_Mercator_Kruger(&Ellipsoid->Kruger, Latitude, dlam, &x, &y);
+      *Easting = Projection->False_Easting + Projection->Scale_Factor * x;
+      *Northing = Projection->False_Northing + Projection->Scale_Factor * (y - Projection->tmdo);
+      return (Error_Code);
+    }
+    if (Ellipsoid->Series == TRANMERC_SHARED_TRIG_SERIES)
+    {
+      Transverse_Mercator_Shared_Trig(Ellipsoid, Latitude, dlam, &x, &y);
+      *Easting = Projection->False_Easting + Projection->Scale_Factor * x;
+      *Northing = Projection->False_Northing + Projection->Scale_Factor * (y - Projection->tmdo);
+      return (Error_Code);
+    }
 
     s = sin(Latitude);
     c = cos(Latitude);
@@ -166,51 +628,213 @@ long Convert_Geodetic_To_Transverse_Mercator (double Latitude,
     tan4 = tan3 * t;
     tan5 = tan4 * t;
     tan6 = tan5 * t;
-    eta = TranMerc_ebs * c2;
+    eta = Ellipsoid->ebs * c2;
     eta2 = eta * eta;
     eta3 = eta2 * eta;
     eta4 = eta3 * eta;
 
     /* radius of curvature in prime vertical */
-    sn = SPHSN(Latitude);
+    sn = SPHSN(Ellipsoid, Latitude);
 
     /* True Meridianal Distances */
-    tmd = SPHTMD(Latitude);
-
-    /*  Origin  */
-    tmdo = SPHTMD (TranMerc_Origin_Lat);
+    tmd = SPHTMD(Ellipsoid, Latitude);
 
     /* northing */
-    t1 = (tmd - tmdo) * TranMerc_Scale_Factor;
-    t2 = sn * s * c * TranMerc_Scale_Factor/ 2.e0;
-    t3 = sn * s * c3 * TranMerc_Scale_Factor * (5.e0 - tan2 + 9.e0 * eta 
+    t1 = (tmd - Projection->tmdo) * Projection->Scale_Factor;
+    t2 = sn * s * c * Projection->Scale_Factor/ 2.e0;
+    t3 = sn * s * c3 * Projection->Scale_Factor * (5.e0 - tan2 + 9.e0 * eta 
                                                 + 4.e0 * eta2) /24.e0; 
 
-    t4 = sn * s * c5 * TranMerc_Scale_Factor * (61.e0 - 58.e0 * tan2
+    t4 = sn * s * c5 * Projection->Scale_Factor * (61.e0 - 58.e0 * tan2
                                                 + tan4 + 270.e0 * eta - 330.e0 * tan2 * eta + 445.e0 * eta2
                                                 + 324.e0 * eta3 -680.e0 * tan2 * eta2 + 88.e0 * eta4 
                                                 -600.e0 * tan2 * eta3 - 192.e0 * tan2 * eta4) / 720.e0;
 
-    t5 = sn * s * c7 * TranMerc_Scale_Factor * (1385.e0 - 3111.e0 * 
+    t5 = sn * s * c7 * Projection->Scale_Factor * (1385.e0 - 3111.e0 * 
                                                 tan2 + 543.e0 * tan4 - tan6) / 40320.e0;
 
-    *Northing = TranMerc_False_Northing + t1 + pow(dlam,2.e0) * t2
+    *Northing = Projection->False_Northing + t1 + pow(dlam,2.e0) * t2
                 + pow(dlam,4.e0) * t3 + pow(dlam,6.e0) * t4
                 + pow(dlam,8.e0) * t5; 
 
     /* Easting */
-    t6 = sn * c * TranMerc_Scale_Factor;
-    t7 = sn * c3 * TranMerc_Scale_Factor * (1.e0 - tan2 + eta ) /6.e0;
-    t8 = sn * c5 * TranMerc_Scale_Factor * (5.e0 - 18.e0 * tan2 + tan4
+    t6 = sn * c * Projection->Scale_Factor;
+    t7 = sn * c3 * Projection->Scale_Factor * (1.e0 - tan2 + eta ) /6.e0;
+    t8 = sn * c5 * Projection->Scale_Factor * (5.e0 - 18.e0 * tan2 + tan4
                                             + 14.e0 * eta - 58.e0 * tan2 * eta + 13.e0 * eta2 + 4.e0 * eta3 
                                             - 64.e0 * tan2 * eta2 - 24.e0 * tan2 * eta3 )/ 120.e0;
-    t9 = sn * c7 * TranMerc_Scale_Factor * ( 61.e0 - 479.e0 * tan2
+    t9 = sn * c7 * Projection->Scale_Factor * ( 61.e0 - 479.e0 * tan2
                                              + 179.e0 * tan4 - tan6 ) /5040.e0;
 
-    *Easting = TranMerc_False_Easting + dlam * t6 + pow(dlam,3.e0) * t7 
+    *Easting = Projection->False_Easting + dlam * t6 + pow(dlam,3.e0) * t7 
                + pow(dlam,5.e0) * t8 + pow(dlam,7.e0) * t9;
   }
   return (Error_Code);
+} /* END OF Convert_Geodetic_To_Transverse_Mercator_R */
+
+long Convert_Geodetic_To_Transverse_Mercator_Terms_R (const TranMerc_Ellipsoid *Ellipsoid,
+                                                      const TranMerc_Projection *Projection,
+                                                      double Latitude,
+                                                      double Longitude,
+                                                      long Terms,
+                                                      double *Easting,
+                                                      double *Northing,
+                                                      double *Easting_Bound,
+                                                      double *Northing_Bound)
+
+{      /* BEGIN Convert_Geodetic_To_Transverse_Mercator_Terms_R */
+
+  /*
+   * The function Convert_Geodetic_To_Transverse_Mercator_Terms_R converts
+   * geodetic coordinates to Transverse Mercator coordinates as
+   * Convert_Geodetic_To_Transverse_Mercator_R does, evaluating only the
+   * terms of the classic series selected by Terms, with the multiple angle
+   * sines of the meridional distance and the powers of the longitude
+   * worked out by products instead of library calls.  Easting_Bound and
+   * Northing_Bound are set to bounds on the difference from
+   * Convert_Geodetic_To_Transverse_Mercator_R: the terms left out, plus
+   * TRANMERC_TERMS_ROUNDING.  Where the terms are not bounded (the Kruger
+   * series, more than TRANMERC_TERMS_MAX_DELTA_LONG from the central
+   * meridian, or an ellipsoid flatter than TRANMERC_TERMS_MAX_EBS) or Terms
+   * is TRANMERC_EXACT_TERMS, the conversion is
+   * Convert_Geodetic_To_Transverse_Mercator_R's and the bounds are 0.  The
+   * error codes are those of Convert_Geodetic_To_Transverse_Mercator_R.
+   *
+   *    Ellipsoid     : Ellipsoid constants                         (input)
+   *    Projection    : Projection parameters                       (input)
+   *    Latitude      : Latitude in radians                         (input)
+   *    Longitude     : Longitude in radians                        (input)
+   *    Terms         : TRANMERC_EXACT_TERMS, ...                   (input)
+   *    Easting       : Easting/X in meters                         (output)
+   *    Northing      : Northing/Y in meters                        (output)
+   *    Easting_Bound : Largest error in Easting, in meters         (output)
+   *    Northing_Bound: Largest error in Northing, in meters        (output)
+   */
+
+  double c;       /* Cosine of latitude                          */
+  double c2;
+  double c3;
+  double c5;
+  double c7;
+  double cos2;    /* Cosine of 2 * latitude                          */
+  double cos4;
+  double dlam;    /* Delta longitude - Difference in Longitude       */
+  double dlam2;
+  double dlam4;
+  double eta;     /* constant - Ellipsoid->ebs *c *c                 */
+  double eta2;
+  double eta3;
+  double eta4;
+  double s;       /* Sine of latitude                        */
+  double sin2;    /* Sine of 2 * latitude                            */
+  double sin4;
+  double sn;      /* Radius of curvature in the prime vertical       */
+  double t;       /* Tangent of latitude                             */
+  double tan2;
+  double tan4;
+  double tan6;
+  double k = Projection->Scale_Factor;
+  double tmd;     /* True Meridional distance                        */
+  double x;       /* Easting less false easting                      */
+  double y;       /* Northing less false northing                    */
+  long    Error_Code;
+
+  *Easting_Bound = 0.0;
+  *Northing_Bound = 0.0;
+  Error_Code = Get_Transverse_Mercator_Delta_Long(Projection, Latitude, Longitude, &dlam);
+  if ((Terms == TRANMERC_EXACT_TERMS) || (Error_Code & ~TRANMERC_LON_WARNING)
+      || (Ellipsoid->Series == TRANMERC_KRUGER_SERIES)
+      || (fabs(dlam) > TRANMERC_TERMS_MAX_DELTA_LONG) || (Ellipsoid->ebs > TRANMERC_TERMS_MAX_EBS))
+    return (Convert_Geodetic_To_Transverse_Mercator_R(Ellipsoid, Projection, Latitude,
+                                                      Longitude, Easting, Northing));
+
+  s = sin(Latitude);
+  c = cos(Latitude);
+  c2 = c * c;
+  c3 = c2 * c;
+  t = s / c;
+  tan2 = t * t;
+  eta = Ellipsoid->ebs * c2;
+  eta2 = eta * eta;
+  sn = Ellipsoid->a / sqrt(1.e0 - Ellipsoid->es * s * s);
+  dlam2 = dlam * dlam;
+
+  sin2 = 2.e0 * s * c;
+  cos2 = c2 - s * s;
+  sin4 = 2.e0 * sin2 * cos2;
+  cos4 = cos2 * cos2 - sin2 * sin2;
+  tmd = Ellipsoid->ap * Latitude - Ellipsoid->bp * sin2 + Ellipsoid->cp * sin4;
+
+  x = dlam * (sn * c + dlam2 * sn * c3 * (1.e0 - tan2 + eta) / 6.e0);
+  y = sn * s * c / 2.e0 + dlam2 * sn * s * c3 * (5.e0 - tan2 + 9.e0 * eta + 4.e0 * eta2) / 24.e0;
+
+  if (Terms == TRANMERC_4TH_ORDER_TERMS)
+  {
+    /*
+     * Largest values over latitude of t4, t5, t8 and t9 of the classic
+     * series, over a and the scale factor, for any ebs up to
+     * TRANMERC_TERMS_MAX_EBS, with some margin; and the sin 6 and sin 8
+     * latitude terms of the meridional distance.
+     */
+    dlam4 = dlam2 * dlam2;
+    *Easting_Bound = k * Ellipsoid->a * fabs(dlam) * dlam4 * (0.0446 + 0.0128 * dlam2)
+                     + TRANMERC_TERMS_ROUNDING;
+    *Northing_Bound = k * Ellipsoid->a * dlam4 * dlam2 * (0.0200 + 0.0062 * dlam2)
+                      + k * (fabs(Ellipsoid->dp) + fabs(Ellipsoid->ep)) + TRANMERC_TERMS_ROUNDING;
+  }
+  else
+  {
+    c5 = c3 * c2;
+    c7 = c5 * c2;
+    tan4 = tan2 * tan2;
+    tan6 = tan4 * tan2;
+    eta3 = eta2 * eta;
+    eta4 = eta3 * eta;
+    dlam4 = dlam2 * dlam2;
+    tmd += - Ellipsoid->dp * (sin4 * cos2 + cos4 * sin2) + Ellipsoid->ep * 2.e0 * sin4 * cos4;
+    x += dlam * dlam4 * (sn * c5 * (5.e0 - 18.e0 * tan2 + tan4
+                                    + 14.e0 * eta - 58.e0 * tan2 * eta + 13.e0 * eta2 + 4.e0 * eta3
+                                    - 64.e0 * tan2 * eta2 - 24.e0 * tan2 * eta3) / 120.e0
+                         + dlam2 * sn * c7 * (61.e0 - 479.e0 * tan2 + 179.e0 * tan4 - tan6) / 5040.e0);
+    y += dlam4 * (sn * s * c5 * (61.e0 - 58.e0 * tan2
+                                 + tan4 + 270.e0 * eta - 330.e0 * tan2 * eta + 445.e0 * eta2
+                                 + 324.e0 * eta3 -680.e0 * tan2 * eta2 + 88.e0 * eta4
+                                 -600.e0 * tan2 * eta3 - 192.e0 * tan2 * eta4) / 720.e0
+                  + dlam2 * sn * s * c7 * (1385.e0 - 3111.e0 * tan2 + 543.e0 * tan4 - tan6) / 40320.e0);
+    *Easting_Bound = TRANMERC_TERMS_ROUNDING;
+    *Northing_Bound = TRANMERC_TERMS_ROUNDING;
+  }
+
+  *Easting = Projection->False_Easting + k * x;
+  *Northing = Projection->False_Northing + k * ((tmd - Projection->tmdo) + dlam2 * y);
+  return (Error_Code);
+} /* END OF Convert_Geodetic_To_Transverse_Mercator_Terms_R */
+
+long Convert_Geodetic_To_Transverse_Mercator (double Latitude,
+                                              double Longitude,
+                                              double *Easting,
+                                              double *Northing)
+
+{      /* BEGIN Convert_Geodetic_To_Transverse_Mercator */
+
+  /*
+   * The function Convert_Geodetic_To_Transverse_Mercator converts geodetic
+   * (latitude and longitude) coordinates to Transverse Mercator projection
+   * (easting and northing) coordinates, according to the current ellipsoid
+   * and Transverse Mercator projection coordinates.  If any errors occur, the
+   * error code(s) are returned by the function, otherwise TRANMERC_NO_ERROR is
+   * returned.
+   *
+   *    Latitude      : Latitude in radians                         (input)
+   *    Longitude     : Longitude in radians                        (input)
+   *    Easting       : Easting/X in meters                         (output)
+   *    Northing      : Northing/Y in meters                        (output)
+   */
+
+  return (Convert_Geodetic_To_Transverse_Mercator_R(&TranMerc_Ellipsoid_State,
+                                                    &TranMerc_Projection_State,
+                                                    Latitude, Longitude,
+                                                    Easting, Northing));
 } /* END OF Convert_Geodetic_To_Transverse_Mercator */
 
 long Set_Transverse_Mercator_Parameters(double a,
@@ -225,9 +849,9 @@ long Set_Transverse_Mercator_Parameters(double a,
   /*
    * The function Set_Tranverse_Mercator_Parameters receives the ellipsoid
    * parameters and Tranverse Mercator projection parameters as inputs, and
-   * sets the corresponding state variables. If any errors occur, the error
-   * code(s) are returned by the function, otherwise TRANMERC_NO_ERROR is
-   * returned.
+   * sets the corresponding state variables, keeping the selected series.
+   * If any errors occur, the error code(s) are returned by the function,
+   * otherwise TRANMERC_NO_ERROR is returned.
    *
    *    a                 : Semi-major axis of ellipsoid, in meters    (input)
    *    f                 : Flattening of ellipsoid                     (input)
@@ -240,14 +864,10 @@ long Set_Transverse_Mercator_Parameters(double a,
    *    Scale_Factor      : Projection scale factor                    (input) 
    */
 
-  double tn;        /* True Meridianal distance constant  */
-  double tn2;
-  double tn3;
-  double tn4;
-  double tn5;
+  TranMerc_Ellipsoid classic;
   double dummy_northing;
-  double TranMerc_b; /* Semi-minor axis of ellipsoid, in meters */
   double inv_f = 1 / f;
+  long series;
   long Error_Code = TRANMERC_NO_ERROR;
 
   if (a <= 0.0)
@@ -272,47 +892,230 @@ long Set_Transverse_Mercator_Parameters(double a,
   }
   if (!Error_Code)
   { /* no errors */
-    TranMerc_a = a;
-    TranMerc_f = f;
-    TranMerc_Origin_Lat = Origin_Latitude;
+    series = TranMerc_Ellipsoid_State.Series;
+    TranMerc_Ellipsoid_State = Make_Transverse_Mercator_Ellipsoid(a, f);
+    TranMerc_Ellipsoid_State.Series = series;
+    TranMerc_Projection_State.Origin_Lat = Origin_Latitude;
     if (Central_Meridian > PI)
       Central_Meridian -= (2*PI);
-    TranMerc_Origin_Long = Central_Meridian;
-    TranMerc_False_Northing = False_Northing;
-    TranMerc_False_Easting = False_Easting; 
-    TranMerc_Scale_Factor = Scale_Factor;
-
-    /* Eccentricity Squared */
-    TranMerc_es = 2 * TranMerc_f - TranMerc_f * TranMerc_f;
-    /* Second Eccentricity Squared */
-    TranMerc_ebs = (1 / (1 - TranMerc_es)) - 1;
-
-    TranMerc_b = TranMerc_a * (1 - TranMerc_f);    
-    /*True meridianal constants  */
-    tn = (TranMerc_a - TranMerc_b) / (TranMerc_a + TranMerc_b);
-    tn2 = tn * tn;
-    tn3 = tn2 * tn;
-    tn4 = tn3 * tn;
-    tn5 = tn4 * tn;
-
-    TranMerc_ap = TranMerc_a * (1.e0 - tn + 5.e0 * (tn2 - tn3)/4.e0
-                                + 81.e0 * (tn4 - tn5)/64.e0 );
-    TranMerc_bp = 3.e0 * TranMerc_a * (tn - tn2 + 7.e0 * (tn3 - tn4)
-                                       /8.e0 + 55.e0 * tn5/64.e0 )/2.e0;
-    TranMerc_cp = 15.e0 * TranMerc_a * (tn2 - tn3 + 3.e0 * (tn4 - tn5 )/4.e0) /16.0;
-    TranMerc_dp = 35.e0 * TranMerc_a * (tn3 - tn4 + 11.e0 * tn5 / 16.e0) / 48.e0;
-    TranMerc_ep = 315.e0 * TranMerc_a * (tn4 - tn5) / 512.e0;
-    Convert_Geodetic_To_Transverse_Mercator(MAX_LAT,
-                                            MAX_DELTA_LONG + Central_Meridian,
-                                            &TranMerc_Delta_Easting,
-                                            &TranMerc_Delta_Northing);
-    Convert_Geodetic_To_Transverse_Mercator(0,
-                                            MAX_DELTA_LONG + Central_Meridian,
-                                            &TranMerc_Delta_Easting,
-                                            &dummy_northing);
+    TranMerc_Projection_State.Origin_Long = Central_Meridian;
+    TranMerc_Projection_State.False_Northing = False_Northing;
+    TranMerc_Projection_State.False_Easting = False_Easting; 
+    TranMerc_Projection_State.Scale_Factor = Scale_Factor;
+    TranMerc_Projection_State.tmdo = SPHTMD(&TranMerc_Ellipsoid_State, Origin_Latitude);
+
+    /* The extent is that of the classic series, whichever is selected */
+    classic = TranMerc_Ellipsoid_State;
+    classic.Series = TRANMERC_CLASSIC_SERIES;
+    Convert_Geodetic_To_Transverse_Mercator_R(&classic, &TranMerc_Projection_State,
+                                              MAX_LAT,
+                                              MAX_DELTA_LONG + Central_Meridian,
+                                              &TranMerc_Delta_Easting,
+                                              &TranMerc_Delta_Northing);
+    Convert_Geodetic_To_Transverse_Mercator_R(&classic, &TranMerc_Projection_State,
+                                              0,
+                                              MAX_DELTA_LONG + Central_Meridian,
+                                              &TranMerc_Delta_Easting,
+                                              &dummy_northing);
     TranMerc_Delta_Northing++;
     TranMerc_Delta_Easting++;
 
   } /* END OF if(!Error_Code) */
   return (Error_Code);
 }  /* END of Set_Transverse_Mercator_Parameters  */
+
+long Convert_Transverse_Mercator_To_Geodetic_R (const TranMerc_Ellipsoid *Ellipsoid,
+                                                const TranMerc_Projection *Projection,
+                                                double Easting,
+                                                double Northing,
+                                                double *Latitude,
+                                                double *Longitude)
+{      /* BEGIN Convert_Transverse_Mercator_To_Geodetic_R */
+
+  /*
+   * The function Convert_Transverse_Mercator_To_Geodetic_R converts
+   * Transverse Mercator projection (easting and northing) coordinates to
+   * geodetic (latitude and longitude) coordinates, according to the given
+   * ellipsoid and Transverse Mercator projection parameters, using the
+   * series selected by Ellipsoid->Series.  It reads no global state, and
+   * leaves checking that Easting and Northing lie within the projection's
+   * extent to the caller.  If any errors occur, the error code(s) are
+   * returned by the function, otherwise TRANMERC_NO_ERROR is returned.
+   *
+   *    Ellipsoid     : Ellipsoid constants                         (input)
+   *    Projection    : Projection parameters                       (input)
+   *    Easting       : Easting/X in meters                         (input)
+   *    Northing      : Northing/Y in meters                        (input)
+   *    Latitude      : Latitude in radians                         (output)
+   *    Longitude     : Longitude in radians                        (output)
+   */
+
+  double c;       /* Cosine of latitude                          */
+  double de;      /* Delta easting - Difference in Easting (Easting-Fe)    */
+  double dlam;    /* Delta longitude - Difference in Longitude       */
+  double eta;     /* constant - Ellipsoid->ebs *c *c                 */
+  double eta2;
+  double eta3;
+  double eta4;
+  double ftphi;   /* Footpoint latitude                              */
+  int    i;       /* Loop iterator                                   */
+  double sn;      /* Radius of curvature in the prime vertical       */
+  double sr;      /* Radius of curvature in the meridian             */
+  double t;       /* Tangent of latitude                             */
+  double tan2;
+  double tan4;
+  double t10;     /* Term in coordinate conversion formula - GP to Y */
+  double t11;     /* Term in coordinate conversion formula - GP to Y */
+  double t12;     /* Term in coordinate conversion formula - GP to Y */
+  double t13;     /* Term in coordinate conversion formula - GP to Y */
+  double t14;     /* Term in coordinate conversion formula - GP to Y */
+  double t15;     /* Term in coordinate conversion formula - GP to Y */
+  double t16;     /* Term in coordinate conversion formula - GP to Y */
+  double t17;     /* Term in coordinate conversion formula - GP to Y */
+  double tmd;     /* True Meridional distance                        */
+  double k = Projection->Scale_Factor;
+  long Error_Code = TRANMERC_NO_ERROR;
+
+  if (Ellipsoid->Series == TRANMERC_KRUGER_SERIES)
+  {
+    Transverse_Mercator_Kruger_Inverse(&Ellipsoid->Kruger,
+                                       (Easting - Projection->False_Easting) / k,
+                                       Projection->tmdo + (Northing - Projection->False_Northing) / k,
+                                       Latitude, &dlam);
+  }
+  else
+  {
+    /*  Origin  */
+    tmd = Projection->tmdo + (Northing - Projection->False_Northing) / k;
+
+    /* First Estimate */
+    sr = SPHSR(Ellipsoid, 0.e0);
+    ftphi = tmd/sr;
+
+    for (i = 0; i < 5 ; i++)
+    {
+      t10 = SPHTMD (Ellipsoid, ftphi);
+      sr = SPHSR(Ellipsoid, ftphi);
+      ftphi = ftphi + (tmd - t10) / sr;
+    }
+
+    /* Radius of Curvature in the meridian */
+    sr = SPHSR(Ellipsoid, ftphi);
+
+    /* Radius of Curvature in the prime vertical */
+    sn = SPHSN(Ellipsoid, ftphi);
+
+    /* Cosine term */
+    c = cos(ftphi);
+
+    /* Tangent Value  */
+    t = tan(ftphi);
+    tan2 = t * t;
+    tan4 = tan2 * tan2;
+    eta = Ellipsoid->ebs * c * c;
+    eta2 = eta * eta;
+    eta3 = eta2 * eta;
+    eta4 = eta3 * eta;
+    de = Easting - Projection->False_Easting;
+    if (fabs(de) < 0.0001)
+      de = 0.0;
+
+    /* Latitude */
+    t10 = t / (2.e0 * sr * sn * pow(k, 2));
+    t11 = t * (5.e0  + 3.e0 * tan2 + eta - 4.e0 * pow(eta,2)
+               - 9.e0 * tan2 * eta) / (24.e0 * sr * pow(sn,3) * pow(k,4));
+    t12 = t * (61.e0 + 90.e0 * tan2 + 46.e0 * eta + 45.E0 * tan4
+               - 252.e0 * tan2 * eta  - 3.e0 * eta2 + 100.e0
+               * eta3 - 66.e0 * tan2 * eta2 - 90.e0 * tan4
+               * eta + 88.e0 * eta4 + 225.e0 * tan4 * eta2
+               + 84.e0 * tan2* eta3 - 192.e0 * tan2 * eta4)
+          / ( 720.e0 * sr * pow(sn,5) * pow(k, 6) );
+    t13 = t * ( 1385.e0 + 3633.e0 * tan2 + 4095.e0 * tan4 + 1575.e0
+                * pow(t,6))/ (40320.e0 * sr * pow(sn,7) * pow(k,8));
+    *Latitude = ftphi - pow(de,2) * t10 + pow(de,4) * t11 - pow(de,6) * t12
+                + pow(de,8) * t13;
+
+    t14 = 1.e0 / (sn * c * k);
+
+    t15 = (1.e0 + 2.e0 * tan2 + eta) / (6.e0 * pow(sn,3) * c * pow(k,3));
+
+    t16 = (5.e0 + 6.e0 * eta + 28.e0 * tan2 - 3.e0 * eta2
+           + 8.e0 * tan2 * eta + 24.e0 * tan4 - 4.e0
+           * eta3 + 4.e0 * tan2 * eta2 + 24.e0
+           * tan2 * eta3) / (120.e0 * pow(sn,5) * c * pow(k,5));
+
+    t17 = (61.e0 +  662.e0 * tan2 + 1320.e0 * tan4 + 720.e0
+           * pow(t,6)) / (5040.e0 * pow(sn,7) * c * pow(k,7));
+
+    /* Difference in Longitude */
+    dlam = de * t14 - pow(de,3) * t15 + pow(de,5) * t16 - pow(de,7) * t17;
+  }
+
+  /* Longitude */
+  *Longitude = Projection->Origin_Long + dlam;
+
+  if (fabs(*Latitude) > (90.0 * PI / 180.0))
+    Error_Code |= TRANMERC_NORTHING_ERROR;
+
+  if (*Longitude > PI)
+  {
+    *Longitude -= (2 * PI);
+    if (fabs(*Longitude) > PI)
+      Error_Code |= TRANMERC_EASTING_ERROR;
+  }
+  else if (*Longitude < -PI)
+  {
+    *Longitude += (2 * PI);
+    if (fabs(*Longitude) > PI)
+      Error_Code |= TRANMERC_EASTING_ERROR;
+  }
+
+  if (fabs(dlam) > (9.0 * PI / 180) * cos(*Latitude))
+  { /* Distortion will result if Longitude is more than 9 degrees from the Central Meridian at the equator */
+    /* and decreases to 0 degrees at the poles */
+    Error_Code |= TRANMERC_LON_WARNING;
+  }
+  return (Error_Code);
+} /* END OF Convert_Transverse_Mercator_To_Geodetic_R */
+
+long Convert_Transverse_Mercator_To_Geodetic (double Easting,
+                                              double Northing,
+                                              double *Latitude,
+                                              double *Longitude)
+{      /* BEGIN Convert_Transverse_Mercator_To_Geodetic */
+
+  /*
+   * The function Convert_Transverse_Mercator_To_Geodetic converts Transverse
+   * Mercator projection (easting and northing) coordinates to geodetic
+   * (latitude and longitude) coordinates, according to the current ellipsoid
+   * and Transverse Mercator projection parameters.  If any errors occur, the
+   * error code(s) are returned by the function, otherwise TRANMERC_NO_ERROR is
+   * returned.
+   *
+   *    Easting       : Easting/X in meters                         (input)
+   *    Northing      : Northing/Y in meters                        (input)
+   *    Latitude      : Latitude in radians                         (output)
+   *    Longitude     : Longitude in radians                        (output)
+   */
+
+  long Error_Code = TRANMERC_NO_ERROR;
+
+  if ((Easting < (TranMerc_Projection_State.False_Easting - TranMerc_Delta_Easting))
+      ||(Easting > (TranMerc_Projection_State.False_Easting + TranMerc_Delta_Easting)))
+  { /* Easting out of range  */
+    Error_Code |= TRANMERC_EASTING_ERROR;
+  }
+  if ((Northing < (TranMerc_Projection_State.False_Northing - TranMerc_Delta_Northing))
+      || (Northing > (TranMerc_Projection_State.False_Northing + TranMerc_Delta_Northing)))
+  { /* Northing out of range */
+    Error_Code |= TRANMERC_NORTHING_ERROR;
+  }
+  if (!Error_Code)
+    Error_Code = Convert_Transverse_Mercator_To_Geodetic_R(&TranMerc_Ellipsoid_State,
+                                                           &TranMerc_Projection_State,
+                                                           Easting, Northing,
+                                                           Latitude, Longitude);
+  return (Error_Code);
+} /* END OF Convert_Transverse_Mercator_To_Geodetic */
+
+#endif /* TRANMERC_H */
@@ -1,4 +1,8 @@
+#ifndef UTM_H
+#define UTM_H
+
 #include "tranmerc.h"
+#include "mgrs_probe.h"
 
 #define UTM_NO_ERROR            0x0000
 #define UTM_LAT_ERROR           0x0001
@@ -19,20 +23,65 @@
 #define MIN_NORTHING 0
 #define MAX_NORTHING 10000000
 
-static double UTM_a = 6378137.0;         /* Semi-major axis of ellipsoid in meters  */
-static double UTM_f = 1 / 298.257223563; /* Flattening of ellipsoid                 */
-static long   UTM_Override = 0;          /* Zone override flag                      */
+typedef struct UTM_Parameters_Value
+{
+  TranMerc_Ellipsoid Ellipsoid;  /* Ellipsoid constants                     */
+  long Override;                 /* Zone override, zero for none            */
+} UTM_Parameters;
 
-long Set_UTM_Parameters(double a,      
-                        double f,
-                        long   override)
+/* Parameters used by the functions without an explicit context, default to WGS 84 */
+static UTM_Parameters UTM_State = {TranMerc_WGS84, 0};
+
+/*
+ * Central meridian of a UTM zone, already folded into [-PI, PI] the same
+ * way Set_Transverse_Mercator_Parameters would fold it.
+ */
+#define UTM_CENTRAL_MERIDIAN(zone) ((zone) >= 31 ? \
+    (6 * (zone) - 183) * PI / 180.0 : (6 * (zone) + 177) * PI / 180.0 - (2*PI))
+
+/* Northern and southern hemisphere projections of a UTM zone */
+#define UTM_ZONE_PROJECTION(zone) \
+  {{0.0, UTM_CENTRAL_MERIDIAN(zone), 500000.0, 0.0, 0.9996, 0.0}, \
+   {0.0, UTM_CENTRAL_MERIDIAN(zone), 500000.0, 10000000.0, 0.9996, 0.0}}
+
+/*
+ * Transverse Mercator parameters of every UTM zone, indexed by
+ * [zone - 1][0 for 'N', 1 for 'S'].  The origin latitude is the equator,
+ * so the true meridional distance of the origin is zero for any ellipsoid.
+ */
+static const TranMerc_Projection UTM_Zone_Projection[60][2] =
+  {
+   UTM_ZONE_PROJECTION(1), UTM_ZONE_PROJECTION(2), UTM_ZONE_PROJECTION(3), UTM_ZONE_PROJECTION(4),
+   UTM_ZONE_PROJECTION(5), UTM_ZONE_PROJECTION(6), UTM_ZONE_PROJECTION(7), UTM_ZONE_PROJECTION(8),
+   UTM_ZONE_PROJECTION(9), UTM_ZONE_PROJECTION(10), UTM_ZONE_PROJECTION(11), UTM_ZONE_PROJECTION(12),
+   UTM_ZONE_PROJECTION(13), UTM_ZONE_PROJECTION(14), UTM_ZONE_PROJECTION(15), UTM_ZONE_PROJECTION(16),
+   UTM_ZONE_PROJECTION(17), UTM_ZONE_PROJECTION(18), UTM_ZONE_PROJECTION(19), UTM_ZONE_PROJECTION(20),
+   UTM_ZONE_PROJECTION(21), UTM_ZONE_PROJECTION(22), UTM_ZONE_PROJECTION(23), UTM_ZONE_PROJECTION(24),
+   UTM_ZONE_PROJECTION(25), UTM_ZONE_PROJECTION(26), UTM_ZONE_PROJECTION(27), UTM_ZONE_PROJECTION(28),
+   UTM_ZONE_PROJECTION(29), UTM_ZONE_PROJECTION(30), UTM_ZONE_PROJECTION(31), UTM_ZONE_PROJECTION(32),
+   UTM_ZONE_PROJECTION(33), UTM_ZONE_PROJECTION(34), UTM_ZONE_PROJECTION(35), UTM_ZONE_PROJECTION(36),
+   UTM_ZONE_PROJECTION(37), UTM_ZONE_PROJECTION(38), UTM_ZONE_PROJECTION(39), UTM_ZONE_PROJECTION(40),
+   UTM_ZONE_PROJECTION(41), UTM_ZONE_PROJECTION(42), UTM_ZONE_PROJECTION(43), UTM_ZONE_PROJECTION(44),
+   UTM_ZONE_PROJECTION(45), UTM_ZONE_PROJECTION(46), UTM_ZONE_PROJECTION(47), UTM_ZONE_PROJECTION(48),
+   UTM_ZONE_PROJECTION(49), UTM_ZONE_PROJECTION(50), UTM_ZONE_PROJECTION(51), UTM_ZONE_PROJECTION(52),
+   UTM_ZONE_PROJECTION(53), UTM_ZONE_PROJECTION(54), UTM_ZONE_PROJECTION(55), UTM_ZONE_PROJECTION(56),
+   UTM_ZONE_PROJECTION(57), UTM_ZONE_PROJECTION(58), UTM_ZONE_PROJECTION(59), UTM_ZONE_PROJECTION(60)
+  };
+
+long Set_UTM_Parameters_R(UTM_Parameters *Parameters,
+                          double a,
+                          double f,
+                          long   override)
 {
 /*
- * The function Set_UTM_Parameters receives the ellipsoid parameters and
- * UTM zone override parameter as inputs, and sets the corresponding state
- * variables.  If any errors occur, the error code(s) are returned by the 
- * function, otherwise UTM_NO_ERROR is returned.
+ * The function Set_UTM_Parameters_R receives the ellipsoid parameters and
+ * UTM zone override parameter as inputs, and stores them, with the derived
+ * ellipsoid constants, in Parameters.  TRANMERC_DEFAULT_SERIES is selected;
+ * set Parameters->Ellipsoid.Series afterwards to use another series.  If
+ * any errors occur, the error code(s) are returned by the function and
+ * Parameters is left unchanged, otherwise UTM_NO_ERROR is returned.
  *
+ *    Parameters        : UTM conversion parameters              (output)
  *    a                 : Semi-major axis of ellipsoid, in meters       (input)
  *    f                 : Flattening of ellipsoid                        (input)
  *    override          : UTM override zone, zero indicates no override (input)
@@ -55,128 +104,380 @@ long Set_UTM_Parameters(double a,
   }
   if (!Error_Code)
   { /* no errors */
-    UTM_a = a;
-    UTM_f = f;
-    UTM_Override = override;
+    Parameters->Ellipsoid = Make_Transverse_Mercator_Ellipsoid(a, f);
+    Parameters->Override = override;
   }
   return (Error_Code);
+} /* END OF Set_UTM_Parameters_R */
+
+long Set_UTM_Parameters(double a,      
+                        double f,
+                        long   override)
+{
+/*
+ * The function Set_UTM_Parameters receives the ellipsoid parameters and
+ * UTM zone override parameter as inputs, and sets the corresponding state
+ * variables.  If any errors occur, the error code(s) are returned by the 
+ * function, otherwise UTM_NO_ERROR is returned.
+ *
+ *    a                 : Semi-major axis of ellipsoid, in meters       (input)
+ *    f                 : Flattening of ellipsoid                        (input)
+ *    override          : UTM override zone, zero indicates no override (input)
+ */
+
+  return (Set_UTM_Parameters_R(&UTM_State, a, f, override));
 } /* END OF Set_UTM_Parameters */
 
-long Convert_Geodetic_To_UTM (double Latitude,
-                              double Longitude,
-                              long   *Zone,
-                              char   *Hemisphere,
-                              double *Easting,
-                              double *Northing)
-{ 
 /*
- * The function Convert_Geodetic_To_UTM converts geodetic (latitude and
- * longitude) coordinates to UTM projection (zone, hemisphere, easting and
- * northing) coordinates according to the current ellipsoid and UTM zone
- * override parameters.  If any errors occur, the error code(s) are returned
- * by the function, otherwise UTM_NO_ERROR is returned.
+ * Zones of the Norway and Svalbard special cases, indexed by
+ * [(whole degrees of latitude - 56) / 8][whole degrees of longitude east
+ * of Greenwich], for 56 degrees north and up and the first
+ * UTM_SPECIAL_LONGITUDES degrees east; 0 where the zone is the usual one.
+ */
+#define UTM_SPECIAL_LONGITUDES 42
+
+static const unsigned char UTM_Special_Zone_Table[4][UTM_SPECIAL_LONGITUDES] =
+  {
+   /* 56 to 63 degrees north: 31V and the widened 32V */
+   {31, 31, 31, 32, 32, 32, 32, 32, 32, 32, 32, 32, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+   /* 64 to 71 degrees north: no special cases */
+   {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+   /* 72 degrees north and up: 31X, 33X, 35X and 37X, 9 or 12 degrees wide */
+   {31, 31, 31, 31, 31, 31, 31, 31, 31, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33,
+    35, 35, 35, 35, 35, 35, 35, 35, 35, 35, 35, 35, 37, 37, 37, 37, 37, 37, 37, 37, 37},
+   {31, 31, 31, 31, 31, 31, 31, 31, 31, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33,
+    35, 35, 35, 35, 35, 35, 35, 35, 35, 35, 35, 35, 37, 37, 37, 37, 37, 37, 37, 37, 37}
+  };
+
+long Get_UTM_Zone_R (const UTM_Parameters *Parameters,
+                     double *Latitude,
+                     double *Longitude,
+                     long   *Zone)
+{
+/*
+ * The function Get_UTM_Zone_R selects the UTM zone of a geodetic position,
+ * applying the Norway and Svalbard special cases and the zone override in
+ * Parameters.  Latitude and Longitude are normalised in place to the values
+ * the zone's Transverse Mercator projection expects.  If any errors occur,
+ * the error code(s) are returned by the function, otherwise UTM_NO_ERROR
+ * is returned.
  *
- *    Latitude          : Latitude in radians                 (input)
- *    Longitude         : Longitude in radians                (input)
+ *    Parameters        : UTM conversion parameters           (input)
+ *    Latitude          : Latitude in radians                 (input/output)
+ *    Longitude         : Longitude in radians                (input/output)
  *    Zone              : UTM zone                            (output)
- *    Hemisphere        : North or South hemisphere           (output)
- *    Easting           : Easting (X) in meters               (output)
- *    Northing          : Northing (Y) in meters              (output)
  */
 
   long Lat_Degrees;
   long Long_Degrees;
   long temp_zone;
   long Error_Code = UTM_NO_ERROR;
-  double Origin_Latitude = 0;
-  double Central_Meridian = 0;
-  double False_Easting = 500000;
-  double False_Northing = 0;
-  double Scale = 0.9996;
 
-  if ((Latitude < MIN_LAT) || (Latitude > MAX_LAT_UTM))
+  /* Written so that a NaN, which every comparison fails, is out of range */
+  if (!((*Latitude >= MIN_LAT) && (*Latitude <= MAX_LAT_UTM)))
   { /* Latitude out of range */
     Error_Code |= UTM_LAT_ERROR;
   }
-  if ((Longitude < -PI) || (Longitude > (2*PI)))
+  if (!((*Longitude >= -PI) && (*Longitude <= (2*PI))))
   { /* Longitude out of range */
     Error_Code |= UTM_LON_ERROR;
   }
   if (!Error_Code)
   { /* no errors */
-    if((Latitude > -1.0e-9) && (Latitude < 0))
-      Latitude = 0.0;
-    if (Longitude < 0)
-      Longitude += (2*PI) + 1.0e-10;
+    if((*Latitude > -1.0e-9) && (*Latitude < 0))
+      *Latitude = 0.0;
+    if (*Longitude < 0)
+      *Longitude += (2*PI) + 1.0e-10;
 
-    Lat_Degrees = (long)(Latitude * 180.0 / PI);
-    Long_Degrees = (long)(Longitude * 180.0 / PI);
+    Lat_Degrees = (long)(*Latitude * 180.0 / PI);
+    Long_Degrees = (long)(*Longitude * 180.0 / PI);
 
-    if (Longitude < PI)
-      temp_zone = (long)(31 + ((Longitude * 180.0 / PI) / 6.0));
+    if (*Longitude < PI)
+      temp_zone = (long)(31 + ((*Longitude * 180.0 / PI) / 6.0));
     else
-      temp_zone = (long)(((Longitude * 180.0 / PI) / 6.0) - 29);
+      temp_zone = (long)(((*Longitude * 180.0 / PI) / 6.0) - 29);
 
     if (temp_zone > 60)
       temp_zone = 1;
-    /* UTM special cases */
-    if ((Lat_Degrees > 55) && (Lat_Degrees < 64) && (Long_Degrees > -1)
-        && (Long_Degrees < 3))
-      temp_zone = 31;
-    if ((Lat_Degrees > 55) && (Lat_Degrees < 64) && (Long_Degrees > 2)
-        && (Long_Degrees < 12))
-      temp_zone = 32;
-    if ((Lat_Degrees > 71) && (Long_Degrees > -1) && (Long_Degrees < 9))
-      temp_zone = 31;
-    if ((Lat_Degrees > 71) && (Long_Degrees > 8) && (Long_Degrees < 21))
-      temp_zone = 33;
-    if ((Lat_Degrees > 71) && (Long_Degrees > 20) && (Long_Degrees < 33))
-      temp_zone = 35;
-    if ((Lat_Degrees > 71) && (Long_Degrees > 32) && (Long_Degrees < 42))
-      temp_zone = 37;
-
-    if (UTM_Override)
+    /* UTM special cases, by whole degrees; Long_Degrees is not negative */
+    if ((Lat_Degrees > 55) && (Long_Degrees < UTM_SPECIAL_LONGITUDES)
+        && UTM_Special_Zone_Table[(Lat_Degrees - 56) / 8][Long_Degrees])
+      temp_zone = UTM_Special_Zone_Table[(Lat_Degrees - 56) / 8][Long_Degrees];
+
+    if (Parameters->Override)
     {
-      if ((temp_zone == 1) && (UTM_Override == 60))
-        temp_zone = UTM_Override;
-      else if ((temp_zone == 60) && (UTM_Override == 1))
-        temp_zone = UTM_Override;
-      else if ((Lat_Degrees > 71) && (Long_Degrees > -1) && (Long_Degrees < 42))
+      if ((temp_zone == 1) && (Parameters->Override == 60))
+        temp_zone = Parameters->Override;
+      else if ((temp_zone == 60) && (Parameters->Override == 1))
+        temp_zone = Parameters->Override;
+      else if ((Lat_Degrees > 71) && (Long_Degrees < UTM_SPECIAL_LONGITUDES))
       {
-        if (((temp_zone-2) <= UTM_Override) && (UTM_Override <= (temp_zone+2)))
-          temp_zone = UTM_Override;
+        if (((temp_zone-2) <= Parameters->Override) && (Parameters->Override <= (temp_zone+2)))
+          temp_zone = Parameters->Override;
         else
           Error_Code = UTM_ZONE_OVERRIDE_ERROR;
       }
-      else if (((temp_zone-1) <= UTM_Override) && (UTM_Override <= (temp_zone+1)))
-        temp_zone = UTM_Override;
+      else if (((temp_zone-1) <= Parameters->Override) && (Parameters->Override <= (temp_zone+1)))
+        temp_zone = Parameters->Override;
       else
         Error_Code = UTM_ZONE_OVERRIDE_ERROR;
     }
     if (!Error_Code)
-    {
-      if (temp_zone >= 31)
-        Central_Meridian = (6 * temp_zone - 183) * PI / 180.0;
-      else
-        Central_Meridian = (6 * temp_zone + 177) * PI / 180.0;
       *Zone = temp_zone;
-      if (Latitude < 0)
-      {
-        False_Northing = 10000000;
-        *Hemisphere = 'S';
-      }
-      else
-        *Hemisphere = 'N';
-      Set_Transverse_Mercator_Parameters(UTM_a, UTM_f, Origin_Latitude,
-                                         Central_Meridian, False_Easting, False_Northing, Scale);
-      Convert_Geodetic_To_Transverse_Mercator(Latitude, Longitude, Easting,
-                                              Northing);
-      if ((*Easting < MIN_EASTING) || (*Easting > MAX_EASTING))
-        Error_Code = UTM_EASTING_ERROR;
-      if ((*Northing < MIN_NORTHING) || (*Northing > MAX_NORTHING))
-        Error_Code |= UTM_NORTHING_ERROR;
-    }
   } /* END OF if (!Error_Code) */
   return (Error_Code);
+} /* END OF Get_UTM_Zone_R */
+
+long Convert_Geodetic_To_UTM_Zone_R (const UTM_Parameters *Parameters,
+                                     double Latitude,
+                                     double Longitude,
+                                     long   Zone,
+                                     long   Terms,
+                                     char   *Hemisphere,
+                                     double *Easting,
+                                     double *Northing,
+                                     double *Easting_Bound,
+                                     double *Northing_Bound)
+{
+/*
+ * The function Convert_Geodetic_To_UTM_Zone_R projects a geodetic position
+ * in a zone already chosen by Get_UTM_Zone_R, with the Latitude and
+ * Longitude it normalised, as Convert_Geodetic_To_UTM_Terms_R does after
+ * choosing it.  If any errors occur, the error code(s) are returned by
+ * the function, otherwise UTM_NO_ERROR is returned.
+ *
+ *    Parameters        : UTM conversion parameters           (input)
+ *    Latitude          : Latitude in radians                 (input)
+ *    Longitude         : Longitude in radians                (input)
+ *    Zone              : UTM zone                            (input)
+ *    Terms             : TRANMERC_EXACT_TERMS, ...           (input)
+ *    Hemisphere        : North or South hemisphere           (output)
+ *    Easting           : Easting (X) in meters               (output)
+ *    Northing          : Northing (Y) in meters              (output)
+ *    Easting_Bound     : Largest error in Easting, meters    (output)
+ *    Northing_Bound    : Largest error in Northing, meters   (output)
+ */
+
+  long Error_Code = UTM_NO_ERROR;
+  const TranMerc_Projection *Projection;
+
+  *Easting_Bound = 0.0;
+  *Northing_Bound = 0.0;
+  if (Latitude < 0)
+  {
+    Projection = &UTM_Zone_Projection[Zone - 1][1];
+    *Hemisphere = 'S';
+  }
+  else
+  {
+    Projection = &UTM_Zone_Projection[Zone - 1][0];
+    *Hemisphere = 'N';
+  }
+  MGRS_PROBE_BEGIN(MGRS_PROBE_TRANSVERSE_MERCATOR);
+  Convert_Geodetic_To_Transverse_Mercator_Terms_R(&Parameters->Ellipsoid, Projection,
+                                                  Latitude, Longitude, Terms,
+                                                  Easting, Northing,
+                                                  Easting_Bound, Northing_Bound);
+  MGRS_PROBE_END(MGRS_PROBE_TRANSVERSE_MERCATOR);
+  if ((*Easting < MIN_EASTING) || (*Easting > MAX_EASTING))
+    Error_Code = UTM_EASTING_ERROR;
+  if ((*Northing < MIN_NORTHING) || (*Northing > MAX_NORTHING))
+    Error_Code |= UTM_NORTHING_ERROR;
+  return (Error_Code);
+} /* END OF Convert_Geodetic_To_UTM_Zone_R */
+
+long Convert_Geodetic_To_UTM_Terms_R (const UTM_Parameters *Parameters,
+                                      double Latitude,
+                                      double Longitude,
+                                      long   Terms,
+                                      long   *Zone,
+                                      char   *Hemisphere,
+                                      double *Easting,
+                                      double *Northing,
+                                      double *Easting_Bound,
+                                      double *Northing_Bound)
+{ 
+/*
+ * The function Convert_Geodetic_To_UTM_Terms_R converts geodetic (latitude
+ * and longitude) coordinates to UTM projection (zone, hemisphere, easting
+ * and northing) coordinates as Convert_Geodetic_To_UTM_R does, evaluating
+ * the terms of the Transverse Mercator series selected by Terms (see
+ * Convert_Geodetic_To_Transverse_Mercator_Terms_R).  Easting_Bound and
+ * Northing_Bound bound the difference from Convert_Geodetic_To_UTM_R; the
+ * error codes are the same unless Easting or Northing is within its bound
+ * of a limit of the UTM grid.  If any errors occur, the error code(s) are
+ * returned by the function, otherwise UTM_NO_ERROR is returned.
+ *
+ *    Parameters        : UTM conversion parameters           (input)
+ *    Latitude          : Latitude in radians                 (input)
+ *    Longitude         : Longitude in radians                (input)
+ *    Terms             : TRANMERC_EXACT_TERMS, ...           (input)
+ *    Zone              : UTM zone                            (output)
+ *    Hemisphere        : North or South hemisphere           (output)
+ *    Easting           : Easting (X) in meters               (output)
+ *    Northing          : Northing (Y) in meters              (output)
+ *    Easting_Bound     : Largest error in Easting, meters    (output)
+ *    Northing_Bound    : Largest error in Northing, meters   (output)
+ */
+
+  long Error_Code;
+
+  *Easting_Bound = 0.0;
+  *Northing_Bound = 0.0;
+  Error_Code = Get_UTM_Zone_R(Parameters, &Latitude, &Longitude, Zone);
+  if (!Error_Code)
+  { /* no errors */
+    Error_Code = Convert_Geodetic_To_UTM_Zone_R(Parameters, Latitude, Longitude, *Zone, Terms,
+                                                Hemisphere, Easting, Northing,
+                                                Easting_Bound, Northing_Bound);
+  }
+  return (Error_Code);
+} /* END OF Convert_Geodetic_To_UTM_Terms_R */
+
+long Convert_Geodetic_To_UTM_R (const UTM_Parameters *Parameters,
+                                double Latitude,
+                                double Longitude,
+                                long   *Zone,
+                                char   *Hemisphere,
+                                double *Easting,
+                                double *Northing)
+{ 
+/*
+ * The function Convert_Geodetic_To_UTM_R converts geodetic (latitude and
+ * longitude) coordinates to UTM projection (zone, hemisphere, easting and
+ * northing) coordinates according to the ellipsoid and UTM zone override
+ * in Parameters.  The zone's projection is taken from UTM_Zone_Projection,
+ * so no Transverse Mercator setup is repeated per call and no global state
+ * is read or written.  If any errors occur, the error code(s) are returned
+ * by the function, otherwise UTM_NO_ERROR is returned.
+ *
+ *    Parameters        : UTM conversion parameters           (input)
+ *    Latitude          : Latitude in radians                 (input)
+ *    Longitude         : Longitude in radians                (input)
+ *    Zone              : UTM zone                            (output)
+ *    Hemisphere        : North or South hemisphere           (output)
+ *    Easting           : Easting (X) in meters               (output)
+ *    Northing          : Northing (Y) in meters              (output)
+ */
+
+  double easting_bound;
+  double northing_bound;
+
+  return (Convert_Geodetic_To_UTM_Terms_R(Parameters, Latitude, Longitude,
+                                          TRANMERC_EXACT_TERMS, Zone, Hemisphere,
+                                          Easting, Northing,
+                                          &easting_bound, &northing_bound));
+} /* END OF Convert_Geodetic_To_UTM_R */
+
+long Convert_Geodetic_To_UTM (double Latitude,
+                              double Longitude,
+                              long   *Zone,
+                              char   *Hemisphere,
+                              double *Easting,
+                              double *Northing)
+{ 
+/*
+ * The function Convert_Geodetic_To_UTM converts geodetic (latitude and
+ * longitude) coordinates to UTM projection (zone, hemisphere, easting and
+ * northing) coordinates according to the current ellipsoid and UTM zone
+ * override parameters.  If any errors occur, the error code(s) are returned
+ * by the function, otherwise UTM_NO_ERROR is returned.
+ *
+ *    Latitude          : Latitude in radians                 (input)
+ *    Longitude         : Longitude in radians                (input)
+ *    Zone              : UTM zone                            (output)
+ *    Hemisphere        : North or South hemisphere           (output)
+ *    Easting           : Easting (X) in meters               (output)
+ *    Northing          : Northing (Y) in meters              (output)
+ */
+
+  return (Convert_Geodetic_To_UTM_R(&UTM_State, Latitude, Longitude,
+                                    Zone, Hemisphere, Easting, Northing));
 } /* END OF Convert_Geodetic_To_UTM */
 
+long Convert_UTM_To_Geodetic_R (const UTM_Parameters *Parameters,
+                                long   Zone,
+                                char   Hemisphere,
+                                double Easting,
+                                double Northing,
+                                double *Latitude,
+                                double *Longitude)
+{
+/*
+ * The function Convert_UTM_To_Geodetic_R converts UTM projection (zone,
+ * hemisphere, easting and northing) coordinates to geodetic (latitude
+ * and longitude) coordinates, according to the ellipsoid in Parameters.
+ * The zone override is not used.  If any errors occur, the error code(s)
+ * are returned by the function, otherwise UTM_NO_ERROR is returned.
+ *
+ *    Parameters        : UTM conversion parameters           (input)
+ *    Zone              : UTM zone                            (input)
+ *    Hemisphere        : North or South hemisphere           (input)
+ *    Easting           : Easting (X) in meters               (input)
+ *    Northing          : Northing (Y) in meters              (input)
+ *    Latitude          : Latitude in radians                 (output)
+ *    Longitude         : Longitude in radians                (output)
+ */
+
+  long Error_Code = UTM_NO_ERROR;
+  long tm_error_code;
+
+  if ((Zone < 1) || (Zone > 60))
+    Error_Code |= UTM_ZONE_ERROR;
+  if ((Hemisphere != 'S') && (Hemisphere != 'N'))
+    Error_Code |= UTM_HEMISPHERE_ERROR;
+  if ((Easting < MIN_EASTING) || (Easting > MAX_EASTING))
+    Error_Code |= UTM_EASTING_ERROR;
+  if ((Northing < MIN_NORTHING) || (Northing > MAX_NORTHING))
+    Error_Code |= UTM_NORTHING_ERROR;
+  if (!Error_Code)
+  { /* no errors */
+    tm_error_code = Convert_Transverse_Mercator_To_Geodetic_R(&Parameters->Ellipsoid,
+                                                              &UTM_Zone_Projection[Zone - 1][Hemisphere == 'S'],
+                                                              Easting, Northing,
+                                                              Latitude, Longitude);
+    if (tm_error_code)
+    {
+      if (tm_error_code & TRANMERC_EASTING_ERROR)
+        Error_Code |= UTM_EASTING_ERROR;
+      if (tm_error_code & TRANMERC_NORTHING_ERROR)
+        Error_Code |= UTM_NORTHING_ERROR;
+    }
+
+    if ((*Latitude < MIN_LAT) || (*Latitude > MAX_LAT_UTM))
+    { /* Latitude out of range */
+      Error_Code |= UTM_NORTHING_ERROR;
+    }
+  }
+  return (Error_Code);
+} /* END OF Convert_UTM_To_Geodetic_R */
+
+long Convert_UTM_To_Geodetic (long   Zone,
+                              char   Hemisphere,
+                              double Easting,
+                              double Northing,
+                              double *Latitude,
+                              double *Longitude)
+{
+/*
+ * The function Convert_UTM_To_Geodetic converts UTM projection (zone,
+ * hemisphere, easting and northing) coordinates to geodetic (latitude
+ * and longitude) coordinates, according to the current ellipsoid
+ * parameters.  If any errors occur, the error code(s) are returned by the
+ * function, otherwise UTM_NO_ERROR is returned.
+ *
+ *    Zone              : UTM zone                            (input)
+ *    Hemisphere        : North or South hemisphere           (input)
+ *    Easting           : Easting (X) in meters               (input)
+ *    Northing          : Northing (Y) in meters              (input)
+ *    Latitude          : Latitude in radians                 (output)
+ *    Longitude         : Longitude in radians                (output)
+ */
+
+  return (Convert_UTM_To_Geodetic_R(&UTM_State, Zone, Hemisphere, Easting,
+                                    Northing, Latitude, Longitude));
+} /* END OF Convert_UTM_To_Geodetic */
+
+#endif /* UTM_H */